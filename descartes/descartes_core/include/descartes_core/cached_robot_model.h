@@ -0,0 +1,170 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCARTES_CORE_CACHED_ROBOT_MODEL_H
+#define DESCARTES_CORE_CACHED_ROBOT_MODEL_H
+
+#include "descartes_core/robot_model.h"
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <boost/thread/mutex.hpp>
+
+namespace descartes_core
+{
+DESCARTES_CLASS_FORWARD(CachedRobotModel);
+
+/**
+ * @brief A RobotModel decorator that remembers the results of getAllIK(). Any RobotModel can be wrapped,
+ *        e.g. descartes_moveit::MoveitStateAdapter or descartes_moveit::IkFastMoveitStateAdapter; every
+ *        other call is forwarded to the wrapped model unchanged.
+ *
+ * Results are keyed by the requested pose, quantized to a configurable position & orientation
+ * resolution, and by the world & tool frames and collision checking setting of the model, so poses that
+ * are equal to within the resolution share an entry. Failed lookups are cached as well. The least recently
+ * used entries are evicted once the cache reaches its capacity. The cache may be saved to and restored
+ * from a file so that it survives restarts.
+ *
+ * The wrapped model's IK must be a function of the pose alone: call clear() if anything else that it
+ * depends on (a planning scene, joint limits...) changes. Safe to query from several threads at once if
+ * the wrapped model is.
+ */
+class CachedRobotModel : public RobotModel
+{
+public:
+  /**
+   * An entry costs about 220 bytes plus 90 bytes per solution of a 6 DOF model, so ~1 KB for a pose with
+   * eight solutions: the default bounds the cache at roughly 20 MB.
+   */
+  static const std::size_t DEFAULT_CAPACITY = 20000;
+
+  /**
+   * @brief Wraps 'model'. If 'model' has already been initialized, call setFrames() with the frames it
+   *        was initialized with; otherwise initialize() the decorator, which records them.
+   * @param capacity The maximum number of cached poses, see DEFAULT_CAPACITY for the memory this takes
+   */
+  explicit CachedRobotModel(RobotModelPtr model, std::size_t capacity = DEFAULT_CAPACITY);
+
+  virtual bool initialize(const std::string &robot_description, const std::string &group_name,
+                          const std::string &world_frame, const std::string &tcp_frame);
+
+  /** @brief Not cached; the result depends on the seed */
+  virtual bool getIK(const Eigen::Affine3d &pose, const std::vector<double> &seed_state,
+                     std::vector<double> &joint_pose) const;
+
+  virtual bool getAllIK(const Eigen::Affine3d &pose, std::vector<std::vector<double> > &joint_poses) const;
+  using RobotModel::getAllIK;
+
+  virtual bool getFK(const std::vector<double> &joint_pose, Eigen::Affine3d &pose) const;
+
+  virtual int getDOF() const;
+
+  virtual bool isValid(const std::vector<double> &joint_pose) const;
+
+  virtual bool isValid(const Eigen::Affine3d &pose) const;
+
+  virtual std::vector<double> getJointVelocityLimits() const;
+
+  virtual void setCheckCollisions(bool check_collisions);
+
+  virtual bool getCheckCollisions();
+
+  virtual bool isValidMove(const double* s, const double* f, double dt) const;
+
+  /** @brief Sets the world & tool frames that identify the wrapped model's IK results */
+  void setFrames(const std::string &world_frame, const std::string &tcp_frame);
+
+  /**
+   * @brief Sets the quantization of cache keys. Also clears the cache.
+   * @param position Linear resolution, in meters
+   * @param orientation Resolution of each unit quaternion component
+   */
+  void setResolution(double position, double orientation);
+
+  /** @brief Drops every cached entry; the hit and miss counters are kept */
+  void clear();
+
+  std::size_t size() const;
+  std::size_t capacity() const { return capacity_; }
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+  /**
+   * @brief Writes every cached entry to 'path'
+   * @return True if the file was written completely
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * @brief Adds the entries saved in 'path' to the cache. Fails, leaving the cache unchanged, if the file
+   *        is unreadable or was saved with a different DOF or resolution.
+   */
+  bool load(const std::string &path);
+
+  const RobotModelPtr& model() const { return model_; }
+
+private:
+  // Quantized pose (x, y, z, qx, qy, qz, qw) plus a hash of the frames & collision setting
+  struct Key
+  {
+    std::array<std::int64_t, 7> pose;
+    std::uint64_t context;
+
+    bool operator==(const Key &other) const { return context == other.context && pose == other.pose; }
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  struct Entry
+  {
+    Key key;
+    bool found;
+    std::vector<std::vector<double> > joint_poses;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  Key makeKey(const Eigen::Affine3d &pose) const;
+  void updateContext();
+  // Expects 'mutex_' to be held
+  void insert(Entry &&entry) const;
+
+  RobotModelPtr model_;
+  std::size_t capacity_;
+  double position_resolution_;
+  double orientation_resolution_;
+  std::string world_frame_;
+  std::string tcp_frame_;
+  std::uint64_t context_;
+
+  // Most recently used entries are at the front of 'entries_'
+  mutable EntryList entries_;
+  mutable std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  mutable std::size_t hits_;
+  mutable std::size_t misses_;
+  mutable boost::mutex mutex_;
+};
+
+} // descartes_core
+
+#endif
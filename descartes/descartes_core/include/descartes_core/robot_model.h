@@ -21,6 +21,7 @@
 
 // TODO: The include below picks up Eigen::Affine3d, but there is probably a better way
 #include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <eigen_stl_containers/eigen_stl_vector_container.h>
 #include "descartes_core/utils.h"
 
 namespace descartes_core
@@ -63,6 +64,38 @@ public:
    */
   virtual bool getAllIK(const Eigen::Affine3d &pose, std::vector<std::vector<double> > &joint_poses) const = 0;
 
+  /**
+   * @brief Batched form of getAllIK() that writes every solution of every pose into one flat buffer. The
+   *        solutions of poses[i] are the getDOF() sized rows [offsets[i], offsets[i + 1]) of 'joint_data'.
+   *        The default calls the single pose getAllIK() for each pose; implementations that can solve
+   *        straight into the buffer override it.
+   * @param poses Affine poses of TOOL in WOBJ frame
+   * @param joint_data Solutions of all poses, back to back. Cleared first.
+   * @param offsets Row offsets of each pose's solutions; resized to poses.size() + 1
+   * @return True if every pose has at least one solution
+   */
+  virtual bool getAllIK(const EigenSTL::vector_Affine3d &poses, std::vector<double> &joint_data,
+                        std::vector<std::size_t> &offsets) const
+  {
+    joint_data.clear();
+    offsets.resize(poses.size() + 1);
+    offsets[0] = 0;
+
+    std::vector<std::vector<double> > joint_poses;
+    bool all_found = true;
+    for (std::size_t i = 0; i < poses.size(); ++i)
+    {
+      if (!getAllIK(poses[i], joint_poses))
+        joint_poses.clear();
+      for (const auto &sol : joint_poses)
+        joint_data.insert(joint_data.end(), sol.begin(), sol.end());
+
+      offsets[i + 1] = offsets[i] + joint_poses.size();
+      all_found = all_found && !joint_poses.empty();
+    }
+    return all_found;
+  }
+
   /**
    * @brief Returns the affine pose
    * @param joint_pose Solution (if function successful).
@@ -138,6 +138,22 @@ public:
    * discretization used.
    */
   virtual void getJointPoses(const RobotModel &model, std::vector<std::vector<double> > &joint_poses) const = 0;
+
+  /**@brief Like the above, with the solutions laid out back to back, getDOF() values each, in 'joint_data'.
+   * The default flattens the result of the above; points that solve several Cartesian poses override it to
+   * use the batched RobotModel::getAllIK().
+   * @param model Robot model object used to calculate pose
+   * @param joint_data Solutions of this point. Cleared first.
+   */
+  virtual void getJointPoses(const RobotModel &model, std::vector<double> &joint_data) const
+  {
+    std::vector<std::vector<double> > joint_poses;
+    getJointPoses(model, joint_poses);
+
+    joint_data.clear();
+    for (const auto &sol : joint_poses)
+      joint_data.insert(joint_data.end(), sol.begin(), sol.end());
+  }
   /** @} (end section) */
 
   /**@brief Check if state satisfies trajectory point requirements.
@@ -0,0 +1,361 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_core/cached_robot_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <Eigen/Geometry>
+#include <ros/console.h>
+
+namespace
+{
+
+const char SNAPSHOT_MAGIC[8] = {'D', 'S', 'C', 'I', 'K', 'C', '0', '1'};
+
+const double DEFAULT_POSITION_RESOLUTION = 1e-5;    // m
+const double DEFAULT_ORIENTATION_RESOLUTION = 1e-5; // unit quaternion component
+
+// FNV-1a; unlike std::hash, stable across builds so that saved caches stay valid
+std::uint64_t fnv1a(const void* data, std::size_t n, std::uint64_t hash = 14695981039346656037ULL)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+template <typename T>
+void write(std::ostream& os, const T& value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read(std::istream& is, T& value)
+{
+  return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // anon namespace
+
+namespace descartes_core
+{
+
+const std::size_t CachedRobotModel::DEFAULT_CAPACITY;
+
+CachedRobotModel::CachedRobotModel(RobotModelPtr model, std::size_t capacity)
+  : model_(std::move(model))
+  , capacity_(capacity)
+  , position_resolution_(DEFAULT_POSITION_RESOLUTION)
+  , orientation_resolution_(DEFAULT_ORIENTATION_RESOLUTION)
+  , context_(0)
+  , hits_(0)
+  , misses_(0)
+{
+  if (!model_)
+    throw std::invalid_argument("CachedRobotModel requires a robot model to wrap");
+  if (capacity_ == 0)
+    throw std::invalid_argument("CachedRobotModel capacity must be positive");
+
+  check_collisions_ = model_->getCheckCollisions();
+  updateContext();
+}
+
+bool CachedRobotModel::initialize(const std::string& robot_description, const std::string& group_name,
+                                  const std::string& world_frame, const std::string& tcp_frame)
+{
+  if (!model_->initialize(robot_description, group_name, world_frame, tcp_frame))
+    return false;
+
+  setFrames(world_frame, tcp_frame);
+  return true;
+}
+
+bool CachedRobotModel::getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
+                             std::vector<double>& joint_pose) const
+{
+  return model_->getIK(pose, seed_state, joint_pose);
+}
+
+bool CachedRobotModel::getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const
+{
+  const Key key = makeKey(pose);
+
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end())
+    {
+      // Move the entry to the front of the LRU list
+      entries_.splice(entries_.begin(), entries_, it->second);
+      ++hits_;
+      joint_poses = it->second->joint_poses;
+      return it->second->found;
+    }
+    ++misses_;
+  }
+
+  // Solve without holding the lock so that other threads can carry on; if two threads miss on the same key
+  // the second insert is simply dropped
+  Entry entry;
+  entry.key = key;
+  entry.found = model_->getAllIK(pose, entry.joint_poses);
+  joint_poses = entry.joint_poses;
+  const bool found = entry.found;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  insert(std::move(entry));
+  return found;
+}
+
+bool CachedRobotModel::getFK(const std::vector<double>& joint_pose, Eigen::Affine3d& pose) const
+{
+  return model_->getFK(joint_pose, pose);
+}
+
+int CachedRobotModel::getDOF() const
+{
+  return model_->getDOF();
+}
+
+bool CachedRobotModel::isValid(const std::vector<double>& joint_pose) const
+{
+  return model_->isValid(joint_pose);
+}
+
+bool CachedRobotModel::isValid(const Eigen::Affine3d& pose) const
+{
+  return model_->isValid(pose);
+}
+
+std::vector<double> CachedRobotModel::getJointVelocityLimits() const
+{
+  return model_->getJointVelocityLimits();
+}
+
+void CachedRobotModel::setCheckCollisions(bool check_collisions)
+{
+  model_->setCheckCollisions(check_collisions);
+  check_collisions_ = check_collisions;
+  updateContext();
+}
+
+bool CachedRobotModel::getCheckCollisions()
+{
+  return model_->getCheckCollisions();
+}
+
+bool CachedRobotModel::isValidMove(const double* s, const double* f, double dt) const
+{
+  return model_->isValidMove(s, f, dt);
+}
+
+void CachedRobotModel::setFrames(const std::string& world_frame, const std::string& tcp_frame)
+{
+  world_frame_ = world_frame;
+  tcp_frame_ = tcp_frame;
+  updateContext();
+}
+
+void CachedRobotModel::setResolution(double position, double orientation)
+{
+  if (position <= 0.0 || orientation <= 0.0)
+    throw std::invalid_argument("CachedRobotModel resolutions must be positive");
+
+  boost::mutex::scoped_lock lock(mutex_);
+  position_resolution_ = position;
+  orientation_resolution_ = orientation;
+  entries_.clear();
+  index_.clear();
+}
+
+void CachedRobotModel::clear()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+std::size_t CachedRobotModel::size() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t CachedRobotModel::hits() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return hits_;
+}
+
+std::size_t CachedRobotModel::misses() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return misses_;
+}
+
+bool CachedRobotModel::save(const std::string& path) const
+{
+  std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    ROS_ERROR_STREAM("Could not open IK cache file '" << path << "' for writing");
+    return false;
+  }
+
+  boost::mutex::scoped_lock lock(mutex_);
+
+  file.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  write(file, static_cast<std::uint32_t>(model_->getDOF()));
+  write(file, position_resolution_);
+  write(file, orientation_resolution_);
+  write(file, static_cast<std::uint64_t>(entries_.size()));
+
+  // Least recently used first so that loading the file restores the LRU order
+  for (auto it = entries_.rbegin(); it != entries_.rend(); ++it)
+  {
+    write(file, it->key.pose);
+    write(file, it->key.context);
+    write(file, static_cast<std::uint8_t>(it->found));
+    write(file, static_cast<std::uint32_t>(it->joint_poses.size()));
+    for (const auto& sol : it->joint_poses)
+      file.write(reinterpret_cast<const char*>(sol.data()), sol.size() * sizeof(double));
+  }
+
+  return static_cast<bool>(file);
+}
+
+bool CachedRobotModel::load(const std::string& path)
+{
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file)
+  {
+    ROS_WARN_STREAM("Could not open IK cache file '" << path << "'");
+    return false;
+  }
+
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  std::uint32_t dof;
+  double position_resolution, orientation_resolution;
+  std::uint64_t n_entries;
+
+  if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+      !read(file, dof) || !read(file, position_resolution) || !read(file, orientation_resolution) ||
+      !read(file, n_entries))
+  {
+    ROS_ERROR_STREAM("'" << path << "' is not an IK cache file");
+    return false;
+  }
+
+  if (static_cast<int>(dof) != model_->getDOF() || position_resolution != position_resolution_ ||
+      orientation_resolution != orientation_resolution_)
+  {
+    ROS_ERROR_STREAM("IK cache file '" << path << "' was saved for a different DOF or resolution");
+    return false;
+  }
+
+  // Read everything before touching the cache so that a truncated file changes nothing
+  std::vector<Entry> loaded;
+  loaded.reserve(std::min<std::uint64_t>(n_entries, capacity_));
+  for (std::uint64_t i = 0; i < n_entries; ++i)
+  {
+    Entry entry;
+    std::uint8_t found;
+    std::uint32_t n_sols;
+    if (!read(file, entry.key.pose) || !read(file, entry.key.context) || !read(file, found) || !read(file, n_sols))
+    {
+      ROS_ERROR_STREAM("IK cache file '" << path << "' is truncated");
+      return false;
+    }
+
+    entry.found = found != 0;
+    entry.joint_poses.assign(n_sols, std::vector<double>(dof));
+    for (auto& sol : entry.joint_poses)
+    {
+      if (!file.read(reinterpret_cast<char*>(sol.data()), dof * sizeof(double)))
+      {
+        ROS_ERROR_STREAM("IK cache file '" << path << "' is truncated");
+        return false;
+      }
+    }
+    loaded.push_back(std::move(entry));
+  }
+
+  boost::mutex::scoped_lock lock(mutex_);
+  for (auto& entry : loaded)
+    insert(std::move(entry));
+
+  ROS_INFO_STREAM("Loaded " << loaded.size() << " IK cache entries from '" << path << "'");
+  return true;
+}
+
+std::size_t CachedRobotModel::KeyHash::operator()(const Key& key) const
+{
+  return static_cast<std::size_t>(fnv1a(key.pose.data(), sizeof(key.pose), key.context));
+}
+
+CachedRobotModel::Key CachedRobotModel::makeKey(const Eigen::Affine3d& pose) const
+{
+  Eigen::Quaterniond q (pose.rotation());
+  q.normalize();
+  // q and -q are the same rotation; pick the one with a non-negative w
+  if (q.w() < 0.0) q.coeffs() *= -1.0;
+
+  const Eigen::Vector3d& t = pose.translation();
+
+  Key key;
+  for (int i = 0; i < 3; ++i)
+    key.pose[i] = static_cast<std::int64_t>(std::llround(t(i) / position_resolution_));
+  for (int i = 0; i < 4; ++i) // x, y, z, w
+    key.pose[3 + i] = static_cast<std::int64_t>(std::llround(q.coeffs()(i) / orientation_resolution_));
+  key.context = context_;
+  return key;
+}
+
+void CachedRobotModel::updateContext()
+{
+  const std::uint8_t collisions = check_collisions_ ? 1 : 0;
+  auto hash = fnv1a(world_frame_.data(), world_frame_.size());
+  hash = fnv1a("\0", 1, hash);
+  hash = fnv1a(tcp_frame_.data(), tcp_frame_.size(), hash);
+  context_ = fnv1a(&collisions, 1, hash);
+}
+
+void CachedRobotModel::insert(Entry&& entry) const
+{
+  if (index_.count(entry.key)) return;
+
+  entries_.push_front(std::move(entry));
+  index_[entries_.front().key] = entries_.begin();
+
+  if (entries_.size() > capacity_)
+  {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+} // descartes_core
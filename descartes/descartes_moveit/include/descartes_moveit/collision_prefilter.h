@@ -0,0 +1,141 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLLISION_PREFILTER_H
+#define COLLISION_PREFILTER_H
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/robot_state.h>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace descartes_moveit
+{
+/**
+ * @brief Broad phase collision test that settles most states of a move group without running the exact
+ *        (narrow phase) checker of the planning scene.
+ *
+ * The links moved by the group are 'moving'; the rest of the robot (e.g. a workcell described in the URDF)
+ * and the world objects of the planning scene make up the static scene, which is voxelized once. Each voxel
+ * holds a bitmask of the static bodies that may touch it and a second mask of the bodies that certainly
+ * contain it; a coarse grid of blocks of voxels ORs the fine masks together so that most probes stop at the
+ * first level. Every moving link caches, in its own frame:
+ *  - a bounding sphere of its (padded) collision geometry
+ *  - 'inner' points that lie inside its geometry, namely the centers of its primitive shapes
+ *  - masks of the static bodies the allowed collision matrix lets it touch
+ *
+ * A state is CLEAR if no moving link's sphere reaches a voxel of a static body it may not touch and no two
+ * moving links that may not touch have overlapping spheres. It is COLLIDING if an inner point of a link
+ * lies in a voxel that is inside a static primitive the link may not touch. Anything else is UNKNOWN and
+ * must go to the exact checker. Both verdicts are conservative with respect to a collision request made
+ * for the same group.
+ *
+ * Immutable once built, so classify() may be called from any number of threads.
+ */
+class CollisionPrefilter
+{
+public:
+  enum Result
+  {
+    CLEAR,
+    COLLIDING,
+    UNKNOWN
+  };
+
+  static const double DEFAULT_RESOLUTION; // m
+
+  /**
+   * @brief Builds the prefilter for 'group_name' with the static links posed as in 'state'. Check
+   *        isUsable() afterwards: the scene may hold geometry the prefilter cannot bound.
+   * @param resolution Voxel edge length; coarsened automatically if the grid would be too large
+   */
+  CollisionPrefilter(const planning_scene::PlanningScene& scene, const moveit::core::RobotState& state,
+                     const std::string& group_name, double resolution = DEFAULT_RESOLUTION);
+
+  /**
+   * @brief False if the scene contains unbounded shapes (planes) or bodies attached to the robot; every
+   *        state is then UNKNOWN
+   */
+  bool isUsable() const
+  {
+    return usable_;
+  }
+
+  /**
+   * @brief Classifies 'state', whose link transforms must be up to date (see RobotState::update())
+   */
+  Result classify(const moveit::core::RobotState& state) const;
+
+  double resolution() const
+  {
+    return resolution_;
+  }
+
+private:
+  typedef std::uint64_t BodyMask;
+
+  struct MovingLink
+  {
+    const moveit::core::LinkModel* link;
+    Eigen::Vector3d center; // bounding sphere, link frame
+    double radius;
+    std::vector<Eigen::Vector3d> inner_points; // link frame
+    BodyMask check_mask;                       // static bodies that are not always allowed to touch it
+    BodyMask hard_mask;                        // static bodies a contact with always counts as a collision
+  };
+
+  struct LinkPair
+  {
+    std::size_t a, b;
+  };
+
+  void build(const planning_scene::PlanningScene& scene, const moveit::core::RobotState& state,
+             const std::string& group_name, double resolution);
+
+  // Voxel index of a point, clamped to the grid
+  void cellOf(const Eigen::Vector3d& p, int cell[3]) const;
+  std::size_t index(int x, int y, int z) const
+  {
+    return (static_cast<std::size_t>(z) * dims_[1] + y) * dims_[0] + x;
+  }
+  std::size_t coarseIndex(int x, int y, int z) const
+  {
+    return (static_cast<std::size_t>(z) * coarse_dims_[1] + y) * coarse_dims_[0] + x;
+  }
+
+  bool sphereHitsScene(const Eigen::Vector3d& center, double radius, BodyMask mask) const;
+  bool pointInSolid(const Eigen::Vector3d& p, BodyMask mask) const;
+
+  bool usable_;
+  double resolution_;
+  Eigen::Vector3d origin_; // min corner of voxel (0, 0, 0)
+  int dims_[3];
+  int coarse_dims_[3];
+  std::vector<BodyMask> touch_;  // bodies that may touch each voxel
+  std::vector<BodyMask> solid_;  // bodies that contain each voxel entirely
+  std::vector<BodyMask> coarse_; // OR of 'touch_' over each block of voxels
+
+  std::vector<MovingLink> links_;
+  std::vector<LinkPair> link_pairs_; // moving links that are not always allowed to touch
+};
+
+typedef boost::shared_ptr<const CollisionPrefilter> CollisionPrefilterConstPtr;
+
+}  // end namespace 'descartes_moveit'
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IKFAST_FLAT_SOLUTION_LIST_H
+#define IKFAST_FLAT_SOLUTION_LIST_H
+
+#include <cmath>
+#include <vector>
+
+// The ikfast:: solution types come from the header generated with the solver, which must be included first
+
+namespace descartes_moveit
+{
+/**
+ * @brief IKFast solution list that writes each solution's joint values straight into a flat buffer instead of
+ *        keeping one heap allocated IkSolution per solution. Free parameters are taken to be zero. Used by
+ *        IkFastMoveitStateAdapter::solveIK() overrides that call a generated ComputeIk() directly.
+ */
+template <typename T>
+class IkFastFlatSolutionList : public ikfast::IkSolutionListBase<T>
+{
+public:
+  /**
+   * @param buffer Solutions are appended to it, 'dof' values each
+   * @param dof The number of joints of the solver, i.e. its GetNumJoints()
+   */
+  IkFastFlatSolutionList(std::vector<double>& buffer, std::size_t dof)
+    : buffer_(buffer)
+    , start_(buffer.size())
+    , dof_(dof)
+    , last_(std::vector<ikfast::IkSingleDOFSolutionBase<T> >(), std::vector<int>())
+  {
+  }
+
+  virtual size_t AddSolution(const std::vector<ikfast::IkSingleDOFSolutionBase<T> >& vinfos,
+                             const std::vector<int>& /*vfree*/)
+  {
+    for (const auto& info : vinfos)
+    {
+      // Same evaluation as ikfast::IkSolution::GetSolution() with all free values at zero
+      double value = info.foffset;
+      if (info.freeind >= 0)
+      {
+        if (value > M_PI)
+          value -= 2.0 * M_PI;
+        else if (value < -M_PI)
+          value += 2.0 * M_PI;
+      }
+      buffer_.push_back(value);
+    }
+    return GetNumSolutions() - 1;
+  }
+
+  /** @brief Only used by IKFast's stand alone main(); rebuilds an IkSolution from the stored values */
+  virtual const ikfast::IkSolutionBase<T>& GetSolution(size_t index) const
+  {
+    std::vector<ikfast::IkSingleDOFSolutionBase<T> > vinfos(dof_);
+    for (std::size_t i = 0; i < dof_; ++i)
+      vinfos[i].foffset = buffer_[start_ + index * dof_ + i];
+    last_ = ikfast::IkSolution<T>(vinfos, std::vector<int>());
+    return last_;
+  }
+
+  virtual size_t GetNumSolutions() const
+  {
+    return (buffer_.size() - start_) / dof_;
+  }
+
+  virtual void Clear()
+  {
+    buffer_.resize(start_);
+  }
+
+private:
+  std::vector<double>& buffer_;
+  std::size_t start_;
+  std::size_t dof_;
+  mutable ikfast::IkSolution<T> last_;
+};
+
+}  // end namespace 'descartes_moveit'
+#endif
@@ -20,6 +20,7 @@
 #define IKFAST_MOVEIT_STATE_ADAPTER_H
 
 #include "descartes_moveit/moveit_state_adapter.h"
+#include <eigen_stl_containers/eigen_stl_vector_container.h>
 
 namespace descartes_moveit
 {
@@ -35,6 +36,18 @@ public:
 
   virtual bool getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const;
 
+  /**
+   * @brief Batched form of getAllIK() that solves every pose straight into one flat buffer, ready to be handed
+   *        to descartes_planner::LadderGraph::assignRung(). The solutions of poses[i] are the getDOF() sized
+   *        rows [offsets[i], offsets[i + 1]) of 'joint_data'.
+   *
+   * Both output buffers are reused: once they have grown to the size of a typical batch, repeated calls
+   * allocate nothing in this class.
+   * @return True if every pose has at least one valid solution
+   */
+  virtual bool getAllIK(const EigenSTL::vector_Affine3d& poses, std::vector<double>& joint_data,
+                        std::vector<std::size_t>& offsets) const;
+
   virtual bool getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
                      std::vector<double>& joint_pose) const;
 
@@ -49,6 +62,21 @@ public:
 protected:
   bool computeIKFastTransforms();
 
+  /**
+   * @brief Computes the raw IKFast solutions of 'pose', given between the IKFast base and tool frames, and
+   *        appends them, getDOF() values each, to 'solutions'. The default goes through the MoveIt
+   *        kinematics plugin; robot models linked against the generated solver may override this to call
+   *        it directly.
+   * @return The number of solutions appended
+   */
+  virtual std::size_t solveIK(const Eigen::Affine3d& pose, std::vector<double>& solutions) const;
+
+  /**
+   * @brief Appends the valid members of 'solutions', plus their copies with the last joint turned by
+   *        +/-2PI, to 'joint_data'. Returns the number of rows appended.
+   */
+  std::size_t appendValidSolutions(const std::vector<double>& solutions, std::vector<double>& joint_data) const;
+
   /**
    * The IKFast implementation commonly solves between 'base_link' of a robot
    * and 'tool0'. We will commonly want to take advantage of an additional
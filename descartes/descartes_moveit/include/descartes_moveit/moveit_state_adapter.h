@@ -21,6 +21,8 @@
 
 #include "descartes_core/robot_model.h"
 #include "descartes_trajectory/cart_trajectory_pt.h"
+#include "descartes_moveit/robot_state_pool.h"
+#include "descartes_moveit/collision_prefilter.h"
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_model_loader/robot_model_loader.h>
@@ -30,6 +32,16 @@ namespace descartes_moveit
 {
 /**
  * @brief MoveitStateAdapter adapts the MoveIt RobotState to the Descartes RobotModel interface
+ *
+ * Thread safety: once initialized, the const query methods (getIK, getAllIK, getFK, isValid and
+ * isValidMove) may be called concurrently from any number of threads. Each query borrows its own
+ * RobotState and collision scratch objects from an internal pool, so no query mutates shared state.
+ * The IK solver plugin of the move group must itself be reentrant (the IKFast plugins are).
+ * initialize(), setState(), setSeedStates(), setCheckCollisions() and setUseCollisionPrefilter() must
+ * not be called while queries are running.
+ *
+ * Collision checks first go through a CollisionPrefilter built from the static part of the planning
+ * scene; only the states it cannot settle reach the exact checker.
  */
 class MoveitStateAdapter : public descartes_core::RobotModel
 {
@@ -50,6 +62,7 @@ public:
                      std::vector<double> &joint_pose) const;
 
   virtual bool getAllIK(const Eigen::Affine3d &pose, std::vector<std::vector<double> > &joint_poses) const;
+  using descartes_core::RobotModel::getAllIK;
 
   virtual bool getFK(const std::vector<double> &joint_pose, Eigen::Affine3d &pose) const;
 
@@ -82,7 +95,8 @@ public:
   }
 
   /**
-   * @brief Returns the underlying moveit state object so it can be used to generate seeds
+   * @brief Returns the underlying moveit state object so it can be used to generate seeds. Queries do
+   *        not read this object; use setState() to change the state they start from.
    */
   moveit::core::RobotStatePtr getState()
   {
@@ -92,18 +106,31 @@ public:
   /**
    * @brief Copies the internal state of 'state' into this model. Useful for initializing the
    *        value of joints that are not part of the active move group. Should be called after
-   *        'initialize()'.
+   *        'initialize()' and not while other threads are running queries.
    */
   void setState(const moveit::core::RobotState &state);
 
+  /**
+   * @brief Enables or disables the CollisionPrefilter that settles most collision checks before the
+   *        planning scene's exact checker runs (enabled by default). Stage counts are reported through
+   *        swri_profiler. Must not be called while queries are running.
+   */
+  void setUseCollisionPrefilter(bool use);
+
+  bool getUseCollisionPrefilter() const
+  {
+    return use_collision_prefilter_;
+  }
+
 protected:
   /**
    * Gets IK solution (assumes robot state is pre-seeded)
+   * @param state The caller's scratch state, seeded with the initial guess
    * @param pose Affine pose of TOOL in WOBJ frame
    * @param joint_pose Solution (if function successful).
    * @return
    */
-  bool getIK(const Eigen::Affine3d &pose, std::vector<double> &joint_pose) const;
+  bool getIK(moveit::core::RobotState &state, const Eigen::Affine3d &pose, std::vector<double> &joint_pose) const;
 
   /**
    * TODO: Checks for collisions at this joint pose. The setCollisionCheck(true) must have been
@@ -112,16 +139,41 @@ protected:
    */
   bool isInCollision(const std::vector<double> &joint_pose) const;
 
+  /**
+   * @brief Allocation free variants of isValid() and isInCollision() for hot loops. 'joint_pose'
+   *        must hold getDOF() values; unlike isValid(const std::vector<double>&) these do not
+   *        check the size and are not virtual.
+   */
+  bool isValid(const double* joint_pose) const;
+
+  bool isInCollision(const double* joint_pose) const;
+
   /**
    * Maximum joint velocities (rad/s) for each joint in the chain. Used for checking in
    * `isValidMove()`
    */
   std::vector<double> velocity_limits_;
 
-  mutable moveit::core::RobotStatePtr robot_state_;
+  moveit::core::RobotStatePtr robot_state_;
+
+  /**
+   * @brief Per-query scratch states, copied from 'robot_state_'
+   */
+  RobotStatePool state_pool_;
 
   planning_scene::PlanningScenePtr planning_scene_;
 
+  /**
+   * @brief Rebuilds 'collision_prefilter_' from the planning scene & 'robot_state_'
+   */
+  void updateCollisionPrefilter();
+
+  /**
+   * @brief Broad phase collision test built from the static part of 'planning_scene_'; null if disabled
+   */
+  CollisionPrefilterConstPtr collision_prefilter_;
+  bool use_collision_prefilter_;
+
   robot_model::RobotModelConstPtr robot_model_ptr_;
 
   robot_model_loader::RobotModelLoaderPtr robot_model_loader_;
@@ -0,0 +1,112 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ROBOT_STATE_POOL_H
+#define ROBOT_STATE_POOL_H
+
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/collision_detection/collision_common.h>
+#include <boost/thread/mutex.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace descartes_moveit
+{
+/**
+ * @brief The scratch objects a single IK, FK or collision query works in
+ */
+struct StateContext
+{
+  StateContext(const moveit::core::RobotState& prototype, const std::string& group_name, unsigned generation)
+    : state(prototype), generation(generation)
+  {
+    collision_request.group_name = group_name;
+  }
+
+  moveit::core::RobotState state;
+  collision_detection::CollisionRequest collision_request;
+  collision_detection::CollisionResult collision_result;
+  unsigned generation; // the prototype this context was copied from
+};
+
+/**
+ * @brief RobotStatePool hands out StateContext objects to concurrent callers. A context is borrowed
+ *        for the duration of one query through a Lease and goes back to the pool when the lease is
+ *        destroyed, so the pool only grows to the peak number of concurrent queries.
+ *
+ *        acquire() may be called from any thread. reset() must not run concurrently with queries.
+ */
+class RobotStatePool
+{
+public:
+  class Lease
+  {
+  public:
+    Lease(const RobotStatePool* pool, std::unique_ptr<StateContext> ctx) : pool_(pool), ctx_(std::move(ctx)) {}
+
+    Lease(Lease&& other) : pool_(other.pool_), ctx_(std::move(other.ctx_)) {}
+
+    ~Lease()
+    {
+      if (ctx_) pool_->release(std::move(ctx_));
+    }
+
+    StateContext& operator*() const { return *ctx_; }
+    StateContext* operator->() const { return ctx_.get(); }
+
+  private:
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    const RobotStatePool* pool_;
+    std::unique_ptr<StateContext> ctx_;
+  };
+
+  RobotStatePool() : generation_(0), created_(0) {}
+
+  /**
+   * @brief Sets the state that new contexts are copied from and discards every idle context. Contexts
+   *        currently on lease are discarded when they are returned.
+   */
+  void reset(const moveit::core::RobotState& prototype, const std::string& group_name);
+
+  /**
+   * @brief Borrows a context, creating a new one from the prototype if none are idle
+   */
+  Lease acquire() const;
+
+  /**
+   * @brief The number of contexts created since the last reset()
+   */
+  std::size_t size() const;
+
+private:
+  void release(std::unique_ptr<StateContext> ctx) const;
+
+  mutable boost::mutex mutex_;
+  std::unique_ptr<moveit::core::RobotState> prototype_;
+  std::string group_name_;
+  unsigned generation_;
+  mutable std::vector<std::unique_ptr<StateContext>> idle_;
+  mutable std::size_t created_;
+};
+
+}  // descartes_moveit
+
+#endif  // ROBOT_STATE_POOL_H
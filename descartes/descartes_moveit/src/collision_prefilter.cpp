@@ -0,0 +1,583 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_moveit/collision_prefilter.h"
+
+#include <geometric_shapes/shape_operations.h>
+#include <octomap/octomap.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace
+{
+typedef std::uint64_t BodyMask;
+
+// Static bodies past the 64th share the last bit of the masks
+const std::size_t MAX_BODY_BITS = 64;
+// Upper bound on the number of voxels; the resolution is coarsened until the grid fits
+const std::size_t MAX_VOXELS = 1 << 20;
+// Edge length, in voxels, of the blocks of the coarse grid
+const int BLOCK = 8;
+
+BodyMask bodyBit(std::size_t body)
+{
+  return BodyMask(1) << std::min(body, MAX_BODY_BITS - 1);
+}
+
+enum Contact
+{
+  IGNORED, // always allowed by the ACM: never checked
+  CHECKED, // conditionally allowed: checked, but may not count as a collision
+  COUNTED  // always a collision
+};
+
+Contact contactType(const collision_detection::AllowedCollisionMatrix& acm, const std::string& a,
+                    const std::string& b)
+{
+  collision_detection::AllowedCollision::Type type;
+  if (!acm.getAllowedCollision(a, b, type))
+    return COUNTED;
+
+  switch (type)
+  {
+    case collision_detection::AllowedCollision::ALWAYS:
+      return IGNORED;
+    case collision_detection::AllowedCollision::NEVER:
+      return COUNTED;
+    default:
+      return CHECKED;
+  }
+}
+
+/**
+ * A piece of the static scene: one shape of a static link or world object, or one occupied octree cell,
+ * posed in the planning frame. The exact checker tests robot links against each other unpadded and world
+ * objects carry no padding, so neither is padded here.
+ */
+struct StaticShape
+{
+  shapes::ShapeConstPtr shape;
+  Eigen::Matrix3d rotation;
+  Eigen::Vector3d translation;
+  std::size_t body;
+};
+
+// Half extents, in the shape's frame, of the box bounding a centered primitive
+bool primitiveHalfExtents(const shapes::Shape& shape, Eigen::Vector3d& half)
+{
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+    {
+      const double r = static_cast<const shapes::Sphere&>(shape).radius;
+      half = Eigen::Vector3d(r, r, r);
+      return true;
+    }
+    case shapes::BOX:
+    {
+      const double* size = static_cast<const shapes::Box&>(shape).size;
+      half = 0.5 * Eigen::Vector3d(size[0], size[1], size[2]);
+      return true;
+    }
+    case shapes::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const shapes::Cylinder&>(shape);
+      half = Eigen::Vector3d(cylinder.radius, cylinder.radius, 0.5 * cylinder.length);
+      return true;
+    }
+    case shapes::CONE:
+    {
+      const auto& cone = static_cast<const shapes::Cone&>(shape);
+      half = Eigen::Vector3d(cone.radius, cone.radius, 0.5 * cone.length);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Whether 'p', given in the frame of a convex primitive, lies inside it
+bool insidePrimitive(const shapes::Shape& shape, const Eigen::Vector3d& p)
+{
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+      return p.norm() <= static_cast<const shapes::Sphere&>(shape).radius;
+    case shapes::BOX:
+    {
+      const double* size = static_cast<const shapes::Box&>(shape).size;
+      return std::abs(p.x()) <= 0.5 * size[0] && std::abs(p.y()) <= 0.5 * size[1] &&
+             std::abs(p.z()) <= 0.5 * size[2];
+    }
+    case shapes::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const shapes::Cylinder&>(shape);
+      return p.head<2>().norm() <= cylinder.radius && std::abs(p.z()) <= 0.5 * cylinder.length;
+    }
+    default:
+      return false;
+  }
+}
+
+void expand(Eigen::Vector3d& lo, Eigen::Vector3d& hi, const Eigen::Vector3d& p)
+{
+  lo = lo.cwiseMin(p);
+  hi = hi.cwiseMax(p);
+}
+
+// Bounds of a static shape in the planning frame
+bool staticShapeBounds(const StaticShape& s, Eigen::Vector3d& lo, Eigen::Vector3d& hi)
+{
+  Eigen::Vector3d half;
+  if (primitiveHalfExtents(*s.shape, half))
+  {
+    const Eigen::Vector3d world_half = s.rotation.cwiseAbs() * half;
+    lo = s.translation - world_half;
+    hi = s.translation + world_half;
+    return true;
+  }
+
+  if (s.shape->type == shapes::MESH)
+  {
+    const auto& mesh = static_cast<const shapes::Mesh&>(*s.shape);
+    lo.setConstant(std::numeric_limits<double>::max());
+    hi.setConstant(-std::numeric_limits<double>::max());
+    for (unsigned i = 0; i < mesh.vertex_count; ++i)
+      expand(lo, hi, s.rotation * Eigen::Map<const Eigen::Vector3d>(mesh.vertices + 3 * i) + s.translation);
+    return mesh.vertex_count > 0;
+  }
+
+  return false;
+}
+
+// Appends the shapes of a static body, splitting octrees into one box per occupied cell
+bool addStaticShapes(const shapes::ShapeConstPtr& shape, const Eigen::Affine3d& pose, std::size_t body,
+                     std::vector<StaticShape>& out)
+{
+  if (shape->type == shapes::OCTREE)
+  {
+    const auto& tree = static_cast<const shapes::OcTree&>(*shape).octree;
+    for (auto it = tree->begin_leafs(), end = tree->end_leafs(); it != end; ++it)
+    {
+      if (!tree->isNodeOccupied(*it))
+        continue;
+
+      const double size = it.getSize();
+      shapes::ShapeConstPtr cell(new shapes::Box(size, size, size));
+      const Eigen::Affine3d cell_pose = pose * Eigen::Translation3d(it.getX(), it.getY(), it.getZ());
+      out.push_back({ cell, cell_pose.linear(), cell_pose.translation(), body });
+    }
+    return true;
+  }
+
+  if (shape->type != shapes::MESH && shape->type != shapes::SPHERE && shape->type != shapes::BOX &&
+      shape->type != shapes::CYLINDER && shape->type != shapes::CONE)
+  {
+    return false;
+  }
+
+  out.push_back({ shape, pose.linear(), pose.translation(), body });
+  return true;
+}
+
+// Bounding sphere, in the link frame, of all of a link's collision shapes
+void linkBoundingSphere(const moveit::core::LinkModel& link, double scale, double padding, Eigen::Vector3d& center,
+                        double& radius)
+{
+  const auto& link_shapes = link.getShapes();
+  const auto& origins = link.getCollisionOriginTransforms();
+
+  std::vector<Eigen::Vector3d> centers(link_shapes.size());
+  std::vector<double> radii(link_shapes.size());
+  for (std::size_t i = 0; i < link_shapes.size(); ++i)
+  {
+    shapes::ShapePtr padded(link_shapes[i]->clone());
+    padded->scaleAndPadd(scale, padding);
+    shapes::computeShapeBoundingSphere(padded.get(), centers[i], radii[i]);
+    centers[i] = origins[i] * centers[i];
+  }
+
+  center.setZero();
+  for (const auto& c : centers)
+    center += c;
+  center /= static_cast<double>(std::max<std::size_t>(centers.size(), 1));
+
+  radius = 0.0;
+  for (std::size_t i = 0; i < centers.size(); ++i)
+    radius = std::max(radius, (centers[i] - center).norm() + radii[i]);
+}
+
+}  // end anon namespace
+
+namespace descartes_moveit
+{
+const double CollisionPrefilter::DEFAULT_RESOLUTION = 0.02;
+
+CollisionPrefilter::CollisionPrefilter(const planning_scene::PlanningScene& scene,
+                                       const moveit::core::RobotState& state, const std::string& group_name,
+                                       double resolution)
+  : usable_(false), resolution_(resolution), origin_(Eigen::Vector3d::Zero())
+{
+  dims_[0] = dims_[1] = dims_[2] = 0;
+  coarse_dims_[0] = coarse_dims_[1] = coarse_dims_[2] = 0;
+  build(scene, state, group_name, resolution);
+}
+
+void CollisionPrefilter::build(const planning_scene::PlanningScene& scene, const moveit::core::RobotState& state,
+                               const std::string& group_name, double resolution)
+{
+  const auto& robot_model = *scene.getRobotModel();
+  const auto* group = robot_model.getJointModelGroup(group_name);
+  if (!group)
+  {
+    ROS_ERROR_STREAM("Collision prefilter: unknown group '" << group_name << "'");
+    return;
+  }
+
+  std::vector<const moveit::core::AttachedBody*> attached;
+  state.getAttachedBodies(attached);
+  if (!attached.empty())
+  {
+    ROS_WARN_STREAM("Collision prefilter disabled: the robot has attached bodies");
+    return;
+  }
+
+  const auto& acm = scene.getAllowedCollisionMatrix();
+  const auto& padded_robot = *scene.getCollisionRobot();
+
+  // Moving links: exactly those a collision request for 'group_name' checks
+  const auto& moving = group->getUpdatedLinkModelsWithGeometry();
+  const std::set<const moveit::core::LinkModel*> moving_set(moving.begin(), moving.end());
+
+  // Collect the static scene: the rest of the robot, then the world
+  std::vector<std::string> body_names;
+  std::vector<StaticShape> static_shapes;
+
+  moveit::core::RobotState static_state(state);
+  static_state.update();
+  for (const auto* link : robot_model.getLinkModelsWithCollisionGeometry())
+  {
+    if (moving_set.count(link))
+      continue;
+
+    const auto body = body_names.size();
+    body_names.push_back(link->getName());
+    const auto& origins = link->getCollisionOriginTransforms();
+    for (std::size_t i = 0; i < link->getShapes().size(); ++i)
+    {
+      if (!addStaticShapes(link->getShapes()[i], static_state.getGlobalLinkTransform(link) * origins[i], body,
+                           static_shapes))
+      {
+        ROS_WARN_STREAM("Collision prefilter disabled: link '" << link->getName() << "' has an unsupported shape");
+        return;
+      }
+    }
+  }
+
+  const auto& world = *scene.getWorld();
+  for (auto it = world.begin(); it != world.end(); ++it)
+  {
+    const auto body = body_names.size();
+    body_names.push_back(it->first);
+    const auto& object = *it->second;
+    for (std::size_t i = 0; i < object.shapes_.size(); ++i)
+    {
+      if (!addStaticShapes(object.shapes_[i], object.shape_poses_[i], body, static_shapes))
+      {
+        ROS_WARN_STREAM("Collision prefilter disabled: object '" << it->first << "' has an unsupported shape");
+        return;
+      }
+    }
+  }
+
+  if (body_names.size() > MAX_BODY_BITS)
+  {
+    ROS_DEBUG_STREAM("Collision prefilter: " << body_names.size() << " static bodies; the last "
+                                             << body_names.size() - MAX_BODY_BITS + 1 << " share a mask bit");
+  }
+
+  // Moving links & the static bodies they may touch
+  links_.clear();
+  for (const auto* link : moving)
+  {
+    MovingLink ml;
+    ml.link = link;
+    ml.check_mask = 0;
+    ml.hard_mask = 0;
+    linkBoundingSphere(*link, padded_robot.getLinkScale(link->getName()),
+                       padded_robot.getLinkPadding(link->getName()), ml.center, ml.radius);
+
+    for (std::size_t i = 0; i < link->getShapes().size(); ++i)
+    {
+      const auto type = link->getShapes()[i]->type;
+      if (type == shapes::SPHERE || type == shapes::BOX || type == shapes::CYLINDER)
+        ml.inner_points.push_back(link->getCollisionOriginTransforms()[i].translation());
+    }
+
+    for (std::size_t body = 0; body < body_names.size(); ++body)
+    {
+      const auto contact = contactType(acm, link->getName(), body_names[body]);
+      if (contact != IGNORED)
+        ml.check_mask |= bodyBit(body);
+      // A shared bit stands for several bodies; it may only be 'hard' if it is for all of them
+      if (contact == COUNTED && body < MAX_BODY_BITS - 1)
+        ml.hard_mask |= bodyBit(body);
+    }
+    links_.push_back(ml);
+  }
+
+  link_pairs_.clear();
+  for (std::size_t a = 0; a < links_.size(); ++a)
+  {
+    for (std::size_t b = a + 1; b < links_.size(); ++b)
+    {
+      if (contactType(acm, links_[a].link->getName(), links_[b].link->getName()) != IGNORED)
+        link_pairs_.push_back({ a, b });
+    }
+  }
+
+  // Size the grid around the static scene
+  std::vector<Eigen::Vector3d> lo(static_shapes.size()), hi(static_shapes.size());
+  Eigen::Vector3d scene_lo = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+  Eigen::Vector3d scene_hi = -scene_lo;
+  for (std::size_t i = 0; i < static_shapes.size(); ++i)
+  {
+    if (!staticShapeBounds(static_shapes[i], lo[i], hi[i]))
+    {
+      // Empty mesh
+      lo[i].setConstant(std::numeric_limits<double>::max());
+      hi[i] = -lo[i];
+      continue;
+    }
+    expand(scene_lo, scene_hi, lo[i]);
+    expand(scene_lo, scene_hi, hi[i]);
+  }
+
+  touch_.clear();
+  solid_.clear();
+  coarse_.clear();
+  usable_ = true;
+  if ((scene_hi.array() < scene_lo.array()).any())
+    return; // nothing static: every link is always clear of the scene
+
+  resolution_ = resolution;
+  std::size_t n_voxels;
+  for (;;)
+  {
+    for (int k = 0; k < 3; ++k)
+      dims_[k] = static_cast<int>(std::ceil((scene_hi(k) - scene_lo(k)) / resolution_)) + 1;
+    n_voxels = static_cast<std::size_t>(dims_[0]) * dims_[1] * dims_[2];
+    if (n_voxels <= MAX_VOXELS)
+      break;
+    resolution_ *= 1.25;
+  }
+  origin_ = scene_lo;
+  for (int k = 0; k < 3; ++k)
+    coarse_dims_[k] = (dims_[k] + BLOCK - 1) / BLOCK;
+
+  touch_.assign(n_voxels, 0);
+  solid_.assign(n_voxels, 0);
+
+  // Mark the voxels each piece of the scene may touch
+  for (std::size_t i = 0; i < static_shapes.size(); ++i)
+  {
+    const auto& s = static_shapes[i];
+    const BodyMask bit = bodyBit(s.body);
+
+    if (s.shape->type == shapes::MESH)
+    {
+      // The exact checker tests meshes triangle by triangle, so only voxels along the surface matter
+      const auto& mesh = static_cast<const shapes::Mesh&>(*s.shape);
+      for (unsigned t = 0; t < mesh.triangle_count; ++t)
+      {
+        Eigen::Vector3d t_lo = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+        Eigen::Vector3d t_hi = -t_lo;
+        for (int v = 0; v < 3; ++v)
+        {
+          const unsigned vi = mesh.triangles[3 * t + v];
+          expand(t_lo, t_hi, s.rotation * Eigen::Map<const Eigen::Vector3d>(mesh.vertices + 3 * vi) + s.translation);
+        }
+
+        int c_lo[3], c_hi[3];
+        cellOf(t_lo, c_lo);
+        cellOf(t_hi, c_hi);
+        for (int z = c_lo[2]; z <= c_hi[2]; ++z)
+          for (int y = c_lo[1]; y <= c_hi[1]; ++y)
+            for (int x = c_lo[0]; x <= c_hi[0]; ++x)
+              touch_[index(x, y, z)] |= bit;
+      }
+      continue;
+    }
+
+    int c_lo[3], c_hi[3];
+    cellOf(lo[i], c_lo);
+    cellOf(hi[i], c_hi);
+    const Eigen::Matrix3d to_shape = s.rotation.transpose();
+    const bool can_be_solid = s.shape->type != shapes::CONE;
+
+    for (int z = c_lo[2]; z <= c_hi[2]; ++z)
+    {
+      for (int y = c_lo[1]; y <= c_hi[1]; ++y)
+      {
+        for (int x = c_lo[0]; x <= c_hi[0]; ++x)
+        {
+          const auto idx = index(x, y, z);
+          touch_[idx] |= bit;
+          if (!can_be_solid)
+            continue;
+
+          // The primitives are convex: the voxel is inside if its corners are
+          const Eigen::Vector3d corner = origin_ + resolution_ * Eigen::Vector3d(x, y, z);
+          bool inside = true;
+          for (int c = 0; c < 8 && inside; ++c)
+          {
+            const Eigen::Vector3d p = corner + resolution_ * Eigen::Vector3d(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+            inside = insidePrimitive(*s.shape, to_shape * (p - s.translation));
+          }
+          if (inside)
+            solid_[idx] |= bit;
+        }
+      }
+    }
+  }
+
+  // Coarse level
+  coarse_.assign(static_cast<std::size_t>(coarse_dims_[0]) * coarse_dims_[1] * coarse_dims_[2], 0);
+  for (int z = 0; z < dims_[2]; ++z)
+    for (int y = 0; y < dims_[1]; ++y)
+      for (int x = 0; x < dims_[0]; ++x)
+        coarse_[coarseIndex(x / BLOCK, y / BLOCK, z / BLOCK)] |= touch_[index(x, y, z)];
+
+  ROS_INFO_STREAM("Collision prefilter: " << body_names.size() << " static bodies in a " << dims_[0] << "x"
+                                          << dims_[1] << "x" << dims_[2] << " grid of " << resolution_ << " m voxels, "
+                                          << links_.size() << " moving links, " << link_pairs_.size()
+                                          << " moving link pairs");
+}
+
+CollisionPrefilter::Result CollisionPrefilter::classify(const moveit::core::RobotState& state) const
+{
+  if (!usable_)
+    return UNKNOWN;
+
+  thread_local std::vector<Eigen::Vector3d> centers;
+  centers.resize(links_.size());
+
+  for (std::size_t i = 0; i < links_.size(); ++i)
+  {
+    const auto& link = links_[i];
+    const Eigen::Affine3d& pose = state.getGlobalLinkTransform(link.link);
+    for (const auto& p : link.inner_points)
+    {
+      if (pointInSolid(pose * p, link.hard_mask))
+        return COLLIDING;
+    }
+    centers[i] = pose * link.center;
+  }
+
+  for (std::size_t i = 0; i < links_.size(); ++i)
+  {
+    if (sphereHitsScene(centers[i], links_[i].radius, links_[i].check_mask))
+      return UNKNOWN;
+  }
+
+  for (const auto& pair : link_pairs_)
+  {
+    const double reach = links_[pair.a].radius + links_[pair.b].radius;
+    if ((centers[pair.a] - centers[pair.b]).squaredNorm() <= reach * reach)
+      return UNKNOWN;
+  }
+
+  return CLEAR;
+}
+
+void CollisionPrefilter::cellOf(const Eigen::Vector3d& p, int cell[3]) const
+{
+  for (int k = 0; k < 3; ++k)
+  {
+    const int c = static_cast<int>(std::floor((p(k) - origin_(k)) / resolution_));
+    cell[k] = std::min(std::max(c, 0), dims_[k] - 1);
+  }
+}
+
+bool CollisionPrefilter::sphereHitsScene(const Eigen::Vector3d& center, double radius, BodyMask mask) const
+{
+  if (touch_.empty() || mask == 0)
+    return false;
+
+  // Cells overlapped by the sphere's bounding box; nothing static lies outside the grid
+  int lo[3], hi[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    const double a = (center(k) - radius - origin_(k)) / resolution_;
+    const double b = (center(k) + radius - origin_(k)) / resolution_;
+    if (b < 0.0 || a >= dims_[k])
+      return false;
+    lo[k] = std::max(static_cast<int>(std::floor(a)), 0);
+    hi[k] = std::min(static_cast<int>(std::floor(b)), dims_[k] - 1);
+  }
+
+  BodyMask coarse = 0;
+  for (int z = lo[2] / BLOCK; z <= hi[2] / BLOCK; ++z)
+    for (int y = lo[1] / BLOCK; y <= hi[1] / BLOCK; ++y)
+      for (int x = lo[0] / BLOCK; x <= hi[0] / BLOCK; ++x)
+        coarse |= coarse_[coarseIndex(x, y, z)];
+  if ((coarse & mask) == 0)
+    return false;
+
+  const double r2 = radius * radius;
+  for (int z = lo[2]; z <= hi[2]; ++z)
+  {
+    for (int y = lo[1]; y <= hi[1]; ++y)
+    {
+      for (int x = lo[0]; x <= hi[0]; ++x)
+      {
+        if ((touch_[index(x, y, z)] & mask) == 0)
+          continue;
+
+        // Distance from the center to the voxel
+        const Eigen::Vector3d v_lo = origin_ + resolution_ * Eigen::Vector3d(x, y, z);
+        const Eigen::Vector3d v_hi = v_lo + Eigen::Vector3d::Constant(resolution_);
+        const Eigen::Vector3d d = (v_lo - center).cwiseMax(center - v_hi).cwiseMax(Eigen::Vector3d::Zero());
+        if (d.squaredNorm() <= r2)
+          return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool CollisionPrefilter::pointInSolid(const Eigen::Vector3d& p, BodyMask mask) const
+{
+  if (solid_.empty() || mask == 0)
+    return false;
+
+  int cell[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    const double c = std::floor((p(k) - origin_(k)) / resolution_);
+    if (c < 0.0 || c >= dims_[k])
+      return false;
+    cell[k] = static_cast<int>(c);
+  }
+  return (solid_[index(cell[0], cell[1], cell[2])] & mask) != 0;
+}
+
+}  // end namespace 'descartes_moveit'
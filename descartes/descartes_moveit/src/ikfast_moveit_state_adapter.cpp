@@ -68,46 +68,46 @@ bool descartes_moveit::IkFastMoveitStateAdapter::getAllIK(const Eigen::Affine3d&
                                                           std::vector<std::vector<double>>& joint_poses) const
 {
   joint_poses.clear();
-  const auto& solver = joint_group_->getSolverInstance();
+
+  thread_local std::vector<double> solutions;
+  thread_local std::vector<double> joint_data;
+  solutions.clear();
+  joint_data.clear();
 
   // Transform input pose
-  Eigen::Affine3d tool_pose = world_to_base_.frame_inv * pose * tool0_to_tip_.frame;
+  solveIK(world_to_base_.frame_inv * pose * tool0_to_tip_.frame, solutions);
 
-  // convert to geometry_msgs ...
-  geometry_msgs::Pose geometry_pose;
-  tf::poseEigenToMsg(tool_pose, geometry_pose);
-  std::vector<geometry_msgs::Pose> poses = { geometry_pose };
+  const auto dof = static_cast<std::size_t>(getDOF());
+  const auto n = appendValidSolutions(solutions, joint_data);
+  joint_poses.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    joint_poses.emplace_back(joint_data.begin() + i * dof, joint_data.begin() + (i + 1) * dof);
 
-  std::vector<double> dummy_seed(getDOF(), 0.0);
-  std::vector<std::vector<double>> joint_results;
-  kinematics::KinematicsResult result;
-  kinematics::KinematicsQueryOptions options;  // defaults are reasonable as of Indigo
-  options.discretization_method = kinematics::DiscretizationMethods::ALL_DISCRETIZED;
+  return joint_poses.size() > 0;
+}
 
-  if (!solver->getPositionIK(poses, dummy_seed, joint_results, result, options))
-  {
-    return false;
-  }
+bool descartes_moveit::IkFastMoveitStateAdapter::getAllIK(const EigenSTL::vector_Affine3d& poses,
+                                                          std::vector<double>& joint_data,
+                                                          std::vector<std::size_t>& offsets) const
+{
+  joint_data.clear();
+  offsets.resize(poses.size() + 1);
+  offsets[0] = 0;
 
-  const auto last_index = getDOF() - 1;
+  thread_local std::vector<double> solutions;
+  bool all_found = true;
 
-  for (auto& sol : joint_results)
+  for (std::size_t i = 0; i < poses.size(); ++i)
   {
-    if (isValid(sol))
-      joint_poses.push_back(sol);
-
-    // Search last joint +2PI
-    sol[last_index] += 2.0 * M_PI;
-    if (isValid(sol))
-      joint_poses.push_back(sol);
-
-    // Search last joint -2PI
-    sol[last_index] -= 2.0 * 2.0 * M_PI;
-    if (isValid(sol))
-      joint_poses.push_back(sol);
+    solutions.clear();
+    solveIK(world_to_base_.frame_inv * poses[i] * tool0_to_tip_.frame, solutions);
+
+    const auto n = appendValidSolutions(solutions, joint_data);
+    offsets[i + 1] = offsets[i] + n;
+    all_found = all_found && n > 0;
   }
 
-  return joint_poses.size() > 0;
+  return all_found;
 }
 
 bool descartes_moveit::IkFastMoveitStateAdapter::getIK(const Eigen::Affine3d& pose,
@@ -128,8 +128,10 @@ bool descartes_moveit::IkFastMoveitStateAdapter::getFK(const std::vector<double>
 {
   const auto& solver = joint_group_->getSolverInstance();
 
-  std::vector<std::string> tip_frame = { solver->getTipFrame() };
-  std::vector<geometry_msgs::Pose> output;
+  // Reused between calls; assigning the same tip frame again does not allocate
+  thread_local std::vector<std::string> tip_frame(1);
+  thread_local std::vector<geometry_msgs::Pose> output;
+  tip_frame[0] = solver->getTipFrame();
 
   if (!isValid(joint_pose))
     return false;
@@ -142,6 +144,60 @@ bool descartes_moveit::IkFastMoveitStateAdapter::getFK(const std::vector<double>
   return true;
 }
 
+std::size_t descartes_moveit::IkFastMoveitStateAdapter::solveIK(const Eigen::Affine3d& pose,
+                                                               std::vector<double>& solutions) const
+{
+  const auto& solver = joint_group_->getSolverInstance();
+
+  // convert to geometry_msgs ...
+  std::vector<geometry_msgs::Pose> poses(1);
+  tf::poseEigenToMsg(pose, poses[0]);
+
+  std::vector<double> dummy_seed(getDOF(), 0.0);
+  std::vector<std::vector<double>> joint_results;
+  kinematics::KinematicsResult result;
+  kinematics::KinematicsQueryOptions options;  // defaults are reasonable as of Indigo
+  options.discretization_method = kinematics::DiscretizationMethods::ALL_DISCRETIZED;
+
+  if (!solver->getPositionIK(poses, dummy_seed, joint_results, result, options))
+  {
+    return 0;
+  }
+
+  for (const auto& sol : joint_results)
+    solutions.insert(solutions.end(), sol.begin(), sol.end());
+
+  return joint_results.size();
+}
+
+std::size_t descartes_moveit::IkFastMoveitStateAdapter::appendValidSolutions(const std::vector<double>& solutions,
+                                                                             std::vector<double>& joint_data) const
+{
+  const auto dof = static_cast<std::size_t>(getDOF());
+  const auto last_index = dof - 1;
+  std::size_t n_valid = 0;
+
+  thread_local std::vector<double> sol;
+  for (std::size_t i = 0; i + dof <= solutions.size(); i += dof)
+  {
+    sol.assign(solutions.begin() + i, solutions.begin() + i + dof);
+
+    // IKFast returns each configuration with joints in [-PI, PI]; the last joint commonly turns further, so
+    // also search its +/-2PI copies
+    for (double turn : { 0.0, 2.0 * M_PI, -2.0 * 2.0 * M_PI })
+    {
+      sol[last_index] += turn;
+      if (isValid(sol.data()))
+      {
+        joint_data.insert(joint_data.end(), sol.begin(), sol.end());
+        ++n_valid;
+      }
+    }
+  }
+
+  return n_valid;
+}
+
 void descartes_moveit::IkFastMoveitStateAdapter::setState(const moveit::core::RobotState& state)
 {
   descartes_moveit::MoveitStateAdapter::setState(state);
@@ -25,6 +25,7 @@
 #include <eigen_conversions/eigen_msg.h>
 #include <random_numbers/random_numbers.h>
 #include <ros/assert.h>
+#include <swri_profiler/profiler.h>
 #include <sstream>
 
 const static int SAMPLE_ITERATIONS = 10;
@@ -63,7 +64,8 @@ bool getJointVelocityLimits(const moveit::core::RobotState& state, const std::st
 
 namespace descartes_moveit
 {
-MoveitStateAdapter::MoveitStateAdapter() : world_to_root_(Eigen::Affine3d::Identity())
+MoveitStateAdapter::MoveitStateAdapter()
+  : use_collision_prefilter_(true), world_to_root_(Eigen::Affine3d::Identity())
 {
 }
 
@@ -82,6 +84,7 @@ bool MoveitStateAdapter::initialize(robot_model::RobotModelConstPtr robot_model,
   robot_model_ptr_ = robot_model;
   robot_state_.reset(new moveit::core::RobotState(robot_model_ptr_));
   robot_state_->setToDefaultValues();
+  state_pool_.reset(*robot_state_, group_name);
   planning_scene_.reset(new planning_scene::PlanningScene(robot_model));
   joint_group_ = robot_model_ptr_->getJointModelGroup(group_name);
 
@@ -131,26 +134,30 @@ bool MoveitStateAdapter::initialize(robot_model::RobotModelConstPtr robot_model,
     world_to_root_ = descartes_core::Frame(root_to_world.inverse());
   }
 
+  updateCollisionPrefilter();
+
   return true;
 }
 
 bool MoveitStateAdapter::getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
                                std::vector<double>& joint_pose) const
 {
-  robot_state_->setJointGroupPositions(group_name_, seed_state);
-  return getIK(pose, joint_pose);
+  auto ctx = state_pool_.acquire();
+  ctx->state.setJointGroupPositions(group_name_, seed_state);
+  return getIK(ctx->state, pose, joint_pose);
 }
 
-bool MoveitStateAdapter::getIK(const Eigen::Affine3d& pose, std::vector<double>& joint_pose) const
+bool MoveitStateAdapter::getIK(moveit::core::RobotState& state, const Eigen::Affine3d& pose,
+                               std::vector<double>& joint_pose) const
 {
   bool rtn = false;
 
   // transform to group base
   Eigen::Affine3d tool_pose = world_to_root_.frame * pose;
 
-  if (robot_state_->setFromIK(joint_group_, tool_pose, tool_frame_))
+  if (state.setFromIK(joint_group_, tool_pose, tool_frame_))
   {
-    robot_state_->copyJointGroupPositions(group_name_, joint_pose);
+    state.copyJointGroupPositions(group_name_, joint_pose);
     if (!isValid(joint_pose))
     {
       ROS_DEBUG_STREAM("Robot joint pose is invalid");
@@ -177,11 +184,12 @@ bool MoveitStateAdapter::getAllIK(const Eigen::Affine3d& pose, std::vector<std::
   double epsilon = 4 * joint_group_->getSolverInstance()->getSearchDiscretization();
   logDebug("Utilizing an min. difference of %f between IK solutions", epsilon);
   joint_poses.clear();
+  auto ctx = state_pool_.acquire();
   for (size_t sample_iter = 0; sample_iter < seed_states_.size(); ++sample_iter)
   {
-    robot_state_->setJointGroupPositions(group_name_, seed_states_[sample_iter]);
+    ctx->state.setJointGroupPositions(group_name_, seed_states_[sample_iter]);
     std::vector<double> joint_pose;
-    if (getIK(pose, joint_pose))
+    if (getIK(ctx->state, pose, joint_pose))
     {
       if (joint_poses.empty())
       {
@@ -236,25 +244,57 @@ bool MoveitStateAdapter::getAllIK(const Eigen::Affine3d& pose, std::vector<std::
 
 bool MoveitStateAdapter::isInCollision(const std::vector<double>& joint_pose) const
 {
-  bool in_collision = false;
-  if (check_collisions_)
+  return isInCollision(joint_pose.data());
+}
+
+bool MoveitStateAdapter::isInCollision(const double* joint_pose) const
+{
+  if (!check_collisions_)
   {
-    moveit::core::RobotState state (this->robot_model_ptr_);
-    state.setJointGroupPositions(this->joint_group_, joint_pose);
-    in_collision = planning_scene_->isStateColliding(state, group_name_); //, group_name_);
+    return false;
   }
-  return in_collision;
+
+  auto ctx = state_pool_.acquire();
+  ctx->state.setJointGroupPositions(joint_group_, joint_pose);
+
+  if (collision_prefilter_)
+  {
+    CollisionPrefilter::Result verdict;
+    {
+      SWRI_PROFILE("collision-prefilter");
+      ctx->state.update();
+      verdict = collision_prefilter_->classify(ctx->state);
+    }
+
+    // Empty blocks: only their counts are of interest
+    if (verdict == CollisionPrefilter::CLEAR)
+    {
+      SWRI_PROFILE("prefilter-clear");
+      return false;
+    }
+    if (verdict == CollisionPrefilter::COLLIDING)
+    {
+      SWRI_PROFILE("prefilter-colliding");
+      return true;
+    }
+  }
+
+  SWRI_PROFILE("exact-collision-check");
+  ctx->collision_result.clear();
+  planning_scene_->checkCollision(ctx->collision_request, ctx->collision_result, ctx->state);
+  return ctx->collision_result.collision;
 }
 
 bool MoveitStateAdapter::getFK(const std::vector<double>& joint_pose, Eigen::Affine3d& pose) const
 {
   bool rtn = false;
-  robot_state_->setJointGroupPositions(group_name_, joint_pose);
+  auto ctx = state_pool_.acquire();
+  ctx->state.setJointGroupPositions(group_name_, joint_pose);
   if (isValid(joint_pose))
   {
-    if (robot_state_->knowsFrameTransform(tool_frame_))
+    if (ctx->state.knowsFrameTransform(tool_frame_))
     {
-      pose = world_to_root_.frame * robot_state_->getFrameTransform(tool_frame_);
+      pose = world_to_root_.frame * ctx->state.getFrameTransform(tool_frame_);
       rtn = true;
     }
     else
@@ -283,8 +323,13 @@ bool MoveitStateAdapter::isValid(const std::vector<double>& joint_pose) const
     return false;
   }
 
+  return isValid(joint_pose.data());
+}
+
+bool MoveitStateAdapter::isValid(const double* joint_pose) const
+{
   // Satisfies joint positional bounds?
-  if (!joint_group_->satisfiesPositionBounds(joint_pose.data()))
+  if (!joint_group_->satisfiesPositionBounds(joint_pose))
   {
     return false;
   }
@@ -296,7 +341,8 @@ bool MoveitStateAdapter::isValid(const Eigen::Affine3d& pose) const
 {
   // TODO: Could check robot extents first as a quick check
   std::vector<double> dummy;
-  return getIK(pose, dummy);
+  auto ctx = state_pool_.acquire();
+  return getIK(ctx->state, pose, dummy);
 }
 
 int MoveitStateAdapter::getDOF() const
@@ -329,7 +375,31 @@ void MoveitStateAdapter::setState(const moveit::core::RobotState& state)
   ROS_ASSERT_MSG(static_cast<bool>(robot_state_), "'robot_state_' member pointer is null. Have you called "
                                                   "initialize()?");
   *robot_state_ = state;
+  state_pool_.reset(state, group_name_);
   planning_scene_->setCurrentState(state);
+  updateCollisionPrefilter();
+}
+
+void MoveitStateAdapter::setUseCollisionPrefilter(bool use)
+{
+  use_collision_prefilter_ = use;
+  updateCollisionPrefilter();
+}
+
+void MoveitStateAdapter::updateCollisionPrefilter()
+{
+  collision_prefilter_.reset();
+  if (!use_collision_prefilter_ || !planning_scene_ || !robot_state_)
+  {
+    return;
+  }
+
+  // The joints outside of the group place the static part of the robot
+  CollisionPrefilterConstPtr prefilter(new CollisionPrefilter(*planning_scene_, *robot_state_, group_name_));
+  if (prefilter->isUsable())
+  {
+    collision_prefilter_ = prefilter;
+  }
 }
 
 }  // descartes_moveit
@@ -0,0 +1,64 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_moveit/robot_state_pool.h"
+#include <ros/assert.h>
+
+namespace descartes_moveit
+{
+void RobotStatePool::reset(const moveit::core::RobotState& prototype, const std::string& group_name)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  prototype_.reset(new moveit::core::RobotState(prototype));
+  group_name_ = group_name;
+  ++generation_;
+  idle_.clear();
+  created_ = 0;
+}
+
+RobotStatePool::Lease RobotStatePool::acquire() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  ROS_ASSERT_MSG(static_cast<bool>(prototype_), "RobotStatePool used before reset()");
+
+  if (idle_.empty())
+  {
+    ++created_;
+    // Copying the prototype is the expensive part; it happens at most once per concurrent caller
+    return Lease(this, std::unique_ptr<StateContext>(new StateContext(*prototype_, group_name_, generation_)));
+  }
+
+  std::unique_ptr<StateContext> ctx = std::move(idle_.back());
+  idle_.pop_back();
+  return Lease(this, std::move(ctx));
+}
+
+std::size_t RobotStatePool::size() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return created_;
+}
+
+void RobotStatePool::release(std::unique_ptr<StateContext> ctx) const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if (ctx->generation == generation_)
+    idle_.push_back(std::move(ctx));
+}
+
+}  // descartes_moveit
@@ -0,0 +1,172 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_moveit/moveit_state_adapter.h"
+#include "descartes_moveit/collision_prefilter.h"
+#include "descartes_moveit/seed_search.h"
+#include <geometric_shapes/shapes.h>
+#include <srdfdom/model.h>
+#include <urdf_parser/urdf_parser.h>
+#include <gtest/gtest.h>
+
+using namespace descartes_moveit;
+
+namespace
+{
+const unsigned N_STATES = 2000;
+
+// The test KUKA model has no collision geometry, so use a small arm built from primitives next to a
+// fixed wall that belongs to the robot, like the workcells of most applications
+const char* ARM_URDF = R"(
+<robot name="prefilter_arm">
+  <link name="base_link">
+    <collision><origin xyz="0 0 0.05"/><geometry><box size="0.4 0.4 0.1"/></geometry></collision>
+  </link>
+  <link name="wall">
+    <collision><origin xyz="0 0 1.0"/><geometry><box size="0.6 3.0 2.0"/></geometry></collision>
+  </link>
+  <link name="link1">
+    <collision><origin xyz="0 0 0.25"/><geometry><cylinder radius="0.08" length="0.4"/></geometry></collision>
+  </link>
+  <link name="link2">
+    <collision><origin xyz="0 0 0.4"/><geometry><box size="0.1 0.1 0.7"/></geometry></collision>
+  </link>
+  <link name="link3">
+    <collision><origin xyz="0 0 0.25"/><geometry><box size="0.08 0.08 0.4"/></geometry></collision>
+  </link>
+  <link name="tool0"/>
+  <joint name="wall_joint" type="fixed">
+    <parent link="base_link"/><child link="wall"/><origin xyz="0.8 0 0"/>
+  </joint>
+  <joint name="joint1" type="revolute">
+    <parent link="base_link"/><child link="link1"/><origin xyz="0 0 0.1"/><axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="100" velocity="1"/>
+  </joint>
+  <joint name="joint2" type="revolute">
+    <parent link="link1"/><child link="link2"/><origin xyz="0 0 0.5"/><axis xyz="0 1 0"/>
+    <limit lower="-2.0" upper="2.0" effort="100" velocity="1"/>
+  </joint>
+  <joint name="joint3" type="revolute">
+    <parent link="link2"/><child link="link3"/><origin xyz="0 0 0.8"/><axis xyz="0 1 0"/>
+    <limit lower="-2.5" upper="2.5" effort="100" velocity="1"/>
+  </joint>
+  <joint name="tool_joint" type="fixed">
+    <parent link="link3"/><child link="tool0"/><origin xyz="0 0 0.5"/>
+  </joint>
+</robot>
+)";
+
+const char* ARM_SRDF = R"(
+<robot name="prefilter_arm">
+  <group name="arm"><chain base_link="base_link" tip_link="tool0"/></group>
+  <disable_collisions link1="base_link" link2="wall" reason="Adjacent"/>
+  <disable_collisions link1="base_link" link2="link1" reason="Adjacent"/>
+  <disable_collisions link1="link1" link2="link2" reason="Adjacent"/>
+  <disable_collisions link1="link2" link2="link3" reason="Adjacent"/>
+</robot>
+)";
+
+robot_model::RobotModelConstPtr makeArm()
+{
+  auto urdf_model = urdf::parseURDF(ARM_URDF);
+  boost::shared_ptr<srdf::Model> srdf_model(new srdf::Model());
+  srdf_model->initString(*urdf_model, ARM_SRDF);
+  return robot_model::RobotModelConstPtr(new robot_model::RobotModel(urdf_model, srdf_model));
+}
+
+// Exposes the planning scene so that world objects can be added
+class ObstacleStateAdapter : public MoveitStateAdapter
+{
+public:
+  void addBox(const std::string& id, const Eigen::Affine3d& pose, double x, double y, double z)
+  {
+    planning_scene_->getWorldNonConst()->addToObject(id, shapes::ShapeConstPtr(new shapes::Box(x, y, z)), pose);
+    // Picks up the new object
+    setUseCollisionPrefilter(getUseCollisionPrefilter());
+  }
+
+  planning_scene::PlanningScenePtr scene()
+  {
+    return planning_scene_;
+  }
+};
+}
+
+TEST(CollisionPrefilter, verdicts_agree_with_exact_checks)
+{
+  ObstacleStateAdapter model;
+  ASSERT_TRUE(model.initialize(makeArm(), "arm", "base_link", "tool0"));
+  model.setCheckCollisions(true);
+  model.addBox("floor", Eigen::Affine3d(Eigen::Translation3d(0.0, 0.0, -0.25)), 4.0, 4.0, 0.5);
+
+  CollisionPrefilter prefilter(*model.scene(), *model.getState(), "arm");
+  ASSERT_TRUE(prefilter.isUsable());
+
+  const std::vector<std::vector<double> > joints = seed::findRandomSeeds(*model.getState(), "arm", N_STATES);
+
+  moveit::core::RobotState state(*model.getState());
+  collision_detection::CollisionRequest request;
+  request.group_name = "arm";
+
+  unsigned n_clear = 0, n_colliding = 0, n_exact_collisions = 0;
+  for (const auto& joint_pose : joints)
+  {
+    state.setJointGroupPositions("arm", joint_pose);
+    state.update();
+
+    collision_detection::CollisionResult result;
+    model.scene()->checkCollision(request, result, state);
+    n_exact_collisions += result.collision;
+
+    switch (prefilter.classify(state))
+    {
+      case CollisionPrefilter::CLEAR:
+        ++n_clear;
+        EXPECT_FALSE(result.collision);
+        break;
+      case CollisionPrefilter::COLLIDING:
+        ++n_colliding;
+        EXPECT_TRUE(result.collision);
+        break;
+      default:
+        break;
+    }
+  }
+
+  EXPECT_GT(n_exact_collisions, 0u);
+  EXPECT_GT(n_clear, 0u);
+  EXPECT_GT(n_colliding, 0u);
+}
+
+TEST(CollisionPrefilter, validity_matches_exact_checks)
+{
+  ObstacleStateAdapter model;
+  ASSERT_TRUE(model.initialize(makeArm(), "arm", "base_link", "tool0"));
+  model.setCheckCollisions(true);
+  model.addBox("floor", Eigen::Affine3d(Eigen::Translation3d(0.0, 0.0, -0.25)), 4.0, 4.0, 0.5);
+
+  const std::vector<std::vector<double> > joints = seed::findRandomSeeds(*model.getState(), "arm", N_STATES);
+
+  std::vector<char> filtered(joints.size());
+  for (std::size_t i = 0; i < joints.size(); ++i)
+    filtered[i] = model.isValid(joints[i]);
+
+  model.setUseCollisionPrefilter(false);
+  for (std::size_t i = 0; i < joints.size(); ++i)
+    EXPECT_EQ(filtered[i], model.isValid(joints[i])) << "state " << i;
+}
@@ -0,0 +1,97 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_moveit/ikfast_moveit_state_adapter.h"
+#include "descartes_moveit/seed_search.h"
+#include <gtest/gtest.h>
+
+using namespace descartes_moveit;
+
+namespace
+{
+const unsigned N_POSES = 20;
+const double TF_EQ_TOL = 0.001;
+
+/**
+ * The test robot has no generated IKFast solver, so this stands in for one: a pose 'solves' to every stored
+ * configuration that reaches it, plus one far outside the joint limits that the adapter must filter out.
+ */
+class StandInIkFastModel : public IkFastMoveitStateAdapter
+{
+public:
+  std::vector<std::vector<double> > configurations;
+
+protected:
+  virtual std::size_t solveIK(const Eigen::Affine3d& pose, std::vector<double>& solutions) const
+  {
+    std::size_t n = 0;
+    for (const auto& config : configurations)
+    {
+      Eigen::Affine3d reached;
+      if (getFK(config, reached) && pose.isApprox(world_to_base_.frame_inv * reached * tool0_to_tip_.frame, TF_EQ_TOL))
+      {
+        solutions.insert(solutions.end(), config.begin(), config.end());
+        ++n;
+      }
+    }
+
+    solutions.insert(solutions.end(), getDOF(), 100.0);
+    return n + 1;
+  }
+};
+}
+
+TEST(IkFastMoveitStateAdapter, batched_getAllIK_matches_single_pose)
+{
+  StandInIkFastModel model;
+  ASSERT_TRUE(model.initialize("robot_description", "manipulator", "base_link", "tool0"));
+
+  model.configurations = seed::findRandomSeeds(*model.getState(), "manipulator", N_POSES);
+  ASSERT_EQ(N_POSES, model.configurations.size());
+
+  EigenSTL::vector_Affine3d poses (N_POSES);
+  for (std::size_t i = 0; i < N_POSES; ++i)
+    ASSERT_TRUE(model.getFK(model.configurations[i], poses[i]));
+
+  std::vector<double> joint_data;
+  std::vector<std::size_t> offsets;
+  EXPECT_TRUE(model.getAllIK(poses, joint_data, offsets));
+
+  // A pose nothing reaches leaves an empty slice, and fails the batch
+  poses.push_back(Eigen::Translation3d(100.0, 0.0, 0.0) * poses[0]);
+  EXPECT_FALSE(model.getAllIK(poses, joint_data, offsets));
+  ASSERT_EQ(poses.size() + 1, offsets.size());
+  EXPECT_EQ(offsets[N_POSES], offsets[N_POSES + 1]);
+
+  const auto dof = static_cast<std::size_t>(model.getDOF());
+  EXPECT_EQ(offsets.back() * dof, joint_data.size());
+
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    std::vector<std::vector<double> > joint_poses;
+    EXPECT_EQ(i < N_POSES, model.getAllIK(poses[i], joint_poses)) << "pose " << i;
+
+    ASSERT_EQ(joint_poses.size(), offsets[i + 1] - offsets[i]) << "pose " << i;
+    for (std::size_t j = 0; j < joint_poses.size(); ++j)
+    {
+      const std::vector<double> row (joint_data.begin() + (offsets[i] + j) * dof,
+                                     joint_data.begin() + (offsets[i] + j + 1) * dof);
+      EXPECT_EQ(joint_poses[j], row) << "pose " << i << ", solution " << j;
+    }
+  }
+}
@@ -0,0 +1,100 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_moveit/moveit_state_adapter.h"
+#include "descartes_moveit/seed_search.h"
+#include "descartes_core/utils.h"
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+
+using namespace descartes_moveit;
+
+namespace
+{
+const unsigned N_POSES = 200;
+const unsigned N_THREADS = 8;
+const double TF_EQ_TOL = 0.001;
+
+struct QueryResults
+{
+  explicit QueryResults(std::size_t n) : fk_ok(n), poses(n), valid(n), ik_ok(n), ik_solutions(n) {}
+
+  std::vector<char> fk_ok;
+  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+  std::vector<char> valid;
+  std::vector<char> ik_ok;
+  std::vector<std::vector<std::vector<double> > > ik_solutions;
+};
+
+// Runs FK, validity and IK queries for the given indices (first, first + stride, ...)
+void runQueries(const MoveitStateAdapter& model, const std::vector<std::vector<double> >& joints, std::size_t first,
+                std::size_t stride, QueryResults& out)
+{
+  for (std::size_t i = first; i < joints.size(); i += stride)
+  {
+    Eigen::Affine3d pose;
+    out.fk_ok[i] = model.getFK(joints[i], pose);
+    out.poses[i] = pose;
+    out.valid[i] = model.isValid(joints[i]);
+    out.ik_ok[i] = out.fk_ok[i] && model.getAllIK(pose, out.ik_solutions[i]);
+  }
+}
+}
+
+TEST(MoveitStateAdapterThreading, concurrent_queries_match_serial_queries)
+{
+  MoveitStateAdapter model;
+  ASSERT_TRUE(model.initialize("robot_description", "manipulator", "base_link", "tool0"));
+  model.setCheckCollisions(true);
+
+  const std::vector<std::vector<double> > joints = seed::findRandomSeeds(*model.getState(), "manipulator", N_POSES);
+  ASSERT_EQ(N_POSES, joints.size());
+
+  QueryResults serial(joints.size());
+  runQueries(model, joints, 0, 1, serial);
+
+  QueryResults parallel(joints.size());
+  boost::thread_group threads;
+  for (unsigned t = 0; t < N_THREADS; ++t)
+  {
+    threads.create_thread(boost::bind(&runQueries, boost::cref(model), boost::cref(joints), t, N_THREADS,
+                                      boost::ref(parallel)));
+  }
+  threads.join_all();
+
+  for (std::size_t i = 0; i < joints.size(); ++i)
+  {
+    // FK & collision checks are deterministic, so they must agree exactly with the serial path
+    EXPECT_EQ(serial.fk_ok[i], parallel.fk_ok[i]) << "pose " << i;
+    EXPECT_EQ(serial.valid[i], parallel.valid[i]) << "pose " << i;
+    if (serial.fk_ok[i] && parallel.fk_ok[i])
+    {
+      EXPECT_TRUE(serial.poses[i].isApprox(parallel.poses[i], TF_EQ_TOL)) << "pose " << i;
+    }
+
+    // Numerical IK may land on different solutions from run to run; instead check that every
+    // solution found concurrently really reaches the target pose
+    if (!parallel.ik_ok[i]) continue;
+    for (const auto& sol : parallel.ik_solutions[i])
+    {
+      Eigen::Affine3d check;
+      ASSERT_TRUE(model.getFK(sol, check));
+      EXPECT_TRUE(parallel.poses[i].isApprox(check, TF_EQ_TOL)) << "pose " << i;
+    }
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCARTES_EDGE_KERNELS_H
+#define DESCARTES_EDGE_KERNELS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace descartes_planner
+{
+namespace kernels
+{
+
+/**
+ * @brief JointMatrix holds the joint solutions of a rung in structure-of-arrays order: joint 'j' of
+ *        vertex 'i' is stored at data()[j * stride() + i]. The stride is padded so that each joint's
+ *        column can be streamed with full-width vector loads.
+ */
+class JointMatrix
+{
+public:
+  using size_type = std::size_t;
+
+  JointMatrix() : size_(0), dof_(0), stride_(0) {}
+
+  /**
+   * @brief assign Transposes 'n' vertices of 'dof' joints each, stored contiguously per vertex (the
+   *        LadderGraph layout), into this matrix. Existing storage is reused where possible.
+   */
+  void assign(const double* data, size_type n, size_type dof);
+
+  const double* data() const noexcept { return data_.data(); }
+
+  const double* column(size_type joint) const noexcept { return data_.data() + joint * stride_; }
+
+  /** @brief The number of vertices */
+  size_type size() const noexcept { return size_; }
+
+  size_type dof() const noexcept { return dof_; }
+
+  size_type stride() const noexcept { return stride_; }
+
+private:
+  std::vector<double> data_;
+  size_type size_;
+  size_type dof_;
+  size_type stride_;
+};
+
+/**
+ * @brief l1Distance Scores one vertex against every vertex of a rung.
+ * @param from The 'to.dof()' joint values of the source vertex
+ * @param to The destination rung
+ * @param max_delta Optional (may be nullptr) per-joint limit on |from[j] - to[j]|. Vertices that
+ *        exceed the limit on any joint are given a cost of +infinity.
+ * @param out Must have room for 'to.stride()' values; out[i] is the L1 distance to vertex 'i'
+ */
+void l1Distance(const double* from, const JointMatrix& to, const double* max_delta, double* out) noexcept;
+
+/**
+ * @brief Portable reference implementation of l1Distance(). Produces bit-identical results.
+ */
+void l1DistanceScalar(const double* from, const JointMatrix& to, const double* max_delta, double* out) noexcept;
+
+/**
+ * @brief The name of the instruction set the kernels were compiled for ("AVX", "SSE2" or "scalar")
+ */
+const char* instructionSet() noexcept;
+
+} // namespace kernels
+} // namespace descartes_planner
+#endif
@@ -19,6 +19,9 @@
 #ifndef DESCARTES_LADDER_GRAPH_H
 #define DESCARTES_LADDER_GRAPH_H
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
 #include "descartes_core/trajectory_id.h"
 #include "descartes_core/trajectory_timing_constraint.h"
 
@@ -31,14 +34,147 @@ struct __attribute__ ((__packed__)) Edge
   unsigned idx; // from THIS rung to 'idx' into the NEXT rung
 };
 
-struct Rung
+/**
+ * @brief RungEdges stores the out-edges of every vertex in a rung in compressed-sparse-row form: one
+ *        contiguous array of edges plus an array of offsets such that the edges leaving vertex 'i' are
+ *        found in [offsets[i], offsets[i+1]).
+ *
+ *        A rung may instead be marked 'implicit', meaning every vertex connects to every vertex of the
+ *        next rung with a cost equal to the L1 joint distance between them. No edges are stored in this
+ *        case; the search computes costs on the fly from the vertex data.
+ */
+class RungEdges
 {
-  using EdgeList = std::vector<Edge>;
+public:
+  using size_type = std::size_t;
+
+  /**
+   * @brief A view of the contiguous out-edges of a single vertex
+   */
+  template <typename EdgeT>
+  struct BasicRange
+  {
+    EdgeT* first;
+    EdgeT* last;
+
+    EdgeT* begin() const noexcept { return first; }
+    EdgeT* end() const noexcept { return last; }
+    size_type size() const noexcept { return static_cast<size_type>(last - first); }
+    bool empty() const noexcept { return first == last; }
+  };
+
+  using Range = BasicRange<const Edge>;
+  using MutableRange = BasicRange<Edge>;
+
+  RungEdges() : implicit_(false) {}
+
+  /**
+   * @brief Creates an edge set in which every vertex of this rung connects to every vertex of the next
+   */
+  static RungEdges makeImplicit()
+  {
+    RungEdges e;
+    e.implicit_ = true;
+    return e;
+  }
+
+  /**
+   * @brief reserve Pre-allocates storage for 'n_vertices' out-edge lists holding 'n_edges' edges in total
+   */
+  void reserve(size_type n_vertices, size_type n_edges)
+  {
+    offsets_.reserve(n_vertices + 1);
+    data_.reserve(n_edges);
+  }
+
+  /**
+   * @brief append Adds the out-edges of the next vertex in sequence. Vertices must be appended in order.
+   */
+  void append(const Edge* first, const Edge* last)
+  {
+    if (offsets_.empty()) offsets_.push_back(0);
+    data_.insert(data_.end(), first, last);
+    offsets_.push_back(static_cast<unsigned>(data_.size()));
+  }
+
+  /**
+   * @brief Releases any storage reserved beyond what the appended edges require
+   */
+  void shrinkToFit()
+  {
+    offsets_.shrink_to_fit();
+    data_.shrink_to_fit();
+  }
+
+  /**
+   * @brief Out-edges of 'vertex', empty if the rung has no edge list for it (e.g. after clear())
+   */
+  Range operator[](size_type vertex) const noexcept
+  {
+    assert(!implicit_);
+    if (vertex + 1 >= offsets_.size()) return {nullptr, nullptr};
+    return {data_.data() + offsets_[vertex], data_.data() + offsets_[vertex + 1]};
+  }
+
+  /**
+   * @brief Out-edges of 'vertex' whose costs may be changed in place, e.g. to replace lower bounds with
+   *        exact costs. Setting a cost to infinity removes the edge from any search.
+   */
+  MutableRange mutableEdges(size_type vertex) noexcept
+  {
+    assert(!implicit_);
+    if (vertex + 1 >= offsets_.size()) return {nullptr, nullptr};
+    return {data_.data() + offsets_[vertex], data_.data() + offsets_[vertex + 1]};
+  }
 
+  /**
+   * @brief The number of vertices with explicit edge lists
+   */
+  size_type size() const noexcept
+  {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+
+  /**
+   * @brief The total number of explicitly stored edges
+   */
+  size_type numEdges() const noexcept
+  {
+    return data_.size();
+  }
+
+  bool isImplicit() const noexcept
+  {
+    return implicit_;
+  }
+
+  /**
+   * @brief The number of bytes currently allocated for edge storage
+   */
+  size_type memoryUsage() const noexcept
+  {
+    return offsets_.capacity() * sizeof(unsigned) + data_.capacity() * sizeof(Edge);
+  }
+
+  void clear()
+  {
+    offsets_.clear();
+    data_.clear();
+    implicit_ = false;
+  }
+
+private:
+  std::vector<unsigned> offsets_;
+  std::vector<Edge> data_;
+  bool implicit_;
+};
+
+struct Rung
+{
   descartes_core::TrajectoryID id; // corresponds to user's input ID
   descartes_core::TimingConstraint timing; // user input timing
   std::vector<double> data; // joint values stored in one contiguous array
-  std::vector<EdgeList> edges;
+  RungEdges edges;
 };
 
 /**
@@ -50,7 +186,6 @@ class LadderGraph
 {
 public:
   using size_type = std::size_t;
-  using EdgeList = Rung::EdgeList;
 
   /**
    * @brief LadderGraph
@@ -82,12 +217,12 @@ public:
     return rungs_[index];
   }
 
-  std::vector<EdgeList>& getEdges(size_type index) noexcept // see p.23 Effective C++ (Scott Meyers)
+  RungEdges& getEdges(size_type index) noexcept // see p.23 Effective C++ (Scott Meyers)
   {
-    return const_cast<std::vector<EdgeList>&>(static_cast<const LadderGraph&>(*this).getEdges(index));
+    return const_cast<RungEdges&>(static_cast<const LadderGraph&>(*this).getEdges(index));
   }
 
-  const std::vector<EdgeList>& getEdges(size_type index) const noexcept
+  const RungEdges& getEdges(size_type index) const noexcept
   {
     assert(index < rungs_.size());
     return rungs_[index].edges;
@@ -108,6 +243,16 @@ public:
     return count;
   }
 
+  /**
+   * @brief numEdges Counts the total number of explicitly stored edges in the graph
+   */
+  size_type numEdges() const noexcept
+  {
+    size_type count = 0;
+    for (const auto& rung : rungs_) count += rung.edges.numEdges();
+    return count;
+  }
+
   /**
    * @brief indexOf returns a pair describing whether the given ID is in the graph and if so, what
    *        index it has.
@@ -166,14 +311,14 @@ public:
   /**
    * @brief assign Consumes the given edge list and assigns it to the rung-index given by 'rung'
    */
-  void assignEdges(size_type rung, std::vector<EdgeList>&& edges) // noexcept?
+  void assignEdges(size_type rung, RungEdges&& edges) // noexcept?
   {
     getEdges(rung) = std::move(edges);
   }
 
   /**
    * @brief assignRung Special helper function to assign a solution set associated with a Descartes point &
-   *        it's meta-info. Also resizes the associated edge list to the size of 'sols'.
+   *        it's meta-info. Any edges previously leaving this rung are discarded.
    * @param sols All of the joint solutions for this point.
    */
   void assignRung(size_type index, descartes_core::TrajectoryID id, descartes_core::TimingConstraint time,
@@ -187,8 +332,23 @@ public:
     {
       r.data.insert(r.data.end(), sol.cbegin(), sol.cend());
     }
-    // Given this new vertex set, build an edge list for each
-    getEdges(index).resize(r.data.size());
+    // Edges are only valid for the vertex set they were built against
+    r.edges.clear();
+  }
+
+  /**
+   * @brief assignRung Variant of the above taking 'n_sols' joint solutions laid out back to back in 'sols',
+   *        e.g. one point's solutions from RobotModel's batched getAllIK(). The rung's vertices are replaced,
+   *        reusing their storage.
+   */
+  void assignRung(size_type index, descartes_core::TrajectoryID id, descartes_core::TimingConstraint time,
+                  const double* sols, size_type n_sols)
+  {
+    Rung& r = getRung(index);
+    r.id = id;
+    r.timing = time;
+    r.data.assign(sols, sols + n_sols * dof_);
+    r.edges.clear();
   }
 
   void removeRung(size_type index)
@@ -20,6 +20,7 @@
 #define DESCARTES_LADDER_GRAPH_DAG_SEARCH_H
 
 #include "descartes_planner/ladder_graph.h"
+#include "descartes_planner/edge_kernels.h"
 
 namespace descartes_planner
 {
@@ -33,11 +34,53 @@ public:
 
   explicit DAGSearch(const LadderGraph& graph);
 
+  /**
+   * @brief Computes the shortest path through the whole graph from scratch
+   * @param seed_weights Optional initial costs of the vertices of the first rung; zero if empty
+   * @return The cost of the shortest path, or std::numeric_limits<double>::max() if there is none
+   */
   double run(const std::vector<double>& seed_weights = {});
 
+  /**
+   * @brief Re-runs the search after the graph has been modified, reusing the distance & predecessor
+   *        tables of every rung before 'first_dirty_rung'.
+   *
+   * A rung is dirty if its vertices changed or if the edges leading into it changed. Inserting,
+   * modifying or removing rung 'i' of the graph therefore dirties rung 'i' onwards; the tables of
+   * rungs [0, i) stay valid because the search only propagates forward. Rungs that were never
+   * searched are always recomputed, so calling this on a fresh search is the same as run().
+   * The seed weights of the last call to run() are reused.
+   */
+  double update(size_type first_dirty_rung);
+
   std::vector<predecessor_t> shortestPath() const;
 
+  /** @brief Lowest cost of reaching each vertex of 'rung' found by the last search */
+  const std::vector<double>& distances(size_type rung) const noexcept
+  {
+    return solution_[rung].distance;
+  }
+
+  /**
+   * @brief Index of the vertex in 'rung' - 1 through which each vertex of 'rung' is reached at the
+   *        lowest cost. Only meaningful for vertices whose distance is finite.
+   */
+  const std::vector<predecessor_t>& predecessors(size_type rung) const noexcept
+  {
+    return solution_[rung].predecessor;
+  }
+
 private:
+  /**
+   * @brief Relaxes every edge leaving 'rung' when its edges are stored explicitly
+   */
+  void relaxExplicit(size_type rung);
+
+  /**
+   * @brief Relaxes every edge of a rung whose edges are implicit (see RungEdges::makeImplicit)
+   */
+  void relaxImplicit(size_type rung);
+
   const LadderGraph& graph_;
 
   struct SolutionRung
@@ -62,6 +105,14 @@ private:
   }
 
   std::vector<SolutionRung> solution_;
+
+  // Number of leading rungs in 'solution_' that are consistent with the graph
+  size_type valid_rungs_;
+  std::vector<double> seed_weights_;
+
+  // Scratch space for scoring implicit edges
+  kernels::JointMatrix to_scratch_;
+  std::vector<double> cost_scratch_;
 };
 } // descartes_planner
 #endif
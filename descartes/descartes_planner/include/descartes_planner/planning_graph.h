@@ -32,20 +32,32 @@
 #include "descartes_trajectory/joint_trajectory_pt.h"
 
 #include "descartes_planner/ladder_graph.h"
+#include "descartes_planner/ladder_graph_dag_search.h"
 
 namespace descartes_planner
 {
 
 typedef boost::function<double(const double*, const double*)> CostFunction;
 
+/** @brief Cost of starting a path at a given joint configuration */
+typedef boost::function<double(const double*)> StartCostFunction;
+
 
 class PlanningGraph
 {
 public:
   PlanningGraph(descartes_core::RobotModelConstPtr model, CostFunction cost_function_callback = CostFunction{});
 
+  // The search keeps a reference to 'graph_'
+  PlanningGraph(const PlanningGraph&) = delete;
+  PlanningGraph& operator=(const PlanningGraph&) = delete;
+
   /** \brief Clear all previous graph data */
-  void clear() { graph_.clear(); }
+  void clear()
+  {
+    graph_.clear();
+    invalidateFrom(0);
+  }
 
   /** @brief initial population of graph trajectory elements
    * @param points list of trajectory points to be used to construct the graph
@@ -64,8 +76,51 @@ public:
 
   bool removeTrajectory(const descartes_core::TrajectoryPt::ID& point);
 
+  /**
+   * @brief Computes the lowest cost path through the graph. Search results are kept between calls so that
+   *        only the rungs touched by addTrajectory(), modifyTrajectory() or removeTrajectory() since the
+   *        last call, and the rungs after them, are searched again.
+   */
   bool getShortestPath(double &cost, std::list<descartes_trajectory::JointTrajectoryPt> &path);
 
+  /**
+   * @brief Plans through 'points' without holding the whole graph in memory, for process paths that are
+   *        too long for insertGraph(). Rungs are built and searched 'window_size' points at a time. Once a
+   *        window has been searched its edges are dropped and, of its vertices, only those that can still
+   *        lie on the optimal path are kept along with their predecessor indices. The result is the same
+   *        as insertGraph() followed by getShortestPath(). Leaves the graph empty.
+   * @param start_cost Optional cost of starting the path at each joint solution of the first point
+   */
+  bool getShortestPathStreaming(const std::vector<descartes_core::TrajectoryPtPtr>& points, std::size_t window_size,
+                                double &cost, std::list<descartes_trajectory::JointTrajectoryPt> &path,
+                                const StartCostFunction& start_cost = StartCostFunction{});
+
+  /**
+   * @brief Plans through 'points' evaluating the cost function lazily, for cost functions that are expensive.
+   *        Every feasible edge starts out with 'lower_bound' as its cost. Only the edges on the shortest path
+   *        are then scored with the real cost function, and the search is repeated (incrementally) until the
+   *        path holds no edge whose cost is still a bound. Provided that 'lower_bound' never exceeds the cost
+   *        function, the path is as cheap as that of insertGraph() followed by getShortestPath(). Leaves the
+   *        graph empty.
+   * @param lower_bound Lower bound of the cost of moving between two joint configurations; the L1 joint
+   *        distance if empty
+   */
+  bool getShortestPathLazy(const std::vector<descartes_core::TrajectoryPtPtr>& points, double &cost,
+                           std::list<descartes_trajectory::JointTrajectoryPt> &path,
+                           const CostFunction& lower_bound = CostFunction{});
+
+  /**
+   * @brief Plans through a path made of consecutive 'segments', e.g. the surfaces of a multi-surface process
+   *        path. Each segment's joint solutions and edges are computed concurrently in a graph of its own. The
+   *        searches are then chained across the rungs where neighbouring segments meet, so the result is the
+   *        same as insertGraph() followed by getShortestPath() on the concatenated points. Every segment must
+   *        hold at least one point. Does not modify this graph.
+   * @param start_cost Optional cost of starting the path at each joint solution of the first point
+   */
+  bool getShortestPathSegmented(const std::vector<std::vector<descartes_core::TrajectoryPtPtr>>& segments,
+                                double &cost, std::list<descartes_trajectory::JointTrajectoryPt> &path,
+                                const StartCostFunction& start_cost = StartCostFunction{});
+
   const descartes_planner::LadderGraph& graph() const noexcept { return graph_; }
 
   descartes_core::RobotModelConstPtr getRobotModel() const { return robot_model_; }
@@ -75,12 +130,29 @@ protected:
   descartes_core::RobotModelConstPtr robot_model_;
   CostFunction custom_cost_function_;
 
+  /** @brief Shortest path tables, reused across calls to getShortestPath() */
+  DAGSearch search_;
+  /** @brief Index of the first rung whose search results are out of date */
+  std::size_t first_dirty_rung_;
+
+  void invalidateFrom(std::size_t rung) { first_dirty_rung_ = std::min(first_dirty_rung_, rung); }
+
   /**
-   * @brief A pair indicating the validity of the edge, and if valid, the cost associated
-   *        with that edge
+   * @brief Replaces the graph with 'n_lead' empty rungs followed by the rungs of 'points', with the edges
+   *        between the latter. The caller fills in the leading rungs and the edges out of them.
+   */
+  bool buildGraph(const std::vector<descartes_core::TrajectoryPtPtr>& points, std::size_t n_lead);
+
+  /**
+   * @brief Solves each of the 'count' points into its own flat buffer of joint solutions, getDOF() values each
+   * @return True if every point has at least one solution
    */
   bool calculateJointSolutions(const descartes_core::TrajectoryPtPtr* points, const std::size_t count,
-                               std::vector<std::vector<std::vector<double>>>& poses) const;
+                               std::vector<std::vector<double>>& joint_data) const;
+
+  /** @brief Assigns the solutions of 'point', back to back in 'joint_data', to rung 'index' */
+  void assignRung(std::size_t index, const descartes_core::TrajectoryPtPtr& point,
+                  const std::vector<double>& joint_data);
 
   /** @brief (Re)create the actual graph nodes(vertices) from the list of joint solutions (vertices) */
   bool populateGraphVertices(const std::vector<descartes_core::TrajectoryPtPtr> &points,
@@ -88,13 +160,19 @@ protected:
 
   void computeAndAssignEdges(const std::size_t start_idx, const std::size_t end_idx);
 
+  /**
+   * @brief Like computeAndAssignEdges() for rungs 'start_idx' and 'start_idx' + 1, but with 'lower_bound' (or
+   *        the L1 joint distance) as the cost of every feasible edge. Used by getShortestPathLazy().
+   */
+  void computeAndAssignBoundEdges(const std::size_t start_idx, const CostFunction& lower_bound);
+
 
   template <typename EdgeBuilder>
-  std::vector<LadderGraph::EdgeList> calculateEdgeWeights(EdgeBuilder&& builder,
-                                                          const std::vector<double> &start_joints,
-                                                          const std::vector<double> &end_joints,
-                                                          const size_t dof,
-                                                          bool& has_edges) const;
+  RungEdges calculateEdgeWeights(EdgeBuilder&& builder,
+                                const std::vector<double> &start_joints,
+                                const std::vector<double> &end_joints,
+                                const size_t dof,
+                                bool& has_edges) const;
 
 };
 
@@ -1,7 +1,11 @@
 #ifndef PLANNING_GRAPH_EDGE_POLICY_H
 #define PLANNING_GRAPH_EDGE_POLICY_H
 
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include "descartes_planner/ladder_graph.h"
+#include "descartes_planner/edge_kernels.h"
 
 namespace descartes_planner
 {
@@ -13,8 +17,7 @@ struct DefaultEdgesWithTime
                       const size_t dof,
                       const double upper_tm,
                       const std::vector<double>& joint_vel_limits)
-    : results_(n_start)
-    , edge_scratch_(n_end)
+    : edge_scratch_(n_end)
     , max_dtheta_(dof)
     , delta_buffer_(dof)
     , dof_(dof)
@@ -24,6 +27,8 @@ struct DefaultEdgesWithTime
    std::transform(joint_vel_limits.cbegin(), joint_vel_limits.cend(), max_dtheta_.begin(), [upper_tm] (double v) {
                     return std::min(1.0, v * upper_tm);
                   });
+   // The number of feasible edges isn't known up front; let the edge array grow as needed
+   results_.reserve(n_start, 0);
   }
 
   inline void consider(const double* const start, const double* const stop, size_t index) noexcept
@@ -40,19 +45,23 @@ struct DefaultEdgesWithTime
     count_++;
   }
 
-  inline void next(const size_t i)
+  inline void next(const size_t)
   {
-    results_[i].assign(edge_scratch_.cbegin(), edge_scratch_.cbegin() + count_);
+    results_.append(edge_scratch_.data(), edge_scratch_.data() + count_);
     has_edges_ = has_edges_ || count_ > 0;
     count_ = 0;
   }
 
-  inline std::vector<LadderGraph::EdgeList>& result() noexcept { return results_; }
+  inline RungEdges& result()
+  {
+    results_.shrinkToFit();
+    return results_;
+  }
 
   inline bool hasEdges() const noexcept { return has_edges_; }
 
-  std::vector<LadderGraph::EdgeList> results_;
-  LadderGraph::EdgeList edge_scratch_; // pre-allocated space to work in
+  RungEdges results_;
+  std::vector<Edge> edge_scratch_; // pre-allocated space to work in
   std::vector<double> max_dtheta_;
   std::vector<double> delta_buffer_;
   size_t dof_;
@@ -60,6 +69,65 @@ struct DefaultEdgesWithTime
   bool has_edges_;
 };
 
+/**
+ * Produces the same edges as DefaultEdgesWithTime, but scores one 'from' vertex against the whole
+ * 'to' rung at a time. The 'to' rung is transposed into structure-of-arrays order once so that the
+ * distance and velocity-limit checks run through the vectorized kernels in edge_kernels.h.
+ */
+struct BatchedEdgesWithTime
+{
+  BatchedEdgesWithTime(const size_t n_start,
+                       const std::vector<double>& end_joints,
+                       const size_t dof,
+                       const double upper_tm,
+                       const std::vector<double>& joint_vel_limits)
+    : max_dtheta_(dof)
+    , has_edges_(false)
+  {
+    std::transform(joint_vel_limits.cbegin(), joint_vel_limits.cend(), max_dtheta_.begin(), [upper_tm] (double v) {
+                     return std::min(1.0, v * upper_tm);
+                   });
+    to_.assign(end_joints.data(), end_joints.size() / dof, dof);
+    costs_.resize(to_.stride());
+    edge_scratch_.resize(to_.size());
+    results_.reserve(n_start, 0);
+  }
+
+  /**
+   * @brief consider Computes the edges from 'start' to every feasible vertex of the 'to' rung. Must
+   *        be called once for each 'from' vertex, in order.
+   */
+  inline void consider(const double* const start) noexcept
+  {
+    kernels::l1Distance(start, to_, max_dtheta_.data(), costs_.data());
+
+    unsigned count = 0;
+    for (size_t j = 0; j < to_.size(); ++j)
+    {
+      if (costs_[j] < std::numeric_limits<double>::infinity())
+        edge_scratch_[count++] = {costs_[j], static_cast<unsigned>(j)};
+    }
+
+    results_.append(edge_scratch_.data(), edge_scratch_.data() + count);
+    has_edges_ = has_edges_ || count > 0;
+  }
+
+  inline RungEdges& result()
+  {
+    results_.shrinkToFit();
+    return results_;
+  }
+
+  inline bool hasEdges() const noexcept { return has_edges_; }
+
+  RungEdges results_;
+  kernels::JointMatrix to_;
+  std::vector<double> costs_; // per 'to' vertex cost of the current 'from' vertex
+  std::vector<Edge> edge_scratch_;
+  std::vector<double> max_dtheta_;
+  bool has_edges_;
+};
+
 struct CustomEdgesWithTime : public DefaultEdgesWithTime
 {
   CustomEdgesWithTime(const size_t n_start,
@@ -87,28 +155,32 @@ struct CustomEdgesWithTime : public DefaultEdgesWithTime
   descartes_planner::CostFunction custom_cost_fn; // TODO: Header doesn't stand on its own
 };
 
+/**
+ * Builds an explicit, fully connected edge set. Note that PlanningGraph prefers to mark such rungs as
+ * implicit (see RungEdges::makeImplicit) and let the search compute the costs on the fly; this builder
+ * remains for custom cost functions and for callers that want the costs materialized.
+ */
 struct DefaultEdgesWithoutTime
 {
   DefaultEdgesWithoutTime(const size_t n_start,
                        const size_t n_end,
                        const size_t dof)
-     : results_(n_start)
+     : edge_scratch_(n_end)
      , dof_(dof)
      , count_(0)
-     , layer_(0)
   {
-    for (auto& edges : results_)
-    {
-      edges.resize(n_end);
-    }
+    results_.reserve(n_start, n_start * n_end);
   }
 
   inline bool hasEdges() const { return true; }
 
-  // no-op
-  inline void next(const size_t) { layer_++; count_ = 0; }
+  inline void next(const size_t)
+  {
+    results_.append(edge_scratch_.data(), edge_scratch_.data() + count_);
+    count_ = 0;
+  }
 
-  inline std::vector<LadderGraph::EdgeList>& result() noexcept { return results_; }
+  inline RungEdges& result() noexcept { return results_; }
 
   inline void consider(const double* const start, const double* const stop, const size_t index) noexcept
   {
@@ -116,15 +188,15 @@ struct DefaultEdgesWithoutTime
     for (size_t i = 0; i < dof_; ++i)
       cost += std::abs(start[i] - stop[i]);
 
-    results_[layer_][count_].cost = cost;
-    results_[layer_][count_].idx = static_cast<unsigned>(index);
+    edge_scratch_[count_].cost = cost;
+    edge_scratch_[count_].idx = static_cast<unsigned>(index);
     count_++;
   }
 
-  std::vector<LadderGraph::EdgeList> results_;
+  RungEdges results_;
+  std::vector<Edge> edge_scratch_; // pre-allocated space to work in
   size_t dof_;
   size_t count_;
-  size_t layer_;
 };
 
 struct CustomEdgesWithoutTime : public DefaultEdgesWithoutTime
@@ -138,8 +210,8 @@ struct CustomEdgesWithoutTime : public DefaultEdgesWithoutTime
 
   inline void consider(const double* const start, const double* const stop, const size_t index) noexcept
   {
-    results_[layer_][count_].cost = custom_cost_fn(start, stop);
-    results_[layer_][count_].idx = static_cast<unsigned>(index);
+    edge_scratch_[count_].cost = custom_cost_fn(start, stop);
+    edge_scratch_[count_].idx = static_cast<unsigned>(index);
     count_++;
   }
 
@@ -0,0 +1,128 @@
+#include "descartes_planner/edge_kernels.h"
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace descartes_planner
+{
+namespace kernels
+{
+
+namespace
+{
+#if defined(__AVX__)
+const std::size_t LANES = 4;
+#elif defined(__SSE2__)
+const std::size_t LANES = 2;
+#else
+const std::size_t LANES = 1;
+#endif
+}
+
+void JointMatrix::assign(const double* data, size_type n, size_type dof)
+{
+  size_ = n;
+  dof_ = dof;
+  stride_ = (n + LANES - 1) / LANES * LANES;
+  // Padding lanes are zeroed so that the kernels never read uninitialized memory
+  data_.assign(stride_ * dof, 0.0);
+
+  for (size_type i = 0; i < n; ++i)
+    for (size_type j = 0; j < dof; ++j)
+      data_[j * stride_ + i] = data[i * dof + j];
+}
+
+void l1DistanceScalar(const double* from, const JointMatrix& to, const double* max_delta, double* out) noexcept
+{
+  const auto dof = to.dof();
+  const auto stride = to.stride();
+  const double inf = std::numeric_limits<double>::infinity();
+
+  for (std::size_t i = 0; i < stride; ++i)
+  {
+    double cost = 0.0;
+    bool valid = true;
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const double d = std::abs(from[j] - to.column(j)[i]);
+      if (max_delta && d > max_delta[j]) valid = false;
+      cost += d;
+    }
+    out[i] = valid ? cost : inf;
+  }
+}
+
+#if defined(__AVX__)
+
+void l1Distance(const double* from, const JointMatrix& to, const double* max_delta, double* out) noexcept
+{
+  const auto dof = to.dof();
+  const auto stride = to.stride();
+  const __m256d sign_mask = _mm256_set1_pd(-0.0);
+  const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+
+  for (std::size_t i = 0; i < stride; i += 4)
+  {
+    __m256d cost = _mm256_setzero_pd();
+    __m256d invalid = _mm256_setzero_pd();
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const __m256d diff = _mm256_sub_pd(_mm256_set1_pd(from[j]), _mm256_loadu_pd(to.column(j) + i));
+      const __m256d d = _mm256_andnot_pd(sign_mask, diff);
+      if (max_delta)
+        invalid = _mm256_or_pd(invalid, _mm256_cmp_pd(d, _mm256_set1_pd(max_delta[j]), _CMP_GT_OQ));
+      cost = _mm256_add_pd(cost, d);
+    }
+    _mm256_storeu_pd(out + i, _mm256_blendv_pd(cost, inf, invalid));
+  }
+}
+
+const char* instructionSet() noexcept { return "AVX"; }
+
+#elif defined(__SSE2__)
+
+void l1Distance(const double* from, const JointMatrix& to, const double* max_delta, double* out) noexcept
+{
+  const auto dof = to.dof();
+  const auto stride = to.stride();
+  const __m128d sign_mask = _mm_set1_pd(-0.0);
+  const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+
+  for (std::size_t i = 0; i < stride; i += 2)
+  {
+    __m128d cost = _mm_setzero_pd();
+    __m128d invalid = _mm_setzero_pd();
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const __m128d diff = _mm_sub_pd(_mm_set1_pd(from[j]), _mm_loadu_pd(to.column(j) + i));
+      const __m128d d = _mm_andnot_pd(sign_mask, diff);
+      if (max_delta)
+        invalid = _mm_or_pd(invalid, _mm_cmpgt_pd(d, _mm_set1_pd(max_delta[j])));
+      cost = _mm_add_pd(cost, d);
+    }
+    // SSE2 has no blend instruction: select with and/andnot/or
+    const __m128d result = _mm_or_pd(_mm_and_pd(invalid, inf), _mm_andnot_pd(invalid, cost));
+    _mm_storeu_pd(out + i, result);
+  }
+}
+
+const char* instructionSet() noexcept { return "SSE2"; }
+
+#else
+
+void l1Distance(const double* from, const JointMatrix& to, const double* max_delta, double* out) noexcept
+{
+  l1DistanceScalar(from, to, max_delta, out);
+}
+
+const char* instructionSet() noexcept { return "scalar"; }
+
+#endif
+
+} // namespace kernels
+} // namespace descartes_planner
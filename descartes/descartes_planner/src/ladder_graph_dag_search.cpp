@@ -1,10 +1,14 @@
 #include "descartes_planner/ladder_graph_dag_search.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 namespace descartes_planner
 {
 
 DAGSearch::DAGSearch(const LadderGraph &graph)
   : graph_(graph)
+  , valid_rungs_(0)
 {
   // On creating an object, let's allocate everything we need
   solution_.resize(graph.size());
@@ -19,50 +23,108 @@ DAGSearch::DAGSearch(const LadderGraph &graph)
 
 double DAGSearch::run(const std::vector<double>& seed_weights)
 {
+  seed_weights_ = seed_weights;
+  valid_rungs_ = 0;
+  return update(0);
+}
 
-  if (!seed_weights.empty())
-  {
-    if (seed_weights.size() != solution_.front().distance.size())
-      throw std::invalid_argument("Seed weights must match the size of initial row of joint solutions");
+double DAGSearch::update(size_type first_dirty_rung)
+{
+  // Rungs past the previous search were never filled in, so they are dirty as well
+  const auto n_rungs = graph_.size();
+  const auto first = std::min(std::min(first_dirty_rung, valid_rungs_), n_rungs);
 
-    solution_.front().distance = seed_weights;
+  // Rungs may have been added or removed, so re-shape the tables from the first dirty rung onward
+  solution_.resize(n_rungs);
+  for (size_type i = first; i < n_rungs; ++i)
+  {
+    const auto n_vertices = graph_.rungSize(i);
+    solution_[i].distance.assign(n_vertices, std::numeric_limits<double>::max());
+    solution_[i].predecessor.resize(n_vertices);
   }
-  else
+  valid_rungs_ = n_rungs;
+
+  if (n_rungs == 0) return std::numeric_limits<double>::max();
+
+  if (first == 0)
   {
-    // Cost to the first rung should be set to zero
-    std::fill(solution_.front().distance.begin(), solution_.front().distance.end(), 0.0);
+    if (!seed_weights_.empty())
+    {
+      if (seed_weights_.size() != solution_.front().distance.size())
+        throw std::invalid_argument("Seed weights must match the size of initial row of joint solutions");
+
+      solution_.front().distance = seed_weights_;
+    }
+    else
+    {
+      // Cost to the first rung should be set to zero
+      std::fill(solution_.front().distance.begin(), solution_.front().distance.end(), 0.0);
+    }
   }
 
-  // Other rows initialize to zero
-  for (size_type i = 1; i < solution_.size(); ++i)
+  // Now we iterate over the graph in 'topological' order, starting with the edges that lead into
+  // the first dirty rung
+  for (size_type rung = first > 0 ? first - 1 : 0; rung + 1 < n_rungs; ++rung)
   {
-    std::fill(solution_[i].distance.begin(), solution_[i].distance.end(), std::numeric_limits<double>::max());
+    if (graph_.getEdges(rung).isImplicit())
+      relaxImplicit(rung);
+    else
+      relaxExplicit(rung);
   }
 
-  // Now we iterate over the graph in 'topological' order
-  for (size_type rung = 0; rung < solution_.size() - 1; ++rung)
+  return *std::min_element(solution_.back().distance.begin(), solution_.back().distance.end());
+}
+
+void DAGSearch::relaxExplicit(size_type rung)
+{
+  const auto n_vertices = graph_.rungSize(rung);
+  const auto next_rung = rung + 1;
+  const auto& rung_edges = graph_.getEdges(rung);
+
+  // For each vertex in the out edge list
+  for (size_t index = 0; index < n_vertices; ++index)
   {
-    const auto n_vertices = graph_.rungSize(rung);
-    const auto next_rung = rung + 1;
-    // For each vertex in the out edge list
-    for (size_t index = 0; index < n_vertices; ++index)
+    const auto u_cost = distance(rung, index);
+    // for each out edge
+    for (const auto& edge : rung_edges[index])
     {
-      const auto u_cost = distance(rung, index);
-      const auto& edges = graph_.getEdges(rung)[index];
-      // for each out edge
-      for (const auto& edge : edges)
+      auto dv = u_cost + edge.cost; // new cost
+      if (dv < distance(next_rung, edge.idx))
       {
-        auto dv = u_cost + edge.cost; // new cost
-        if (dv < distance(next_rung, edge.idx))
-        {
-          distance(next_rung, edge.idx) = dv;
-          predecessor(next_rung, edge.idx) = index; // the predecessor's rung is implied to be the current rung
-        }
+        distance(next_rung, edge.idx) = dv;
+        predecessor(next_rung, edge.idx) = index; // the predecessor's rung is implied to be the current rung
       }
-    } // vertex for loop
-  } // rung for loop
+    }
+  } // vertex for loop
+}
 
-  return *std::min_element(solution_.back().distance.begin(), solution_.back().distance.end());
+void DAGSearch::relaxImplicit(size_type rung)
+{
+  // Every vertex in 'rung' connects to every vertex in the next rung with a cost equal to the L1
+  // distance between their joint values
+  const auto dof = graph_.dof();
+  const auto next_rung = rung + 1;
+  const auto n_from = graph_.rungSize(rung);
+  const auto n_to = graph_.rungSize(next_rung);
+
+  to_scratch_.assign(graph_.vertex(next_rung, 0), n_to, dof);
+  cost_scratch_.resize(to_scratch_.stride());
+
+  for (size_type index = 0; index < n_from; ++index)
+  {
+    const auto u_cost = distance(rung, index);
+    kernels::l1Distance(graph_.vertex(rung, index), to_scratch_, nullptr, cost_scratch_.data());
+
+    for (size_type next = 0; next < n_to; ++next)
+    {
+      auto dv = u_cost + cost_scratch_[next];
+      if (dv < distance(next_rung, next))
+      {
+        distance(next_rung, next) = dv;
+        predecessor(next_rung, next) = index;
+      }
+    }
+  }
 }
 
 std::vector<DAGSearch::predecessor_t> DAGSearch::shortestPath() const
@@ -27,15 +27,94 @@
 #include "descartes_planner/ladder_graph_dag_search.h"
 #include "descartes_planner/planning_graph_edge_policy.h"
 #include <ros/console.h>
+#include <algorithm>
+#include <memory>
 
 using namespace descartes_core;
 using namespace descartes_trajectory;
 
+namespace
+{
+
+// A rung of a window that has already been searched by PlanningGraph::getShortestPathStreaming()
+struct FinishedRung
+{
+  TimingConstraint timing;
+  std::vector<double> data; // joint values of the vertices that may still lie on the optimal path
+  std::vector<descartes_planner::DAGSearch::predecessor_t> predecessor; // indexes the kept vertices of the
+                                                                        // previous finished rung
+};
+
+/**
+ * @brief Drops the vertices of finished rungs that none of the reachable vertices of the last (frontier) rung
+ *        lead back to. The frontier itself keeps every vertex because the next window refers to them by index.
+ *        Rungs up to 'settled' were pruned by an earlier call, so the walk stops there once nothing changes.
+ */
+void pruneFinishedRungs(std::vector<FinishedRung>& rungs, const std::vector<double>& frontier_distance,
+                        const std::size_t settled, const std::size_t dof)
+{
+  std::vector<char> live (frontier_distance.size());
+  for (std::size_t i = 0; i < live.size(); ++i)
+    live[i] = frontier_distance[i] < std::numeric_limits<double>::max();
+
+  std::vector<char> used;
+  std::vector<descartes_planner::DAGSearch::predecessor_t> remap;
+
+  for (std::size_t r = rungs.size() - 1; r > 0; --r)
+  {
+    auto& current = rungs[r];
+    auto& prev = rungs[r - 1];
+    const auto n_prev = prev.data.size() / dof;
+
+    used.assign(n_prev, 0);
+    for (std::size_t i = 0; i < live.size(); ++i)
+      if (live[i]) used[current.predecessor[i]] = 1;
+
+    const auto n_used = static_cast<std::size_t>(std::count(used.begin(), used.end(), 1));
+    if (n_used == n_prev && r - 1 <= settled) break;
+
+    // Compact the previous rung and point the current rung at the new indices
+    remap.assign(n_prev, 0);
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < n_prev; ++i)
+    {
+      if (!used[i]) continue;
+      remap[i] = kept;
+      if (kept != i)
+      {
+        std::copy_n(&prev.data[i * dof], dof, &prev.data[kept * dof]);
+        if (!prev.predecessor.empty()) prev.predecessor[kept] = prev.predecessor[i];
+      }
+      ++kept;
+    }
+
+    prev.data.resize(kept * dof);
+    prev.data.shrink_to_fit();
+    if (!prev.predecessor.empty())
+    {
+      prev.predecessor.resize(kept);
+      prev.predecessor.shrink_to_fit();
+    }
+
+    for (std::size_t i = 0; i < live.size(); ++i)
+      if (live[i]) current.predecessor[i] = remap[current.predecessor[i]];
+
+    // Every vertex left in the previous rung is on the way to the frontier
+    live.assign(kept, 1);
+  }
+}
+
+} // anon namespace
+
 namespace descartes_planner
 {
 
 PlanningGraph::PlanningGraph(RobotModelConstPtr model, CostFunction cost_function_callback)
-  : graph_(model->getDOF()), robot_model_(std::move(model)), custom_cost_function_(cost_function_callback)
+  : graph_(model->getDOF())
+  , robot_model_(std::move(model))
+  , custom_cost_function_(cost_function_callback)
+  , search_(graph_)
+  , first_dirty_rung_(0)
 {}
 
 bool PlanningGraph::insertGraph(const std::vector<TrajectoryPtPtr>& points)
@@ -46,25 +125,30 @@ bool PlanningGraph::insertGraph(const std::vector<TrajectoryPtPtr>& points)
     return false;
   }
 
-  if (graph_.size() > 0) clear();
+  return buildGraph(points, 0);
+}
+
+bool PlanningGraph::buildGraph(const std::vector<TrajectoryPtPtr>& points, std::size_t n_lead)
+{
+  clear();
 
   // generate solutions for this point
-  std::vector<std::vector<std::vector<double>>> all_joint_sols;
+  std::vector<std::vector<double>> all_joint_sols;
   if (!calculateJointSolutions(points.data(), points.size(), all_joint_sols))
   {
     return false;
   }
 
   // insert into graph as vertices
-  graph_.resize(points.size());
+  graph_.resize(n_lead + points.size());
   for (std::size_t i = 0; i < points.size(); ++i)
   {
-    graph_.assignRung(i, points[i]->getID(), points[i]->getTiming(), all_joint_sols[i]);
+    assignRung(n_lead + i, points[i], all_joint_sols[i]);
   }
 
   // now we have a graph with data in the 'rungs' and we need to compute the edges
   #pragma omp parallel for
-  for (std::size_t i = 0; i < graph_.size() - 1; ++i)
+  for (std::size_t i = n_lead; i < graph_.size() - 1; ++i)
   {
     computeAndAssignEdges(i, i + 1);
   }
@@ -80,13 +164,14 @@ bool PlanningGraph::addTrajectory(TrajectoryPtPtr point, TrajectoryPt::ID previo
   auto ns = graph_.indexOf(next_id);
 
   // Next & prev can be 'null' indicating end & start of trajectory
-  std::vector<std::vector<std::vector<double>>> poses;
+  std::vector<std::vector<double>> poses;
   calculateJointSolutions(&point, 1, poses); // TODO: If there are no points, return false?
 
   // Insert new point into graph
   auto insert_idx = ns.second ? ns.first : graph_.size();
   graph_.insertRung(insert_idx);
-  graph_.assignRung(insert_idx, point->getID(), point->getTiming(), poses[0]);
+  assignRung(insert_idx, point, poses[0]);
+  invalidateFrom(insert_idx);
 
   // Build edges from prev point, if applicable
   if (!previous_id.is_nil())
@@ -112,13 +197,14 @@ bool PlanningGraph::modifyTrajectory(TrajectoryPtPtr point)
   auto idx = s.first;
 
   // we will need to recompute some vertices now
-  std::vector<std::vector<std::vector<double>>> poses;
+  std::vector<std::vector<double>> poses;
   calculateJointSolutions(&point, 1, poses); // TODO: If there are no points, return false?
 
   // clear vertices & edges of 'point'
   graph_.clearVertices(idx);
   graph_.clearEdges(idx);
-  graph_.assignRung(idx, point->getID(), point->getTiming(), poses[0]);
+  assignRung(idx, point, poses[0]);
+  invalidateFrom(idx);
 
   // If there is a previous point, compute new edges
   if (!graph_.isFirst(idx))
@@ -147,6 +233,7 @@ bool PlanningGraph::removeTrajectory(const TrajectoryPt::ID& point)
 
   // remove the vertices & edges associated with this point
   graph_.removeRung(s.first);
+  invalidateFrom(s.first);
 
   // recompute edges from previous rung to next rung, if applicable
   if (in_middle)
@@ -161,11 +248,12 @@ bool PlanningGraph::removeTrajectory(const TrajectoryPt::ID& point)
 
 bool PlanningGraph::getShortestPath(double& cost, std::list<JointTrajectoryPt>& path)
 {
-  DAGSearch search (graph_);
-  cost = search.run();
+  // Only the rungs from the first modification onward need to be searched again
+  cost = search_.update(first_dirty_rung_);
+  first_dirty_rung_ = graph_.size();
   if (cost == std::numeric_limits<double>::max()) return false;
 
-  auto path_idxs = search.shortestPath();
+  auto path_idxs = search_.shortestPath();
   const auto dof = graph_.dof();
 
   for (size_t i = 0; i < path_idxs.size(); ++i)
@@ -183,27 +271,348 @@ bool PlanningGraph::getShortestPath(double& cost, std::list<JointTrajectoryPt>&
   return true;
 }
 
+bool PlanningGraph::getShortestPathStreaming(const std::vector<TrajectoryPtPtr>& points, std::size_t window_size,
+                                             double& cost, std::list<JointTrajectoryPt>& path,
+                                             const StartCostFunction& start_cost)
+{
+  if (points.size() < 2)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": must provide at least 2 input trajectory points.");
+    return false;
+  }
+
+  if (window_size == 0)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": window size must be at least 1.");
+    return false;
+  }
+
+  clear();
+
+  const auto dof = graph_.dof();
+  std::vector<FinishedRung> finished;
+  finished.reserve(points.size());
+  std::vector<double> seed_weights;
+
+  for (std::size_t begin = 0; begin < points.size(); begin += window_size)
+  {
+    const auto count = std::min(window_size, points.size() - begin);
+
+    std::vector<std::vector<double>> all_joint_sols;
+    if (!calculateJointSolutions(points.data() + begin, count, all_joint_sols))
+    {
+      clear();
+      return false;
+    }
+
+    // The last rung of the previous window is kept as the first rung of this one so that the edges
+    // between the windows can be built. Its distances seed the search.
+    const std::size_t carry = begin > 0 ? 1 : 0;
+    if (carry)
+    {
+      Rung last = std::move(graph_.getRung(graph_.size() - 1));
+      graph_.clear();
+      graph_.resize(1);
+      graph_.getRung(0) = std::move(last);
+      graph_.clearEdges(0);
+    }
+
+    graph_.resize(carry + count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      assignRung(carry + i, points[begin + i], all_joint_sols[i]);
+    }
+
+    #pragma omp parallel for
+    for (std::size_t i = 0; i < graph_.size() - 1; ++i)
+    {
+      computeAndAssignEdges(i, i + 1);
+    }
+
+    if (begin == 0 && start_cost)
+    {
+      seed_weights.resize(graph_.rungSize(0));
+      for (std::size_t i = 0; i < seed_weights.size(); ++i)
+        seed_weights[i] = start_cost(graph_.vertex(0, i));
+    }
+
+    DAGSearch search (graph_);
+    if (search.run(seed_weights) == std::numeric_limits<double>::max())
+    {
+      // Nothing at the end of this window can be reached, so neither can the end of the path
+      clear();
+      return false;
+    }
+
+    // Hand the searched rungs over to the finished list; their edges are dropped with the window
+    const auto settled = finished.empty() ? 0 : finished.size() - 1;
+    const auto last = graph_.size() - 1;
+    for (std::size_t r = carry; r <= last; ++r)
+    {
+      FinishedRung f;
+      f.timing = graph_.getRung(r).timing;
+      if (r == last) f.data = graph_.getRung(r).data; // still needed by the next window
+      else f.data = std::move(graph_.getRung(r).data);
+      if (r > 0) f.predecessor = search.predecessors(r);
+      finished.push_back(std::move(f));
+    }
+
+    seed_weights = search.distances(last);
+    pruneFinishedRungs(finished, seed_weights, settled, dof);
+  }
+
+  clear();
+
+  // Back-track from the cheapest vertex of the final rung
+  auto min_it = std::min_element(seed_weights.begin(), seed_weights.end());
+  cost = *min_it;
+  DAGSearch::predecessor_t idx = std::distance(seed_weights.begin(), min_it);
+
+  std::list<JointTrajectoryPt> solution;
+  for (std::size_t r = finished.size(); r-- > 0;)
+  {
+    const auto& rung = finished[r];
+    const auto* data = &rung.data[idx * dof];
+    solution.push_front(JointTrajectoryPt(std::vector<double>(data, data + dof), rung.timing));
+    if (r > 0) idx = rung.predecessor[idx];
+  }
+  path.splice(path.end(), solution);
+
+  ROS_INFO("Computed streaming path of length %lu with cost %lf", finished.size(), cost);
+
+  return true;
+}
+
+bool PlanningGraph::getShortestPathLazy(const std::vector<TrajectoryPtPtr>& points, double& cost,
+                                        std::list<JointTrajectoryPt>& path, const CostFunction& lower_bound)
+{
+  if (points.size() < 2)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": must provide at least 2 input trajectory points.");
+    return false;
+  }
+
+  clear();
+
+  std::vector<std::vector<double>> all_joint_sols;
+  if (!calculateJointSolutions(points.data(), points.size(), all_joint_sols))
+  {
+    return false;
+  }
+
+  graph_.resize(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    assignRung(i, points[i], all_joint_sols[i]);
+  }
+
+  #pragma omp parallel for
+  for (std::size_t i = 0; i < graph_.size() - 1; ++i)
+  {
+    computeAndAssignBoundEdges(i, lower_bound);
+  }
+
+  const auto dof = graph_.dof();
+  const auto n_rungs = graph_.size();
+
+  // Whether each edge of a rung holds its exact cost, indexed by from * (size of next rung) + to
+  std::vector<std::vector<char>> evaluated (n_rungs - 1);
+  for (std::size_t r = 0; r < n_rungs - 1; ++r)
+  {
+    evaluated[r].assign(graph_.rungSize(r) * graph_.rungSize(r + 1), 0);
+  }
+
+  auto exact_cost = [this, dof](const double* a, const double* b) {
+    if (custom_cost_function_) return custom_cost_function_(a, b);
+    double c = 0.0;
+    for (std::size_t i = 0; i < dof; ++i) c += std::abs(a[i] - b[i]);
+    return c;
+  };
+
+  DAGSearch search (graph_);
+  cost = search.run();
+
+  std::vector<DAGSearch::predecessor_t> path_idxs;
+  std::vector<std::size_t> pending; // rungs whose edge along the current path still holds a bound
+  std::vector<double> exact;
+  std::size_t n_searches = 1, n_evaluated = 0;
+
+  while (cost != std::numeric_limits<double>::max())
+  {
+    path_idxs = search.shortestPath();
+
+    pending.clear();
+    for (std::size_t r = 0; r < n_rungs - 1; ++r)
+    {
+      auto& done = evaluated[r][path_idxs[r] * graph_.rungSize(r + 1) + path_idxs[r + 1]];
+      if (!done) pending.push_back(r);
+      done = 1;
+    }
+    if (pending.empty()) break;
+
+    // Score the path's bounded edges all at once; the search only needs to resume from the first that changed
+    exact.resize(pending.size());
+    #pragma omp parallel for
+    for (std::size_t i = 0; i < pending.size(); ++i)
+    {
+      const auto r = pending[i];
+      exact[i] = exact_cost(graph_.vertex(r, path_idxs[r]), graph_.vertex(r + 1, path_idxs[r + 1]));
+    }
+    n_evaluated += pending.size();
+
+    std::size_t first_dirty = n_rungs;
+    for (std::size_t i = 0; i < pending.size(); ++i)
+    {
+      const auto r = pending[i];
+      for (auto& edge : graph_.getEdges(r).mutableEdges(path_idxs[r]))
+      {
+        if (edge.idx != path_idxs[r + 1]) continue;
+        if (edge.cost != exact[i])
+        {
+          edge.cost = exact[i];
+          first_dirty = std::min(first_dirty, r + 1);
+        }
+        break;
+      }
+    }
+    if (first_dirty == n_rungs) break;
+
+    cost = search.update(first_dirty);
+    ++n_searches;
+  }
+
+  if (cost == std::numeric_limits<double>::max())
+  {
+    clear();
+    return false;
+  }
+
+  for (size_t i = 0; i < path_idxs.size(); ++i)
+  {
+    const auto* data = graph_.vertex(i, path_idxs[i]);
+    path.push_back(JointTrajectoryPt(std::vector<double>(data, data + dof), graph_.getRung(i).timing));
+  }
+
+  ROS_INFO("Computed lazy path of length %lu with cost %lf after %lu searches and %lu edge evaluations",
+           path_idxs.size(), cost, n_searches, n_evaluated);
+
+  clear();
+  return true;
+}
+
+bool PlanningGraph::getShortestPathSegmented(const std::vector<std::vector<TrajectoryPtPtr>>& segments,
+                                             double& cost, std::list<JointTrajectoryPt>& path,
+                                             const StartCostFunction& start_cost)
+{
+  std::size_t n_points = 0;
+  for (const auto& segment : segments)
+  {
+    if (segment.empty())
+    {
+      ROS_ERROR_STREAM(__FUNCTION__ << ": every segment must contain at least 1 trajectory point.");
+      return false;
+    }
+    n_points += segment.size();
+  }
+
+  if (n_points < 2)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": must provide at least 2 input trajectory points.");
+    return false;
+  }
+
+  // Every segment after the first starts with a copy of the last rung of the one before it, filled in below
+  // once both are built, so that each edge of the path lies within a single segment graph. Nested parallel
+  // regions are inactive by default, so while several segments are built at once each one is built by one
+  // thread; a lone segment still gets the whole team.
+  const std::size_t n_segments = segments.size();
+  std::vector<std::unique_ptr<PlanningGraph>> graphs (n_segments);
+  std::vector<char> built (n_segments);
+
+  #pragma omp parallel for schedule(dynamic) if (n_segments > 1)
+  for (std::size_t s = 0; s < n_segments; ++s)
+  {
+    graphs[s].reset(new PlanningGraph(robot_model_, custom_cost_function_));
+    built[s] = graphs[s]->buildGraph(segments[s], s > 0 ? 1 : 0);
+  }
+
+  if (std::find(built.begin(), built.end(), 0) != built.end())
+  {
+    return false;
+  }
+
+  const auto dof = graph_.dof();
+
+  // Search the segments in order: the distances to the vertices of the boundary rung shared by two segments
+  // seed the search of the second, so every segment is searched once and the optimum stays global
+  std::vector<double> seed_weights;
+  for (std::size_t s = 0; s < n_segments; ++s)
+  {
+    PlanningGraph& segment = *graphs[s];
+    if (s > 0)
+    {
+      const LadderGraph& prev = graphs[s - 1]->graph_;
+      const Rung& boundary = prev.getRung(prev.size() - 1);
+      segment.graph_.assignRung(0, boundary.id, boundary.timing, boundary.data.data(), boundary.data.size() / dof);
+      segment.computeAndAssignEdges(0, 1);
+    }
+    else if (start_cost)
+    {
+      seed_weights.resize(segment.graph_.rungSize(0));
+      for (std::size_t i = 0; i < seed_weights.size(); ++i)
+        seed_weights[i] = start_cost(segment.graph_.vertex(0, i));
+    }
+
+    if (segment.search_.run(seed_weights) == std::numeric_limits<double>::max())
+    {
+      ROS_ERROR_STREAM(__FUNCTION__ << ": no path through segment " << s);
+      return false;
+    }
+    seed_weights = segment.search_.distances(segment.graph_.size() - 1);
+  }
+
+  // Back-track from the cheapest vertex of the final rung, skipping the copied boundary rungs
+  auto min_it = std::min_element(seed_weights.begin(), seed_weights.end());
+  cost = *min_it;
+  DAGSearch::predecessor_t idx = std::distance(seed_weights.begin(), min_it);
+
+  std::list<JointTrajectoryPt> solution;
+  for (std::size_t s = n_segments; s-- > 0;)
+  {
+    const PlanningGraph& segment = *graphs[s];
+    const std::size_t n_lead = s > 0 ? 1 : 0;
+    for (std::size_t r = segment.graph_.size(); r-- > n_lead;)
+    {
+      const auto* data = segment.graph_.vertex(r, idx);
+      solution.push_front(JointTrajectoryPt(std::vector<double>(data, data + dof), segment.graph_.getRung(r).timing));
+      if (r > 0) idx = segment.search_.predecessors(r)[idx];
+    }
+  }
+  path.splice(path.end(), solution);
+
+  ROS_INFO("Computed path of length %lu with cost %lf through %lu segments", n_points, cost, n_segments);
+
+  return true;
+}
+
 bool PlanningGraph::calculateJointSolutions(const TrajectoryPtPtr* points, const std::size_t count,
-                                            std::vector<std::vector<std::vector<double>>>& poses) const
+                                            std::vector<std::vector<double>>& joint_data) const
 {
-  poses.resize(count);
+  joint_data.resize(count);
 
   #pragma omp parallel for
   for (std::size_t i = 0; i < count; ++i)
   {
-    std::vector<std::vector<double>> joint_poses;
-    points[i]->getJointPoses(*robot_model_, joint_poses);
+    points[i]->getJointPoses(*robot_model_, joint_data[i]);
 
-    if (joint_poses.empty())
+    if (joint_data[i].empty())
     {
       ROS_ERROR_STREAM(__FUNCTION__ << ": IK failed for input trajectory point with ID = " << points[i]->getID());
 //     return false;
     }
-
-    poses[i] = std::move(joint_poses);
   }
 
-  for (const auto& sols : poses)
+  for (const auto& sols : joint_data)
   {
     if (sols.empty())
       return false;
@@ -212,6 +621,12 @@ bool PlanningGraph::calculateJointSolutions(const TrajectoryPtPtr* points, const
   return true;
 }
 
+void PlanningGraph::assignRung(const std::size_t index, const TrajectoryPtPtr& point,
+                               const std::vector<double>& joint_data)
+{
+  graph_.assignRung(index, point->getID(), point->getTiming(), joint_data.data(), joint_data.size() / graph_.dof());
+}
+
 void PlanningGraph::computeAndAssignEdges(const std::size_t start_idx, const std::size_t end_idx)
 {
   assert(end_idx > start_idx);
@@ -226,12 +641,17 @@ void PlanningGraph::computeAndAssignEdges(const std::size_t start_idx, const std
   const auto end_size = joints2.size() / dof;
 
   bool b;
-  std::vector<LadderGraph::EdgeList> edges;
+  RungEdges edges;
 
   if (!custom_cost_function_ && tm.isSpecified())
   {
-    DefaultEdgesWithTime builder (start_size, end_size, dof, tm.upper, robot_model_->getJointVelocityLimits());
-    edges = calculateEdgeWeights(builder, joints1, joints2, dof, b);
+    BatchedEdgesWithTime builder (start_size, joints2, dof, tm.upper, robot_model_->getJointVelocityLimits());
+    for (std::size_t i = 0; i < start_size; ++i)
+    {
+      builder.consider(&joints1[i * dof]);
+    }
+    edges = std::move(builder.result());
+    b = builder.hasEdges();
   }
   else if (custom_cost_function_ && tm.isSpecified())
   {
@@ -240,8 +660,10 @@ void PlanningGraph::computeAndAssignEdges(const std::size_t start_idx, const std
   }
   else if (!custom_cost_function_ && !tm.isSpecified())
   {
-    DefaultEdgesWithoutTime builder (start_size, end_size, dof);
-    edges = calculateEdgeWeights(builder, joints1, joints2, dof, b);
+    // Every pair is connected by its joint distance; let the search compute these on the fly rather
+    // than storing start_size * end_size edges
+    edges = RungEdges::makeImplicit();
+    b = start_size > 0 && end_size > 0;
   }
   else
   {
@@ -253,10 +675,55 @@ void PlanningGraph::computeAndAssignEdges(const std::size_t start_idx, const std
   if (!b) ROS_WARN("No edges between user input points at index %lu and %lu", start_idx, end_idx);
 }
 
+void PlanningGraph::computeAndAssignBoundEdges(const std::size_t start_idx, const CostFunction& lower_bound)
+{
+  const auto& joints1 = graph_.getRung(start_idx).data;
+  const auto& joints2 = graph_.getRung(start_idx + 1).data;
+  const auto& tm = graph_.getRung(start_idx + 1).timing;
+  const auto dof = graph_.dof();
+
+  const auto start_size = joints1.size() / dof;
+  const auto end_size = joints2.size() / dof;
+
+  // Velocity feasibility is settled here rather than lazily: the kernel that computes the L1 distance rejects
+  // pairs that break the limits in the same pass
+  bool b;
+  RungEdges edges;
+
+  if (tm.isSpecified())
+  {
+    BatchedEdgesWithTime builder (start_size, joints2, dof, tm.upper, robot_model_->getJointVelocityLimits());
+    for (std::size_t i = 0; i < start_size; ++i)
+    {
+      builder.consider(&joints1[i * dof]);
+    }
+    edges = std::move(builder.result());
+    b = builder.hasEdges();
+  }
+  else
+  {
+    // Stored explicitly, unlike in computeAndAssignEdges(), so that the costs can be refined in place
+    DefaultEdgesWithoutTime builder (start_size, end_size, dof);
+    edges = calculateEdgeWeights(builder, joints1, joints2, dof, b);
+  }
+
+  if (lower_bound)
+  {
+    for (std::size_t i = 0; i < start_size; ++i)
+    {
+      for (auto& edge : edges.mutableEdges(i))
+        edge.cost = lower_bound(&joints1[i * dof], &joints2[edge.idx * dof]);
+    }
+  }
+
+  graph_.assignEdges(start_idx, std::move(edges));
+  if (!b) ROS_WARN("No edges between user input points at index %lu and %lu", start_idx, start_idx + 1);
+}
+
 template<typename EdgeBuilder>
-std::vector<LadderGraph::EdgeList> PlanningGraph::calculateEdgeWeights(EdgeBuilder&& builder, const std::vector<double>& start_joints,
-                                                                       const std::vector<double>& end_joints, const size_t dof,
-                                                                       bool& has_edges) const
+RungEdges PlanningGraph::calculateEdgeWeights(EdgeBuilder&& builder, const std::vector<double>& start_joints,
+                                              const std::vector<double>& end_joints, const size_t dof,
+                                              bool& has_edges) const
 {
   const auto from_size = start_joints.size();
   const auto to_size = end_joints.size();
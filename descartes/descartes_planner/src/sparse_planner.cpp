@@ -683,7 +683,7 @@ bool SparsePlanner::plan()
           {
             sparse_solution_array_.clear();
             ROS_INFO_STREAM("Added new point to sparse trajectory from dense trajectory at position "
-                            << point_pos << ", re-planning entire trajectory");
+                            << point_pos << ", re-planning from sparse index " << sparse_index);
           }
           else
           {
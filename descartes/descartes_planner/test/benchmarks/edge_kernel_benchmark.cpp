@@ -0,0 +1,92 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Compares building timed edges with the per-pair DefaultEdgesWithTime policy against the batched,
+ * vectorized BatchedEdgesWithTime policy.
+ *
+ * Usage: edge_kernel_benchmark [n_rungs] [n_solutions_per_rung]
+ */
+
+#include <descartes_planner/planning_graph.h>
+#include <descartes_planner/planning_graph_edge_policy.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace descartes_planner;
+
+namespace
+{
+
+const std::size_t DOF = 6;
+const double UPPER_TM = 0.5;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t n_rungs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+  const std::size_t n_sols = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 24;
+  const std::vector<double> vel_limits (DOF, 3.0);
+
+  std::printf("%lu rungs, %lu solutions per rung, %lu DOF, kernels built for %s\n", n_rungs, n_sols, DOF,
+              kernels::instructionSet());
+
+  std::mt19937 gen (0);
+  std::uniform_real_distribution<double> dist (-M_PI, M_PI);
+  std::vector<std::vector<double>> rungs (n_rungs, std::vector<double>(n_sols * DOF));
+  for (auto& rung : rungs)
+    for (auto& v : rung) v = dist(gen);
+
+  std::size_t n_edges = 0;
+  auto start = Clock::now();
+  for (std::size_t r = 0; r + 1 < n_rungs; ++r)
+  {
+    DefaultEdgesWithTime builder (n_sols, n_sols, DOF, UPPER_TM, vel_limits);
+    for (std::size_t i = 0; i < n_sols; ++i)
+    {
+      for (std::size_t j = 0; j < n_sols; ++j)
+        builder.consider(&rungs[r][i * DOF], &rungs[r + 1][j * DOF], j);
+      builder.next(i);
+    }
+    n_edges += builder.result().numEdges();
+  }
+  std::printf("%-10s %10.2f ms   %lu edges\n", "per-pair", elapsedMs(start), n_edges);
+
+  n_edges = 0;
+  start = Clock::now();
+  for (std::size_t r = 0; r + 1 < n_rungs; ++r)
+  {
+    BatchedEdgesWithTime builder (n_sols, rungs[r + 1], DOF, UPPER_TM, vel_limits);
+    for (std::size_t i = 0; i < n_sols; ++i)
+      builder.consider(&rungs[r][i * DOF]);
+    n_edges += builder.result().numEdges();
+  }
+  std::printf("%-10s %10.2f ms   %lu edges\n", "batched", elapsedMs(start), n_edges);
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Compares the memory footprint, build time and search time of the ladder graph edge layouts:
+ *  - 'nested': the previous one-std::vector-per-vertex layout, reproduced here for reference
+ *  - 'csr': RungEdges in compressed-sparse-row form
+ *  - 'implicit': no stored edges, costs computed by DAGSearch on the fly
+ *
+ * Usage: edge_storage_benchmark [n_rungs] [n_solutions_per_rung]
+ */
+
+#include <descartes_planner/planning_graph.h>
+#include <descartes_planner/planning_graph_edge_policy.h>
+#include <descartes_planner/ladder_graph_dag_search.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace descartes_planner;
+
+namespace
+{
+
+const std::size_t DOF = 6;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+LadderGraph makeGraph(std::size_t n_rungs, std::size_t n_sols)
+{
+  std::mt19937 gen (0);
+  std::uniform_real_distribution<double> dist (-M_PI, M_PI);
+
+  LadderGraph graph (DOF);
+  graph.resize(n_rungs);
+  for (std::size_t i = 0; i < n_rungs; ++i)
+  {
+    std::vector<std::vector<double>> sols (n_sols, std::vector<double>(DOF));
+    for (auto& sol : sols)
+      for (auto& v : sol) v = dist(gen);
+    graph.assignRung(i, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(), sols);
+  }
+  return graph;
+}
+
+// The layout LadderGraph used before RungEdges: one heap allocated edge list per vertex
+using NestedEdges = std::vector<std::vector<Edge>>;
+
+NestedEdges buildNested(const LadderGraph& graph, std::size_t rung)
+{
+  const auto n_from = graph.rungSize(rung);
+  const auto n_to = graph.rungSize(rung + 1);
+  NestedEdges edges (n_from);
+  for (std::size_t i = 0; i < n_from; ++i)
+  {
+    edges[i].resize(n_to);
+    for (std::size_t j = 0; j < n_to; ++j)
+    {
+      const double* a = graph.vertex(rung, i);
+      const double* b = graph.vertex(rung + 1, j);
+      double cost = 0.0;
+      for (std::size_t k = 0; k < DOF; ++k) cost += std::abs(a[k] - b[k]);
+      edges[i][j].cost = cost;
+      edges[i][j].idx = static_cast<unsigned>(j);
+    }
+  }
+  return edges;
+}
+
+std::size_t nestedMemory(const NestedEdges& edges)
+{
+  std::size_t bytes = edges.capacity() * sizeof(std::vector<Edge>);
+  for (const auto& e : edges) bytes += e.capacity() * sizeof(Edge);
+  return bytes;
+}
+
+double searchNested(const LadderGraph& graph, const std::vector<NestedEdges>& edges)
+{
+  std::vector<std::vector<double>> dist (graph.size());
+  for (std::size_t i = 0; i < graph.size(); ++i)
+    dist[i].assign(graph.rungSize(i), i == 0 ? 0.0 : std::numeric_limits<double>::max());
+
+  for (std::size_t rung = 0; rung + 1 < graph.size(); ++rung)
+    for (std::size_t index = 0; index < edges[rung].size(); ++index)
+      for (const auto& edge : edges[rung][index])
+        dist[rung + 1][edge.idx] = std::min(dist[rung + 1][edge.idx], dist[rung][index] + edge.cost);
+
+  return *std::min_element(dist.back().begin(), dist.back().end());
+}
+
+RungEdges buildCsr(const LadderGraph& graph, std::size_t rung)
+{
+  const auto n_from = graph.rungSize(rung);
+  const auto n_to = graph.rungSize(rung + 1);
+  DefaultEdgesWithoutTime builder (n_from, n_to, DOF);
+  for (std::size_t i = 0; i < n_from; ++i)
+  {
+    for (std::size_t j = 0; j < n_to; ++j)
+      builder.consider(graph.vertex(rung, i), graph.vertex(rung + 1, j), j);
+    builder.next(i);
+  }
+  return std::move(builder.result());
+}
+
+void report(const char* name, double build_ms, double search_ms, std::size_t bytes, double cost)
+{
+  std::printf("%-10s build %10.2f ms   search %10.2f ms   edge memory %10.2f MB   cost %.6f\n", name, build_ms,
+              search_ms, bytes / (1024.0 * 1024.0), cost);
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t n_rungs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+  const std::size_t n_sols = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 24;
+
+  if (n_rungs < 2)
+  {
+    std::fprintf(stderr, "At least 2 rungs are required\n");
+    return 1;
+  }
+
+  std::printf("%lu rungs, %lu solutions per rung, %lu DOF\n", n_rungs, n_sols, DOF);
+
+  // Nested layout
+  {
+    LadderGraph graph = makeGraph(n_rungs, n_sols);
+    auto start = Clock::now();
+    std::vector<NestedEdges> edges (n_rungs - 1);
+    for (std::size_t i = 0; i < n_rungs - 1; ++i) edges[i] = buildNested(graph, i);
+    const double build_ms = elapsedMs(start);
+
+    std::size_t bytes = 0;
+    for (const auto& e : edges) bytes += nestedMemory(e);
+
+    start = Clock::now();
+    const double cost = searchNested(graph, edges);
+    report("nested", build_ms, elapsedMs(start), bytes, cost);
+  }
+
+  // CSR layout
+  {
+    LadderGraph graph = makeGraph(n_rungs, n_sols);
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < n_rungs - 1; ++i) graph.assignEdges(i, buildCsr(graph, i));
+    const double build_ms = elapsedMs(start);
+
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < n_rungs; ++i) bytes += graph.getEdges(i).memoryUsage();
+
+    start = Clock::now();
+    DAGSearch search (graph);
+    const double cost = search.run();
+    report("csr", build_ms, elapsedMs(start), bytes, cost);
+  }
+
+  // Implicit dense edges
+  {
+    LadderGraph graph = makeGraph(n_rungs, n_sols);
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < n_rungs - 1; ++i) graph.assignEdges(i, RungEdges::makeImplicit());
+    const double build_ms = elapsedMs(start);
+
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < n_rungs; ++i) bytes += graph.getEdges(i).memoryUsage();
+
+    start = Clock::now();
+    DAGSearch search (graph);
+    const double cost = search.run();
+    report("implicit", build_ms, elapsedMs(start), bytes, cost);
+  }
+
+  return 0;
+}
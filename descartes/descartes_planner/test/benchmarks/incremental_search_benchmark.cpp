@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Replays the replanning loop of SparsePlanner on a synthetic ladder graph: each replan inserts a rung
+ * just before an existing sparse point, modifies that point and searches the graph again. Replans are
+ * issued front to back, as interpolateSparseTrajectory() reports the first failure it finds.
+ *
+ * The 'full' column searches the whole graph after each replan (the previous behaviour), the
+ * 'incremental' column reuses the tables of the unmodified prefix via DAGSearch::update().
+ *
+ * Usage: incremental_search_benchmark [n_sparse_rungs] [n_replans] [n_solutions_per_rung]
+ */
+
+#include <descartes_planner/ladder_graph.h>
+#include <descartes_planner/ladder_graph_dag_search.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace descartes_planner;
+
+namespace
+{
+
+const std::size_t DOF = 6;
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<std::vector<double>> randomSolutions(std::mt19937& gen, std::size_t n_sols)
+{
+  std::uniform_real_distribution<double> dist (-M_PI, M_PI);
+  std::vector<std::vector<double>> sols (n_sols, std::vector<double>(DOF));
+  for (auto& sol : sols)
+    for (auto& v : sol) v = dist(gen);
+  return sols;
+}
+
+LadderGraph makeGraph(std::mt19937& gen, std::size_t n_rungs, std::size_t n_sols)
+{
+  LadderGraph graph (DOF);
+  graph.resize(n_rungs);
+  for (std::size_t i = 0; i < n_rungs; ++i)
+  {
+    graph.assignRung(i, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                     randomSolutions(gen, n_sols));
+    if (i > 0) graph.assignEdges(i - 1, RungEdges::makeImplicit());
+  }
+  return graph;
+}
+
+// Returns the position of each replan; positions move forward through the graph as it grows
+std::vector<std::size_t> replanPositions(std::mt19937& gen, std::size_t n_rungs, std::size_t n_replans)
+{
+  std::vector<std::size_t> positions (n_replans);
+  for (std::size_t i = 0; i < n_replans; ++i)
+  {
+    const std::size_t size = n_rungs + i;
+    const std::size_t base = 1 + (size - 2) * i / n_replans;
+    positions[i] = std::min(size - 1, base + gen() % 3);
+  }
+  return positions;
+}
+
+// Mimics PlanningGraph::addTrajectory() followed by PlanningGraph::modifyTrajectory() on the next point
+void replan(LadderGraph& graph, std::mt19937& gen, std::size_t idx, std::size_t n_sols)
+{
+  graph.insertRung(idx);
+  graph.assignRung(idx, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                   randomSolutions(gen, n_sols));
+  graph.clearVertices(idx + 1);
+  graph.assignRung(idx + 1, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                   randomSolutions(gen, n_sols));
+
+  graph.assignEdges(idx - 1, RungEdges::makeImplicit());
+  graph.assignEdges(idx, RungEdges::makeImplicit());
+  if (idx + 2 < graph.size()) graph.assignEdges(idx + 1, RungEdges::makeImplicit());
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t n_rungs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+  const std::size_t n_replans = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+  const std::size_t n_sols = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 16;
+
+  if (n_rungs < 3)
+  {
+    std::fprintf(stderr, "At least 3 rungs are required\n");
+    return 1;
+  }
+
+  std::printf("%lu sparse rungs, %lu replans, %lu solutions per rung, %lu DOF\n", n_rungs, n_replans, n_sols, DOF);
+
+  double totals[2] = {0.0, 0.0};
+  double costs[2] = {0.0, 0.0};
+
+  for (int mode = 0; mode < 2; ++mode)
+  {
+    // Both modes see exactly the same sequence of graphs
+    std::mt19937 gen (0);
+    LadderGraph graph = makeGraph(gen, n_rungs, n_sols);
+    const auto positions = replanPositions(gen, n_rungs, n_replans);
+
+    DAGSearch incremental (graph);
+    incremental.run();
+
+    for (auto idx : positions)
+    {
+      replan(graph, gen, idx, n_sols);
+
+      const auto start = Clock::now();
+      if (mode == 0)
+      {
+        DAGSearch full (graph);
+        costs[mode] = full.run();
+      }
+      else
+      {
+        costs[mode] = incremental.update(idx);
+      }
+      totals[mode] += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+  }
+
+  std::printf("%-12s total search %10.2f ms   per replan %8.3f ms   final cost %.6f\n", "full", totals[0],
+              totals[0] / n_replans, costs[0]);
+  std::printf("%-12s total search %10.2f ms   per replan %8.3f ms   final cost %.6f\n", "incremental", totals[1],
+              totals[1] / n_replans, costs[1]);
+  std::printf("speedup %.2fx\n", totals[0] / totals[1]);
+
+  return 0;
+}
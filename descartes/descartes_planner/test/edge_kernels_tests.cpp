@@ -0,0 +1,114 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descartes_planner/planning_graph.h>
+#include <descartes_planner/planning_graph_edge_policy.h>
+#include <descartes_planner/edge_kernels.h>
+
+#include <random>
+#include <gtest/gtest.h>
+
+using descartes_planner::kernels::JointMatrix;
+
+static std::vector<double> randomJoints(std::size_t n, std::size_t dof, std::mt19937& gen, double range = M_PI)
+{
+  std::uniform_real_distribution<double> dist (-range, range);
+  std::vector<double> v (n * dof);
+  for (auto& x : v) x = dist(gen);
+  return v;
+}
+
+TEST(EdgeKernels, joint_matrix_transposes)
+{
+  const std::vector<double> data = {1, 2, 3, 4, 5, 6}; // three 2-dof vertices
+  JointMatrix m;
+  m.assign(data.data(), 3, 2);
+
+  ASSERT_EQ(3u, m.size());
+  ASSERT_GE(m.stride(), 3u);
+  EXPECT_EQ(1.0, m.column(0)[0]);
+  EXPECT_EQ(3.0, m.column(0)[1]);
+  EXPECT_EQ(5.0, m.column(0)[2]);
+  EXPECT_EQ(2.0, m.column(1)[0]);
+  EXPECT_EQ(6.0, m.column(1)[2]);
+}
+
+TEST(EdgeKernels, vectorized_matches_scalar)
+{
+  std::mt19937 gen (7);
+  const std::size_t dof = 6;
+  const std::vector<double> limits (dof, 1.5);
+
+  // Odd sizes exercise the padded tail of each column
+  for (std::size_t n : {1u, 3u, 8u, 23u, 24u})
+  {
+    auto from = randomJoints(1, dof, gen);
+    auto to_data = randomJoints(n, dof, gen);
+    JointMatrix to;
+    to.assign(to_data.data(), n, dof);
+
+    std::vector<double> fast (to.stride()), slow (to.stride());
+    descartes_planner::kernels::l1Distance(from.data(), to, nullptr, fast.data());
+    descartes_planner::kernels::l1DistanceScalar(from.data(), to, nullptr, slow.data());
+    for (std::size_t i = 0; i < n; ++i) EXPECT_EQ(slow[i], fast[i]);
+
+    descartes_planner::kernels::l1Distance(from.data(), to, limits.data(), fast.data());
+    descartes_planner::kernels::l1DistanceScalar(from.data(), to, limits.data(), slow.data());
+    for (std::size_t i = 0; i < n; ++i) EXPECT_EQ(slow[i], fast[i]);
+  }
+}
+
+TEST(EdgeKernels, batched_builder_matches_default_builder)
+{
+  std::mt19937 gen (11);
+  const std::size_t dof = 6;
+  const std::size_t n_start = 24, n_end = 19;
+  const std::vector<double> vel_limits (dof, 2.0);
+  const double upper_tm = 0.4; // tight enough that some, but not all, edges are infeasible
+
+  auto from = randomJoints(n_start, dof, gen, 0.6);
+  auto to = randomJoints(n_end, dof, gen, 0.6);
+
+  descartes_planner::DefaultEdgesWithTime reference (n_start, n_end, dof, upper_tm, vel_limits);
+  descartes_planner::BatchedEdgesWithTime batched (n_start, to, dof, upper_tm, vel_limits);
+  for (std::size_t i = 0; i < n_start; ++i)
+  {
+    for (std::size_t j = 0; j < n_end; ++j)
+      reference.consider(&from[i * dof], &to[j * dof], j);
+    reference.next(i);
+    batched.consider(&from[i * dof]);
+  }
+
+  const auto& expected = reference.result();
+  const auto& actual = batched.result();
+  EXPECT_EQ(reference.hasEdges(), batched.hasEdges());
+  ASSERT_EQ(expected.size(), actual.size());
+  ASSERT_EQ(expected.numEdges(), actual.numEdges());
+  EXPECT_GT(expected.numEdges(), 0u);
+  EXPECT_LT(expected.numEdges(), n_start * n_end);
+
+  for (std::size_t i = 0; i < n_start; ++i)
+  {
+    ASSERT_EQ(expected[i].size(), actual[i].size());
+    for (std::size_t k = 0; k < expected[i].size(); ++k)
+    {
+      EXPECT_EQ(expected[i].begin()[k].idx, actual[i].begin()[k].idx);
+      EXPECT_EQ(expected[i].begin()[k].cost, actual[i].begin()[k].cost);
+    }
+  }
+}
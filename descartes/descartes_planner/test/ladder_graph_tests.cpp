@@ -0,0 +1,212 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descartes_planner/planning_graph.h>
+#include <descartes_planner/planning_graph_edge_policy.h>
+#include <descartes_planner/ladder_graph_dag_search.h>
+
+#include <random>
+#include <gtest/gtest.h>
+
+using descartes_planner::LadderGraph;
+using descartes_planner::RungEdges;
+
+static LadderGraph makeRandomGraph(std::size_t n_rungs, std::size_t n_sols, std::size_t dof, unsigned seed)
+{
+  std::mt19937 gen (seed);
+  std::uniform_real_distribution<double> dist (-M_PI, M_PI);
+
+  LadderGraph graph (dof);
+  graph.resize(n_rungs);
+  for (std::size_t i = 0; i < n_rungs; ++i)
+  {
+    std::vector<std::vector<double>> sols (n_sols, std::vector<double>(dof));
+    for (auto& sol : sols)
+      for (auto& v : sol) v = dist(gen);
+    graph.assignRung(i, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(), sols);
+  }
+  return graph;
+}
+
+static RungEdges buildExplicitEdges(const LadderGraph& graph, std::size_t rung)
+{
+  const auto dof = graph.dof();
+  const auto n_start = graph.rungSize(rung);
+  const auto n_end = graph.rungSize(rung + 1);
+
+  descartes_planner::DefaultEdgesWithoutTime builder (n_start, n_end, dof);
+  for (std::size_t i = 0; i < n_start; ++i)
+  {
+    for (std::size_t j = 0; j < n_end; ++j)
+      builder.consider(graph.vertex(rung, i), graph.vertex(rung + 1, j), j);
+    builder.next(i);
+  }
+  return std::move(builder.result());
+}
+
+TEST(LadderGraph, csr_edges_layout)
+{
+  RungEdges edges;
+  std::vector<descartes_planner::Edge> a = {{1.0, 0}, {2.0, 2}};
+  std::vector<descartes_planner::Edge> b;
+  std::vector<descartes_planner::Edge> c = {{3.0, 1}};
+
+  edges.append(a.data(), a.data() + a.size());
+  edges.append(b.data(), b.data() + b.size());
+  edges.append(c.data(), c.data() + c.size());
+
+  ASSERT_EQ(3u, edges.size());
+  EXPECT_EQ(3u, edges.numEdges());
+  EXPECT_FALSE(edges.isImplicit());
+
+  ASSERT_EQ(2u, edges[0].size());
+  EXPECT_EQ(2u, edges[0].begin()[1].idx);
+  EXPECT_TRUE(edges[1].empty());
+  ASSERT_EQ(1u, edges[2].size());
+  EXPECT_DOUBLE_EQ(3.0, edges[2].begin()->cost);
+}
+
+TEST(LadderGraph, cleared_edges_are_empty)
+{
+  RungEdges edges;
+  EXPECT_TRUE(edges[0].empty());
+
+  std::vector<descartes_planner::Edge> a = {{1.0, 0}};
+  edges.append(a.data(), a.data() + a.size());
+  ASSERT_EQ(1u, edges[0].size());
+  EXPECT_TRUE(edges[1].empty());
+
+  edges.clear();
+  EXPECT_TRUE(edges[0].empty());
+  EXPECT_TRUE(edges.mutableEdges(0).empty());
+}
+
+TEST(LadderGraph, assign_rung_from_flat_buffer)
+{
+  LadderGraph graph (2);
+  graph.resize(2);
+
+  // Two poses' solutions back to back
+  const std::vector<double> joint_data = {0.0, 1.0, 2.0, 3.0, 4.0, 5.0};
+  const std::vector<std::size_t> offsets = {0, 1, 3};
+
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    graph.assignEdges(i, RungEdges::makeImplicit());
+    graph.assignRung(i, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                     joint_data.data() + offsets[i] * graph.dof(), offsets[i + 1] - offsets[i]);
+  }
+
+  ASSERT_EQ(1u, graph.rungSize(0));
+  ASSERT_EQ(2u, graph.rungSize(1));
+  EXPECT_DOUBLE_EQ(1.0, graph.vertex(0, 0)[1]);
+  EXPECT_DOUBLE_EQ(4.0, graph.vertex(1, 1)[0]);
+  EXPECT_FALSE(graph.getEdges(0).isImplicit());
+
+  // Reassigning replaces the vertices rather than appending to them
+  graph.assignRung(1, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                   joint_data.data(), 1);
+  ASSERT_EQ(1u, graph.rungSize(1));
+  EXPECT_DOUBLE_EQ(0.0, graph.vertex(1, 0)[0]);
+}
+
+TEST(LadderGraph, implicit_edges_match_explicit_edges)
+{
+  const std::size_t n_rungs = 50;
+  LadderGraph explicit_graph = makeRandomGraph(n_rungs, 12, 6, 42);
+  LadderGraph implicit_graph = makeRandomGraph(n_rungs, 12, 6, 42);
+
+  for (std::size_t i = 0; i < n_rungs - 1; ++i)
+  {
+    explicit_graph.assignEdges(i, buildExplicitEdges(explicit_graph, i));
+    implicit_graph.assignEdges(i, RungEdges::makeImplicit());
+  }
+
+  EXPECT_EQ(0u, implicit_graph.numEdges());
+  EXPECT_EQ((n_rungs - 1) * 12 * 12, explicit_graph.numEdges());
+
+  descartes_planner::DAGSearch explicit_search (explicit_graph);
+  descartes_planner::DAGSearch implicit_search (implicit_graph);
+
+  const double explicit_cost = explicit_search.run();
+  const double implicit_cost = implicit_search.run();
+
+  EXPECT_DOUBLE_EQ(explicit_cost, implicit_cost);
+  EXPECT_EQ(explicit_search.shortestPath(), implicit_search.shortestPath());
+}
+
+static std::vector<std::vector<double>> randomSolutions(std::mt19937& gen, std::size_t n_sols, std::size_t dof)
+{
+  std::uniform_real_distribution<double> dist (-M_PI, M_PI);
+  std::vector<std::vector<double>> sols (n_sols, std::vector<double>(dof));
+  for (auto& sol : sols)
+    for (auto& v : sol) v = dist(gen);
+  return sols;
+}
+
+TEST(LadderGraph, incremental_search_matches_full_search)
+{
+  const std::size_t dof = 6;
+  LadderGraph graph = makeRandomGraph(30, 8, dof, 7);
+  for (std::size_t i = 0; i < graph.size() - 1; ++i)
+    graph.assignEdges(i, buildExplicitEdges(graph, i));
+
+  descartes_planner::DAGSearch incremental (graph);
+  incremental.run();
+
+  std::mt19937 gen (11);
+  for (int iter = 0; iter < 60; ++iter)
+  {
+    // Mimic PlanningGraph: insert, modify or remove a rung, rebuild the edges around it and remember the
+    // first rung whose incoming edges changed
+    std::size_t dirty = 0;
+    const int op = iter % 3;
+    if (op == 0)
+    {
+      dirty = std::uniform_int_distribution<std::size_t>(0, graph.size())(gen);
+      graph.insertRung(dirty);
+      graph.assignRung(dirty, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                       randomSolutions(gen, 1 + gen() % 10, dof));
+    }
+    else if (op == 1)
+    {
+      dirty = std::uniform_int_distribution<std::size_t>(0, graph.size() - 1)(gen);
+      graph.clearVertices(dirty);
+      graph.assignRung(dirty, descartes_core::TrajectoryID::make_nil(), descartes_core::TimingConstraint(),
+                       randomSolutions(gen, 1 + gen() % 10, dof));
+    }
+    else
+    {
+      dirty = std::uniform_int_distribution<std::size_t>(0, graph.size() - 1)(gen);
+      graph.removeRung(dirty);
+    }
+
+    if (dirty > 0 && dirty <= graph.size() - 1)
+      graph.assignEdges(dirty - 1, buildExplicitEdges(graph, dirty - 1));
+    if (dirty < graph.size() - 1)
+      graph.assignEdges(dirty, buildExplicitEdges(graph, dirty));
+    graph.clearEdges(graph.size() - 1);
+
+    descartes_planner::DAGSearch full (graph);
+    const double full_cost = full.run();
+    const double incremental_cost = incremental.update(dirty);
+
+    ASSERT_DOUBLE_EQ(full_cost, incremental_cost) << "iteration " << iter;
+    ASSERT_EQ(full.shortestPath(), incremental.shortestPath()) << "iteration " << iter;
+  }
+}
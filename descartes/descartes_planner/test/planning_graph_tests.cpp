@@ -18,8 +18,13 @@
 
 #include <descartes_planner/planning_graph.h>
 #include <descartes_trajectory/joint_trajectory_pt.h>
+#include <descartes_trajectory/axial_symmetric_pt.h>
 #include <descartes_trajectory_test/cartesian_robot.h>
 #include <boost/make_shared.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -177,3 +182,200 @@ TEST(PlanningGraph, insert_then_modify_all_points)
   ASSERT_TRUE( graph.modifyTrajectory(invalid_pt) );
   EXPECT_FALSE(graph.getShortestPath(cost, out));
 }
+
+// Points that are free to rotate about Z, so that each has several joint solutions
+static std::vector<descartes_core::TrajectoryPtPtr> makeAxialPoints(std::size_t n, double dt)
+{
+  std::vector<descartes_core::TrajectoryPtPtr> points;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const double t = static_cast<double>(i) / n;
+    points.push_back(boost::make_shared<descartes_trajectory::AxialSymmetricPt>(
+        t, 0.5 * std::sin(6.0 * t), 0.0, 0.0, 0.0, 0.3 * i, M_PI / 4.0,
+        descartes_trajectory::AxialSymmetricPt::Z_AXIS, descartes_core::TimingConstraint(dt)));
+  }
+  return points;
+}
+
+using PlannedPath = std::list<descartes_trajectory::JointTrajectoryPt>;
+using PlanFn = std::function<bool(descartes_planner::PlanningGraph&, double&, PlannedPath&)>;
+
+/**
+ * Plans 'points' with the whole graph in memory, then once per entry of 'variants', and expects each variant
+ * to find the same path at the same cost, to within 'tolerance' if it is nonzero.
+ */
+static void expectMatchesInMemory(const std::vector<descartes_core::TrajectoryPtPtr>& points,
+                                  descartes_planner::CostFunction cost_fn,
+                                  const std::vector<std::pair<std::string, PlanFn>>& variants,
+                                  double tolerance = 0.0)
+{
+  auto robot = boost::shared_ptr<descartes_core::RobotModel>(
+    new descartes_trajectory_test::CartesianRobot(5.0, 2.0 * M_PI + 0.1, std::vector<double>(6, 1.0)));
+
+  descartes_planner::PlanningGraph graph {robot, cost_fn};
+  ASSERT_TRUE(graph.insertGraph(points));
+
+  double expected_cost;
+  PlannedPath expected;
+  ASSERT_TRUE(graph.getShortestPath(expected_cost, expected));
+  ASSERT_EQ(points.size(), expected.size());
+
+  for (const auto& variant : variants)
+  {
+    double cost;
+    PlannedPath out;
+    ASSERT_TRUE(variant.second(graph, cost, out)) << variant.first;
+    ASSERT_EQ(expected.size(), out.size()) << variant.first;
+    if (tolerance > 0.0)
+      EXPECT_NEAR(expected_cost, cost, tolerance) << variant.first;
+    else
+      EXPECT_DOUBLE_EQ(expected_cost, cost) << variant.first;
+
+    auto it = out.begin();
+    for (const auto& pt : expected)
+    {
+      EXPECT_EQ(pt.nominal(), it->nominal()) << variant.first;
+      ++it;
+    }
+  }
+}
+
+static descartes_planner::CostFunction squaredCost()
+{
+  return [](const double* a, const double* b) {
+    double cost = 0.0;
+    for (int i = 0; i < 6; ++i) cost += (a[i] - b[i]) * (a[i] - b[i]);
+    return cost;
+  };
+}
+
+static void expectStreamingMatchesInMemory(const std::vector<descartes_core::TrajectoryPtPtr>& points,
+                                           descartes_planner::CostFunction cost_fn = descartes_planner::CostFunction{})
+{
+  std::vector<std::pair<std::string, PlanFn>> variants;
+  for (std::size_t window : {1, 2, 3, 7, 1000})
+  {
+    variants.emplace_back("window " + std::to_string(window),
+                          [&points, window](descartes_planner::PlanningGraph& graph, double& cost, PlannedPath& out) {
+                            const bool found = graph.getShortestPathStreaming(points, window, cost, out);
+                            EXPECT_EQ(0u, graph.graph().size());
+                            return found;
+                          });
+  }
+  expectMatchesInMemory(points, cost_fn, variants);
+}
+
+TEST(PlanningGraph, streaming_matches_in_memory)
+{
+  // Implicit edges
+  expectStreamingMatchesInMemory(makeAxialPoints(60, 0.0));
+  // Velocity limited edges, some of which are infeasible
+  expectStreamingMatchesInMemory(makeAxialPoints(60, 1.5));
+  // Explicitly stored custom cost edges
+  expectStreamingMatchesInMemory(makeAxialPoints(60, 0.0), squaredCost());
+}
+
+static void expectSegmentedMatchesInMemory(const std::vector<descartes_core::TrajectoryPtPtr>& points,
+                                           descartes_planner::CostFunction cost_fn = descartes_planner::CostFunction{})
+{
+  // Split the points into segments of the given lengths, including single point segments at either end
+  const std::vector<std::vector<std::size_t>> splits = {{60}, {30, 30}, {1, 59}, {59, 1}, {7, 1, 20, 13, 19}};
+
+  std::vector<std::pair<std::string, PlanFn>> variants;
+  for (const auto& lengths : splits)
+  {
+    std::vector<std::vector<descartes_core::TrajectoryPtPtr>> segments;
+    auto begin = points.begin();
+    for (auto n : lengths)
+    {
+      segments.emplace_back(begin, begin + n);
+      begin += n;
+    }
+
+    variants.emplace_back(std::to_string(lengths.size()) + " segments",
+                          [segments](descartes_planner::PlanningGraph& graph, double& cost, PlannedPath& out) {
+                            return graph.getShortestPathSegmented(segments, cost, out);
+                          });
+  }
+  expectMatchesInMemory(points, cost_fn, variants);
+}
+
+TEST(PlanningGraph, segmented_matches_in_memory)
+{
+  expectSegmentedMatchesInMemory(makeAxialPoints(60, 0.0));
+  expectSegmentedMatchesInMemory(makeAxialPoints(60, 1.5));
+  expectSegmentedMatchesInMemory(makeAxialPoints(60, 0.0), squaredCost());
+}
+
+static void expectLazyMatchesEager(const std::vector<descartes_core::TrajectoryPtPtr>& points,
+                                   descartes_planner::CostFunction cost_fn,
+                                   descartes_planner::CostFunction lower_bound = descartes_planner::CostFunction{})
+{
+  auto n_calls = std::make_shared<std::atomic<std::size_t>>(0);
+  auto counted_fn = [n_calls, cost_fn](const double* a, const double* b) {
+    ++*n_calls;
+    return cost_fn(a, b);
+  };
+
+  // Runs after the in memory search, so the calls counted so far are those of the eager search
+  auto lazy = [&points, n_calls, lower_bound](descartes_planner::PlanningGraph& graph, double& cost,
+                                              PlannedPath& out) {
+    const std::size_t eager_calls = *n_calls;
+    *n_calls = 0;
+    const bool found = graph.getShortestPathLazy(points, cost, out, lower_bound);
+    EXPECT_EQ(0u, graph.graph().size());
+    EXPECT_LT(*n_calls, eager_calls);
+    return found;
+  };
+
+  expectMatchesInMemory(points, counted_fn, {{"lazy", lazy}}, 1e-9);
+}
+
+TEST(PlanningGraph, lazy_matches_eager)
+{
+  // Never cheaper than the L1 distance, so the default bound holds
+  auto l1_plus_squared = [](const double* a, const double* b) {
+    double cost = 0.0;
+    for (int i = 0; i < 6; ++i) cost += std::abs(a[i] - b[i]) + (a[i] - b[i]) * (a[i] - b[i]);
+    return cost;
+  };
+  expectLazyMatchesEager(makeAxialPoints(60, 0.0), l1_plus_squared);
+  expectLazyMatchesEager(makeAxialPoints(60, 1.5), l1_plus_squared);
+
+  // Can be cheaper than the L1 distance, so it needs a bound of its own
+  auto max_squared = [](const double* a, const double* b) {
+    double cost = 0.0;
+    for (int i = 0; i < 6; ++i) cost = std::max(cost, (a[i] - b[i]) * (a[i] - b[i]));
+    return cost;
+  };
+  expectLazyMatchesEager(makeAxialPoints(60, 0.0), squaredCost(), max_squared);
+}
+
+TEST(PlanningGraph, lazy_fails_without_path)
+{
+  auto robot = makeTestRobot();
+  auto points = threePoints();
+  points.insert(points.begin() + 1, makePoint(4.0, 1.0));
+
+  descartes_planner::PlanningGraph graph {robot};
+  double cost;
+  std::list<descartes_trajectory::JointTrajectoryPt> out;
+  EXPECT_FALSE(graph.getShortestPathLazy(points, cost, out));
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(PlanningGraph, streaming_fails_without_path)
+{
+  auto robot = makeTestRobot();
+  auto points = threePoints();
+
+  // The middle point is out of reach of its neighbours in the allowed time
+  auto far_pt = makePoint(4.0, 1.0);
+  points.insert(points.begin() + 1, far_pt);
+
+  descartes_planner::PlanningGraph graph {robot};
+  double cost;
+  std::list<descartes_trajectory::JointTrajectoryPt> out;
+  EXPECT_FALSE(graph.getShortestPathStreaming(points, 2, cost, out));
+  EXPECT_TRUE(out.empty());
+}
@@ -281,6 +281,9 @@ public:
   // TODO complete
   virtual void getJointPoses(const descartes_core::RobotModel &model,
                              std::vector<std::vector<double> > &joint_poses) const;
+
+  /** @brief Solves all of the sampled Cartesian poses with one batched RobotModel::getAllIK() call */
+  virtual void getJointPoses(const descartes_core::RobotModel &model, std::vector<double> &joint_data) const;
   /** @} (end section) */
 
   // TODO complete
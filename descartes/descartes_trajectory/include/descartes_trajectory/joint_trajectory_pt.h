@@ -131,6 +131,7 @@ public:
   // TODO complete
   virtual void getJointPoses(const descartes_core::RobotModel &model,
                              std::vector<std::vector<double> > &joint_poses) const;
+  using descartes_core::TrajectoryPt::getJointPoses;
   /** @} (end section) */
 
   // TODO complete
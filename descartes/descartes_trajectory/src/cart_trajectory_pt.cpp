@@ -402,6 +402,32 @@ void CartTrajectoryPt::getJointPoses(const RobotModel &model, std::vector<std::v
   }
 }
 
+void CartTrajectoryPt::getJointPoses(const RobotModel &model, std::vector<double> &joint_data) const
+{
+  joint_data.clear();
+
+  EigenSTL::vector_Affine3d poses;
+  std::vector<std::size_t> offsets;
+  if (computeCartesianPoses(poses))
+  {
+    model.getAllIK(poses, joint_data, offsets);
+  }
+  else
+  {
+    ROS_ERROR("Failed for find ANY cartesian poses");
+  }
+
+  if (joint_data.empty())
+  {
+    ROS_WARN("Failed for find ANY joint poses, returning");
+  }
+  else
+  {
+    ROS_DEBUG_STREAM("Get joint poses, sampled: " << poses.size() << ", with " << offsets.back()
+                                                  << " valid(returned) poses");
+  }
+}
+
 bool CartTrajectoryPt::isValid(const RobotModel &model) const
 {
   Eigen::Affine3d robot_pose = wobj_base_.frame * wobj_pt_.frame * tool_pt_.frame_inv * tool_base_.frame_inv;
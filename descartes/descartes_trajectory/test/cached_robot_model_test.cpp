@@ -0,0 +1,165 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descartes_core/cached_robot_model.h"
+#include "descartes_trajectory_test/cartesian_robot.h"
+
+#include <boost/make_shared.hpp>
+#include <cstdio>
+#include <gtest/gtest.h>
+
+using descartes_core::CachedRobotModel;
+using descartes_core::utils::toFrame;
+
+namespace
+{
+
+// Counts the IK requests that reach the underlying model
+class CountingRobot : public descartes_trajectory_test::CartesianRobot
+{
+public:
+  virtual bool getAllIK(const Eigen::Affine3d &pose, std::vector<std::vector<double> > &joint_poses) const
+  {
+    ++calls;
+    return CartesianRobot::getAllIK(pose, joint_poses);
+  }
+
+  mutable int calls = 0;
+};
+
+struct CachedRobotModelTest : public ::testing::Test
+{
+  CachedRobotModelTest()
+    : robot(new CountingRobot())
+    , cache(robot, 3)
+  {
+    cache.setFrames("world", "tool0");
+  }
+
+  boost::shared_ptr<CountingRobot> robot;
+  CachedRobotModel cache;
+};
+
+} // anon namespace
+
+TEST_F(CachedRobotModelTest, repeatedPosesHitTheCache)
+{
+  const Eigen::Affine3d pose = toFrame(0.1, 0.2, 0.3, 0.1, 0.0, 0.2);
+  std::vector<std::vector<double> > expected, sols;
+  ASSERT_TRUE(robot->CartesianRobot::getAllIK(pose, expected));
+
+  EXPECT_TRUE(cache.getAllIK(pose, sols));
+  EXPECT_EQ(expected, sols);
+  EXPECT_TRUE(cache.getAllIK(pose, sols));
+  EXPECT_EQ(expected, sols);
+
+  // Within the quantization resolution of the first pose
+  const Eigen::Affine3d nearby = toFrame(0.1 + 1e-7, 0.2, 0.3, 0.1, 0.0, 0.2 + 1e-7);
+  EXPECT_TRUE(cache.getAllIK(nearby, sols));
+  EXPECT_EQ(expected, sols);
+
+  EXPECT_EQ(1, robot->calls);
+  EXPECT_EQ(2u, cache.hits());
+  EXPECT_EQ(1u, cache.misses());
+  EXPECT_EQ(1u, cache.size());
+}
+
+TEST_F(CachedRobotModelTest, failuresAreCached)
+{
+  const Eigen::Affine3d unreachable = toFrame(100.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  std::vector<std::vector<double> > sols;
+
+  EXPECT_FALSE(cache.getAllIK(unreachable, sols));
+  EXPECT_FALSE(cache.getAllIK(unreachable, sols));
+  EXPECT_EQ(1, robot->calls);
+}
+
+TEST_F(CachedRobotModelTest, framesAndCollisionsArePartOfTheKey)
+{
+  const Eigen::Affine3d pose = toFrame(0.1, 0.2, 0.3, 0.0, 0.0, 0.0);
+  std::vector<std::vector<double> > sols;
+
+  cache.getAllIK(pose, sols);
+  cache.setFrames("world", "other_tool");
+  cache.getAllIK(pose, sols);
+  cache.setCheckCollisions(true);
+  EXPECT_TRUE(robot->getCheckCollisions());
+  cache.getAllIK(pose, sols);
+  EXPECT_EQ(3, robot->calls);
+
+  cache.setCheckCollisions(false);
+  cache.setFrames("world", "tool0");
+  cache.getAllIK(pose, sols);
+  EXPECT_EQ(3, robot->calls);
+}
+
+TEST_F(CachedRobotModelTest, leastRecentlyUsedIsEvicted)
+{
+  std::vector<std::vector<double> > sols;
+  const Eigen::Affine3d a = toFrame(0.1, 0.0, 0.0, 0.0, 0.0, 0.0);
+  const Eigen::Affine3d b = toFrame(0.2, 0.0, 0.0, 0.0, 0.0, 0.0);
+  const Eigen::Affine3d c = toFrame(0.3, 0.0, 0.0, 0.0, 0.0, 0.0);
+  const Eigen::Affine3d d = toFrame(0.4, 0.0, 0.0, 0.0, 0.0, 0.0);
+
+  cache.getAllIK(a, sols);
+  cache.getAllIK(b, sols);
+  cache.getAllIK(c, sols);
+  cache.getAllIK(a, sols); // 'b' is now the least recently used
+  cache.getAllIK(d, sols);
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(4, robot->calls);
+
+  cache.getAllIK(a, sols);
+  cache.getAllIK(c, sols);
+  cache.getAllIK(d, sols);
+  EXPECT_EQ(4, robot->calls);
+
+  cache.getAllIK(b, sols);
+  EXPECT_EQ(5, robot->calls);
+}
+
+TEST_F(CachedRobotModelTest, snapshotRoundTrip)
+{
+  const std::string path = "cached_robot_model_test.snapshot";
+  std::vector<std::vector<double> > expected, sols;
+  const Eigen::Affine3d pose = toFrame(0.1, 0.2, 0.3, 0.1, 0.2, 0.3);
+  const Eigen::Affine3d unreachable = toFrame(100.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+
+  cache.getAllIK(pose, expected);
+  cache.getAllIK(unreachable, sols);
+  ASSERT_TRUE(cache.save(path));
+
+  auto other_robot = boost::make_shared<CountingRobot>();
+  CachedRobotModel restored (other_robot);
+  restored.setFrames("world", "tool0");
+  ASSERT_TRUE(restored.load(path));
+  EXPECT_EQ(2u, restored.size());
+
+  EXPECT_TRUE(restored.getAllIK(pose, sols));
+  EXPECT_EQ(expected, sols);
+  EXPECT_FALSE(restored.getAllIK(unreachable, sols));
+  EXPECT_EQ(0, other_robot->calls);
+
+  // Snapshots are only valid for the resolution they were saved with
+  CachedRobotModel coarse (other_robot);
+  coarse.setResolution(1e-3, 1e-3);
+  EXPECT_FALSE(coarse.load(path));
+  EXPECT_EQ(0u, coarse.size());
+
+  std::remove(path.c_str());
+}
@@ -108,6 +108,31 @@ TEST(CartTrajPt, getPoses)
   //  EXPECT_EQ(solutions.size(), LIMIT_SAMPLED_BOTH);
 }
 
+TEST(CartTrajPt, flatJointPoses)
+{
+  CartTrajectoryPt fuzzy(
+      TolerancedFrame(utils::toFrame(0, 0, 0, 0, 0, 0),
+                      ToleranceBase::createSymmetric<PositionTolerance>(0.0, 0.0, 0.0, 1.0),
+                      ToleranceBase::createSymmetric<OrientationTolerance>(0.0, 0.0, 0.0, M_PI)),
+      0.5, M_PI / 2);
+
+  // The workspace only takes in part of the sampled poses
+  CartesianRobot robot(0.6, M_PI);
+  std::vector<std::vector<double> > joint_solutions;
+  fuzzy.getJointPoses(robot, joint_solutions);
+  ASSERT_FALSE(joint_solutions.empty());
+
+  // The batched IK call must give the same solutions, in the same order, laid out back to back
+  std::vector<double> joint_data(3, -1.0);
+  fuzzy.getJointPoses(robot, joint_data);
+  ASSERT_EQ(joint_solutions.size() * robot.getDOF(), joint_data.size());
+  for (std::size_t i = 0; i < joint_solutions.size(); ++i)
+  {
+    const auto row = joint_data.begin() + i * robot.getDOF();
+    EXPECT_EQ(joint_solutions[i], std::vector<double>(row, row + robot.getDOF()));
+  }
+}
+
 TEST(CartTrajPt, zeroTolerance)
 {
   ROS_INFO_STREAM("Initializing zero tolerance cartesian point");
@@ -112,7 +112,40 @@ TYPED_TEST_P(RobotModelTest, getAllIK)
   }
 }
 
-REGISTER_TYPED_TEST_CASE_P(RobotModelTest, construction, getIK, getAllIK);
+TYPED_TEST_P(RobotModelTest, getAllIKBatched)
+{
+  ROS_INFO_STREAM("Testing batched getAllIK");
+  EigenSTL::vector_Affine3d poses;
+  for (double joint : { 0.0, 0.25, 0.5 })
+  {
+    Eigen::Affine3d pose;
+    EXPECT_TRUE(this->model_->getFK(std::vector<double>(6, joint), pose));
+    poses.push_back(pose);
+  }
+
+  std::vector<double> joint_data;
+  std::vector<std::size_t> offsets;
+  EXPECT_TRUE(this->model_->getAllIK(poses, joint_data, offsets));
+  ASSERT_EQ(poses.size() + 1, offsets.size());
+  EXPECT_EQ(offsets.back() * this->model_->getDOF(), joint_data.size());
+
+  // Numerical IK need not land on the same solutions as a single pose call, so check that every solution in
+  // a pose's slice reaches that pose
+  const std::size_t dof = this->model_->getDOF();
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    EXPECT_LT(offsets[i], offsets[i + 1]);
+    for (std::size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+    {
+      const double* row = joint_data.data() + j * dof;
+      Eigen::Affine3d fk_pose;
+      EXPECT_TRUE(this->model_->getFK(std::vector<double>(row, row + dof), fk_pose));
+      EXPECT_TRUE(poses[i].matrix().isApprox(fk_pose.matrix(), TF_EQ_TOL));
+    }
+  }
+}
+
+REGISTER_TYPED_TEST_CASE_P(RobotModelTest, construction, getIK, getAllIK, getAllIKBatched);
 
 }  // descartes_trajectory_test
 
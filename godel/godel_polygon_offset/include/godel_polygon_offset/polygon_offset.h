@@ -31,7 +31,7 @@
 #include <limits>
 #include <boost/shared_ptr.hpp>
 #include <openvoronoi/voronoidiagram.hpp>
-#include <openvoronoi/offset_sorter.hpp>
+#include <openvoronoi/offset.hpp>
 #include "godel_process_path_generation/polygon_pts.hpp"
 
 using godel_process_path::PolygonBoundaryCollection;
@@ -28,7 +28,6 @@
 #include <ros/ros.h>
 #include <openvoronoi/offset.hpp>
 #include <openvoronoi/polygon_interior_filter.hpp>
-#include <boost/tuple/tuple.hpp>
 #include <boost/foreach.hpp>
 #include <boost/next_prior.hpp>
 #include <godel_process_path_generation/utils.h>
@@ -37,11 +36,98 @@
 using godel_process_path::PolygonBoundaryCollection;
 using godel_process_path::PolygonBoundary;
 using godel_process_path::PolygonPt;
-using godel_process_path::utils::exists;
-using godel_process_path::utils::getFirstChild;
-using godel_process_path::utils::moveItemFrom;
 
-typedef std::vector<ovd::MGVertex> MachiningLoopList;
+namespace
+{
+
+/**@brief Identifies an offset loop: index of its offset level, and index of the loop within that level */
+typedef std::pair<size_t, size_t> LoopId;
+
+typedef std::list<ovd::OffsetVertex>::const_iterator VertexIter;
+
+/**@brief Orders offset loops for machining: start at the deepest remaining loop and work outwards
+ * through the loops enclosing it, then hop to the next deepest remaining loop.
+ * The loops form a tree in which the parent of a loop is the loop one level further out that passes
+ * through the same voronoi face. As every face of the filtered diagram reaches down to its site, a face
+ * crossed at one offset distance is crossed at every smaller one, so each loop finds its parent among
+ * the faces recorded for the previous level. This takes time linear in the number of offset vertices.
+ * @param levels Offset loops of each level, by increasing offset distance.
+ * @param n_faces Number of faces in the voronoi diagram the loops were produced from.
+ * @return Loops in machining order.
+ */
+std::vector<LoopId> orderLoops(const std::vector<ovd::OffsetLoops>& levels, size_t n_faces)
+{
+  const size_t NO_LOOP = std::numeric_limits<size_t>::max();
+
+  // For each face, the latest level that crossed it (plus one; zero if none yet) and the first loop
+  // of that level to do so
+  std::vector<size_t> face_level(n_faces, 0);
+  std::vector<size_t> face_loop(n_faces, NO_LOOP);
+
+  std::vector<std::vector<size_t> > parents(levels.size());
+  for (size_t level = 0; level < levels.size(); ++level)
+  {
+    const ovd::OffsetLoops& loops = levels[level];
+    parents[level].assign(loops.size(), NO_LOOP);
+
+    // Find parents before recording this level, in case two of its loops share a face
+    for (size_t i = 0; i < loops.size() && level > 0; ++i)
+    {
+      // The first vertex only holds the start point of the loop
+      for (VertexIter vtx = boost::next(loops[i].vertices.begin()); vtx != loops[i].vertices.end(); ++vtx)
+      {
+        if (face_level[vtx->f] == level)
+        {
+          parents[level][i] = face_loop[vtx->f];
+          break;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < loops.size(); ++i)
+    {
+      for (VertexIter vtx = boost::next(loops[i].vertices.begin()); vtx != loops[i].vertices.end(); ++vtx)
+      {
+        if (face_level[vtx->f] != level + 1)
+        {
+          face_level[vtx->f] = level + 1;
+          face_loop[vtx->f] = i;
+        }
+      }
+    }
+  }
+
+  // Deepest loops first; a loop and the chain of its unordered ancestors are taken together
+  std::vector<LoopId> ordered;
+  std::vector<std::vector<bool> > done(levels.size());
+  for (size_t level = 0; level < levels.size(); ++level)
+  {
+    done[level].assign(levels[level].size(), false);
+  }
+
+  for (size_t level = levels.size(); level-- > 0;)
+  {
+    for (size_t i = 0; i < levels[level].size(); ++i)
+    {
+      size_t l = level, loop = i;
+      while (loop != NO_LOOP && !done[l][loop])
+      {
+        done[l][loop] = true;
+        ordered.push_back(LoopId(l, loop));
+        if (l == 0)
+        {
+          break;
+        }
+        loop = parents[l][loop];
+        --l;
+      }
+    }
+  }
+
+  return ordered;
+}
+
+} // anon namespace
 
 namespace godel_polygon_offset
 {
@@ -62,34 +148,38 @@ bool PolygonOffset::init(const PolygonBoundaryCollection& pbc, double _offset,
   discretization_ = _discretization;
   ROS_INFO_COND(verbose_, "Creating voroni diagram from polygons");
 
-  // Add all points to vd.
-  std::vector<std::vector<int> > pt_id_collection;
+  // Add all points to vd in one batch, which inserts them in a spatially coherent order.
+  std::vector<ovd::Point> points;
   PolygonBoundaryCollection::const_iterator boundary, bs_end;
   for (boundary = pbc.begin(), bs_end = pbc.end(); boundary != bs_end; ++boundary)
   {
-    std::vector<int> pt_id;
-    bool first = true;
     for (PolygonBoundary::const_iterator pt = boundary->begin(), b_end = boundary->end();
          pt != b_end; ++pt)
     {
-      pt_id.push_back(vd_->insert_point_site(ovd::Point(pt->x, pt->y)));
-      ROS_INFO_COND(verbose_, "Added point %i at location %f, %f", pt_id.back(), pt->x, pt->y);
+      points.push_back(ovd::Point(pt->x, pt->y));
     }
-    pt_id_collection.push_back(pt_id);
   }
+  const std::vector<int> pt_ids = vd_->insert_point_sites(points);
 
   // Connect points into boundaries.
+  std::vector<std::pair<int, int> > segments;
+  segments.reserve(pt_ids.size());
+  std::vector<int>::const_iterator first_id = pt_ids.begin();
   for (boundary = pbc.begin(); boundary != bs_end; ++boundary)
   {
-    std::vector<int>& pt_id = pt_id_collection.at(boundary - pbc.begin());
-    for (size_t ii = 0; ii < pt_id.size() - 1; ++ii)
+    std::vector<int>::const_iterator last_id = first_id + boundary->size();
+    for (std::vector<int>::const_iterator id = first_id; id != last_id; ++id)
     {
-      ROS_INFO_COND(verbose_, "Adding line from pt %i to pt %i", pt_id.at(ii), pt_id.at(ii + 1));
-      vd_->insert_line_site(pt_id.at(ii), pt_id.at(ii + 1));
+      ROS_INFO_COND(verbose_, "Added point %i at location %f, %f", *id, points[id - pt_ids.begin()].x,
+                    points[id - pt_ids.begin()].y);
+      // The last point closes the loop
+      const int next_id = (id + 1 == last_id) ? *first_id : *(id + 1);
+      ROS_INFO_COND(verbose_, "Adding line from pt %i to pt %i", *id, next_id);
+      segments.push_back(std::make_pair(*id, next_id));
     }
-    ROS_INFO_COND(verbose_, "Closing loop from pt %i to pt %i", pt_id.back(), pt_id.front());
-    vd_->insert_line_site(pt_id.back(), pt_id.front());
+    first_id = last_id;
   }
+  vd_->insert_line_sites(segments);
 
   // Check vd for validity, filter interior points.
   if (!vd_->check())
@@ -120,29 +210,15 @@ bool PolygonOffset::generateOrderedOffsets(PolygonBoundaryCollection& polygons,
 
   ovd::HEGraph& g = vd_->get_graph_reference();
   ovd::Offset offsetter(g);
-  ovd::OffsetSorter sorter(g);
 
   /* Perform offsets:
    * Start with initial_offset, and proceed with offset distance until no further offsets are
-   * generated.
-   * Add each offset to sorter for subsequent sorting. */
-  double offset_distance(initial_offset_);
+   * generated. All offset distances are produced in a single pass over the voronoi diagram. */
+  std::vector<ovd::OffsetLoops> levels = offsetter.offsets(initial_offset_, offset_);
   size_t loop_count(0);
-  while (true)
+  BOOST_FOREACH (const ovd::OffsetLoops& level, levels)
   {
-    ROS_INFO_COND(verbose_, "Creating offset with distance %f", offset_distance);
-    ovd::OffsetLoops offset_list = offsetter.offset(offset_distance);
-    if (offset_list.size() == 0)
-    {
-      break;
-    }
-    loop_count += offset_list.size();
-    for (ovd::OffsetLoops::const_iterator loop = offset_list.begin(), loops_end = offset_list.end();
-         loop != loops_end; ++loop)
-    {
-      sorter.add_loop(*loop);
-    }
-    offset_distance += offset_;
+    loop_count += level.size();
   }
   if (loop_count == 0)
   {
@@ -151,68 +227,20 @@ bool PolygonOffset::generateOrderedOffsets(PolygonBoundaryCollection& polygons,
                                                   << " (m)");
     return false;
   }
-  ROS_INFO_COND(verbose_, "Created %li offset loops", loop_count);
-
-  // Perform initial sort.
-  sorter.sort_loops();
-  const ovd::MachiningGraph& mg = sorter.getMachiningGraph();
-
-  MachiningLoopList ordered_loops, unordered_loops; // For tracking order of loops for machining
-
-  // Populate unordered loops with all graph vertices
-  ovd::MGVertexItr loop, vertex_end;
-  for (boost::tie(loop, vertex_end) = boost::vertices(mg); loop != vertex_end; ++loop)
-  {
-    unordered_loops.push_back(*loop);
-  }
+  ROS_INFO_COND(verbose_, "Created %li offset loops at %li offset distances", loop_count, levels.size());
 
-  /* Sort unordered loops into ordered loops:
-   *  Move deepest loop in unordered to ordered
-   *  Move each parent from unordered to ordered until no more parents
-   *  Repeat (find deepest loop...)
-   */
-  while (unordered_loops.size() != 0)
-  {
-    // Find deepest loop
-    double largest_offset(0);
-    ovd::MGVertex deepest_loop;
-    BOOST_FOREACH (ovd::MGVertex loop_descriptor, unordered_loops)
-    {
-      if (mg[loop_descriptor].offset_distance > largest_offset)
-      {
-        largest_offset = mg[loop_descriptor].offset_distance;
-        deepest_loop = loop_descriptor;
-      }
-    }
-    ROS_INFO_COND(verbose_, "Moving loop at depth %f to ordered list.", largest_offset);
-    moveItemFrom(unordered_loops, ordered_loops, deepest_loop);
-
-    // Find child of deepest loop (TODO check for multiple children, should never happen!)
-    // Move child to ordered
-    ovd::MGVertex child;
-    while (getFirstChild(child, ordered_loops.back(), mg))
-    {
-      if (exists(child, unordered_loops))
-      {
-        ROS_INFO_COND(verbose_, "Moving loop at depth %f to ordered list.",
-                      mg[child].offset_distance);
-        moveItemFrom(unordered_loops, ordered_loops, child);
-      }
-      else
-      {
-        break;
-      }
-    }
-  }
+  // Sort loops into machining order
+  std::vector<LoopId> ordered_loops = orderLoops(levels, g.num_faces());
 
   // Convert ovg::OffsetLoops to polygons and discretize
   // Populate polygons and offsets
   polygons.clear();
   offsets.clear();
-  BOOST_FOREACH (ovd::MGVertex loop_descriptor, ordered_loops)
+  BOOST_FOREACH (const LoopId& loop_id, ordered_loops)
   {
     PolygonBoundary polygon;
-    const ovd::OffsetLoop& loop = mg[loop_descriptor];
+    const ovd::OffsetLoop& loop = levels[loop_id.first][loop_id.second];
+    ROS_INFO_COND(verbose_, "Adding loop at depth %f to ordered list.", loop.offset_distance);
     ovd::OffsetVertex prior_vtx = loop.vertices.front();
     std::list<ovd::OffsetVertex>::const_iterator vtx = boost::next(loop.vertices.begin());
     while (vtx != loop.vertices.end())
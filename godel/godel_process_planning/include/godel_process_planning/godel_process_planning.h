@@ -5,6 +5,7 @@
 #include "godel_msgs/KeyenceProcessPlanning.h"
 
 #include <descartes_core/robot_model.h>
+#include <descartes_core/cached_robot_model.h>
 #include <pluginlib/class_loader.h>
 
 /*
@@ -29,7 +30,12 @@ class ProcessPlanningManager
 public:
   ProcessPlanningManager(const std::string& world_frame, const std::string& blend_group,
                          const std::string& blend_tcp, const std::string& keyence_group,
-                         const std::string& keyence_tcp, const std::string& robot_model_plugin);
+                         const std::string& keyence_tcp, const std::string& robot_model_plugin,
+                         const std::string& ik_cache_dir = std::string(),
+                         bool parallel_blend_planning = false, std::size_t planning_window_size = 0);
+
+  // Saves the IK caches if 'ik_cache_dir' was given
+  ~ProcessPlanningManager();
 
   bool handleBlendPlanning(godel_msgs::BlendProcessPlanning::Request& req,
                            godel_msgs::BlendProcessPlanning::Response& res);
@@ -38,13 +44,19 @@ public:
                              godel_msgs::KeyenceProcessPlanning::Response& res);
 
 private:
-  descartes_core::RobotModelPtr blend_model_;
-  descartes_core::RobotModelPtr keyence_model_;
+  // Each robot model remembers its IK results so that replanning the same part is cheap
+  descartes_core::CachedRobotModelPtr blend_model_;
+  descartes_core::CachedRobotModelPtr keyence_model_;
   moveit::core::RobotModelConstPtr moveit_model_;
   pluginlib::ClassLoader<descartes_core::RobotModel>
       plugin_loader_; // kept around so code doesn't get unloaded
   std::string blend_group_name_;
   std::string keyence_group_name_;
+  std::string ik_cache_dir_;
+  // Plan the segments of blend paths concurrently instead of searching the whole path as one graph
+  bool parallel_blend_planning_;
+  // If not 0, process paths are searched this many points at a time instead of as one graph
+  std::size_t planning_window_size_;
 };
 }
 
@@ -50,9 +50,6 @@ descartes_core::TrajectoryPtPtr toDescartesBlendPt(const Eigen::Affine3d& pose,
 bool ProcessPlanningManager::handleBlendPlanning(godel_msgs::BlendProcessPlanning::Request& req,
                                                  godel_msgs::BlendProcessPlanning::Response& res)
 {
-  // Enable Collision Checks
-  blend_model_->setCheckCollisions(true);
-
   // Precondition: There must be at least one input segments
   if (req.path.segments.empty())
   {
@@ -84,11 +81,26 @@ bool ProcessPlanningManager::handleBlendPlanning(godel_msgs::BlendProcessPlannin
   transition_params.traverse_height = req.params.safe_traverse_height;
   transition_params.z_adjust = req.params.z_adjust;
 
-  DescartesTraj process_points = toDescartesTraj(req.path.segments, req.params.traverse_spd, transition_params,
-                                                 toDescartesBlendPt);
+  bool planned;
+  if (parallel_blend_planning_)
+  {
+    // Each segment, with the transitions that follow it, gets its own planning graph
+    std::vector<DescartesTraj> segments = toDescartesTrajSegments(req.path.segments, req.params.traverse_spd,
+                                                                  transition_params, toDescartesBlendPt);
+    planned = generateMotionPlan(blend_model_, segments, moveit_model_, blend_group_name_, current_joints,
+                                 res.plan);
+  }
+  else
+  {
+    DescartesTraj process_points = toDescartesTraj(req.path.segments, req.params.traverse_spd, transition_params,
+                                                   toDescartesBlendPt);
+    planned = generateMotionPlan(blend_model_, process_points, moveit_model_, blend_group_name_, current_joints,
+                                 res.plan, planning_window_size_);
+  }
+  ROS_INFO("Blend planning IK cache: %lu hits, %lu misses, %lu entries", blend_model_->hits(),
+           blend_model_->misses(), blend_model_->size());
 
-  if (generateMotionPlan(blend_model_, process_points, moveit_model_, blend_group_name_,
-                         current_joints, res.plan))
+  if (planned)
   {
     res.plan.type = res.plan.BLEND_TYPE;
     return true;
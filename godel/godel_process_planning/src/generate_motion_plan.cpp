@@ -4,6 +4,7 @@
 #include <descartes_trajectory/axial_symmetric_pt.h>
 #include <descartes_trajectory/joint_trajectory_pt.h>
 
+#include <descartes_planner/planning_graph.h>
 #include <descartes_planner/ladder_graph_dag_search.h>
 #include <descartes_planner/dense_planner.h>
 
@@ -37,64 +38,24 @@ const static bool validateTrajectory(const trajectory_msgs::JointTrajectory& pts
   return true;
 }
 
-bool godel_process_planning::generateMotionPlan(const descartes_core::RobotModelPtr model,
-                                                const std::vector<descartes_core::TrajectoryPtPtr> &traj,
-                                                moveit::core::RobotModelConstPtr moveit_model,
-                                                const std::string &move_group_name,
-                                                const std::vector<double> &start_state,
-                                                godel_msgs::ProcessPlan &plan)
+/**
+ * @brief Plans the approach to and departure from the process path 'path' found by Descartes and fills
+ * in 'plan' with the three trajectories.
+ */
+static bool completeMotionPlan(const descartes_core::RobotModelPtr model,
+                               std::list<descartes_trajectory::JointTrajectoryPt>& path,
+                               moveit::core::RobotModelConstPtr moveit_model,
+                               const std::string& move_group_name,
+                               const std::vector<double>& start_state,
+                               godel_msgs::ProcessPlan& plan)
 {
+  using namespace godel_process_planning;
 
-  // Generate a graph of the process path joint solutions
-  descartes_planner::PlanningGraph planning_graph (model);
-  if (!planning_graph.insertGraph(traj)) // builds the graph out
-  {
-    ROS_ERROR("%s: Failed to build graph. One or more points may have no valid IK solutions", __FUNCTION__);
-    return false;
-  }
-
-  // Using the valid starting configurations, let's compute an estimate
-  // of the cost to move to these configurations from our starting pose
-  const auto& graph = planning_graph.graph();
-  const auto dof = graph.dof();
-
-  std::vector<std::vector<double>> process_start_poses;
-  const auto& joint_data = graph.getRung(0).data; // This is a flat vector of doubles w/ all the solutions
-  const auto n_start_poses = joint_data.size() / dof;
-
-  for (std::size_t i = 0; i < n_start_poses; ++i) // This builds a list of starting poses
-  {
-    std::vector<double> sol (&joint_data[i * dof], &joint_data[i*dof + dof]);
-    process_start_poses.push_back(sol);
-  }
-
-  std::vector<double> process_start_costs (process_start_poses.size());
-  for (std::size_t i = 0; i < process_start_costs.size(); ++i) // This computes the list of configurations
-  {
-    process_start_costs[i] = freeSpaceCostFunction(start_state, process_start_poses[i]);
-  }
-
-  // Now we perform the search using the starting costs from our estimation above
-  descartes_planner::DAGSearch search (graph);
-  double cost = search.run(process_start_costs);
-  if (cost == std::numeric_limits<double>::max())
-  {
-    ROS_ERROR("%s: Failed to search graph. All points have IK, but process constraints (e.g velocity) "
-              "prevent a solution", __FUNCTION__);
-    return false;
-  }
-
-  // Here we search the graph for the shortest path and build a descartes trajectory of it!
-  auto path_idxs = search.shortestPath();
-  ROS_INFO("%s: Descartes computed path with cost %lf", __FUNCTION__, cost);
+  // Build a descartes trajectory of the shortest path
   DescartesTraj solution;
-  for (size_t i = 0; i < path_idxs.size(); ++i)
+  for (auto& pt : path)
   {
-    const auto idx = path_idxs[i];
-    const auto* data = graph.vertex(i, idx);
-    const auto& tm = graph.getRung(i).timing;
-    auto pt = descartes_core::TrajectoryPtPtr(new descartes_trajectory::JointTrajectoryPt(std::vector<double>(data, data + dof), tm));
-    solution.push_back(pt);
+    solution.push_back(descartes_core::TrajectoryPtPtr(new descartes_trajectory::JointTrajectoryPt(std::move(pt))));
   }
 
   // Now we plan our approach and depart to/from the path. We try to joint interpolate, and then we run from there
@@ -140,3 +101,100 @@ bool godel_process_planning::generateMotionPlan(const descartes_core::RobotModel
     return false;
   }
 }
+
+bool godel_process_planning::generateMotionPlan(const descartes_core::RobotModelPtr model,
+                                                const std::vector<descartes_core::TrajectoryPtPtr> &traj,
+                                                moveit::core::RobotModelConstPtr moveit_model,
+                                                const std::string &move_group_name,
+                                                const std::vector<double> &start_state,
+                                                godel_msgs::ProcessPlan &plan,
+                                                std::size_t window_size)
+{
+  descartes_planner::PlanningGraph planning_graph (model);
+  const auto dof = model->getDOF();
+
+  // Estimate the cost of moving to each of the valid starting configurations from our starting pose
+  auto start_cost = [&start_state, dof](const double* pose) {
+    return freeSpaceCostFunction(start_state, std::vector<double>(pose, pose + dof));
+  };
+
+  double cost;
+  std::list<descartes_trajectory::JointTrajectoryPt> path;
+  if (window_size > 0)
+  {
+    // Search the process path joint solutions a window at a time, for paths whose complete graph would not
+    // fit in memory
+    if (!planning_graph.getShortestPathStreaming(traj, window_size, cost, path, start_cost))
+    {
+      ROS_ERROR("%s: Failed to search graph. Either one or more points have no valid IK solutions, or process "
+                "constraints (e.g velocity) prevent a solution", __FUNCTION__);
+      return false;
+    }
+  }
+  else
+  {
+    // Generate a graph of the process path joint solutions
+    if (!planning_graph.insertGraph(traj)) // builds the graph out
+    {
+      ROS_ERROR("%s: Failed to build graph. One or more points may have no valid IK solutions", __FUNCTION__);
+      return false;
+    }
+
+    // Search the graph from the valid starting configurations, weighted by their estimated cost
+    const auto& graph = planning_graph.graph();
+    std::vector<double> process_start_costs (graph.rungSize(0));
+    for (std::size_t i = 0; i < process_start_costs.size(); ++i)
+    {
+      process_start_costs[i] = start_cost(graph.vertex(0, i));
+    }
+
+    descartes_planner::DAGSearch search (graph);
+    cost = search.run(process_start_costs);
+    if (cost == std::numeric_limits<double>::max())
+    {
+      ROS_ERROR("%s: Failed to search graph. All points have IK, but process constraints (e.g velocity) "
+                "prevent a solution", __FUNCTION__);
+      return false;
+    }
+
+    // Here we search the graph for the shortest path
+    const auto path_idxs = search.shortestPath();
+    for (std::size_t i = 0; i < path_idxs.size(); ++i)
+    {
+      const auto* data = graph.vertex(i, path_idxs[i]);
+      path.push_back(descartes_trajectory::JointTrajectoryPt(std::vector<double>(data, data + dof),
+                                                             graph.getRung(i).timing));
+    }
+  }
+
+  ROS_INFO("%s: Descartes computed path with cost %lf", __FUNCTION__, cost);
+  return completeMotionPlan(model, path, moveit_model, move_group_name, start_state, plan);
+}
+
+bool godel_process_planning::generateMotionPlan(const descartes_core::RobotModelPtr model,
+                                                const std::vector<DescartesTraj>& segments,
+                                                moveit::core::RobotModelConstPtr moveit_model,
+                                                const std::string &move_group_name,
+                                                const std::vector<double> &start_state,
+                                                godel_msgs::ProcessPlan &plan)
+{
+  descartes_planner::PlanningGraph planning_graph (model);
+  const auto dof = model->getDOF();
+
+  // Estimate the cost of moving to each of the valid starting configurations from our starting pose
+  auto start_cost = [&start_state, dof](const double* pose) {
+    return freeSpaceCostFunction(start_state, std::vector<double>(pose, pose + dof));
+  };
+
+  double cost;
+  std::list<descartes_trajectory::JointTrajectoryPt> path;
+  if (!planning_graph.getShortestPathSegmented(segments, cost, path, start_cost))
+  {
+    ROS_ERROR("%s: Failed to search graph. Either one or more points have no valid IK solutions, or process "
+              "constraints (e.g velocity) prevent a solution", __FUNCTION__);
+    return false;
+  }
+
+  ROS_INFO("%s: Descartes computed path with cost %lf over %lu segments", __FUNCTION__, cost, segments.size());
+  return completeMotionPlan(model, path, moveit_model, move_group_name, start_state, plan);
+}
@@ -19,6 +19,9 @@ namespace godel_process_planning
  * @param start_state The initial position of the robot
  * @param plan Output parameter - the approach, process, and departure joint paths.
  * NOTE THAT ProcessPlan::type is NOT set.
+ * @param window_size If not 0, the process path is searched this many points at a time with
+ * PlanningGraph::getShortestPathStreaming(), so memory use does not grow with the length of the path.
+ * Otherwise the whole path's planning graph is built and searched at once.
  * @return True on planning success, false otherwise
  */
 bool generateMotionPlan(const descartes_core::RobotModelPtr model,
@@ -26,6 +29,21 @@ bool generateMotionPlan(const descartes_core::RobotModelPtr model,
                         moveit::core::RobotModelConstPtr moveit_model,
                         const std::string& move_group_name,
                         const std::vector<double>& start_state,
+                        godel_msgs::ProcessPlan& plan,
+                        std::size_t window_size = 0);
+
+/**
+ * @brief Variant of the above for a process path that is split into segments (see
+ * toDescartesTrajSegments()). The segments' planning graphs are built concurrently and searched one after
+ * the other, which gives the same plan as planning the concatenated segments but scales with the number of
+ * cores for multi-segment paths. As with the above without a window size, the whole path's graph is held in
+ * memory at once.
+ */
+bool generateMotionPlan(const descartes_core::RobotModelPtr model,
+                        const std::vector<std::vector<descartes_core::TrajectoryPtPtr> >& segments,
+                        moveit::core::RobotModelConstPtr moveit_model,
+                        const std::string& move_group_name,
+                        const std::vector<double>& start_state,
                         godel_msgs::ProcessPlan& plan);
 
 
@@ -1,36 +1,54 @@
 #include "godel_process_planning/godel_process_planning.h"
 #include <moveit/robot_model_loader/robot_model_loader.h>
 
+const static std::string BLEND_IK_CACHE_FILE = "blend_ik_cache.bin";
+const static std::string KEYENCE_IK_CACHE_FILE = "keyence_ik_cache.bin";
+
 godel_process_planning::ProcessPlanningManager::ProcessPlanningManager(
     const std::string& world_frame, const std::string& blend_group, const std::string& blend_tcp,
     const std::string& keyence_group, const std::string& keyence_tcp,
-    const std::string& robot_model_plugin)
+    const std::string& robot_model_plugin, const std::string& ik_cache_dir, bool parallel_blend_planning,
+    std::size_t planning_window_size)
     : plugin_loader_("descartes_core", "descartes_core::RobotModel"),
-      blend_group_name_(blend_group), keyence_group_name_(keyence_group)
+      blend_group_name_(blend_group), keyence_group_name_(keyence_group), ik_cache_dir_(ik_cache_dir),
+      parallel_blend_planning_(parallel_blend_planning), planning_window_size_(planning_window_size)
 {
   // Attempt to load and initialize the blending robot model
-  blend_model_ = plugin_loader_.createInstance(robot_model_plugin);
-  if (!blend_model_)
+  descartes_core::RobotModelPtr blend_model = plugin_loader_.createInstance(robot_model_plugin);
+  if (!blend_model)
   {
     throw std::runtime_error(std::string("Could not load: ") + robot_model_plugin);
   }
 
+  blend_model_.reset(new descartes_core::CachedRobotModel(blend_model));
   if (!blend_model_->initialize("robot_description", blend_group, world_frame, blend_tcp))
   {
     throw std::runtime_error("Unable to initialize blending robot model");
   }
+  // Set here rather than per request: the models must not be reconfigured while requests are served
+  // concurrently
+  blend_model_->setCheckCollisions(true);
 
   // Attempt to load and initialize the scanning/keyence robot model
-  keyence_model_ = plugin_loader_.createInstance(robot_model_plugin);
-  if (!keyence_model_)
+  descartes_core::RobotModelPtr keyence_model = plugin_loader_.createInstance(robot_model_plugin);
+  if (!keyence_model)
   {
     throw std::runtime_error(std::string("Could not load: ") + robot_model_plugin);
   }
 
+  keyence_model_.reset(new descartes_core::CachedRobotModel(keyence_model));
   if (!keyence_model_->initialize("robot_description", keyence_group, world_frame, keyence_tcp))
   {
     throw std::runtime_error("Unable to initialize scanning robot model");
   }
+  keyence_model_->setCheckCollisions(true);
+
+  // Restore IK results from previous runs; a missing file just means an empty cache
+  if (!ik_cache_dir_.empty())
+  {
+    blend_model_->load(ik_cache_dir_ + "/" + BLEND_IK_CACHE_FILE);
+    keyence_model_->load(ik_cache_dir_ + "/" + KEYENCE_IK_CACHE_FILE);
+  }
 
   // Load the moveit model
   robot_model_loader::RobotModelLoader robot_model_loader("robot_description");
@@ -41,3 +59,12 @@ godel_process_planning::ProcessPlanningManager::ProcessPlanningManager(
     throw std::runtime_error("Could not load moveit robot model");
   }
 }
+
+godel_process_planning::ProcessPlanningManager::~ProcessPlanningManager()
+{
+  if (!ik_cache_dir_.empty())
+  {
+    blend_model_->save(ik_cache_dir_ + "/" + BLEND_IK_CACHE_FILE);
+    keyence_model_->save(ik_cache_dir_ + "/" + KEYENCE_IK_CACHE_FILE);
+  }
+}
@@ -1,4 +1,5 @@
 #include <ros/ros.h>
+#include <algorithm>
 // Process Services
 #include <godel_process_planning/godel_process_planning.h>
 
@@ -12,13 +13,23 @@ int main(int argc, char** argv)
 
   // Load local parameters
   ros::NodeHandle nh, pnh("~");
-  std::string world_frame, blend_group, keyence_group, blend_tcp, keyence_tcp, robot_model_plugin;
+  std::string world_frame, blend_group, keyence_group, blend_tcp, keyence_tcp, robot_model_plugin, ik_cache_dir;
   pnh.param<std::string>("world_frame", world_frame, "world_frame");
   pnh.param<std::string>("blend_group", blend_group, "manipulator_tcp");
   pnh.param<std::string>("keyence_group", keyence_group, "manipulator_keyence");
   pnh.param<std::string>("blend_tcp", blend_tcp, "tcp_frame");
   pnh.param<std::string>("keyence_tcp", keyence_tcp, "keyence_tcp_frame");
   pnh.param<std::string>("robot_model_plugin", robot_model_plugin, "");
+  pnh.param<std::string>("ik_cache_dir", ik_cache_dir, "");
+  bool parallel_blend_planning;
+  pnh.param<bool>("parallel_blend_planning", parallel_blend_planning, false);
+  // Search process paths this many points at a time; 0 builds the whole path's planning graph
+  int planning_window_size;
+  pnh.param<int>("planning_window_size", planning_window_size, 0);
+  // Requests are served concurrently on this many threads; 0 uses every core. Concurrent requests share the
+  // robot models, so only raise this for robot model plugins whose queries are safe to run concurrently
+  int planning_threads;
+  pnh.param<int>("planning_threads", planning_threads, 1);
 
   // IK Plugin parameter must be specified
   if (robot_model_plugin.empty())
@@ -33,7 +44,8 @@ int main(int argc, char** argv)
   // all required initialization. It exposes member functions to handle each kind of processing
   // event.
   ProcessPlanningManager manager(world_frame, blend_group, blend_tcp, keyence_group, keyence_tcp,
-                                 robot_model_plugin);
+                                 robot_model_plugin, ik_cache_dir, parallel_blend_planning,
+                                 std::max(planning_window_size, 0));
   // Plumb in the appropriate ros services
   ros::ServiceServer blend_server = nh.advertiseService(
       DEFAULT_BLEND_PLANNING_SERVICE, &ProcessPlanningManager::handleBlendPlanning, &manager);
@@ -42,7 +54,8 @@ int main(int argc, char** argv)
 
   // Serve and wait for shutdown
   ROS_INFO_STREAM("Godel Process Planning Server Online");
-  ros::spin();
+  ros::MultiThreadedSpinner spinner(std::max(planning_threads, 0));
+  spinner.spin();
 
   return 0;
 }
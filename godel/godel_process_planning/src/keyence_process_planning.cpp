@@ -54,7 +54,6 @@ descartes_core::TrajectoryPtPtr toDescartesScanPt(const Eigen::Affine3d& pose, d
 bool ProcessPlanningManager::handleKeyencePlanning(godel_msgs::KeyenceProcessPlanning::Request& req,
                                                    godel_msgs::KeyenceProcessPlanning::Response& res)
 {
-  keyence_model_->setCheckCollisions(true);
   // Precondition: Input trajectory must be non-zero
   if (req.path.segments.empty())
   {
@@ -85,8 +84,12 @@ bool ProcessPlanningManager::handleKeyencePlanning(godel_msgs::KeyenceProcessPla
   // Capture the current state of the robot
   std::vector<double> current_joints = getCurrentJointState(JOINT_TOPIC_NAME);
 
-  if (generateMotionPlan(keyence_model_, process_points, moveit_model_, keyence_group_name_,
-                         current_joints, res.plan))
+  const bool planned = generateMotionPlan(keyence_model_, process_points, moveit_model_, keyence_group_name_,
+                                          current_joints, res.plan, planning_window_size_);
+  ROS_INFO("Scan planning IK cache: %lu hits, %lu misses, %lu entries", keyence_model_->hits(),
+           keyence_model_->misses(), keyence_model_->size());
+
+  if (planned)
   {
     res.plan.type = res.plan.SCAN_TYPE;
     return true;
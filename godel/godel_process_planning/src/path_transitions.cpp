@@ -143,9 +143,24 @@ godel_process_planning::DescartesTraj
 godel_process_planning::toDescartesTraj(const std::vector<geometry_msgs::PoseArray> &segments,
                                         const double process_speed, const TransitionParameters& transition_params,
                                         DescartesConversionFunc conversion_fn)
+{
+  DescartesTraj traj;
+  for (auto& segment : toDescartesTrajSegments(segments, process_speed, transition_params, conversion_fn))
+  {
+    traj.insert(traj.end(), segment.begin(), segment.end());
+  }
+  return traj;
+}
+
+std::vector<godel_process_planning::DescartesTraj>
+godel_process_planning::toDescartesTrajSegments(const std::vector<geometry_msgs::PoseArray> &segments,
+                                                const double process_speed,
+                                                const TransitionParameters& transition_params,
+                                                DescartesConversionFunc conversion_fn)
 {
   auto transitions = generateTransitions(segments, transition_params);
 
+  std::vector<DescartesTraj> trajs;
   DescartesTraj traj;
   Eigen::Affine3d last_pose = createNominalTransform(segments.front().poses.front());
 
@@ -196,7 +211,13 @@ godel_process_planning::toDescartesTraj(const std::vector<geometry_msgs::PoseArr
                                              transition_params.linear_disc, transition_params.angular_disc);
       add_segment(connection, false);
     }
+
+    if (!traj.empty())
+    {
+      trajs.push_back(std::move(traj));
+      traj.clear();
+    }
   } // end segments
 
-  return traj;
+  return trajs;
 }
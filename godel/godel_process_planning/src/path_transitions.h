@@ -45,6 +45,16 @@ toDescartesTraj(const std::vector<geometry_msgs::PoseArray>& segments,
                 const double process_speed, const TransitionParameters& transition_params,
                 boost::function<descartes_core::TrajectoryPtPtr(const Eigen::Affine3d&, const double)> conversion_fn);
 
+/**
+ * @brief Same as toDescartesTraj() but keeps each segment apart: the i-th element holds the approach to
+ * segment i, the segment itself, its departure and the traverse to the next segment. Concatenating the
+ * elements gives the output of toDescartesTraj(). Segments that contribute no points are left out.
+ */
+std::vector<godel_process_planning::DescartesTraj>
+toDescartesTrajSegments(const std::vector<geometry_msgs::PoseArray>& segments,
+                        const double process_speed, const TransitionParameters& transition_params,
+                        boost::function<descartes_core::TrajectoryPtPtr(const Eigen::Affine3d&, const double)> conversion_fn);
+
 
 }
 
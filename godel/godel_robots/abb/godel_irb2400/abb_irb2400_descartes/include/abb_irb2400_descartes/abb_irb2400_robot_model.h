@@ -17,12 +17,17 @@
 #ifndef ABB_IRB2400_ROBOT_MODEL_H
 #define ABB_IRB2400_ROBOT_MODEL_H
 
-#include <descartes_moveit/moveit_state_adapter.h>
+#include <descartes_moveit/ikfast_moveit_state_adapter.h>
 #include <irb2400_ikfast_manipulator_plugin/abb_irb2400_manipulator_ikfast_moveit_plugin.hpp>
 
 namespace abb_irb2400_descartes
 {
-class AbbIrb2400RobotModel : public descartes_moveit::MoveitStateAdapter,
+/**
+ * @brief Descartes model of the IRB2400 that calls its generated IKFast solver directly. getAllIK(), including
+ *        the batched form, comes from IkFastMoveitStateAdapter; FK and seeded IK still go through the MoveIt
+ *        robot state.
+ */
+class AbbIrb2400RobotModel : public descartes_moveit::IkFastMoveitStateAdapter,
                              public irb2400_ikfast_manipulator_plugin::IKFastKinematicsPlugin
 {
 public:
@@ -31,8 +36,10 @@ public:
   virtual bool initialize(const std::string& robot_description, const std::string& group_name,
                           const std::string& world_frame, const std::string& tcp_frame);
 
-  virtual bool getAllIK(const Eigen::Affine3d& pose,
-                        std::vector<std::vector<double> >& joint_poses) const;
+  virtual bool getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
+                     std::vector<double>& joint_pose) const;
+
+  virtual bool getFK(const std::vector<double>& joint_pose, Eigen::Affine3d& pose) const;
 
   virtual descartes_core::RobotModelPtr clone() const
   {
@@ -43,8 +50,7 @@ public:
   }
 
 protected:
-  descartes_core::Frame world_to_base_; // world to arm base
-  descartes_core::Frame tool_to_tip_;   // from urdf tool to arm tool
+  virtual std::size_t solveIK(const Eigen::Affine3d& pose, std::vector<double>& solutions) const;
 };
 }
 
@@ -15,12 +15,11 @@
 */
 
 #include <abb_irb2400_descartes/abb_irb2400_robot_model.h>
-#include <eigen_conversions/eigen_kdl.h>
+#include <descartes_moveit/ikfast_flat_solution_list.h>
 #include <pluginlib/class_list_macros.h>
 
-static const std::string MOTOMAN_SIA20D_BASE_LINK = "base_link";
-static const std::string MOTOMAN_SIA20D_TOOL_LINK = "tool0";
-static const double JOINT_LIMIT_TOLERANCE = .0000001f;
+static const std::string IKFAST_BASE_LINK = "base_link";
+static const std::string IKFAST_TOOL_LINK = "tool0";
 
 using namespace descartes_moveit;
 using namespace irb2400_ikfast_manipulator_plugin;
@@ -28,7 +27,6 @@ using namespace irb2400_ikfast_manipulator_plugin;
 namespace abb_irb2400_descartes
 {
 AbbIrb2400RobotModel::AbbIrb2400RobotModel()
-    : world_to_base_(Eigen::Affine3d::Identity()), tool_to_tip_(Eigen::Affine3d::Identity())
 {
 }
 
@@ -36,67 +34,41 @@ bool AbbIrb2400RobotModel::initialize(const std::string& robot_description,
                                       const std::string& group_name, const std::string& world_frame,
                                       const std::string& tcp_frame)
 {
-  MoveitStateAdapter::initialize(robot_description, group_name, world_frame, tcp_frame);
-  irb2400_ikfast_manipulator_plugin::IKFastKinematicsPlugin::initialize(
-      robot_description, group_name, MOTOMAN_SIA20D_BASE_LINK, MOTOMAN_SIA20D_TOOL_LINK, 0.001);
+  // Also computes the world to 'base_link' and tcp to 'tool0' transforms
+  if (!IkFastMoveitStateAdapter::initialize(robot_description, group_name, world_frame, tcp_frame))
+    return false;
 
-  // initialize world transformations
-  if (tcp_frame != getTipFrame())
-  {
-    tool_to_tip_ = descartes_core::Frame(robot_state_->getFrameTransform(tcp_frame).inverse() *
-                                         robot_state_->getFrameTransform(getTipFrame()));
-  }
-
-  if (world_frame != getBaseFrame())
-  {
-    world_to_base_ = descartes_core::Frame(world_to_root_.frame *
-                                           robot_state_->getFrameTransform(getBaseFrame()));
-  }
-
-  return true;
+  return irb2400_ikfast_manipulator_plugin::IKFastKinematicsPlugin::initialize(
+      robot_description, group_name, IKFAST_BASE_LINK, IKFAST_TOOL_LINK, 0.001);
 }
 
-bool AbbIrb2400RobotModel::getAllIK(const Eigen::Affine3d& pose,
-                                    std::vector<std::vector<double> >& joint_poses) const
+bool AbbIrb2400RobotModel::getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
+                           std::vector<double>& joint_pose) const
 {
-  std::vector<double> vfree(free_params_.size(), 0.0);
-  KDL::Frame frame;
-  Eigen::Affine3d tool_pose = world_to_base_.frame_inv * pose * tool_to_tip_.frame;
-  tf::transformEigenToKDL(tool_pose, frame);
-
-  ikfast::IkSolutionList<IkReal> solutions;
-
-  int numsol = solve(frame, vfree, solutions);
+  return MoveitStateAdapter::getIK(pose, seed_state, joint_pose);
+}
 
-  joint_poses.clear();
+bool AbbIrb2400RobotModel::getFK(const std::vector<double>& joint_pose, Eigen::Affine3d& pose) const
+{
+  // The group's MoveIt kinematics solver is not necessarily IKFast, so don't ask it for FK
+  return MoveitStateAdapter::getFK(joint_pose, pose);
+}
 
-  if (numsol)
+std::size_t AbbIrb2400RobotModel::solveIK(const Eigen::Affine3d& pose, std::vector<double>& solutions) const
+{
+  // The generated solver takes a translation and a row major rotation matrix
+  IkReal trans[3];
+  IkReal rot[9];
+  for (int r = 0; r < 3; ++r)
   {
-    for (int s = 0; s < numsol; ++s)
-    {
-      std::vector<double> sol;
-      getSolution(solutions, s, sol);
-
-      if (isValid(sol))
-        joint_poses.push_back(sol);
-
-      // So, IKFast returns the unique configurations of the robot (e.g. elbow up, wrist down)
-      // and the solutions have joint values between -pi and +pi. If the robot can rotate more
-      // than this, then we need to check to see if we have extra solutions that have the same
-      // configuration but a different joint position. In our case, joint 6 has this kind of
-      // extra motion, so here we check for valid solutions 360 degrees from each solution.
-      sol[5] += 2 * M_PI;
-      if (isValid(sol))
-        joint_poses.push_back(sol);
-
-      sol[5] -= 2 * 2 * M_PI;
-      if (isValid(sol))
-        joint_poses.push_back(sol);
-
-    }
+    trans[r] = pose.translation()(r);
+    for (int c = 0; c < 3; ++c)
+      rot[r * 3 + c] = pose.linear()(r, c);
   }
 
-  return !joint_poses.empty();
+  IkFastFlatSolutionList<IkReal> list(solutions, GetNumJoints());
+  ComputeIk(trans, rot, NULL, list);
+  return list.GetNumSolutions();
 }
 
 }
@@ -24,6 +24,7 @@
 #include <pcl/PolygonMesh.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <godel_msgs/SurfaceDetectionParameters.h>
+#include <detection/voxel_map.h>
 
 #include <random>
 
@@ -51,7 +52,7 @@ public:
   static void mesh_to_marker(const pcl::PolygonMesh& mesh, visualization_msgs::Marker& marker,
                              std::default_random_engine &random_engine);
 
-  // adds point cloud to the occupancy grid, it performs no frame transformation
+  // fuses the point cloud into the voxel map, it performs no frame transformation
   void add_cloud(CloudRGB& cloud);
   int get_acquired_clouds_count();
 
@@ -70,6 +71,9 @@ public:
 
   std::string getMeshingPluginName() const;
 
+  // number of threads find_surfaces() meshes the segmented surfaces with
+  void setWorkerCount(std::size_t n_workers);
+
 
 public:
   // parameters
@@ -82,7 +86,7 @@ private:
   std::default_random_engine random_engine_;
 
   // pcl members
-  CloudRGB::Ptr full_cloud_ptr_;
+  VoxelMap cloud_map_; // every scan added since the results were last cleared, fused
   CloudRGB::Ptr process_cloud_ptr_;
   CloudRGB::Ptr region_colored_cloud_ptr_;
   std::vector<CloudRGB::Ptr> surface_clouds_;
@@ -92,11 +96,12 @@ private:
   // counter
   int acquired_clouds_counter_;
 
+  std::size_t worker_count_;
+
   /**
-   * @brief filterFullCloud applies a passthrough and voxelgrid filter to the
-   * full cloud.  The result of these filters is the process cloud. The
-   * passthrough filter eliminates the table and the voxelgrid downsamples the
-   * cloud.
+   * @brief filterFullCloud extracts the process cloud from the voxel map,
+   * which has already downsampled the scans as they were added. Only the
+   * voxels within the height limits are kept, which eliminates the table.
    */
   void filterFullCloud();
 };
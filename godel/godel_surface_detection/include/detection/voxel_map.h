@@ -0,0 +1,89 @@
+/*
+        Copyright 2016 Southwest Research Institute
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
+
+#ifndef VOXEL_MAP_H_
+#define VOXEL_MAP_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+namespace godel_surface_detection
+{
+namespace detection
+{
+
+/**
+ * @brief A sparse voxel grid that fuses point clouds as they arrive. Every occupied voxel keeps the running sums
+ * of the position and color of the points that fell into it, and their count, so memory grows with the surface
+ * area covered rather than with the number of clouds added.
+ *
+ * The grid is aligned with the origin like pcl::VoxelGrid's, and toCloud() emits the voxel centroids in the same
+ * (z, y, x) order, so fusing a set of clouds and extracting them gives the same cloud as concatenating them and
+ * running a VoxelGrid filter with the same leaf size.
+ */
+class VoxelMap
+{
+public:
+  typedef pcl::PointXYZRGB PointT;
+
+  explicit VoxelMap(double leaf_size);
+
+  /**
+   * @brief Merges the finite points of 'cloud' into the map. Points outside the +-(2^20 * leaf size) range
+   * addressable by the map are dropped.
+   */
+  void insert(const pcl::PointCloud<PointT>& cloud);
+
+  /**
+   * @brief Replaces 'cloud' with the centroid and average color of every voxel hit by at least 'min_hits' points
+   * whose centroid has a z coordinate in [min_z, max_z]
+   */
+  void toCloud(pcl::PointCloud<PointT>& cloud, unsigned min_hits = 1,
+               double min_z = -std::numeric_limits<double>::max(),
+               double max_z = std::numeric_limits<double>::max()) const;
+
+  void clear();
+
+  /** @brief The number of occupied voxels */
+  std::size_t size() const { return voxels_.size(); }
+
+  /** @brief The number of points merged into the map since it was last cleared */
+  std::size_t pointCount() const { return n_points_; }
+
+  double leafSize() const { return leaf_size_; }
+
+private:
+  struct Voxel
+  {
+    double x, y, z;
+    std::uint32_t r, g, b;
+    std::uint32_t hits;
+  };
+
+  double leaf_size_;
+  double inverse_leaf_size_;
+  std::size_t n_points_;
+  std::unordered_map<std::uint64_t, Voxel> voxels_;
+};
+
+} /* end namespace detection */
+} /* end namespace godel_surface_detection */
+
+#endif /* VOXEL_MAP_H_ */
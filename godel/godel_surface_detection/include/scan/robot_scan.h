@@ -43,6 +43,7 @@ class RobotScan
 public:
   static const double PLANNING_TIME;
   static const double WAIT_MSG_DURATION;
+  static const double TF_WAIT_DURATION;
   static const double EEF_STEP;
   static const double MIN_TRAJECTORY_TIME_STEP;
   static const double MIN_JOINT_VELOCITY;
@@ -65,6 +66,14 @@ public:
   void publish_scan_poses(std::string topic);
   MoveGroupPtr get_move_group();
   bool move_to_pose(geometry_msgs::Pose& target_pose);
+
+  /**
+   * @brief Moves through the scan poses and captures a cloud at each. A cloud is converted, cleaned,
+   * transformed and handed to the scan callbacks on a worker thread while the robot moves to the next
+   * pose, so the callbacks run on that thread, one cloud at a time. Every callback has returned when
+   * this does.
+   * @return The number of poses reached
+   */
   int scan(bool move_only = false);
 
   static void apply_trajectory_parabolic_time_parameterization(
@@ -76,6 +85,12 @@ protected:
   bool create_scan_trajectory(std::vector<geometry_msgs::Pose>& scan_poses,
                               moveit_msgs::RobotTrajectory& scan_traj);
 
+  // waits for the first cloud stamped at or after 'after'; null if none arrives in time
+  sensor_msgs::PointCloud2ConstPtr capture_cloud(const ros::Time& after);
+
+  // removes NaNs, transforms the cloud to the target frame as of its stamp and runs the callbacks
+  void process_cloud(const sensor_msgs::PointCloud2ConstPtr& msg);
+
 protected:
   // moveit
   MoveGroupPtr move_group_ptr_;
@@ -0,0 +1,68 @@
+/*
+        Copyright 2016 Southwest Research Institute
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
+
+#ifndef NEIGHBOR_GRAPH_H_
+#define NEIGHBOR_GRAPH_H_
+
+#include <pcl/point_types.h>
+#include <pcl/search/search.h>
+
+#include <vector>
+
+namespace godel_surface_detection
+{
+namespace segmentation
+{
+
+/**
+ * @brief The k nearest neighbors of every point of a cloud, searched for once and kept in compressed sparse row
+ * form: the neighbors of point i are [begin(i), end(i)), closest first. A point is not its own neighbor.
+ */
+class NeighborGraph
+{
+public:
+  typedef pcl::PointXYZRGB PointT;
+
+  NeighborGraph() {}
+
+  /**
+   * @brief Finds the 'k' nearest neighbors of every point of the cloud 'search' was set up with, running the
+   * queries on all cores. 'search' must allow concurrent queries, as pcl::search::KdTree does.
+   */
+  void build(const pcl::search::Search<PointT>& search, int k);
+
+  void clear();
+
+  bool empty() const { return offsets_.empty(); }
+
+  /** @brief The number of points */
+  std::size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+  /** @brief The number of neighbor relations stored */
+  std::size_t numEdges() const { return neighbors_.size(); }
+
+  const int* begin(std::size_t point) const { return neighbors_.data() + offsets_[point]; }
+  const int* end(std::size_t point) const { return neighbors_.data() + offsets_[point + 1]; }
+
+private:
+  std::vector<std::size_t> offsets_;
+  std::vector<int> neighbors_;
+};
+
+} /* namespace segmentation */
+} /* namespace godel_surface_detection */
+
+#endif /* NEIGHBOR_GRAPH_H_ */
@@ -0,0 +1,71 @@
+/*
+        Copyright 2016 Southwest Research Institute
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
+
+#ifndef REGION_GROWING_H_
+#define REGION_GROWING_H_
+
+#include <segmentation/neighbor_graph.h>
+#include <pcl/PointIndices.h>
+#include <pcl/point_cloud.h>
+
+namespace godel_surface_detection
+{
+namespace segmentation
+{
+
+struct RegionGrowingParameters
+{
+  double smoothness_threshold; // largest angle between the normals of neighbors in one region, radians
+  double curvature_threshold;  // points curved more than this join a region but do not grow it
+  double residual_threshold;   // points further than this from a neighbor's tangent plane join its region but do
+                               // not grow it
+  std::size_t min_cluster_size;
+  std::size_t max_cluster_size;
+};
+
+/**
+ * @brief Smoothness constrained region growing after pcl::RegionGrowing in smooth mode with the curvature and
+ * residual tests enabled, run on all cores over a precomputed neighbor graph.
+ *
+ * Two neighbors whose normals are within the smoothness threshold, that both pass the curvature test and that
+ * pass the residual test are joined in a lock-free union-find. Any other point with a normal that such a point
+ * neighbors smoothly joins the region of the lowest numbered one, without growing it. The points left over are
+ * seeded flattest first; each takes in its unlabeled smooth neighbors, as pcl's last seeds do.
+ *
+ * The regions can differ from pcl's where its greedy, flattest seed first order matters, as a union-find does
+ * not depend on the order:
+ * - pcl adds a point to the first region that reaches it, and lets it grow that region only if it passes the
+ *   residual test from there. Here a point grows if it passes the test towards any neighbor, so regions that
+ *   meet at such a point are merged where pcl may keep them apart.
+ * - A point that only joins a region goes to the region grown first in pcl, to its lowest numbered growing
+ *   neighbor's here.
+ * - Points without a finite normal belong to no region. pcl, whose tests all pass on NaN, lets them join and
+ *   grow whichever region reaches them first.
+ *
+ * @param graph Neighbors of every point. pcl searches for k neighbors including the point itself, so the graph
+ * of pcl's setNumberOfNeighbours(k) has k - 1 neighbors.
+ * @return The regions with a size in [min_cluster_size, max_cluster_size], ordered by their flattest point (the
+ * first seed pcl would grow them from); each holds ascending point indices
+ */
+std::vector<pcl::PointIndices> growRegions(const pcl::PointCloud<pcl::PointXYZRGB>& cloud,
+                                           const pcl::PointCloud<pcl::Normal>& normals,
+                                           const NeighborGraph& graph,
+                                           const RegionGrowingParameters& params);
+
+} /* namespace segmentation */
+} /* namespace godel_surface_detection */
+
+#endif /* REGION_GROWING_H_ */
@@ -14,7 +14,9 @@
 #include <pcl/io/vtk_io.h>
 #include <pcl/surface/concave_hull.h>
 #include <pcl/surface/ear_clipping.h>
-#include <pcl/segmentation/region_growing.h>
+#include <pcl/search/kdtree.h>
+#include <segmentation/neighbor_graph.h>
+#include <segmentation/region_growing.h>
 #include <pcl/filters/filter.h>
 #include <Eigen/Geometry>
 #include <Eigen/StdVector>
@@ -101,7 +103,13 @@ public:
 
   std::vector <pcl::PointIndices> computeSegments(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &colored_cloud);
   Mesh computeMesh();
-  std::pair<int, int> getNextUnused(std::vector< std::pair<int,int> > used);
+  /**
+   * @brief Chains the points of 'boundary_indices' (indices into input_cloud_) into boundaries by repeatedly
+   *        stepping to the closest unused point within the search radius. Each closed loop, and each piece of
+   *        a boundary broken by a gap or a branch point, becomes one entry of 'sorted_boundaries'. Runs in
+   *        O(n) besides the radius searches.
+   * @return The number of boundaries found
+   */
   int sortBoundary(pcl::IndicesPtr& boundary_indices, std::vector<pcl::IndicesPtr> &sorted_boundaries);
   void setSearchRadius(double radius);
   double getSearchRadius();
@@ -159,6 +167,24 @@ private:
   /** @brief compute the normals and store in normals_, this is requried for both segmentation and meshing*/
   void computeNormals();
 
+  /**
+   * @brief The one search tree over input_cloud_, shared by the normal estimation, the neighbor graph and the
+   * boundary estimation; built on first use
+   */
+  pcl::search::KdTree<pcl::PointXYZRGB>::Ptr searchTree();
+
+  /**
+   * @brief The NUM_NEIGHBORS - 1 nearest neighbors of every point of input_cloud_, which is what
+   * pcl::RegionGrowing searches with setNumberOfNeighbours(NUM_NEIGHBORS); built on first use
+   */
+  const godel_surface_detection::segmentation::NeighborGraph& neighborGraph();
+
+  /** @brief drops the search structures, which must follow every change to input_cloud_ */
+  void resetSearch();
+
+  pcl::search::KdTree<pcl::PointXYZRGB>::Ptr search_tree_;
+  godel_surface_detection::segmentation::NeighborGraph neighbor_graph_;
+
   pcl::PointCloud<pcl::Normal>::Ptr normals_;
   pcl::PointCloud<pcl::PointNormal>::Ptr cloud_with_normals_;
 
@@ -0,0 +1,166 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PLANNING_CACHE_H
+#define PLANNING_CACHE_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+#include <geometry_msgs/PoseArray.h>
+#include <godel_msgs/ProcessPlan.h>
+#include <ros/serialization.h>
+
+namespace godel_surface_detection
+{
+
+/**
+ * @brief Remembers the process plans returned by the blend and keyence planning services, keyed by a hash of
+ * the path and parameters they were planned from, so that surfaces whose inputs did not change are not planned
+ * again. The planners start and end every plan at the robot's current position, so an entry also records the
+ * joint state it was planned from and only matches when the robot is still there. Everything else the planners
+ * depend on, the robot model, the planning scene and their own parameters, makes up the context of the cache:
+ * plans from one context are never returned in another.
+ *
+ * All methods are thread-safe. The cache holds at most 'capacity' plans and forgets the oldest first.
+ */
+class PlanningCache
+{
+public:
+  typedef uint64_t Key;
+
+  explicit PlanningCache(std::size_t capacity = 1024);
+
+  /**
+   * @brief Computes the key of a plan of kind 'process' (e.g. the planning service name) for the path
+   * 'segments' with planning parameters 'params'. The headers of the segments other than their frames do not
+   * contribute to the key.
+   */
+  template <typename Params>
+  static Key makeKey(const std::string& process, const std::vector<geometry_msgs::PoseArray>& segments,
+                     const Params& params)
+  {
+    Key key = hash(FNV_OFFSET_BASIS, process.data(), process.size() + 1);
+    for (std::size_t i = 0; i < segments.size(); ++i)
+    {
+      key = hash(key, segments[i].header.frame_id.data(), segments[i].header.frame_id.size() + 1);
+      key = hashMessage(key, segments[i].poses);
+    }
+    return hashMessage(key, params);
+  }
+
+  /**
+   * @brief Computes the context of plans made for the robot model given by 'urdf' and 'srdf', in 'scene' and
+   * with planner parameters 'planner_params'
+   */
+  template <typename Scene>
+  static Key makeContext(const std::string& urdf, const std::string& srdf, const Scene& scene,
+                         const std::string& planner_params)
+  {
+    Key key = hash(FNV_OFFSET_BASIS, urdf.data(), urdf.size() + 1);
+    key = hash(key, srdf.data(), srdf.size() + 1);
+    key = hashMessage(key, scene);
+    return hash(key, planner_params.data(), planner_params.size() + 1);
+  }
+
+  /**
+   * @brief Sets the context of the plans looked up and inserted from now on. The stored plans are forgotten if
+   * it differs from the current one.
+   */
+  void setContext(Key context);
+
+  Key context() const;
+
+  /**
+   * @brief Copies the plan stored under 'key' into 'plan' if it was planned from within JOINT_TOLERANCE of
+   * 'start_state'
+   */
+  bool lookup(Key key, const std::vector<double>& start_state, godel_msgs::ProcessPlan& plan);
+
+  /**
+   * @brief Stores 'plan', planned from 'start_state', under 'key', replacing any plan already stored there
+   */
+  void insert(Key key, const std::vector<double>& start_state, const godel_msgs::ProcessPlan& plan);
+
+  void clear();
+
+  std::size_t size() const;
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+  /**
+   * @brief Adds the plans stored in 'filename' by save() to the cache. A file saved in another context than the
+   * current one is ignored, to be overwritten by the next save(), and a file holding more plans than the capacity
+   * only adds the newest.
+   * @return False if the file does not exist or could not be read
+   */
+  bool load(const std::string& filename);
+
+  bool save(const std::string& filename) const;
+
+  // Largest difference of any joint, in radians, between the current and the recorded start state of a plan
+  static const double JOINT_TOLERANCE;
+
+private:
+  struct Entry
+  {
+    std::vector<double> start_state;
+    godel_msgs::ProcessPlan plan;
+  };
+
+  static const Key FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+  // 64 bit FNV-1a
+  static Key hash(Key key, const void* data, std::size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      key ^= bytes[i];
+      key *= 1099511628211ull;
+    }
+    return key;
+  }
+
+  template <typename M>
+  static Key hashMessage(Key key, const M& msg)
+  {
+    std::vector<uint8_t> buffer(ros::serialization::serializationLength(msg));
+    ros::serialization::OStream stream(buffer.data(), buffer.size());
+    ros::serialization::serialize(stream, msg);
+    return hash(key, buffer.data(), buffer.size());
+  }
+
+  void insertLocked(Key key, const Entry& entry);
+
+  const std::size_t capacity_;
+  Key context_;
+  std::unordered_map<Key, Entry> entries_;
+  std::deque<Key> order_; // keys from oldest to newest
+  std::size_t hits_;
+  std::size_t misses_;
+  mutable std::mutex mutex_;
+};
+}
+
+#endif // PLANNING_CACHE_H
@@ -46,12 +46,15 @@
 #include <godel_process_path_generation/VisualizeBlendingPlan.h>
 #include <godel_process_path_generation/utils.h>
 #include <godel_process_path_generation/polygon_utils.h>
+#include <path_planning_plugins_base/path_planning_base.h>
 
 #include <services/trajectory_library.h>
+#include <services/planning_cache.h>
 #include <coordination/data_coordinator.h>
 
 #include <pcl/console/parse.h>
 #include <rosbag/bag.h>
+#include <mutex>
 
 //  marker namespaces
 const static std::string BOUNDARY_NAMESPACE = "process_boundary";
@@ -136,22 +139,23 @@ private:
   generateMotionLibrary(const godel_msgs::PathPlanningParameters& params);
 
 
-  bool generateProcessPath(const int& id, ProcessPathResult& result);
+  // Per-thread planning resources, see src/blending_service_path_generation.cpp
+  struct PlanningWorker;
 
 
-  bool generateProcessPath(const int& id,
+  bool generateProcessPath(PlanningWorker& worker,
                            const std::string& name,
                            const pcl::PolygonMesh& mesh,
                            const godel_surface_detection::detection::CloudRGB::Ptr,
                            ProcessPathResult& result);
 
 
-  bool generateBlendPath(const godel_msgs::PathPlanningParameters& params,
+  bool generateBlendPath(path_planning_plugins_base::PathPlanningBase& planner,
                          const pcl::PolygonMesh& mesh,
                          std::vector<geometry_msgs::PoseArray>& result);
 
 
-  bool generateScanPath(const godel_msgs::PathPlanningParameters& params,
+  bool generateScanPath(path_planning_plugins_base::PathPlanningBase& planner,
                          const pcl::PolygonMesh& mesh,
                          std::vector<geometry_msgs::PoseArray>& result);
 
@@ -160,11 +164,15 @@ private:
                         std::vector<geometry_msgs::PoseArray>& result);
 
 
-  ProcessPlanResult generateProcessPlan(const std::string& name,
+  ProcessPlanResult generateProcessPlan(PlanningWorker& worker,
+                                        const std::string& name,
                                         const std::vector<geometry_msgs::PoseArray> &path,
                                         const godel_msgs::BlendingPlanParameters& params,
-                                        const godel_msgs::ScanPlanParameters& scan_params);
+                                        const godel_msgs::ScanPlanParameters& scan_params,
+                                        const std::vector<double>& start_state);
 
+  // Thread-safe; planning workers report progress through this
+  void publishPlanningFeedback(const std::string& message);
 
   bool getMotionPlansCallback(godel_msgs::GetAvailableMotionPlans::Request& req,
                               godel_msgs::GetAvailableMotionPlans::Response& res);
@@ -198,14 +206,16 @@ private:
   ros::ServiceClient process_path_client_;
   ros::ServiceClient trajectory_planner_client_;
 
-  ros::ServiceClient blend_planning_client_;
-  ros::ServiceClient keyence_planning_client_;
+  // one client of each planning service per worker, so that surfaces are planned concurrently
+  std::vector<ros::ServiceClient> blend_planning_clients_;
+  std::vector<ros::ServiceClient> keyence_planning_clients_;
 
   // Actions offered by this class
   ros::NodeHandle nh_;
   actionlib::SimpleActionServer<godel_msgs::ProcessPlanningAction> process_planning_server_;
   actionlib::SimpleActionServer<godel_msgs::SelectMotionPlanAction> select_motion_plan_server_;
   godel_msgs::ProcessPlanningFeedback process_planning_feedback_;
+  std::mutex process_planning_feedback_mutex_;
   godel_msgs::ProcessPlanningResult process_planning_result_;
 
   // Actions subscribed to by this class
@@ -253,11 +263,16 @@ private:
   bool publish_region_point_cloud_;
   bool save_data_;
   std::string save_location_;
+  std::size_t worker_count_; // threads that mesh, generate paths for and plan the surfaces
 
   // msgs
   sensor_msgs::PointCloud2 region_cloud_msg_;
 
   godel_surface_detection::TrajectoryLibrary trajectory_library_;
+  // plans of previously planned paths, shared by the planning workers
+  godel_surface_detection::PlanningCache planning_cache_;
+  std::string planning_cache_file_; // empty if the cache is not persisted
+  bool planning_cache_loaded_; // the file is not saved over before it was loaded
   int marker_counter_;
 
   // Parameter loading and saving
@@ -3,25 +3,66 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
+#include <boost/shared_ptr.hpp>
 #include <godel_msgs/ProcessPlan.h>
 
 namespace godel_surface_detection
 {
 
+/**
+ * @brief Named process plans. Libraries are saved in a compact binary format: an index of fixed size records
+ * followed by the joint positions, velocities, etc. and times of every trajectory in contiguous arrays. Loading
+ * such a file only maps it into memory and reads the index; a plan is decoded the first time it is asked for.
+ * Rosbags remain supported for import and export.
+ */
 class TrajectoryLibrary
 {
 public:
   typedef std::map<std::string, godel_msgs::ProcessPlan> TrajectoryMap;
 
+  /**
+   * @brief Adds the plans in 'filename' to the library. Files in the binary format are memory-mapped, anything
+   * else is imported as a rosbag.
+   * @throws std::runtime_error if the file can not be read or holds a name already in the library
+   */
   void load(const std::string& filename);
+
+  /**
+   * @brief Writes every plan to 'filename', as a rosbag if the name ends in ".bag" and in the binary format
+   * otherwise. The file may be one the library was loaded from.
+   * @throws std::runtime_error if the file can not be written
+   */
   void save(const std::string& filename);
 
-  TrajectoryMap& get() { return map_; }
-  const TrajectoryMap& get() const { return map_; }
+  bool contains(const std::string& name) const;
+
+  /** @brief The names of all the plans, in order */
+  std::vector<std::string> names() const;
+
+  /** @brief The plan called 'name', decoded if need be, or null if there is none */
+  const godel_msgs::ProcessPlan* find(const std::string& name);
+
+  /** @brief All the plans; decodes any that have not been read from a loaded file yet */
+  TrajectoryMap& get();
+  const TrajectoryMap& get() const;
 
 private:
-  TrajectoryMap map_;
+  struct MappedFile;
+
+  struct StoredPlan
+  {
+    boost::shared_ptr<const MappedFile> file;
+    std::size_t record;
+  };
+
+  void decodeAll() const;
+
+  // decoded and newly added plans
+  mutable TrajectoryMap map_;
+  // plans in mapped files that have not been decoded yet; a name is never in both
+  mutable std::map<std::string, StoredPlan> stored_;
 };
 }
 
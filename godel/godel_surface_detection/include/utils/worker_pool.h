@@ -0,0 +1,72 @@
+#ifndef GODEL_WORKER_POOL_H
+#define GODEL_WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace godel_surface_detection
+{
+
+/**
+ * @brief Resolves a configured worker count: zero selects one worker per hardware thread.
+ */
+inline std::size_t resolveWorkerCount(int requested)
+{
+  if (requested > 0)
+    return static_cast<std::size_t>(requested);
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Runs task(i, worker) for every i in [0, n_tasks) on at most 'n_workers' threads, the calling
+ * thread being one of them. Tasks are handed out one at a time so that surfaces of very different
+ * sizes balance across the workers; 'worker' lies in [0, n_workers) and identifies the thread, which
+ * lets each worker use its own instance of a non thread-safe object such as a plugin. Tasks must write
+ * their results into slot 'i' of a pre-sized container so that the caller can merge them in order.
+ * The first exception thrown by a task is rethrown here once every worker has stopped.
+ */
+template <typename Task>
+void runTasks(std::size_t n_tasks, std::size_t n_workers, Task task)
+{
+  n_workers = std::max<std::size_t>(1, std::min(n_workers, n_tasks));
+
+  std::atomic<std::size_t> next(0);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&](std::size_t worker) {
+    for (std::size_t i = next++; i < n_tasks; i = next++)
+    {
+      try
+      {
+        task(i, worker);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+          error = std::current_exception();
+        next = n_tasks; // stop handing out tasks
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(n_workers - 1);
+  for (std::size_t w = 1; w < n_workers; ++w)
+    threads.emplace_back(work, w);
+  work(0);
+  for (auto& t : threads)
+    t.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+}
+
+#endif // GODEL_WORKER_POOL_H
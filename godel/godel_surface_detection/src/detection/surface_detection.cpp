@@ -23,10 +23,9 @@
 #include <sensor_msgs/point_cloud_conversion.h>
 #include <tf/transform_datatypes.h>
 #include <utils/mesh_conversions.h>
+#include <utils/worker_pool.h>
 #include <swri_profiler/profiler.h>
-#include <pcl/filters/voxel_grid.h>
 #include <pcl/pcl_base.h>
-#include <pcl/filters/passthrough.h>
 
 namespace godel_surface_detection
 {
@@ -137,9 +136,10 @@ namespace godel_surface_detection
   namespace detection
   {
     SurfaceDetection::SurfaceDetection()
-      : full_cloud_ptr_(new CloudRGB())
+      : cloud_map_(INPUT_CLOUD_VOXEL_FILTER_SIZE)
       , process_cloud_ptr_(new CloudRGB())
       , acquired_clouds_counter_(0)
+      , worker_count_(1)
       , random_engine_(0) // This is using a fixed seed for down-sampling at the moment
     {
       params_.frame_id = defaults::FRAME_ID;
@@ -170,7 +170,6 @@ namespace godel_surface_detection
 
     bool SurfaceDetection::init()
     {
-      full_cloud_ptr_->header.frame_id = params_.frame_id;
       process_cloud_ptr_->header.frame_id = params_.frame_id;
       acquired_clouds_counter_ = 0;
       return true;
@@ -179,7 +178,7 @@ namespace godel_surface_detection
     void SurfaceDetection::clear_results()
     {
       acquired_clouds_counter_ = 0;
-      full_cloud_ptr_->clear();
+      cloud_map_.clear();
       process_cloud_ptr_->clear();
       surface_clouds_.clear();
       mesh_markers_.markers.clear();
@@ -268,7 +267,8 @@ namespace godel_surface_detection
 
     void SurfaceDetection::add_cloud(CloudRGB& cloud)
     {
-      (*full_cloud_ptr_) += cloud;
+      SWRI_PROFILE("fuse-cloud");
+      cloud_map_.insert(cloud);
       acquired_clouds_counter_++;
     }
 
@@ -294,12 +294,15 @@ namespace godel_surface_detection
 
     void SurfaceDetection::get_full_cloud(CloudRGB& cloud)
     {
-      pcl::copyPointCloud(*full_cloud_ptr_, cloud);
+      cloud_map_.toCloud(cloud);
+      cloud.header.frame_id = params_.frame_id;
     }
 
     void SurfaceDetection::get_full_cloud(sensor_msgs::PointCloud2 cloud_msg)
     {
-      pcl::toROSMsg(*full_cloud_ptr_, cloud_msg);
+      CloudRGB cloud;
+      get_full_cloud(cloud);
+      pcl::toROSMsg(cloud, cloud_msg);
     }
 
     void SurfaceDetection::get_process_cloud(CloudRGB& cloud)
@@ -334,8 +337,8 @@ namespace godel_surface_detection
       mesh_markers_.markers.clear();
       meshes_.clear();
 
-      // Ensure cloud ptr is not empty
-      if (full_cloud_ptr_->empty())
+      // Ensure some points have been acquired
+      if (cloud_map_.size() == 0)
         return false;
 
       filterFullCloud();
@@ -349,14 +352,17 @@ namespace godel_surface_detection
       }
       SS.getSurfaceClouds(surface_clouds_);
 
-      // Load the code to perform meshing dynamically
+      // Load the code to perform meshing dynamically. Meshing plugins keep state between init() and
+      // generateMesh(), so every worker gets an instance of its own.
+      const std::size_t n_workers = std::max<std::size_t>(1, std::min(worker_count_, surface_clouds_.size()));
       pluginlib::ClassLoader<meshing_plugins_base::MeshingBase>
           poly_loader("meshing_plugins_base", "meshing_plugins_base::MeshingBase");
-      boost::shared_ptr<meshing_plugins_base::MeshingBase> mesher;
+      std::vector<boost::shared_ptr<meshing_plugins_base::MeshingBase> > meshers;
 
       try
       {
-        mesher = poly_loader.createInstance(getMeshingPluginName());
+        for (std::size_t w = 0; w < n_workers; ++w)
+          meshers.push_back(poly_loader.createInstance(getMeshingPluginName()));
       }
       catch(pluginlib::PluginlibException& ex)
       {
@@ -366,13 +372,20 @@ namespace godel_surface_detection
 
       // Compute mesh from point clouds
       SWRI_PROFILE("mesh-clouds");
+      std::vector<pcl::PolygonMesh> meshes (surface_clouds_.size());
+      std::vector<char> meshed (surface_clouds_.size(), false);
+      runTasks(surface_clouds_.size(), n_workers, [&](std::size_t i, std::size_t worker) {
+        meshers[worker]->init(*surface_clouds_[i]);
+        meshed[i] = meshers[worker]->generateMesh(meshes[i]);
+      });
+
+      // Markers are created in surface order so that ids and colors do not depend on the schedule
       for (std::size_t i = 0; i < surface_clouds_.size(); i++)
       {
-        pcl::PolygonMesh mesh;
+        pcl::PolygonMesh& mesh = meshes[i];
         visualization_msgs::Marker marker;
-        mesher->init(*surface_clouds_[i]);
 
-        if (mesher->generateMesh(mesh))
+        if (meshed[i])
         {
           // Create marker from mesh
           mesh_to_marker(mesh, marker, random_engine_);
@@ -387,7 +400,7 @@ namespace godel_surface_detection
           mesh_markers_.markers.push_back(marker);
 
           // Push mesh to meshes_
-          meshes_.push_back(mesh);
+          meshes_.push_back(std::move(mesh));
         }
         else
         {
@@ -398,6 +411,11 @@ namespace godel_surface_detection
       return true;
     }
 
+    void SurfaceDetection::setWorkerCount(std::size_t n_workers)
+    {
+      worker_count_ = std::max<std::size_t>(n_workers, 1);
+    }
+
     std::string SurfaceDetection::getMeshingPluginName() const
     {
       ros::NodeHandle pnh ("~");
@@ -413,26 +431,13 @@ namespace godel_surface_detection
 
     void SurfaceDetection::filterFullCloud()
     {
-      pcl::PointCloud<pcl::PointXYZRGB>::Ptr intermediate_cloud_ptr(new pcl::PointCloud<pcl::PointXYZRGB>);
-
-      //remove the table using the passthrough filter
-      pcl::PassThrough<pcl::PointXYZRGB> pass;
-      pass.setInputCloud(full_cloud_ptr_);
-      const std::string FILTER_DIRECTION = "z";
-      pass.setFilterFieldName (FILTER_DIRECTION);
-      //keep poin clouds with these limits
+      // The map holds the scans downsampled to INPUT_CLOUD_VOXEL_FILTER_SIZE; drop the voxels outside these
+      // height limits, which removes the table
       const double MINIMUM_DISTANCE = 0.01; // 1 cm
       const double MAXIMUM_DISTANCE = 1.0; // 1 m
-      pass.setFilterLimits (MINIMUM_DISTANCE, MAXIMUM_DISTANCE);
-      pass.filter (*intermediate_cloud_ptr);
-
-      //downsample the full cloud using the voxelgrid filter method
-      pcl::VoxelGrid<pcl::PointXYZRGB> vox;
-      vox.setInputCloud (intermediate_cloud_ptr);
-      vox.setLeafSize (INPUT_CLOUD_VOXEL_FILTER_SIZE,
-                       INPUT_CLOUD_VOXEL_FILTER_SIZE,
-                       INPUT_CLOUD_VOXEL_FILTER_SIZE);
-      vox.filter(*process_cloud_ptr_);
+      cloud_map_.toCloud(*process_cloud_ptr_, 1, MINIMUM_DISTANCE, MAXIMUM_DISTANCE);
+      ROS_DEBUG_STREAM("Fused " << cloud_map_.pointCount() << " points from " << acquired_clouds_counter_
+                       << " clouds into " << cloud_map_.size() << " voxels");
     }
   } /* end namespace detection */
 } /* end namespace godel_surface_detection */
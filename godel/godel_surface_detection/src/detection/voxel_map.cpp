@@ -0,0 +1,125 @@
+/*
+        Copyright 2016 Southwest Research Institute
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
+
+#include <detection/voxel_map.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Each voxel coordinate is stored in 21 bits of the key, offset so that negative coordinates fit; z takes the
+// high bits so that sorting the keys orders the voxels like pcl::VoxelGrid does
+static const int KEY_BITS = 21;
+static const std::int64_t KEY_OFFSET = std::int64_t(1) << (KEY_BITS - 1);
+static const std::int64_t KEY_LIMIT = std::int64_t(1) << KEY_BITS;
+
+static inline bool voxelKey(std::int64_t ix, std::int64_t iy, std::int64_t iz, std::uint64_t& key)
+{
+  ix += KEY_OFFSET;
+  iy += KEY_OFFSET;
+  iz += KEY_OFFSET;
+  if (ix < 0 || iy < 0 || iz < 0 || ix >= KEY_LIMIT || iy >= KEY_LIMIT || iz >= KEY_LIMIT)
+    return false;
+
+  key = static_cast<std::uint64_t>(ix) | (static_cast<std::uint64_t>(iy) << KEY_BITS) |
+        (static_cast<std::uint64_t>(iz) << (2 * KEY_BITS));
+  return true;
+}
+
+namespace godel_surface_detection
+{
+  namespace detection
+  {
+    VoxelMap::VoxelMap(double leaf_size)
+      : leaf_size_(leaf_size)
+      , inverse_leaf_size_(1.0 / leaf_size)
+      , n_points_(0)
+    {
+    }
+
+    void VoxelMap::insert(const pcl::PointCloud<PointT>& cloud)
+    {
+      for (const auto& pt : cloud.points)
+      {
+        if (!std::isfinite(pt.x) || !std::isfinite(pt.y) || !std::isfinite(pt.z))
+          continue;
+
+        std::uint64_t key;
+        if (!voxelKey(static_cast<std::int64_t>(std::floor(pt.x * inverse_leaf_size_)),
+                      static_cast<std::int64_t>(std::floor(pt.y * inverse_leaf_size_)),
+                      static_cast<std::int64_t>(std::floor(pt.z * inverse_leaf_size_)), key))
+          continue;
+
+        // Value-initialized on first use
+        Voxel& v = voxels_[key];
+        v.x += pt.x;
+        v.y += pt.y;
+        v.z += pt.z;
+        v.r += pt.r;
+        v.g += pt.g;
+        v.b += pt.b;
+        v.hits++;
+        n_points_++;
+      }
+    }
+
+    void VoxelMap::toCloud(pcl::PointCloud<PointT>& cloud, unsigned min_hits, double min_z, double max_z) const
+    {
+      std::vector<std::pair<std::uint64_t, const Voxel*> > sorted;
+      sorted.reserve(voxels_.size());
+      for (const auto& entry : voxels_)
+      {
+        const Voxel& v = entry.second;
+        if (v.hits < min_hits)
+          continue;
+
+        const double z = v.z / v.hits;
+        if (z < min_z || z > max_z)
+          continue;
+
+        sorted.push_back(std::make_pair(entry.first, &v));
+      }
+
+      std::sort(sorted.begin(), sorted.end(),
+                [](const std::pair<std::uint64_t, const Voxel*>& a, const std::pair<std::uint64_t, const Voxel*>& b)
+                { return a.first < b.first; });
+
+      cloud.points.resize(sorted.size());
+      for (std::size_t i = 0; i < sorted.size(); ++i)
+      {
+        const Voxel& v = *sorted[i].second;
+        PointT& pt = cloud.points[i];
+        pt.x = static_cast<float>(v.x / v.hits);
+        pt.y = static_cast<float>(v.y / v.hits);
+        pt.z = static_cast<float>(v.z / v.hits);
+        pt.r = static_cast<std::uint8_t>(v.r / v.hits);
+        pt.g = static_cast<std::uint8_t>(v.g / v.hits);
+        pt.b = static_cast<std::uint8_t>(v.b / v.hits);
+        pt.a = 255;
+      }
+
+      cloud.width = static_cast<std::uint32_t>(cloud.points.size());
+      cloud.height = 1;
+      cloud.is_dense = true;
+    }
+
+    void VoxelMap::clear()
+    {
+      voxels_.clear();
+      n_points_ = 0;
+    }
+  } /* end namespace detection */
+} /* end namespace godel_surface_detection */
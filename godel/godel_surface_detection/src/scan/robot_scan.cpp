@@ -21,6 +21,11 @@
 #include <pcl/filters/filter.h>
 #include <boost/assign/list_of.hpp>
 #include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <math.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/trajectory_processing/iterative_time_parameterization.h>
@@ -28,6 +33,73 @@
 
 static const std::string DEFAULT_MOVEIT_PLANNER = "RRTConnectkConfigDefault";
 
+namespace
+{
+/**
+ * @brief Runs posted jobs one at a time, in order, on a thread of its own
+ */
+class SerialWorker
+{
+public:
+  SerialWorker() : done_(false), thread_(&SerialWorker::run, this) {}
+
+  ~SerialWorker() { finish(); }
+
+  void post(const boost::function<void()>& job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(job);
+    }
+    cv_.notify_one();
+  }
+
+  // Blocks until every posted job has run
+  void finish()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+private:
+  void run()
+  {
+    while (true)
+    {
+      boost::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return done_ || !jobs_.empty(); });
+        if (jobs_.empty())
+          return;
+        job = jobs_.front();
+        jobs_.pop_front();
+      }
+
+      try
+      {
+        job();
+      }
+      catch (const std::exception& e)
+      {
+        ROS_ERROR_STREAM("Processing of a scan failed: " << e.what());
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<boost::function<void()> > jobs_;
+  bool done_;
+  std::thread thread_;
+};
+}
+
 static bool loadPoseParam(ros::NodeHandle& nh, const std::string& name, geometry_msgs::Pose& pose)
 {
   using namespace godel_param_helpers;
@@ -47,6 +119,7 @@ namespace scan
 
 const double RobotScan::PLANNING_TIME = 60.0f;
 const double RobotScan::WAIT_MSG_DURATION = 5.0f;
+const double RobotScan::TF_WAIT_DURATION = 1.0f;
 const double RobotScan::MIN_TRAJECTORY_TIME_STEP = 0.8f; // seconds
 const double RobotScan::EEF_STEP = 0.05f;                // 5cm
 const double RobotScan::MIN_JOINT_VELOCITY = 0.01f;      // rad/sect
@@ -197,6 +270,7 @@ int RobotScan::scan(bool move_only)
     trajectory_poses.insert(trajectory_poses.begin() + 1, scan_traj_poses_.begin(),
                             scan_traj_poses_.end());
 
+    SerialWorker cloud_worker;
     for (size_t i = 1; i < trajectory_poses.size(); i++)
     {
       // reset path plan structure
@@ -259,50 +333,12 @@ int RobotScan::scan(bool move_only)
 
       if (!move_only)
       {
-        // get message
-        ros::Duration(1.0).sleep();
-        sensor_msgs::PointCloud2ConstPtr msg = ros::topic::waitForMessage<sensor_msgs::PointCloud2>(
-            params_.scan_topic, ros::Duration(WAIT_MSG_DURATION));
-        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZRGB>());
-        tf::StampedTransform source_to_target_tf;
+        // The first cloud stamped after the motion finished was captured at this pose; it is processed
+        // on the worker while the robot moves on
+        sensor_msgs::PointCloud2ConstPtr msg = capture_cloud(ros::Time::now());
         if (msg)
         {
-          ROS_INFO_STREAM("Cloud message received, converting to target frame '"
-                          << params_.scan_target_frame << "'");
-
-          // convert to message to point cloud
-          pcl::fromROSMsg<pcl::PointXYZRGB>(*msg, *cloud_ptr);
-
-          // removed nans
-          std::vector<int> index;
-          pcl::removeNaNFromPointCloud(*cloud_ptr, *cloud_ptr, index);
-
-          // transforming
-          if (msg->header.frame_id.compare(params_.scan_target_frame) != 0)
-          {
-            try
-            {
-              tf_listener_ptr_->lookupTransform(params_.scan_target_frame, msg->header.frame_id,
-                                                ros::Time(0), source_to_target_tf);
-              pcl_ros::transformPointCloud(*cloud_ptr, *cloud_ptr, source_to_target_tf);
-            }
-            catch (tf::LookupException& e)
-            {
-              ROS_ERROR_STREAM("Transform lookup error, using source frame id '"
-                               << msg->header.frame_id << "'");
-            }
-            catch (tf::ExtrapolationException& e)
-            {
-              ROS_ERROR_STREAM("Transform lookup error, using source frame id '"
-                               << msg->header.frame_id << "'");
-            }
-          }
-
-          for (std::vector<ScanCallback>::iterator i = callback_list_.begin();
-               i != callback_list_.end(); i++)
-          {
-            (*i)(*cloud_ptr);
-          }
+          cloud_worker.post(boost::bind(&RobotScan::process_cloud, this, msg));
         }
         else
         {
@@ -313,14 +349,71 @@ int RobotScan::scan(bool move_only)
       {
         ROS_WARN_STREAM("MOVE_ONLY mode, skipping scan");
       }
-
-      ros::Duration(0.5f).sleep();
     }
+
+    // Clouds still being processed must reach the callbacks before the scan is reported complete
+    cloud_worker.finish();
   }
 
   return poses_reached;
 }
 
+sensor_msgs::PointCloud2ConstPtr RobotScan::capture_cloud(const ros::Time& after)
+{
+  const ros::Time deadline = ros::Time::now() + ros::Duration(WAIT_MSG_DURATION);
+  ros::Duration remaining = deadline - ros::Time::now();
+  while (remaining > ros::Duration(0.0))
+  {
+    sensor_msgs::PointCloud2ConstPtr msg =
+        ros::topic::waitForMessage<sensor_msgs::PointCloud2>(params_.scan_topic, remaining);
+    if (!msg)
+      break;
+    if (msg->header.stamp >= after)
+      return msg;
+    remaining = deadline - ros::Time::now();
+  }
+  return sensor_msgs::PointCloud2ConstPtr();
+}
+
+void RobotScan::process_cloud(const sensor_msgs::PointCloud2ConstPtr& msg)
+{
+  ROS_INFO_STREAM("Cloud message received, converting to target frame '"
+                  << params_.scan_target_frame << "'");
+
+  // convert to message to point cloud
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZRGB>());
+  pcl::fromROSMsg<pcl::PointXYZRGB>(*msg, *cloud_ptr);
+
+  // removed nans
+  std::vector<int> index;
+  pcl::removeNaNFromPointCloud(*cloud_ptr, *cloud_ptr, index);
+
+  // transforming with the sensor pose at the time the cloud was captured
+  if (msg->header.frame_id.compare(params_.scan_target_frame) != 0)
+  {
+    tf::StampedTransform source_to_target_tf;
+    try
+    {
+      tf_listener_ptr_->waitForTransform(params_.scan_target_frame, msg->header.frame_id, msg->header.stamp,
+                                         ros::Duration(TF_WAIT_DURATION));
+      tf_listener_ptr_->lookupTransform(params_.scan_target_frame, msg->header.frame_id, msg->header.stamp,
+                                        source_to_target_tf);
+      pcl_ros::transformPointCloud(*cloud_ptr, *cloud_ptr, source_to_target_tf);
+    }
+    catch (tf::TransformException& e)
+    {
+      ROS_ERROR_STREAM("Transform lookup error (" << e.what() << "), using source frame id '"
+                       << msg->header.frame_id << "'");
+    }
+  }
+
+  for (std::vector<ScanCallback>::iterator i = callback_list_.begin();
+       i != callback_list_.end(); i++)
+  {
+    (*i)(*cloud_ptr);
+  }
+}
+
 MoveGroupPtr RobotScan::get_move_group() { return move_group_ptr_; }
 
 bool RobotScan::create_scan_trajectory(std::vector<geometry_msgs::Pose>& scan_poses,
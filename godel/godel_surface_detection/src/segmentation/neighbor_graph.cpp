@@ -0,0 +1,83 @@
+/*
+        Copyright 2016 Southwest Research Institute
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
+
+#include <segmentation/neighbor_graph.h>
+
+#include <algorithm>
+
+namespace godel_surface_detection
+{
+namespace segmentation
+{
+
+void NeighborGraph::build(const pcl::search::Search<PointT>& search, int k)
+{
+  clear();
+
+  const int n_points = static_cast<int>(search.getInputCloud()->size());
+  if (n_points == 0 || k <= 0)
+  {
+    offsets_.assign(n_points + 1, 0);
+    return;
+  }
+
+  // Every point gets a slot of k neighbors; the slots are compacted once all the searches are done
+  std::vector<int> slots(static_cast<std::size_t>(n_points) * k);
+  std::vector<int> counts(n_points, 0);
+
+  #pragma omp parallel
+  {
+    std::vector<int> indices;
+    std::vector<float> sqr_distances;
+
+    #pragma omp for schedule(dynamic, 256)
+    for (int i = 0; i < n_points; ++i)
+    {
+      // The point itself is normally the first result, but duplicated points make that uncertain
+      search.nearestKSearch(i, k + 1, indices, sqr_distances);
+
+      int* slot = slots.data() + static_cast<std::size_t>(i) * k;
+      int count = 0;
+      for (std::size_t j = 0; j < indices.size() && count < k; ++j)
+      {
+        if (indices[j] != i)
+          slot[count++] = indices[j];
+      }
+      counts[i] = count;
+    }
+  }
+
+  offsets_.resize(n_points + 1);
+  offsets_[0] = 0;
+  for (int i = 0; i < n_points; ++i)
+    offsets_[i + 1] = offsets_[i] + counts[i];
+
+  neighbors_.resize(offsets_.back());
+  for (int i = 0; i < n_points; ++i)
+  {
+    const int* slot = slots.data() + static_cast<std::size_t>(i) * k;
+    std::copy(slot, slot + counts[i], neighbors_.begin() + offsets_[i]);
+  }
+}
+
+void NeighborGraph::clear()
+{
+  offsets_.clear();
+  neighbors_.clear();
+}
+
+} /* namespace segmentation */
+} /* namespace godel_surface_detection */
@@ -0,0 +1,243 @@
+/*
+        Copyright 2016 Southwest Research Institute
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
+
+#include <segmentation/region_growing.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace
+{
+
+typedef std::vector<std::atomic<int> > Parents;
+
+// Roots always link under a lower numbered root, so a region's root is its lowest numbered point whatever order
+// the threads unite in
+int findRoot(Parents& parent, int x)
+{
+  while (true)
+  {
+    int p = parent[x].load();
+    if (p == x)
+      return x;
+
+    // Path halving; a failed exchange means another thread already shortened the path
+    const int gp = parent[p].load();
+    if (gp != p)
+      parent[x].compare_exchange_weak(p, gp);
+    x = gp;
+  }
+}
+
+void unite(Parents& parent, int a, int b)
+{
+  while (true)
+  {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b)
+      return;
+    if (a < b)
+      std::swap(a, b);
+
+    // Fails if 'a' stopped being a root since it was found, in which case look again
+    int expected = a;
+    if (parent[a].compare_exchange_strong(expected, b))
+      return;
+  }
+}
+
+void atomicMin(std::atomic<int>& value, int candidate)
+{
+  int current = value.load();
+  while (candidate < current && !value.compare_exchange_weak(current, candidate))
+  {
+  }
+}
+
+} // namespace
+
+namespace godel_surface_detection
+{
+namespace segmentation
+{
+
+std::vector<pcl::PointIndices> growRegions(const pcl::PointCloud<pcl::PointXYZRGB>& cloud,
+                                           const pcl::PointCloud<pcl::Normal>& normals,
+                                           const NeighborGraph& graph,
+                                           const RegionGrowingParameters& params)
+{
+  std::vector<pcl::PointIndices> clusters;
+  const int n_points = static_cast<int>(cloud.size());
+  if (n_points == 0 || normals.size() != cloud.size() || graph.size() != cloud.size())
+    return clusters;
+
+  const float cos_threshold = std::cos(params.smoothness_threshold);
+  const float residual_threshold = params.residual_threshold;
+
+  // Seeding: which points have a usable normal, and which may grow a region
+  std::vector<char> has_normal(n_points), core(n_points);
+  Parents parent(n_points);
+  #pragma omp parallel for
+  for (int i = 0; i < n_points; ++i)
+  {
+    const pcl::Normal& n = normals.points[i];
+    has_normal[i] = std::isfinite(n.normal_x) && std::isfinite(n.normal_y) && std::isfinite(n.normal_z);
+    core[i] = has_normal[i] && std::isfinite(n.curvature) && n.curvature <= params.curvature_threshold;
+    parent[i] = i;
+  }
+
+  // Sort key of the seeds; a point without a curvature is seeded last
+  auto curvature = [&](int i) {
+    const float c = normals.points[i].curvature;
+    return std::isfinite(c) ? c : std::numeric_limits<float>::infinity();
+  };
+
+  auto smooth = [&](int i, int j) {
+    return std::abs(normals.points[i].getNormalVector3fMap().dot(normals.points[j].getNormalVector3fMap())) >=
+           cos_threshold;
+  };
+
+  auto inResidual = [&](int i, int j) {
+    const Eigen::Vector3f delta = cloud.points[j].getVector3fMap() - cloud.points[i].getVector3fMap();
+    return std::abs(normals.points[i].getNormalVector3fMap().dot(delta)) <= residual_threshold;
+  };
+
+  // Merging: join smooth neighbors that both pass the curvature test, if they also pass the residual test
+  std::vector<std::atomic<char> > grows(n_points);
+  for (auto& g : grows)
+    g = 0;
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (int i = 0; i < n_points; ++i)
+  {
+    if (!core[i])
+      continue;
+
+    for (const int* it = graph.begin(i); it != graph.end(i); ++it)
+    {
+      const int j = *it;
+      if (core[j] && smooth(i, j) && inResidual(i, j))
+      {
+        unite(parent, i, j);
+        grows[i].store(1, std::memory_order_relaxed);
+        grows[j].store(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Attaching: every other point with a normal joins the region of the lowest numbered growing point that would
+  // have pulled it in, which covers points failing the curvature or the residual test
+  std::vector<std::atomic<int> > attach_to(n_points);
+  for (auto& a : attach_to)
+    a = n_points;
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (int i = 0; i < n_points; ++i)
+  {
+    if (!grows[i])
+      continue;
+
+    for (const int* it = graph.begin(i); it != graph.end(i); ++it)
+    {
+      const int j = *it;
+      if (has_normal[j] && !grows[j] && smooth(i, j))
+        atomicMin(attach_to[j], i);
+    }
+  }
+
+  // Labeling: a region is named by its root
+  std::vector<int> label(n_points);
+  #pragma omp parallel for
+  for (int i = 0; i < n_points; ++i)
+  {
+    if (grows[i])
+      label[i] = findRoot(parent, i);
+    else if (attach_to[i] < n_points)
+      label[i] = findRoot(parent, attach_to[i]);
+    else
+      label[i] = -1;
+  }
+
+  // Seeding the rest: pcl seeds the points that no region took in flattest first, and as none of them can grow a
+  // region, each takes in just its unlabeled smooth neighbors
+  std::vector<std::pair<float, int> > rest;
+  for (int i = 0; i < n_points; ++i)
+  {
+    if (has_normal[i] && label[i] < 0)
+      rest.emplace_back(curvature(i), i);
+  }
+  std::sort(rest.begin(), rest.end());
+
+  for (const auto& seed : rest)
+  {
+    const int i = seed.second;
+    if (label[i] >= 0)
+      continue;
+
+    label[i] = i;
+    for (const int* it = graph.begin(i); it != graph.end(i); ++it)
+    {
+      const int j = *it;
+      if (has_normal[j] && label[j] < 0 && smooth(i, j))
+        label[j] = i;
+    }
+  }
+
+  // Assembly: count the regions and find their flattest points
+  std::vector<std::size_t> size(n_points, 0);
+  std::vector<int> flattest(n_points, -1);
+  for (int i = 0; i < n_points; ++i)
+  {
+    const int l = label[i];
+    if (l < 0)
+      continue;
+    size[l]++;
+    if (flattest[l] < 0 || curvature(i) < curvature(flattest[l]))
+      flattest[l] = i;
+  }
+
+  std::vector<std::tuple<float, int, int> > order; // (curvature, point, region)
+  for (int l = 0; l < n_points; ++l)
+  {
+    if (size[l] > 0 && size[l] >= params.min_cluster_size && size[l] <= params.max_cluster_size)
+      order.emplace_back(curvature(flattest[l]), flattest[l], l);
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<int> cluster_of(n_points, -1);
+  clusters.resize(order.size());
+  for (std::size_t c = 0; c < order.size(); ++c)
+  {
+    const int l = std::get<2>(order[c]);
+    cluster_of[l] = static_cast<int>(c);
+    clusters[c].indices.reserve(size[l]);
+  }
+
+  for (int i = 0; i < n_points; ++i)
+  {
+    if (label[i] >= 0 && cluster_of[label[i]] >= 0)
+      clusters[cluster_of[label[i]]].indices.push_back(i);
+  }
+
+  return clusters;
+}
+
+} /* namespace segmentation */
+} /* namespace godel_surface_detection */
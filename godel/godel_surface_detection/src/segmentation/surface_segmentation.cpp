@@ -9,12 +9,15 @@
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/filters/project_inliers.h>
 #include <ros/io.h>
+#include <random>
 #include <thread>
+#include <unordered_map>
 
 static const double DOWNSAMPLING_LEAF = 0.005f;
 static const double EDGE_SEARCH_RADIUS = 0.01;
 static const double PLANE_INLIER_DISTANCE = 0.005;
 static const double PLANE_INLIER_THRESHOLD = 0.8;
+static const double RESIDUAL_THRESHOLD = 0.05; // pcl::RegionGrowing's default
 
 
 // Custom boundary estimation
@@ -63,6 +66,9 @@ void SurfaceSegmentation::setInputCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr i
   kd_tree_.reset(new pcl::search::KdTree<pcl::PointXYZ>());
   kd_tree_->setInputCloud(input_cloud_downsampled_);
 
+  // the search structures over the full cloud are built when first needed
+  resetSearch();
+
 }
 
 
@@ -89,7 +95,7 @@ void SurfaceSegmentation::getBoundaryCloud(pcl::PointCloud<pcl::Boundary>::Ptr &
     best.setInputCloud(input_cloud_);
     best.setInputNormals(normals_);
     best.setRadiusSearch (radius_);
-    best.setSearchMethod (pcl::search::KdTree<pcl::PointXYZRGB>::Ptr (new pcl::search::KdTree<pcl::PointXYZRGB>));
+    best.setSearchMethod (searchTree());
     best.compute(*boundary_cloud);
   }
 }
@@ -99,51 +105,37 @@ std::vector <pcl::PointIndices> SurfaceSegmentation::computeSegments(pcl::PointC
                                                                      &colored_cloud)
 {
   // Region growing
-  pcl::search::Search<pcl::PointXYZRGB>::Ptr tree =
-      boost::shared_ptr<pcl::search::Search<pcl::PointXYZRGB>> (new pcl::search::KdTree<pcl::PointXYZRGB>);
-  pcl::RegionGrowing<pcl::PointXYZRGB, pcl::Normal> rg;
-
-  rg.setSmoothModeFlag (true); // Depends on the cloud being processed
-  rg.setSmoothnessThreshold (0.035);
-  rg.setCurvatureThreshold(1.0);
-
-  rg.setMaxClusterSize(MAX_CLUSTER_SIZE);
-  rg.setSearchMethod (tree);
-  rg.setMinClusterSize(MIN_CLUSTER_SIZE);
-  rg.setNumberOfNeighbours (NUM_NEIGHBORS);
-
-  float resid_thresh = rg.getResidualThreshold();
-
-  rg.setResidualTestFlag(true);
-  rg.setResidualThreshold(resid_thresh);
-  rg.setInputCloud (input_cloud_);
-  rg.setInputNormals (normals_);
-
-  rg.extract (clusters_);
+  godel_surface_detection::segmentation::RegionGrowingParameters params;
+  params.smoothness_threshold = 0.035;
+  params.curvature_threshold = 1.0;
+  params.residual_threshold = RESIDUAL_THRESHOLD;
+  params.min_cluster_size = MIN_CLUSTER_SIZE;
+  params.max_cluster_size = MAX_CLUSTER_SIZE;
 
-  if (!clusters_.empty()) // Turns out getColoredCloud() returns a null ptr if it didn't segment any surfaces
-    colored_cloud = rg.getColoredCloud();
+  clusters_ = godel_surface_detection::segmentation::growRegions(*input_cloud_, *normals_, neighborGraph(), params);
 
-  return(clusters_);
-}
-
-
-std::pair<int, int> SurfaceSegmentation::getNextUnused(std::vector< std::pair<int,int> > used)
-{
-  std::pair<int,int> rtn;
-  rtn.first=-1;
-  rtn.second=-1;
-  for(int i=0;i<used.size();i++)
+  if (!clusters_.empty()) // colored_cloud is left untouched if no surfaces were segmented
   {
-    if(used[i].first == 0)
+    // Unsegmented points are white, each segment gets a color of its own
+    colored_cloud.reset(new pcl::PointCloud<pcl::PointXYZRGB>(*input_cloud_));
+    for (auto& pt : colored_cloud->points)
+      pt.r = pt.g = pt.b = 255;
+
+    std::default_random_engine random_engine(0);
+    std::uniform_int_distribution<int> color(0, 255);
+    for (const auto& cluster : clusters_)
     {
-      rtn = used[i];
-      used[i].first = 1;
-      break;
+      const uint8_t r = color(random_engine), g = color(random_engine), b = color(random_engine);
+      for (int idx : cluster.indices)
+      {
+        colored_cloud->points[idx].r = r;
+        colored_cloud->points[idx].g = g;
+        colored_cloud->points[idx].b = b;
+      }
     }
   }
 
-  return(rtn);
+  return(clusters_);
 }
 
 
@@ -152,75 +144,69 @@ int SurfaceSegmentation::sortBoundary(pcl::IndicesPtr& boundary_indices,
 {
   sorted_boundaries.clear();
 
-  /* initialize used pairs */
-  std::vector<std::pair<int,int> > used;
-  used.reserve(boundary_indices->size());
-  for(int i = 0; i < boundary_indices->size(); i++)
-  {
-    std::pair<int, int> p;
-    p.first = 0;
-    p.second = boundary_indices->at(i);
-    used.push_back(p);
-  }
+  const std::vector<int>& indices = *boundary_indices;
+  if (indices.empty())
+    return 0;
+
+  // Map each cloud index to its (first) position in the boundary list so that the points returned by a
+  // radius search can be looked up and marked in constant time. Only boundary points are keyed, so the
+  // cost of a call follows the size of the boundary rather than of the cloud.
+  std::unordered_map<int, int> position;
+  position.reserve(indices.size());
+  for (std::size_t i = 0; i < indices.size(); i++)
+    position.emplace(indices[i], static_cast<int>(i));
+
+  // Later copies of an index that is listed more than once are never walked
+  std::vector<bool> used(indices.size(), false);
+  for (std::size_t i = 0; i < indices.size(); i++)
+    used[i] = position[indices[i]] != static_cast<int>(i);
 
   pcl::KdTreeFLANN<pcl::PointXYZRGB> kdtree(true);// true indicates return sorted radius search results
   kdtree.setInputCloud(input_cloud_, boundary_indices); // use just the boundary points for searching
 
-  std::pair<int, int> n = getNextUnused(used);
-  while( n.first >= 0 )
+  std::vector<int> pt_indices;
+  std::vector<float> pt_dist;
+
+  // Points are only ever marked used, so the search for the start of the next boundary resumes where the
+  // previous one stopped
+  std::size_t next_start = 0;
+  while (true)
   {
-    // add first point to the current boundary
+    while (next_start < indices.size() && used[next_start])
+      next_start++;
+    if (next_start == indices.size())
+      break;
+
+    int current = indices[next_start];
+    used[next_start] = true;
+
     pcl::IndicesPtr current_boundary(new std::vector<int>);
-    current_boundary->push_back(n.second);
-
-    // find all points within small radius of current boundary point
-    std::vector<int> pt_indices;
-    std::vector<float> pt_dist;
-    pcl::PointXYZRGB spt = input_cloud_->points[n.second];
-
-    while ( kdtree.radiusSearch (spt, radius_, pt_indices, pt_dist) > 1 )
-    { // gives index into input_cloud_,
-      int q = 0;
-      int add_pt_idx = -1;
-      do
+    current_boundary->push_back(current);
+
+    // Walk to the closest unused point within the search radius until there is none. Whatever the walk
+    // leaves behind, e.g. past a gap or down the other side of a branch, starts a boundary of its own.
+    while (kdtree.radiusSearch(input_cloud_->points[current], radius_, pt_indices, pt_dist) > 1)
+    { // gives index into input_cloud_
+      int next = -1;
+      for (int idx : pt_indices)
       {
-        // find closest unused point in vicinity
-        int pair_index=0;
-
-        // for each item in used list
-        for(int i=0;i<used.size();i++)
+        const int p = position.find(idx)->second;
+        if (!used[p])
         {
-          // look for a match
-          if(pt_indices[q] == used[i].second)
-          {
-            // see if match is used
-            if(used[i].first ==0)
-            {
-              pair_index= i;
-              used[i].first = 1; // mark it used
-              add_pt_idx = used[i].second;
-            }// used
-            break;
-          }// match indices
+          used[p] = true;
+          next = idx;
+          break;
         }
+      }
 
-        q++;
-
-      } while (q < pt_indices.size() && add_pt_idx == -1); // unused point in the vicinity of the current spt?
+      if (next == -1)
+        break; /* end of boundary */
 
-      if(add_pt_idx !=-1)
-      {
-        current_boundary->push_back(add_pt_idx);
-        spt = input_cloud_->points[add_pt_idx]; // search near the new point next time
-      }
-      else
-      { // end if ad_pt_idx was found
-        break;		/* end of boundary */
-      }
-    }// there are points within the radius
+      current_boundary->push_back(next);
+      current = next; // search near the new point next time
+    }
 
     sorted_boundaries.push_back(current_boundary);
-    n = getNextUnused(used);
   }
 
   return(sorted_boundaries.size());
@@ -626,6 +612,33 @@ void SurfaceSegmentation::removeNans()
 {
   std::vector<int> indices;
   pcl::removeNaNFromPointCloud (*input_cloud_, *input_cloud_, indices);
+  resetSearch();
+}
+
+
+pcl::search::KdTree<pcl::PointXYZRGB>::Ptr SurfaceSegmentation::searchTree()
+{
+  if (!search_tree_)
+  {
+    search_tree_.reset(new pcl::search::KdTree<pcl::PointXYZRGB>());
+    search_tree_->setInputCloud(input_cloud_);
+  }
+  return search_tree_;
+}
+
+
+const godel_surface_detection::segmentation::NeighborGraph& SurfaceSegmentation::neighborGraph()
+{
+  if (neighbor_graph_.empty())
+    neighbor_graph_.build(*searchTree(), NUM_NEIGHBORS - 1);
+  return neighbor_graph_;
+}
+
+
+void SurfaceSegmentation::resetSearch()
+{
+  search_tree_.reset();
+  neighbor_graph_.clear();
 }
 
 
@@ -638,8 +651,7 @@ void SurfaceSegmentation::computeNormals()
 
   // Configure parameters
   ne.setInputCloud (input_cloud_);
-  pcl::search::KdTree<pcl::PointXYZRGB>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZRGB> ());
-  ne.setSearchMethod (tree);
+  ne.setSearchMethod (searchTree());
   ne.setRadiusSearch(0.025);
 //  ne.setKSearch (100);
 
@@ -4,11 +4,15 @@
 #include <pcl/point_types.h>
 #include <pcl_ros/point_cloud.h>
 #include <pluginlib/class_loader.h>
+#include <moveit_msgs/GetPlanningScene.h>
 #include <ros/node_handle.h>
+#include <ros/topic.h>
+#include <sensor_msgs/JointState.h>
 #include <services/surface_blending_service.h>
 #include <segmentation/surface_segmentation.h>
 #include <eigen_conversions/eigen_msg.h>
 #include <path_planning_plugins_base/path_planning_base.h>
+#include <utils/worker_pool.h>
 
 #include <swri_profiler/profiler.h>
 
@@ -43,6 +47,17 @@ const static int PATH_TYPE_EDGE = 2;
 
 const static std::string SURFACE_DESIGNATION = "surface_marker_server_";
 
+// The process planners start and end each plan at the robot position published here
+const static std::string JOINT_STATES_TOPIC = "joint_states";
+const static double JOINT_STATES_WAIT_TIME = 1.0; // seconds
+
+// They plan with the robot model and planning scene held by MoveIt, and with their own parameters
+const static std::string ROBOT_DESCRIPTION_PARAM = "robot_description";
+const static std::string ROBOT_DESCRIPTION_SEMANTIC_PARAM = "robot_description_semantic";
+const static std::string PROCESS_PLANNER_PARAMS = "/godel_process_planning";
+const static std::string GET_PLANNING_SCENE_SERVICE = "get_planning_scene";
+const static double GET_PLANNING_SCENE_WAIT_TIME = 1.0; // seconds
+
 const static std::string PARAM_BASE = "/process_planning_params/";
 const static std::string SCAN_PARAM_BASE = "scan_params/";
 const static std::string BLEND_PARAM_BASE = "blend_params/";
@@ -171,76 +186,114 @@ bool SurfaceBlendingService::generateEdgePath(godel_surface_detection::detection
 }
 
 
-bool
-SurfaceBlendingService::generateProcessPath(const int& id,
-                                            ProcessPathResult& result)
+/**
+ * Resources a thread needs to turn a surface into process plans: tool path planning plugins keep
+ * state between init() and generatePath(), and each worker uses its own planning service clients.
+ */
+struct SurfaceBlendingService::PlanningWorker
 {
-  using godel_surface_detection::detection::CloudRGB;
+  boost::shared_ptr<path_planning_plugins_base::PathPlanningBase> blend_planner;
+  boost::shared_ptr<path_planning_plugins_base::PathPlanningBase> scan_planner;
+  ros::ServiceClient blend_client;
+  ros::ServiceClient keyence_client;
+};
+
+/**
+ * @brief Computes the planning cache context from the robot model, the planning scene and the process planner
+ * parameters
+ * @return False if the planning scene could not be retrieved
+ */
+static bool getPlanningContext(ros::NodeHandle& nh, godel_surface_detection::PlanningCache::Key& context)
+{
+  std::string urdf, srdf;
+  nh.getParam(ROBOT_DESCRIPTION_PARAM, urdf);
+  nh.getParam(ROBOT_DESCRIPTION_SEMANTIC_PARAM, srdf);
+
+  XmlRpc::XmlRpcValue planner_params;
+  std::string planner_xml;
+  if (nh.getParam(PROCESS_PLANNER_PARAMS, planner_params))
+    planner_xml = planner_params.toXml();
+
+  moveit_msgs::GetPlanningScene srv;
+  srv.request.components.components = moveit_msgs::PlanningSceneComponents::WORLD_OBJECT_GEOMETRY |
+                                      moveit_msgs::PlanningSceneComponents::ALLOWED_COLLISION_MATRIX;
+  ros::ServiceClient client = nh.serviceClient<moveit_msgs::GetPlanningScene>(GET_PLANNING_SCENE_SERVICE);
+  if (!client.waitForExistence(ros::Duration(GET_PLANNING_SCENE_WAIT_TIME)) || !client.call(srv))
+    return false;
 
-  std::string name;
-  pcl::PolygonMesh mesh;
-  CloudRGB::Ptr surface_ptr (new CloudRGB);
+  // Only the objects count, not when they were last stamped
+  for (auto& object : srv.response.scene.world.collision_objects)
+    object.header.stamp = ros::Time();
 
-  data_coordinator_.getSurfaceName(id, name);
-  data_coordinator_.getSurfaceMesh(id, mesh);
-  data_coordinator_.getCloud(godel_surface_detection::data::CloudTypes::surface_cloud, id, *surface_ptr);
-  return generateProcessPath(id, name, mesh, surface_ptr, result);
+  context = godel_surface_detection::PlanningCache::makeContext(urdf, srdf, srv.response.scene, planner_xml);
+  return true;
 }
 
-static bool generateToolPaths(const godel_msgs::PathPlanningParameters& params,
-                              const pcl::PolygonMesh& mesh,
-                              const std::string& plugin_name,
-                              std::vector<geometry_msgs::PoseArray>& result)
+/**
+ * @brief Fills in the plan of 'srv' from 'cache' if its path and parameters were planned before from
+ * 'start_state', and otherwise calls the planning service behind 'client' and caches the result
+ */
+template <typename Service>
+static bool callPlanningService(ros::ServiceClient& client, godel_surface_detection::PlanningCache& cache,
+                                const std::vector<double>& start_state, Service& srv)
 {
-  pluginlib::ClassLoader<path_planning_plugins_base::PathPlanningBase>
-      loader("path_planning_plugins_base", "path_planning_plugins_base::PathPlanningBase");
-  auto planner = loader.createInstance(plugin_name);
-  planner->init(mesh);
-  return planner->generatePath(result);
+  using godel_surface_detection::PlanningCache;
+  const PlanningCache::Key key =
+      PlanningCache::makeKey(client.getService(), srv.request.path.segments, srv.request.params);
+
+  if (cache.lookup(key, start_state, srv.response.plan))
+  {
+    // Stamped as if it had just been planned
+    const ros::Time now = ros::Time::now();
+    srv.response.plan.trajectory_approach.header.stamp = now;
+    srv.response.plan.trajectory_process.header.stamp = now;
+    srv.response.plan.trajectory_depart.header.stamp = now;
+    return true;
+  }
+
+  if (!client.call(srv))
+    return false;
+
+  cache.insert(key, start_state, srv.response.plan);
+  return true;
 }
 
-bool SurfaceBlendingService::generateBlendPath(const godel_msgs::PathPlanningParameters &params,
+bool SurfaceBlendingService::generateBlendPath(path_planning_plugins_base::PathPlanningBase& planner,
                                                const pcl::PolygonMesh &mesh, std::vector<geometry_msgs::PoseArray> &result)
 {
   SWRI_PROFILE("gen-blend-path");
-  try
+  planner.init(mesh);
+  if (!planner.generatePath(result))
   {
-    if (!generateToolPaths(params, mesh, getBlendToolPlanningPluginName(), result))
-    {
-      ROS_ERROR("Failed to generate tool paths for blend process");
-      return false;
-    }
-  }
-  catch(const pluginlib::PluginlibException& ex)
-  {
-    ROS_ERROR("Blending tool planning plugin loading failed with error: '%s'", ex.what());
+    ROS_ERROR("Failed to generate tool paths for blend process");
     return false;
   }
   return true;
 }
 
-bool SurfaceBlendingService::generateScanPath(const godel_msgs::PathPlanningParameters &params, const pcl::PolygonMesh &mesh,
+bool SurfaceBlendingService::generateScanPath(path_planning_plugins_base::PathPlanningBase& planner,
+                                              const pcl::PolygonMesh &mesh,
                                               std::vector<geometry_msgs::PoseArray> &result)
 {
   SWRI_PROFILE("gen-scan-path");
-  try
+  planner.init(mesh);
+  if (!planner.generatePath(result))
   {
-    if (!generateToolPaths(params, mesh, getScanToolPlanningPluginName(), result))
-    {
-      ROS_ERROR("Failed to generate tool paths for scan process");
-      return false;
-    }
-  }
-  catch(const pluginlib::PluginlibException& ex)
-  {
-    ROS_ERROR("Scan tool planning plugin loading failed with error: '%s'", ex.what());
+    ROS_ERROR("Failed to generate tool paths for scan process");
     return false;
   }
   return true;
 }
 
+void SurfaceBlendingService::publishPlanningFeedback(const std::string& message)
+{
+  std::lock_guard<std::mutex> lock(process_planning_feedback_mutex_);
+  process_planning_feedback_.last_completed = message;
+  process_planning_server_.publishFeedback(process_planning_feedback_);
+}
+
 bool
-SurfaceBlendingService::generateProcessPath(const int& id,
+SurfaceBlendingService::generateProcessPath(PlanningWorker& worker,
                                             const std::string& name,
                                             const pcl::PolygonMesh& mesh,
                                             godel_surface_detection::detection::CloudRGB::Ptr surface,
@@ -250,54 +303,45 @@ SurfaceBlendingService::generateProcessPath(const int& id,
   std::vector<geometry_msgs::PoseArray> blend_result, edge_result, scan_result;
 
   // Step 1: Generate Blending Paths
-  godel_msgs::PathPlanningParameters params;
-  if (!generateBlendPath(params, mesh, blend_result))
+  if (!generateBlendPath(*worker.blend_planner, mesh, blend_result))
   {
-    process_planning_feedback_.last_completed = "Failed to generate blend path for surface " + name;
-    process_planning_server_.publishFeedback(process_planning_feedback_);
+    publishPlanningFeedback("Failed to generate blend path for surface " + name);
   }
   else
   {
-    process_planning_feedback_.last_completed = "Generated blend path for surface " + name;
-    process_planning_server_.publishFeedback(process_planning_feedback_);
+    publishPlanningFeedback("Generated blend path for surface " + name);
 
     // Add the successful blend path to the output
     ProcessPathResult::value_type vt;
     vt.first = name + "_blend";
     vt.second = blend_result;
     result.paths.push_back(vt);
-    data_coordinator_.setPoses(godel_surface_detection::data::PoseTypes::blend_pose, id, vt.second);
   }
 
   // Step 2: Generate Laser Scan Paths
-  if (!generateScanPath(params, mesh, scan_result))
+  if (!generateScanPath(*worker.scan_planner, mesh, scan_result))
   {
-    process_planning_feedback_.last_completed = "Failed to generate scan path for surface " + name;
-    process_planning_server_.publishFeedback(process_planning_feedback_);
+    publishPlanningFeedback("Failed to generate scan path for surface " + name);
   }
   else
   {
-    process_planning_feedback_.last_completed = "Generated scan path for surface " + name;
-    process_planning_server_.publishFeedback(process_planning_feedback_);
+    publishPlanningFeedback("Generated scan path for surface " + name);
 
     // Add the successful scan path to the output
     ProcessPathResult::value_type vt;
     vt.first = name + "_scan";
     vt.second = scan_result;
     result.paths.push_back(vt);
-    data_coordinator_.setPoses(godel_surface_detection::data::PoseTypes::scan_pose, id, vt.second);
   }
 
   // Step 3: Generate Edge Paths for the given surface
   if (!generateEdgePath(surface, edge_result))
   {
-    process_planning_feedback_.last_completed = "Failed to generate generate edge path(s) for surface " + name;
-    process_planning_server_.publishFeedback(process_planning_feedback_);
+    publishPlanningFeedback("Failed to generate generate edge path(s) for surface " + name);
   }
   else
   {
-    process_planning_feedback_.last_completed = "Generated edge path(s) for surface " + name;
-    process_planning_server_.publishFeedback(process_planning_feedback_);
+    publishPlanningFeedback("Generated edge path(s) for surface " + name);
 
     // Add the edge paths to the results
     ProcessPathResult::value_type vt;
@@ -309,7 +353,6 @@ SurfaceBlendingService::generateProcessPath(const int& id,
       temp.push_back(pose_array);
       vt.second = std::move(temp);
       result.paths.push_back(vt);
-      data_coordinator_.addEdge(id, vt.first, pose_array);
     }
   }
 
@@ -320,6 +363,8 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
     const godel_msgs::PathPlanningParameters& params)
 {
   SWRI_PROFILE("generate-motion-library");
+  using godel_surface_detection::detection::CloudRGB;
+
   std::vector<int> selected_ids;
   surface_server_.getSelectedIds(selected_ids);
 
@@ -329,74 +374,145 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
   process_path_results_.edge_poses_.clear();
   process_path_results_.scan_poses_.clear();
 
-  for (const auto& id : selected_ids)
+  ros::NodeHandle nh;
+
+  godel_msgs::BlendingPlanParameters blend_params;
+  blend_params.margin = params.margin;
+  blend_params.overlap = params.overlap;
+  blend_params.tool_radius = params.tool_radius;
+  blend_params.discretization = params.discretization;
+  blend_params.safe_traverse_height = params.traverse_height;
+  nh.getParam(SPINDLE_SPEED_PARAM, blend_params.spindle_speed);
+  nh.getParam(APPROACH_SPD_PARAM, blend_params.approach_spd);
+  nh.getParam(BLENDING_SPD_PARAM, blend_params.blending_spd);
+  nh.getParam(RETRACT_SPD_PARAM, blend_params.retract_spd);
+  nh.getParam(TRAVERSE_SPD_PARAM, blend_params.traverse_spd);
+  nh.getParam(Z_ADJUST_PARAM, blend_params.z_adjust);
+
+  godel_msgs::ScanPlanParameters scan_params;
+  scan_params.scan_width = params.scan_width;
+  scan_params.margin = params.margin;
+  scan_params.overlap = params.overlap;
+  scan_params.scan_width = params.scan_width;
+  nh.getParam(APPROACH_DISTANCE_PARAM, scan_params.approach_distance);
+  nh.getParam(TRAVERSE_SPD_PARAM, scan_params.traverse_spd);
+  nh.getParam(QUALITY_METRIC_PARAM, scan_params.quality_metric);
+  nh.getParam(WINDOW_WIDTH_PARAM, scan_params.window_width);
+  nh.getParam(MIN_QA_VALUE_PARAM, scan_params.min_qa_value);
+  nh.getParam(MAX_QA_VALUE_PARAM, scan_params.min_qa_value);
+//  nh.getParam(Z_ADJUST_PARAM, scan_params.z_adjust);
+  scan_params.z_adjust = 0.0; // Until we fix these parameters and do not share them among the
+                              // different processes, I'm only applying this to blend paths.
+
+  // Plans are reused for paths planned before from the same position in the same context; without either every
+  // path is planned
+  std::vector<double> start_state;
+  godel_surface_detection::PlanningCache::Key context;
+  sensor_msgs::JointStateConstPtr joint_state =
+      ros::topic::waitForMessage<sensor_msgs::JointState>(JOINT_STATES_TOPIC, ros::Duration(JOINT_STATES_WAIT_TIME));
+  if (!joint_state)
+    ROS_WARN("No joint state received, not using the planning cache");
+  else if (!getPlanningContext(nh, context))
+    ROS_WARN("No planning scene received, not using the planning cache");
+  else
   {
+    start_state = joint_state->position;
+    planning_cache_.setContext(context);
+
+    // The file can only be checked against the context once it is known
+    if (!planning_cache_loaded_ && !planning_cache_file_.empty() && !planning_cache_.load(planning_cache_file_))
+      ROS_WARN_STREAM("Unable to load the planning cache from " << planning_cache_file_);
+    planning_cache_loaded_ = true;
+  }
+
+  // The data coordinator is not thread-safe: read every surface up front and write the results back
+  // once the workers are done
+  const std::size_t n_surfaces = selected_ids.size();
+  std::vector<std::string> names (n_surfaces);
+  std::vector<pcl::PolygonMesh> meshes (n_surfaces);
+  std::vector<CloudRGB::Ptr> surfaces (n_surfaces);
+  for (std::size_t i = 0; i < n_surfaces; ++i)
+  {
+    surfaces[i].reset(new CloudRGB);
+    data_coordinator_.getSurfaceName(selected_ids[i], names[i]);
+    data_coordinator_.getSurfaceMesh(selected_ids[i], meshes[i]);
+    data_coordinator_.getCloud(godel_surface_detection::data::CloudTypes::surface_cloud, selected_ids[i],
+                               *surfaces[i]);
+  }
+
+  const std::size_t n_workers = std::min(worker_count_, std::max<std::size_t>(n_surfaces, 1));
+  // The loader must outlive the plugin instances it creates
+  pluginlib::ClassLoader<path_planning_plugins_base::PathPlanningBase>
+      loader("path_planning_plugins_base", "path_planning_plugins_base::PathPlanningBase");
+  std::vector<PlanningWorker> workers (n_workers);
+  try
+  {
+    for (std::size_t w = 0; w < n_workers; ++w)
+    {
+      workers[w].blend_planner = loader.createInstance(getBlendToolPlanningPluginName());
+      workers[w].scan_planner = loader.createInstance(getScanToolPlanningPluginName());
+      workers[w].blend_client = blend_planning_clients_[w];
+      workers[w].keyence_client = keyence_planning_clients_[w];
+    }
+  }
+  catch(const pluginlib::PluginlibException& ex)
+  {
+    ROS_ERROR("Tool planning plugin loading failed with error: '%s'", ex.what());
+    return lib;
+  }
+
+  // Each surface is turned into paths and planned by a single worker; results are kept per surface
+  std::vector<ProcessPathResult> paths (n_surfaces);
+  std::vector<std::vector<ProcessPlanResult>> plans (n_surfaces);
+  godel_surface_detection::runTasks(n_surfaces, n_workers, [&](std::size_t i, std::size_t w) {
     // Generate motion plan
-    ProcessPathResult paths;
-    generateProcessPath(id, paths);
+    generateProcessPath(workers[w], names[i], meshes[i], surfaces[i], paths[i]);
 
-    // If planning failed entirely, skip to next
-    if(paths.paths.size() == 0)
-      continue;
+    // Generate trajectory plans from motion plan
+    SWRI_PROFILE("motion-planning");
+    for (const auto& vt : paths[i].paths)
+      plans[i].push_back(generateProcessPlan(workers[w], vt.first, vt.second, blend_params, scan_params,
+                                             start_state));
+  });
+
+  ROS_INFO("Planning cache: %lu hits, %lu misses, %lu entries", planning_cache_.hits(), planning_cache_.misses(),
+           planning_cache_.size());
+  if (planning_cache_loaded_ && !planning_cache_file_.empty() && !planning_cache_.save(planning_cache_file_))
+    ROS_WARN_STREAM("Unable to save the planning cache to " << planning_cache_file_);
+
+  // Merge in selection order so that the library does not depend on the schedule
+  for (std::size_t i = 0; i < n_surfaces; ++i)
+  {
+    const int id = selected_ids[i];
 
     // Add new path to result
-    for(const auto& vt: paths.paths)
+    for(const auto& vt: paths[i].paths)
     {
       if(isBlendingPath(vt.first))
+      {
         process_path_results_.blend_poses_.push_back(vt.second);
+        data_coordinator_.setPoses(godel_surface_detection::data::PoseTypes::blend_pose, id, vt.second);
+      }
 
       else if(isEdgePath(vt.first))
+      {
         process_path_results_.edge_poses_.push_back(vt.second.front());
+        data_coordinator_.addEdge(id, vt.first, vt.second.front());
+      }
 
       else if(isScanPath(vt.first))
+      {
         process_path_results_.scan_poses_.push_back(vt.second);
+        data_coordinator_.setPoses(godel_surface_detection::data::PoseTypes::scan_pose, id, vt.second);
+      }
 
       else
         ROS_ERROR_STREAM("Tried to process an unrecognized path type: " << vt.first);
     }
 
-    ros::NodeHandle nh;
-
-    godel_msgs::BlendingPlanParameters blend_params;
-    blend_params.margin = params.margin;
-    blend_params.overlap = params.overlap;
-    blend_params.tool_radius = params.tool_radius;
-    blend_params.discretization = params.discretization;
-    blend_params.safe_traverse_height = params.traverse_height;
-    nh.getParam(SPINDLE_SPEED_PARAM, blend_params.spindle_speed);
-    nh.getParam(APPROACH_SPD_PARAM, blend_params.approach_spd);
-    nh.getParam(BLENDING_SPD_PARAM, blend_params.blending_spd);
-    nh.getParam(RETRACT_SPD_PARAM, blend_params.retract_spd);
-    nh.getParam(TRAVERSE_SPD_PARAM, blend_params.traverse_spd);
-    nh.getParam(Z_ADJUST_PARAM, blend_params.z_adjust);
-
-    godel_msgs::ScanPlanParameters scan_params;
-    scan_params.scan_width = params.scan_width;
-    scan_params.margin = params.margin;
-    scan_params.overlap = params.overlap;
-    scan_params.scan_width = params.scan_width;
-    nh.getParam(APPROACH_DISTANCE_PARAM, scan_params.approach_distance);
-    nh.getParam(TRAVERSE_SPD_PARAM, scan_params.traverse_spd);
-    nh.getParam(QUALITY_METRIC_PARAM, scan_params.quality_metric);
-    nh.getParam(WINDOW_WIDTH_PARAM, scan_params.window_width);
-    nh.getParam(MIN_QA_VALUE_PARAM, scan_params.min_qa_value);
-    nh.getParam(MAX_QA_VALUE_PARAM, scan_params.min_qa_value);
-//    nh.getParam(Z_ADJUST_PARAM, scan_params.z_adjust);
-    scan_params.z_adjust = 0.0; // Until we fix these parameters and do not share them among the
-                                // different processes, I'm only applying this to blend paths.
-
-    // Generate trajectory plans from motion plan
-    {
-      SWRI_PROFILE("motion-planning");
-      for (std::size_t j = 0; j < paths.paths.size(); ++j)
-      {
-        ProcessPlanResult plan = generateProcessPlan(paths.paths[j].first, paths.paths[j].second, blend_params,
-                                                     scan_params);
-
-        for (std::size_t k = 0; k < plan.plans.size(); ++k)
-          lib.get()[plan.plans[k].first] = plan.plans[k].second;
-      }
-    }
+    for (const auto& plan : plans[i])
+      for (std::size_t k = 0; k < plan.plans.size(); ++k)
+        lib.get()[plan.plans[k].first] = plan.plans[k].second;
   }
 
   return lib;
@@ -404,10 +520,12 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
 
 
 ProcessPlanResult
-SurfaceBlendingService::generateProcessPlan(const std::string& name,
+SurfaceBlendingService::generateProcessPlan(PlanningWorker& worker,
+                                            const std::string& name,
                                             const std::vector<geometry_msgs::PoseArray>& poses,
                                             const godel_msgs::BlendingPlanParameters& params,
-                                            const godel_msgs::ScanPlanParameters& scan_params)
+                                            const godel_msgs::ScanPlanParameters& scan_params,
+                                            const std::vector<double>& start_state)
 {
   ProcessPlanResult result;
 
@@ -421,7 +539,7 @@ SurfaceBlendingService::generateProcessPlan(const std::string& name,
     srv.request.path.segments = poses;
     srv.request.params = params;
 
-    success = blend_planning_client_.call(srv);
+    success = callPlanningService(worker.blend_client, planning_cache_, start_state, srv);
     process_plan = srv.response.plan;
   }
   else if (isEdgePath(name))
@@ -430,7 +548,7 @@ SurfaceBlendingService::generateProcessPlan(const std::string& name,
     srv.request.path.segments = poses;
     srv.request.params = params;
 
-    success = blend_planning_client_.call(srv);
+    success = callPlanningService(worker.blend_client, planning_cache_, start_state, srv);
     process_plan = srv.response.plan;
   }
   else
@@ -439,7 +557,7 @@ SurfaceBlendingService::generateProcessPlan(const std::string& name,
     srv.request.path.segments = poses;
     srv.request.params = scan_params;
 
-    success = keyence_planning_client_.call(srv);
+    success = callPlanningService(worker.keyence_client, planning_cache_, start_state, srv);
     process_plan = srv.response.plan;
   }
 
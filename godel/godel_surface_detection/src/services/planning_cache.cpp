@@ -0,0 +1,274 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2016, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/planning_cache.h"
+
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+
+#include <ros/console.h>
+
+namespace
+{
+// File layout: MAGIC, uint64 context, uint32 entry count, then per entry the uint64 key, uint32 joint count,
+// the start state doubles, uint32 plan size and the plan in ROS serialization
+const char MAGIC[8] = {'G', 'O', 'D', 'E', 'L', 'P', 'C', '2'};
+// Size of an entry without a start state or plan
+const std::size_t MIN_ENTRY_SIZE = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+template <typename T>
+void writeValue(std::ofstream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool withinTolerance(const std::vector<double>& a, const std::vector<double>& b, double tolerance)
+{
+  if (a.empty() || a.size() != b.size())
+    return false;
+
+  for (std::size_t i = 0; i < a.size(); ++i)
+  {
+    if (std::abs(a[i] - b[i]) > tolerance)
+      return false;
+  }
+  return true;
+}
+}
+
+const double godel_surface_detection::PlanningCache::JOINT_TOLERANCE = 1e-4;
+
+godel_surface_detection::PlanningCache::PlanningCache(std::size_t capacity)
+  : capacity_(capacity), context_(0), hits_(0), misses_(0)
+{
+}
+
+void godel_surface_detection::PlanningCache::setContext(Key context)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (context == context_)
+    return;
+
+  context_ = context;
+  entries_.clear();
+  order_.clear();
+}
+
+godel_surface_detection::PlanningCache::Key godel_surface_detection::PlanningCache::context() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return context_;
+}
+
+bool godel_surface_detection::PlanningCache::lookup(Key key, const std::vector<double>& start_state,
+                                                    godel_msgs::ProcessPlan& plan)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = entries_.find(key);
+  if (it == entries_.end() || !withinTolerance(it->second.start_state, start_state, JOINT_TOLERANCE))
+  {
+    ++misses_;
+    return false;
+  }
+
+  ++hits_;
+  plan = it->second.plan;
+  return true;
+}
+
+void godel_surface_detection::PlanningCache::insert(Key key, const std::vector<double>& start_state,
+                                                    const godel_msgs::ProcessPlan& plan)
+{
+  if (start_state.empty())
+    return;
+
+  Entry entry;
+  entry.start_state = start_state;
+  entry.plan = plan;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  insertLocked(key, entry);
+}
+
+void godel_surface_detection::PlanningCache::insertLocked(Key key, const Entry& entry)
+{
+  if (capacity_ == 0)
+    return;
+
+  auto it = entries_.find(key);
+  if (it != entries_.end())
+  {
+    it->second = entry;
+    return;
+  }
+
+  if (entries_.size() == capacity_)
+  {
+    entries_.erase(order_.front());
+    order_.pop_front();
+  }
+
+  entries_[key] = entry;
+  order_.push_back(key);
+}
+
+void godel_surface_detection::PlanningCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  order_.clear();
+}
+
+std::size_t godel_surface_detection::PlanningCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t godel_surface_detection::PlanningCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+std::size_t godel_surface_detection::PlanningCache::misses() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+bool godel_surface_detection::PlanningCache::load(const std::string& filename)
+{
+  std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate);
+  if (!in)
+    return false;
+
+  // Every count read from the file is checked against what is left of it before anything is allocated
+  const std::streamoff file_size = in.tellg();
+  in.seekg(0);
+  auto fits = [&](uint64_t count, std::size_t size) {
+    const std::streamoff pos = in.tellg();
+    return pos >= 0 && pos <= file_size && count <= static_cast<uint64_t>(file_size - pos) / size;
+  };
+
+  char magic[sizeof(MAGIC)];
+  Key file_context;
+  uint32_t n_entries;
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !readValue(in, file_context) || !readValue(in, n_entries) || !fits(n_entries, MIN_ENTRY_SIZE))
+  {
+    ROS_WARN_STREAM("Planning cache " << filename << " is not in the expected format");
+    return false;
+  }
+
+  if (file_context != context())
+  {
+    ROS_INFO_STREAM("Planning cache " << filename << " was saved for another robot model, planning scene or "
+                                                    "planner parameters, ignoring it");
+    return true;
+  }
+
+  // Read one entry at a time, keeping only the newest 'capacity_': inserting the others would evict them
+  std::deque<std::pair<Key, Entry> > loaded;
+  std::vector<uint8_t> buffer;
+  for (uint32_t i = 0; i < n_entries; ++i)
+  {
+    Key key;
+    Entry entry;
+    uint32_t n_joints, plan_size;
+    if (!readValue(in, key) || !readValue(in, n_joints) || !fits(n_joints, sizeof(double)))
+    {
+      ROS_WARN_STREAM("Planning cache " << filename << " is truncated");
+      return false;
+    }
+
+    entry.start_state.resize(n_joints);
+    if (!in.read(reinterpret_cast<char*>(entry.start_state.data()), n_joints * sizeof(double)) ||
+        !readValue(in, plan_size) || !fits(plan_size, 1))
+    {
+      ROS_WARN_STREAM("Planning cache " << filename << " is truncated");
+      return false;
+    }
+
+    buffer.resize(plan_size);
+    if (!in.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+      return false;
+
+    try
+    {
+      ros::serialization::IStream stream(buffer.data(), buffer.size());
+      ros::serialization::deserialize(stream, entry.plan);
+    }
+    catch (const ros::serialization::StreamOverrunException& e)
+    {
+      ROS_WARN_STREAM("Planning cache " << filename << " is corrupt: " << e.what());
+      return false;
+    }
+
+    if (capacity_ == 0)
+      continue;
+    if (loaded.size() == capacity_)
+      loaded.pop_front();
+    loaded.push_back(std::make_pair(key, entry));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& item : loaded)
+    insertLocked(item.first, item.second);
+  return true;
+}
+
+bool godel_surface_detection::PlanningCache::save(const std::string& filename) const
+{
+  std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out)
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  out.write(MAGIC, sizeof(MAGIC));
+  writeValue(out, context_);
+  writeValue(out, static_cast<uint32_t>(order_.size()));
+
+  // Oldest first, so that loading the file restores the eviction order
+  std::vector<uint8_t> buffer;
+  for (Key key : order_)
+  {
+    const Entry& entry = entries_.find(key)->second;
+    writeValue(out, key);
+    writeValue(out, static_cast<uint32_t>(entry.start_state.size()));
+    out.write(reinterpret_cast<const char*>(entry.start_state.data()), entry.start_state.size() * sizeof(double));
+
+    buffer.resize(ros::serialization::serializationLength(entry.plan));
+    ros::serialization::OStream stream(buffer.data(), buffer.size());
+    ros::serialization::serialize(stream, entry.plan);
+    writeValue(out, static_cast<uint32_t>(buffer.size()));
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  }
+
+  return static_cast<bool>(out.flush());
+}
@@ -10,6 +10,9 @@
 
 #include <godel_param_helpers/godel_param_helpers.h>
 #include <godel_utils/ensenso_guard.h>
+#include <utils/worker_pool.h>
+
+#include <boost/filesystem.hpp>
 
 // topics and services
 const static std::string SAVE_DATA_BOOL_PARAM = "save_data";
@@ -60,6 +63,8 @@ const static std::string PATH_PLANNING_PARAMS_FILE = "godel_path_planning_parame
 const static std::string BLEND_TOOL_PLUGIN_PARAM = "blend_tool_planning_plugin_name";
 const static std::string SCAN_TOOL_PLUGIN_PARAM = "scan_tool_planning_plugin_name";
 const static std::string MESHING_PLUGIN_PARAM = "meshing_plugin_name";
+const static std::string WORKER_THREADS_PARAM = "worker_threads";
+const static std::string PLANNING_CACHE_FILE_PARAM = "planning_cache_file";
 
 // action server name
 const static std::string BLEND_EXE_ACTION_SERVER_NAME = "blend_process_execution_as";
@@ -69,6 +74,7 @@ const static std::string SELECT_MOTION_PLAN_ACTION_SERVER_NAME = "select_motion_
 const static int PROCESS_EXE_BUFFER = 5;  // Additional time [s] buffer between when blending should end and timeout
 
 SurfaceBlendingService::SurfaceBlendingService() : publish_region_point_cloud_(false), save_data_(false),
+  worker_count_(1), planning_cache_loaded_(false),
   blend_exe_client_(BLEND_EXE_ACTION_SERVER_NAME, true),
   scan_exe_client_(SCAN_EXE_ACTION_SERVER_NAME, true),
   process_planning_server_(nh_, PROCESS_PLANNING_ACTION_SERVER_NAME,
@@ -88,6 +94,15 @@ bool SurfaceBlendingService::init()
   ph.getParam(SAVE_DATA_BOOL_PARAM, save_data_);
   ph.getParam(SAVE_LOCATION_PARAM, save_location_);
 
+  // Surfaces are meshed, turned into paths and planned on this many threads; 0 uses every core
+  int worker_threads;
+  ph.param<int>(WORKER_THREADS_PARAM, worker_threads, 1);
+  worker_count_ = resolveWorkerCount(worker_threads);
+  surface_detection_.setWorkerCount(worker_count_);
+
+  // Plans are kept across restarts if a file is given; it is loaded by the first planning run
+  ph.param<std::string>(PLANNING_CACHE_FILE_PARAM, planning_cache_file_, "");
+
   // Load the 'prefix' that will be combined with parameters msg base names to save to disk
   ph.param<std::string>("param_cache_prefix", param_cache_prefix_, "");
 
@@ -157,8 +172,13 @@ bool SurfaceBlendingService::init()
   process_path_client_ = nh_.serviceClient<godel_msgs::PathPlanning>(PATH_GENERATION_SERVICE);
 
   // Process Execution Parameters
-  blend_planning_client_ = nh_.serviceClient<godel_msgs::BlendProcessPlanning>(BLEND_PROCESS_PLANNING_SERVICE);
-  keyence_planning_client_ = nh_.serviceClient<godel_msgs::KeyenceProcessPlanning>(SCAN_PROCESS_PLANNING_SERVICE);
+  for (std::size_t i = 0; i < worker_count_; ++i)
+  {
+    blend_planning_clients_.push_back(
+        nh_.serviceClient<godel_msgs::BlendProcessPlanning>(BLEND_PROCESS_PLANNING_SERVICE));
+    keyence_planning_clients_.push_back(
+        nh_.serviceClient<godel_msgs::KeyenceProcessPlanning>(SCAN_PROCESS_PLANNING_SERVICE));
+  }
 
   // service servers
   surf_blend_parameters_server_ =
@@ -688,8 +708,18 @@ void SurfaceBlendingService::selectMotionPlansActionCallback(const godel_msgs::S
 {
   godel_msgs::SelectMotionPlanResult res;
 
-  // If plan does not exist, abort and return
-  if (trajectory_library_.get().find(goal_in->name) == trajectory_library_.get().end())
+  // If plan does not exist, abort and return. Plans loaded from a file are decoded here, on first use.
+  const godel_msgs::ProcessPlan* plan = NULL;
+  try
+  {
+    plan = trajectory_library_.find(goal_in->name);
+  }
+  catch (const std::runtime_error& e)
+  {
+    ROS_ERROR_STREAM("Could not read motion plan " << goal_in->name << ": " << e.what());
+  }
+
+  if (!plan)
   {
     ROS_WARN_STREAM("Motion plan " << goal_in->name << " does not exist. Cannot execute.");
     res.code = godel_msgs::SelectMotionPlanResponse::NO_SUCH_NAME;
@@ -697,13 +727,13 @@ void SurfaceBlendingService::selectMotionPlansActionCallback(const godel_msgs::S
     return;
   }
 
-  bool is_blend = trajectory_library_.get()[goal_in->name].type == godel_msgs::ProcessPlan::BLEND_TYPE;
+  bool is_blend = plan->type == godel_msgs::ProcessPlan::BLEND_TYPE;
 
   // Send command to execution server
   godel_msgs::ProcessExecutionActionGoal goal;
-  goal.goal.trajectory_approach = trajectory_library_.get()[goal_in->name].trajectory_approach;
-  goal.goal.trajectory_depart = trajectory_library_.get()[goal_in->name].trajectory_depart;
-  goal.goal.trajectory_process = trajectory_library_.get()[goal_in->name].trajectory_process;
+  goal.goal.trajectory_approach = plan->trajectory_approach;
+  goal.goal.trajectory_depart = plan->trajectory_depart;
+  goal.goal.trajectory_process = plan->trajectory_process;
   goal.goal.wait_for_execution = goal_in->wait_for_execution;
   goal.goal.simulate = goal_in->simulate;
 
@@ -730,11 +760,8 @@ bool SurfaceBlendingService::getMotionPlansCallback(
     godel_msgs::GetAvailableMotionPlans::Request&,
     godel_msgs::GetAvailableMotionPlans::Response& res)
 {
-  typedef godel_surface_detection::TrajectoryLibrary::TrajectoryMap::const_iterator MapIter;
-  for (MapIter it = trajectory_library_.get().begin(); it != trajectory_library_.get().end(); ++it)
-  {
-    res.names.push_back(it->first);
-  }
+  // Listing the plans does not decode them
+  res.names = trajectory_library_.names();
   return true;
 }
 
@@ -742,18 +769,42 @@ bool SurfaceBlendingService::getMotionPlansCallback(
 bool SurfaceBlendingService::loadSaveMotionPlanCallback(
     godel_msgs::LoadSaveMotionPlan::Request& req, godel_msgs::LoadSaveMotionPlan::Response& res)
 {
+  res.code = godel_msgs::LoadSaveMotionPlan::Response::SUCCESS;
+
   switch (req.mode)
   {
   case godel_msgs::LoadSaveMotionPlan::Request::MODE_LOAD:
-    trajectory_library_.load(req.path);
+    if (!boost::filesystem::exists(req.path))
+    {
+      ROS_WARN_STREAM("Motion plan file " << req.path << " does not exist");
+      res.code = godel_msgs::LoadSaveMotionPlan::Response::NO_SUCH_FILE;
+      break;
+    }
+
+    try
+    {
+      trajectory_library_.load(req.path);
+    }
+    catch (const std::exception& e)
+    {
+      ROS_ERROR_STREAM("Could not load motion plans from " << req.path << ": " << e.what());
+      res.code = godel_msgs::LoadSaveMotionPlan::Response::ERROR_LOADING;
+    }
     break;
 
   case godel_msgs::LoadSaveMotionPlan::Request::MODE_SAVE:
-    trajectory_library_.save(req.path);
+    try
+    {
+      trajectory_library_.save(req.path);
+    }
+    catch (const std::exception& e)
+    {
+      ROS_ERROR_STREAM("Could not save motion plans to " << req.path << ": " << e.what());
+      res.code = godel_msgs::LoadSaveMotionPlan::Response::ERROR_WRITING;
+    }
     break;
   }
 
-  res.code = godel_msgs::LoadSaveMotionPlan::Response::SUCCESS;
   return true;
 }
 
@@ -1,22 +1,427 @@
 #include "services/trajectory_library.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/algorithm/string/predicate.hpp>
 #include <rosbag/bag.h>
 #include <rosbag/view.h>
 
-void godel_surface_detection::TrajectoryLibrary::save(const std::string& filename)
+/*
+ * Binary library layout. All integers and doubles are stored in host (little endian) byte order and
+ * every section starts on an 8 byte boundary:
+ *
+ *   FileHeader
+ *   data       strings, joint value arrays and time arrays referenced by offset from the index
+ *   index      FileHeader::n_plans PlanRecords, sorted by name
+ *
+ * Each of a trajectory's positions, velocities, accelerations and effort is one column: the values of
+ * all its points back to back. Points normally carry the same number of values ('stride'); a column in
+ * which they do not also stores the per-point lengths.
+ */
+namespace
+{
+const char MAGIC[8] = {'G', 'O', 'D', 'E', 'L', 'T', 'L', 'B'};
+const uint32_t FORMAT_VERSION = 1;
+const uint32_t RAGGED = 0xffffffff;
+const char* const BAG_EXTENSION = ".bag";
+
+struct FileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t n_plans;
+  uint64_t index_offset;
+};
+
+struct StringRef
+{
+  uint64_t offset;
+  uint32_t length;
+  uint32_t reserved;
+};
+
+struct Column
+{
+  uint64_t values;  // offset of the values
+  uint64_t lengths; // offset of n_points uint32 lengths if 'stride' is RAGGED
+  uint32_t stride;
+  uint32_t reserved;
+};
+
+struct TrajectoryRecord
+{
+  uint32_t seq;
+  uint32_t stamp_sec;
+  uint32_t stamp_nsec;
+  uint32_t n_joints;
+  StringRef frame_id;
+  uint64_t joint_names; // offset of n_joints StringRefs
+  uint32_t n_points;
+  uint32_t reserved;
+  Column positions;
+  Column velocities;
+  Column accelerations;
+  Column effort;
+  uint64_t times; // offset of n_points (sec, nsec) int32 pairs
+};
+
+// Approach, process, depart
+const std::size_t TRAJECTORIES_PER_PLAN = 3;
+
+struct PlanRecord
+{
+  StringRef name;
+  int32_t type;
+  uint32_t reserved;
+  TrajectoryRecord trajectories[TRAJECTORIES_PER_PLAN];
+};
+
+trajectory_msgs::JointTrajectory* planTrajectory(godel_msgs::ProcessPlan& plan, std::size_t i)
+{
+  trajectory_msgs::JointTrajectory* trajectories[TRAJECTORIES_PER_PLAN] = {
+      &plan.trajectory_approach, &plan.trajectory_process, &plan.trajectory_depart};
+  return trajectories[i];
+}
+
+const trajectory_msgs::JointTrajectory* planTrajectory(const godel_msgs::ProcessPlan& plan, std::size_t i)
+{
+  return planTrajectory(const_cast<godel_msgs::ProcessPlan&>(plan), i);
+}
+
+typedef std::vector<double> trajectory_msgs::JointTrajectoryPoint::*PointField;
+
+/**
+ * @brief Appends sections to a binary library, keeping track of their offsets and alignment
+ */
+class Writer
+{
+public:
+  explicit Writer(const std::string& filename) : out_(filename.c_str(), std::ios::binary | std::ios::trunc), pos_(0)
+  {
+    if (!out_)
+      throw std::runtime_error("Could not open " + filename + " for writing");
+  }
+
+  uint64_t append(const void* data, std::size_t size)
+  {
+    static const char ZEROS[8] = {0};
+    const std::size_t padding = (8 - pos_ % 8) % 8;
+    out_.write(ZEROS, padding);
+    pos_ += padding;
+
+    const uint64_t offset = pos_;
+    out_.write(static_cast<const char*>(data), size);
+    pos_ += size;
+    return offset;
+  }
+
+  template <typename T>
+  uint64_t append(const std::vector<T>& values)
+  {
+    return append(values.data(), values.size() * sizeof(T));
+  }
+
+  StringRef appendString(const std::string& str)
+  {
+    StringRef ref = StringRef();
+    ref.offset = append(str.data(), str.size());
+    ref.length = str.size();
+    return ref;
+  }
+
+  Column appendColumn(const std::vector<trajectory_msgs::JointTrajectoryPoint>& points, PointField field)
+  {
+    Column column = Column();
+    column.stride = points.empty() ? 0 : (points.front().*field).size();
+
+    std::vector<uint32_t> lengths(points.size());
+    std::vector<double> values;
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+      const std::vector<double>& v = points[i].*field;
+      lengths[i] = v.size();
+      if (v.size() != column.stride)
+        column.stride = RAGGED;
+      values.insert(values.end(), v.begin(), v.end());
+    }
+
+    column.values = append(values);
+    if (column.stride == RAGGED)
+      column.lengths = append(lengths);
+    return column;
+  }
+
+  TrajectoryRecord appendTrajectory(const trajectory_msgs::JointTrajectory& traj)
+  {
+    TrajectoryRecord rec = TrajectoryRecord();
+    rec.seq = traj.header.seq;
+    rec.stamp_sec = traj.header.stamp.sec;
+    rec.stamp_nsec = traj.header.stamp.nsec;
+    rec.frame_id = appendString(traj.header.frame_id);
+
+    std::vector<StringRef> names;
+    for (std::size_t i = 0; i < traj.joint_names.size(); ++i)
+      names.push_back(appendString(traj.joint_names[i]));
+    rec.n_joints = names.size();
+    rec.joint_names = append(names);
+
+    rec.n_points = traj.points.size();
+    rec.positions = appendColumn(traj.points, &trajectory_msgs::JointTrajectoryPoint::positions);
+    rec.velocities = appendColumn(traj.points, &trajectory_msgs::JointTrajectoryPoint::velocities);
+    rec.accelerations = appendColumn(traj.points, &trajectory_msgs::JointTrajectoryPoint::accelerations);
+    rec.effort = appendColumn(traj.points, &trajectory_msgs::JointTrajectoryPoint::effort);
+
+    std::vector<int32_t> times;
+    times.reserve(2 * traj.points.size());
+    for (std::size_t i = 0; i < traj.points.size(); ++i)
+    {
+      times.push_back(traj.points[i].time_from_start.sec);
+      times.push_back(traj.points[i].time_from_start.nsec);
+    }
+    rec.times = append(times);
+    return rec;
+  }
+
+  void finish(FileHeader header)
+  {
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.close();
+    if (out_.fail())
+      throw std::runtime_error("Error while writing trajectory library");
+  }
+
+private:
+  std::ofstream out_;
+  uint64_t pos_;
+};
+
+void saveBag(const godel_surface_detection::TrajectoryLibrary::TrajectoryMap& plans, const std::string& filename)
 {
   rosbag::Bag bag;
   bag.open(filename, rosbag::bagmode::Write);
   ros::Time now = ros::Time::now();
 
-  for (TrajectoryMap::const_iterator it = map_.begin(); it != map_.end(); ++it)
+  typedef godel_surface_detection::TrajectoryLibrary::TrajectoryMap::const_iterator MapIter;
+  for (MapIter it = plans.begin(); it != plans.end(); ++it)
   {
     bag.write(it->first, now, it->second);
   }
 }
 
+void saveBinary(const godel_surface_detection::TrajectoryLibrary::TrajectoryMap& plans, const std::string& filename)
+{
+  // The library may have been loaded from 'filename' and still be mapped: write a new file and move it
+  // into place, which leaves the existing mapping intact
+  const std::string tmp_filename = filename + ".tmp";
+  Writer writer(tmp_filename);
+
+  FileHeader header = FileHeader();
+  writer.append(&header, sizeof(header));
+
+  std::vector<PlanRecord> index;
+  index.reserve(plans.size());
+  typedef godel_surface_detection::TrajectoryLibrary::TrajectoryMap::const_iterator MapIter;
+  for (MapIter it = plans.begin(); it != plans.end(); ++it)
+  {
+    PlanRecord rec = PlanRecord();
+    rec.name = writer.appendString(it->first);
+    rec.type = it->second.type;
+    for (std::size_t i = 0; i < TRAJECTORIES_PER_PLAN; ++i)
+      rec.trajectories[i] = writer.appendTrajectory(*planTrajectory(it->second, i));
+    index.push_back(rec);
+  }
+
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = FORMAT_VERSION;
+  header.n_plans = index.size();
+  header.index_offset = writer.append(index);
+  writer.finish(header);
+
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+  {
+    std::remove(tmp_filename.c_str());
+    throw std::runtime_error("Could not write " + filename + ": " + std::strerror(errno));
+  }
+}
+} // anon namespace
+
+/**
+ * @brief A binary library mapped read-only into memory. Every offset is checked against the size of the
+ * file before it is followed, so that a truncated or corrupt file raises an error rather than a fault.
+ */
+struct godel_surface_detection::TrajectoryLibrary::MappedFile
+{
+  explicit MappedFile(const std::string& filename) : filename(filename), data(NULL), size(0)
+  {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Could not open " + filename + ": " + std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      size = st.st_size;
+      void* ptr = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      data = ptr == MAP_FAILED ? NULL : static_cast<const char*>(ptr);
+    }
+    ::close(fd);
+
+    if (!data)
+      throw std::runtime_error("Could not map " + filename);
+  }
+
+  ~MappedFile() { ::munmap(const_cast<char*>(data), size); }
+
+  static bool isBinaryLibrary(const std::string& filename)
+  {
+    char magic[sizeof(MAGIC)];
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+  }
+
+  const void* at(uint64_t offset, uint64_t count, uint64_t elem_size) const
+  {
+    if (offset > size || (elem_size != 0 && count > (size - offset) / elem_size))
+      throw std::runtime_error("Trajectory library " + filename + " is corrupt");
+    return data + offset;
+  }
+
+  template <typename T>
+  void read(uint64_t offset, uint64_t count, T* out) const
+  {
+    std::memcpy(out, at(offset, count, sizeof(T)), count * sizeof(T));
+  }
+
+  std::string string(const StringRef& ref) const
+  {
+    return std::string(static_cast<const char*>(at(ref.offset, ref.length, 1)), ref.length);
+  }
+
+  FileHeader header() const
+  {
+    FileHeader h;
+    read(0, 1, &h);
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+      throw std::runtime_error(filename + " is not a trajectory library");
+    if (h.version != FORMAT_VERSION)
+      throw std::runtime_error("Trajectory library " + filename + " has an unsupported version");
+    at(h.index_offset, h.n_plans, sizeof(PlanRecord));
+    return h;
+  }
+
+  PlanRecord record(std::size_t i) const
+  {
+    PlanRecord rec;
+    read(header().index_offset + i * sizeof(PlanRecord), 1, &rec);
+    return rec;
+  }
+
+  void readColumn(const Column& column, std::size_t n_points, std::vector<trajectory_msgs::JointTrajectoryPoint>& points,
+                  PointField field) const
+  {
+    std::vector<uint32_t> lengths(n_points, column.stride);
+    if (column.stride == RAGGED)
+      read(column.lengths, n_points, lengths.data());
+
+    uint64_t offset = column.values;
+    for (std::size_t i = 0; i < n_points; ++i)
+    {
+      std::vector<double>& v = points[i].*field;
+      v.resize(lengths[i]);
+      read(offset, lengths[i], v.data());
+      offset += lengths[i] * sizeof(double);
+    }
+  }
+
+  void readTrajectory(const TrajectoryRecord& rec, trajectory_msgs::JointTrajectory& traj) const
+  {
+    traj.header.seq = rec.seq;
+    traj.header.stamp.sec = rec.stamp_sec;
+    traj.header.stamp.nsec = rec.stamp_nsec;
+    traj.header.frame_id = string(rec.frame_id);
+
+    std::vector<StringRef> names(rec.n_joints);
+    read(rec.joint_names, names.size(), names.data());
+    traj.joint_names.resize(names.size());
+    for (std::size_t i = 0; i < names.size(); ++i)
+      traj.joint_names[i] = string(names[i]);
+
+    traj.points.resize(rec.n_points);
+    readColumn(rec.positions, rec.n_points, traj.points, &trajectory_msgs::JointTrajectoryPoint::positions);
+    readColumn(rec.velocities, rec.n_points, traj.points, &trajectory_msgs::JointTrajectoryPoint::velocities);
+    readColumn(rec.accelerations, rec.n_points, traj.points, &trajectory_msgs::JointTrajectoryPoint::accelerations);
+    readColumn(rec.effort, rec.n_points, traj.points, &trajectory_msgs::JointTrajectoryPoint::effort);
+
+    std::vector<int32_t> times(2 * rec.n_points);
+    read(rec.times, times.size(), times.data());
+    for (std::size_t i = 0; i < rec.n_points; ++i)
+    {
+      traj.points[i].time_from_start.sec = times[2 * i];
+      traj.points[i].time_from_start.nsec = times[2 * i + 1];
+    }
+  }
+
+  void readPlan(std::size_t i, godel_msgs::ProcessPlan& plan) const
+  {
+    const PlanRecord rec = record(i);
+    plan.type = rec.type;
+    for (std::size_t t = 0; t < TRAJECTORIES_PER_PLAN; ++t)
+      readTrajectory(rec.trajectories[t], *planTrajectory(plan, t));
+  }
+
+  const std::string filename;
+  const char* data;
+  std::size_t size;
+};
+
+void godel_surface_detection::TrajectoryLibrary::save(const std::string& filename)
+{
+  decodeAll();
+
+  if (boost::algorithm::ends_with(filename, BAG_EXTENSION))
+    saveBag(map_, filename);
+  else
+    saveBinary(map_, filename);
+}
+
 void godel_surface_detection::TrajectoryLibrary::load(const std::string& filename)
 {
+  if (MappedFile::isBinaryLibrary(filename))
+  {
+    boost::shared_ptr<const MappedFile> file(new MappedFile(filename));
+    const FileHeader header = file->header();
+
+    // Only the names are read here; the plans are decoded by find()
+    std::map<std::string, StoredPlan> stored;
+    for (std::size_t i = 0; i < header.n_plans; ++i)
+    {
+      const std::string key = file->string(file->record(i).name);
+      if (contains(key) || stored.count(key))
+      {
+        throw std::runtime_error("Trajectory library had name matching key already in data structure");
+      }
+
+      StoredPlan& plan = stored[key];
+      plan.file = file;
+      plan.record = i;
+    }
+
+    stored_.insert(stored.begin(), stored.end());
+    return;
+  }
+
   rosbag::Bag bag;
   bag.open(filename, rosbag::bagmode::Read);
   rosbag::View view(bag);
@@ -32,7 +437,7 @@ void godel_surface_detection::TrajectoryLibrary::load(const std::string& filenam
 
     // Check to see if key is already in data structure
     std::string const& key = it->getTopic();
-    if (map_.find(key) != map_.end())
+    if (contains(key))
     {
       throw std::runtime_error("Bagfile had name matching key already in data structure");
     }
@@ -40,3 +445,65 @@ void godel_surface_detection::TrajectoryLibrary::load(const std::string& filenam
     map_[key] = *ptr;
   }
 }
+
+bool godel_surface_detection::TrajectoryLibrary::contains(const std::string& name) const
+{
+  return map_.count(name) || stored_.count(name);
+}
+
+std::vector<std::string> godel_surface_detection::TrajectoryLibrary::names() const
+{
+  std::vector<std::string> result;
+  result.reserve(map_.size() + stored_.size());
+  for (TrajectoryMap::const_iterator it = map_.begin(); it != map_.end(); ++it)
+    result.push_back(it->first);
+  for (std::map<std::string, StoredPlan>::const_iterator it = stored_.begin(); it != stored_.end(); ++it)
+    result.push_back(it->first);
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+const godel_msgs::ProcessPlan* godel_surface_detection::TrajectoryLibrary::find(const std::string& name)
+{
+  TrajectoryMap::iterator it = map_.find(name);
+  if (it != map_.end())
+    return &it->second;
+
+  std::map<std::string, StoredPlan>::iterator stored = stored_.find(name);
+  if (stored == stored_.end())
+    return NULL;
+
+  godel_msgs::ProcessPlan plan;
+  stored->second.file->readPlan(stored->second.record, plan);
+  stored_.erase(stored);
+
+  godel_msgs::ProcessPlan& decoded = map_[name];
+  std::swap(decoded, plan);
+  return &decoded;
+}
+
+void godel_surface_detection::TrajectoryLibrary::decodeAll() const
+{
+  while (!stored_.empty())
+  {
+    std::map<std::string, StoredPlan>::iterator it = stored_.begin();
+    godel_msgs::ProcessPlan plan;
+    it->second.file->readPlan(it->second.record, plan);
+    std::swap(map_[it->first], plan);
+    stored_.erase(it);
+  }
+}
+
+godel_surface_detection::TrajectoryLibrary::TrajectoryMap& godel_surface_detection::TrajectoryLibrary::get()
+{
+  decodeAll();
+  return map_;
+}
+
+const godel_surface_detection::TrajectoryLibrary::TrajectoryMap&
+godel_surface_detection::TrajectoryLibrary::get() const
+{
+  decodeAll();
+  return map_;
+}
@@ -0,0 +1,116 @@
+/*
+ * Times the segmentation of a synthetic part: the top and two sides of a box sampled every 1.5 mm, like the
+ * voxel map's output, with 0.2 mm of noise. Reports the SurfaceSegmentation stages (normals, region growing over
+ * the shared neighbor graph, boundary estimation) next to pcl::RegionGrowing run on the same normals with a tree
+ * of its own, as computeSegments() used to.
+ *
+ * Usage: segmentation_benchmark [box size in m] [n_repeats]
+ */
+
+#include <segmentation/surface_segmentation.h>
+#include <pcl/features/normal_3d_omp.h>
+#include <pcl/segmentation/region_growing.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+
+const double SPACING = 0.0015;         // m, the voxel map's leaf size
+const double NOISE = 0.0002;           // m
+const double NORMAL_RADIUS = 0.025;    // m, as SurfaceSegmentation::computeNormals()
+const double BOUNDARY_RADIUS = 0.03;   // m, as the edge path generation
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(const Clock::time_point& start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+pcl::PointCloud<pcl::PointXYZRGB>::Ptr makeBox(double size)
+{
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZRGB>());
+  std::mt19937 gen (7);
+  std::normal_distribution<float> noise (0.0, NOISE);
+
+  const int n = static_cast<int>(size / SPACING);
+  for (int i = 0; i < n; ++i)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      const float a = i * SPACING, b = j * SPACING;
+      pcl::PointXYZRGB top, front, side;
+      top.x = a; top.y = b; top.z = size + noise(gen);
+      front.x = a; front.y = noise(gen); front.z = b;
+      side.x = noise(gen); side.y = a; side.z = b;
+      cloud->push_back(top);
+      cloud->push_back(front);
+      cloud->push_back(side);
+    }
+  }
+  return cloud;
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const double size = argc > 1 ? std::atof(argv[1]) : 0.3;
+  const int n_repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+
+  auto cloud = makeBox(size);
+  std::printf("%lu points\n", cloud->size());
+  std::printf("%10s %12s %12s %12s %12s %10s %12s\n", "repeat", "normals", "segments", "boundary", "pcl rg",
+              "segments", "pcl segs");
+
+  for (int r = 0; r < n_repeats; ++r)
+  {
+    auto start = Clock::now();
+    SurfaceSegmentation segmentation (cloud);
+    const double normals_ms = msSince(start);
+
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr colored;
+    start = Clock::now();
+    const std::size_t n_segments = segmentation.computeSegments(colored).size();
+    const double segments_ms = msSince(start);
+
+    pcl::PointCloud<pcl::Boundary>::Ptr boundary (new pcl::PointCloud<pcl::Boundary>());
+    segmentation.setSearchRadius(BOUNDARY_RADIUS);
+    start = Clock::now();
+    segmentation.getBoundaryCloud(boundary);
+    const double boundary_ms = msSince(start);
+
+    // Baseline, given the same normals for free
+    pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>());
+    pcl::NormalEstimationOMP<pcl::PointXYZRGB, pcl::Normal> ne;
+    ne.setInputCloud(segmentation.input_cloud_);
+    ne.setRadiusSearch(NORMAL_RADIUS);
+    ne.compute(*normals);
+
+    pcl::RegionGrowing<pcl::PointXYZRGB, pcl::Normal> rg;
+    rg.setSmoothModeFlag(true);
+    rg.setSmoothnessThreshold(0.035);
+    rg.setCurvatureThreshold(1.0);
+    rg.setMinClusterSize(MIN_CLUSTER_SIZE);
+    rg.setMaxClusterSize(MAX_CLUSTER_SIZE);
+    rg.setNumberOfNeighbours(NUM_NEIGHBORS);
+    rg.setResidualTestFlag(true);
+    rg.setSearchMethod(pcl::search::Search<pcl::PointXYZRGB>::Ptr(new pcl::search::KdTree<pcl::PointXYZRGB>));
+    rg.setInputCloud(segmentation.input_cloud_);
+    rg.setInputNormals(normals);
+
+    std::vector<pcl::PointIndices> pcl_clusters;
+    start = Clock::now();
+    rg.extract(pcl_clusters);
+    const double pcl_ms = msSince(start);
+
+    std::printf("%10d %12.1f %12.1f %12.1f %12.1f %10lu %12lu\n", r, normals_ms, segments_ms, boundary_ms, pcl_ms,
+                n_segments, pcl_clusters.size());
+  }
+
+  return 0;
+}
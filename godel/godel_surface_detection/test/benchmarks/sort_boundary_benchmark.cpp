@@ -0,0 +1,104 @@
+/*
+ * Times SurfaceSegmentation::sortBoundary() on synthetic boundaries: 'n_loops' circles with 1 mm point
+ * spacing, one of which has a gap, plus a spur that branches off the first circle. The boundary indices
+ * are shuffled, as boundary estimation on a real scan does not return them in walking order.
+ *
+ * Usage: sort_boundary_benchmark [n_points] [n_loops] [n_repeats]
+ */
+
+#include <segmentation/surface_segmentation.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+
+const double SPACING = 0.001;        // m between neighbouring boundary points
+const double SEARCH_RADIUS = 0.0025; // m
+
+using Clock = std::chrono::steady_clock;
+
+pcl::PointCloud<pcl::PointXYZRGB>::Ptr makeBoundaries(std::size_t n_points, std::size_t n_loops)
+{
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZRGB>());
+
+  const std::size_t n_spur = n_points / 100;
+  const std::size_t per_loop = (n_points - n_spur) / n_loops;
+  const double radius = per_loop * SPACING / (2.0 * M_PI);
+
+  for (std::size_t l = 0; l < n_loops; ++l)
+  {
+    const double cx = l * 3.0 * radius;
+    for (std::size_t i = 0; i < per_loop; ++i)
+    {
+      // Break the last loop open
+      if (l + 1 == n_loops && n_loops > 1 && i > per_loop / 2 && i < per_loop / 2 + 10)
+        continue;
+
+      const double t = 2.0 * M_PI * i / per_loop;
+      pcl::PointXYZRGB pt;
+      pt.x = cx + radius * std::cos(t);
+      pt.y = radius * std::sin(t);
+      pt.z = 0.0;
+      cloud->push_back(pt);
+    }
+  }
+
+  // A spur leaving the first loop outwards
+  for (std::size_t i = 1; i <= n_spur; ++i)
+  {
+    pcl::PointXYZRGB pt;
+    pt.x = radius + i * SPACING;
+    pt.y = 0.0;
+    pt.z = 0.0;
+    cloud->push_back(pt);
+  }
+
+  return cloud;
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t n_points = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 100000;
+  const std::size_t n_loops = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 10;
+  const int n_repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+
+  if (n_loops == 0 || n_points < 100 * n_loops)
+  {
+    std::fprintf(stderr, "Need at least one loop and 100 points per loop\n");
+    return 1;
+  }
+
+  auto cloud = makeBoundaries(n_points, n_loops);
+
+  SurfaceSegmentation segmentation;
+  segmentation.setInputCloud(cloud);
+  segmentation.setSearchRadius(SEARCH_RADIUS);
+
+  pcl::IndicesPtr boundary_indices (new std::vector<int>(cloud->size()));
+  for (std::size_t i = 0; i < cloud->size(); ++i)
+    (*boundary_indices)[i] = i;
+  std::shuffle(boundary_indices->begin(), boundary_indices->end(), std::mt19937(42));
+
+  std::printf("%lu boundary points, %lu loops, search radius %.4f m\n", cloud->size(), n_loops, SEARCH_RADIUS);
+  std::printf("%10s %14s %16s %14s\n", "repeat", "time (ms)", "points / s", "boundaries");
+
+  for (int r = 0; r < n_repeats; ++r)
+  {
+    std::vector<pcl::IndicesPtr> sorted;
+    const auto start = Clock::now();
+    const int n_boundaries = segmentation.sortBoundary(boundary_indices, sorted);
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::printf("%10d %14.2f %16.0f %14d\n", r, ms, cloud->size() / (ms * 1e-3), n_boundaries);
+  }
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * Times saving and opening a TrajectoryLibrary of 'n_plans' synthetic six joint plans, each with a
+ * 'n_points' point process trajectory, in the binary format and as a rosbag. For the binary format the
+ * time to list the plans and to decode a single one is reported separately from opening the file.
+ *
+ * Usage: trajectory_library_benchmark [n_plans] [n_points] [directory]
+ */
+
+#include <services/trajectory_library.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+
+const std::size_t N_JOINTS = 6;
+const std::size_t N_APPROACH_POINTS = 10;
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+trajectory_msgs::JointTrajectory makeTrajectory(std::size_t n_points, std::mt19937& rng)
+{
+  std::uniform_real_distribution<double> joint(-M_PI, M_PI);
+
+  trajectory_msgs::JointTrajectory traj;
+  traj.header.frame_id = "world_frame";
+  for (std::size_t j = 0; j < N_JOINTS; ++j)
+    traj.joint_names.push_back("joint_" + std::to_string(j + 1));
+
+  traj.points.resize(n_points);
+  for (std::size_t i = 0; i < n_points; ++i)
+  {
+    for (std::size_t j = 0; j < N_JOINTS; ++j)
+      traj.points[i].positions.push_back(joint(rng));
+    traj.points[i].time_from_start = ros::Duration(0.1 * i);
+  }
+  return traj;
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t n_plans = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000;
+  const std::size_t n_points = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 1000;
+  const std::string directory = argc > 3 ? argv[3] : "/tmp";
+
+  if (n_plans == 0)
+  {
+    std::fprintf(stderr, "Need at least one plan\n");
+    return 1;
+  }
+
+  // rosbag stamps messages with ros::Time::now()
+  ros::Time::init();
+
+  std::mt19937 rng(42);
+  godel_surface_detection::TrajectoryLibrary lib;
+  for (std::size_t k = 0; k < n_plans; ++k)
+  {
+    godel_msgs::ProcessPlan& plan = lib.get()["plan_" + std::to_string(k)];
+    plan.type = k % 2 ? godel_msgs::ProcessPlan::SCAN_TYPE : godel_msgs::ProcessPlan::BLEND_TYPE;
+    plan.trajectory_approach = makeTrajectory(N_APPROACH_POINTS, rng);
+    plan.trajectory_process = makeTrajectory(n_points, rng);
+    plan.trajectory_depart = makeTrajectory(N_APPROACH_POINTS, rng);
+  }
+
+  const std::string binary_file = directory + "/trajectory_library_benchmark.gtl";
+  const std::string bag_file = directory + "/trajectory_library_benchmark.bag";
+  const std::string last_plan = "plan_" + std::to_string(n_plans - 1);
+
+  std::printf("%lu plans, %lu process points each\n", n_plans, n_points);
+  std::printf("%10s %12s %12s %12s %16s\n", "format", "save (ms)", "open (ms)", "list (ms)", "first plan (ms)");
+
+  Clock::time_point start = Clock::now();
+  lib.save(binary_file);
+  const double binary_save = msSince(start);
+
+  godel_surface_detection::TrajectoryLibrary binary;
+  start = Clock::now();
+  binary.load(binary_file);
+  const double binary_open = msSince(start);
+
+  start = Clock::now();
+  const std::size_t n_listed = binary.names().size();
+  const double binary_list = msSince(start);
+
+  start = Clock::now();
+  const godel_msgs::ProcessPlan* plan = binary.find(last_plan);
+  const double binary_find = msSince(start);
+
+  std::printf("%10s %12.2f %12.2f %12.2f %16.3f\n", "binary", binary_save, binary_open, binary_list, binary_find);
+
+  start = Clock::now();
+  lib.save(bag_file);
+  const double bag_save = msSince(start);
+
+  godel_surface_detection::TrajectoryLibrary bag;
+  start = Clock::now();
+  bag.load(bag_file);
+  const double bag_open = msSince(start);
+
+  std::printf("%10s %12.2f %12.2f %12s %16s\n", "rosbag", bag_save, bag_open, "-", "-");
+
+  if (n_listed != n_plans || !plan || plan->trajectory_process.points.size() != n_points)
+  {
+    std::fprintf(stderr, "Binary library does not match the saved one\n");
+    return 1;
+  }
+
+  std::remove(binary_file.c_str());
+  std::remove(bag_file.c_str());
+  return 0;
+}
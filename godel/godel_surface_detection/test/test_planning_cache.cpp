@@ -0,0 +1,272 @@
+/*
+* Software License Agreement (Apache License)
+*
+* Copyright (c) 2016, Southwest Research Institute
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <services/planning_cache.h>
+#include <godel_msgs/BlendingPlanParameters.h>
+#include <moveit_msgs/PlanningScene.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+using godel_surface_detection::PlanningCache;
+
+static std::string tempFile(const std::string& name)
+{
+  return "/tmp/test_planning_cache_" + std::to_string(::getpid()) + "_" + name;
+}
+
+static std::vector<geometry_msgs::PoseArray> makePath(double offset)
+{
+  std::vector<geometry_msgs::PoseArray> segments(2);
+  for (std::size_t s = 0; s < segments.size(); ++s)
+  {
+    segments[s].header.frame_id = "world_frame";
+    segments[s].poses.resize(4);
+    for (std::size_t i = 0; i < segments[s].poses.size(); ++i)
+    {
+      segments[s].poses[i].position.x = offset + 0.01 * i;
+      segments[s].poses[i].position.y = 0.1 * s;
+      segments[s].poses[i].orientation.w = 1.0;
+    }
+  }
+  return segments;
+}
+
+static godel_msgs::ProcessPlan makePlan(std::size_t n_points, double offset)
+{
+  godel_msgs::ProcessPlan plan;
+  plan.type = godel_msgs::ProcessPlan::BLEND_TYPE;
+  plan.trajectory_process.joint_names.assign(6, "joint");
+  plan.trajectory_process.points.resize(n_points);
+  for (std::size_t i = 0; i < n_points; ++i)
+  {
+    plan.trajectory_process.points[i].positions.assign(6, offset + i);
+    plan.trajectory_process.points[i].time_from_start.sec = i;
+  }
+  return plan;
+}
+
+static PlanningCache::Key makeContext(const std::string& urdf)
+{
+  moveit_msgs::PlanningScene scene;
+  scene.name = "scene";
+  return PlanningCache::makeContext(urdf, "srdf", scene, "<value/>");
+}
+
+static void expectSamePlan(const godel_msgs::ProcessPlan& expected, const godel_msgs::ProcessPlan& actual)
+{
+  EXPECT_EQ(expected.type, actual.type);
+  EXPECT_EQ(expected.trajectory_process.joint_names, actual.trajectory_process.joint_names);
+  ASSERT_EQ(expected.trajectory_process.points.size(), actual.trajectory_process.points.size());
+  for (std::size_t i = 0; i < expected.trajectory_process.points.size(); ++i)
+  {
+    EXPECT_EQ(expected.trajectory_process.points[i].positions, actual.trajectory_process.points[i].positions);
+    EXPECT_EQ(expected.trajectory_process.points[i].time_from_start.sec,
+              actual.trajectory_process.points[i].time_from_start.sec);
+  }
+}
+
+static void writeFile(const std::string& filename, const std::string& contents)
+{
+  std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(contents.data(), contents.size());
+}
+
+static std::string readFile(const std::string& filename)
+{
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+TEST(PlanningCache, keys)
+{
+  godel_msgs::BlendingPlanParameters params;
+  params.tool_radius = 0.05;
+  const PlanningCache::Key key = PlanningCache::makeKey("blend_process_planning", makePath(0.0), params);
+  EXPECT_EQ(key, PlanningCache::makeKey("blend_process_planning", makePath(0.0), params));
+  EXPECT_NE(key, PlanningCache::makeKey("keyence_process_planning", makePath(0.0), params));
+  EXPECT_NE(key, PlanningCache::makeKey("blend_process_planning", makePath(0.001), params));
+
+  std::vector<geometry_msgs::PoseArray> other_frame = makePath(0.0);
+  other_frame[1].header.frame_id = "part_frame";
+  EXPECT_NE(key, PlanningCache::makeKey("blend_process_planning", other_frame, params));
+
+  params.tool_radius = 0.06;
+  EXPECT_NE(key, PlanningCache::makeKey("blend_process_planning", makePath(0.0), params));
+
+  EXPECT_EQ(makeContext("urdf"), makeContext("urdf"));
+  EXPECT_NE(makeContext("urdf"), makeContext("other urdf"));
+}
+
+TEST(PlanningCache, hits_and_misses)
+{
+  PlanningCache cache;
+  const std::vector<double> start(6, 0.5);
+  cache.insert(1, start, makePlan(3, 1.0));
+
+  // Plans without a start state are not cached
+  cache.insert(2, std::vector<double>(), makePlan(3, 2.0));
+  EXPECT_EQ(1u, cache.size());
+
+  godel_msgs::ProcessPlan plan;
+  ASSERT_TRUE(cache.lookup(1, start, plan));
+  expectSamePlan(makePlan(3, 1.0), plan);
+
+  std::vector<double> moved = start;
+  moved[3] += 0.5 * PlanningCache::JOINT_TOLERANCE;
+  EXPECT_TRUE(cache.lookup(1, moved, plan));
+  moved[3] += PlanningCache::JOINT_TOLERANCE;
+  EXPECT_FALSE(cache.lookup(1, moved, plan));
+  EXPECT_FALSE(cache.lookup(1, std::vector<double>(5, 0.5), plan));
+  EXPECT_FALSE(cache.lookup(2, start, plan));
+  EXPECT_EQ(2u, cache.hits());
+  EXPECT_EQ(3u, cache.misses());
+
+  // Replacing a plan keeps a single entry
+  cache.insert(1, start, makePlan(5, 1.0));
+  ASSERT_TRUE(cache.lookup(1, start, plan));
+  expectSamePlan(makePlan(5, 1.0), plan);
+  EXPECT_EQ(1u, cache.size());
+
+  // A new context forgets every plan
+  cache.setContext(makeContext("urdf"));
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.lookup(1, start, plan));
+}
+
+TEST(PlanningCache, evicts_oldest)
+{
+  PlanningCache cache(2);
+  const std::vector<double> start(6, 0.0);
+  cache.insert(1, start, makePlan(1, 1.0));
+  cache.insert(2, start, makePlan(1, 2.0));
+  cache.insert(3, start, makePlan(1, 3.0));
+
+  godel_msgs::ProcessPlan plan;
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_FALSE(cache.lookup(1, start, plan));
+  EXPECT_TRUE(cache.lookup(2, start, plan));
+  EXPECT_TRUE(cache.lookup(3, start, plan));
+}
+
+TEST(PlanningCache, save_and_load)
+{
+  const std::string filename = tempFile("round_trip.cache");
+  const std::vector<double> start(6, 0.25);
+
+  PlanningCache cache;
+  cache.setContext(makeContext("urdf"));
+  for (PlanningCache::Key key = 1; key <= 3; ++key)
+    cache.insert(key, start, makePlan(key * 10, key));
+  ASSERT_TRUE(cache.save(filename));
+
+  PlanningCache loaded;
+  loaded.setContext(makeContext("urdf"));
+  ASSERT_TRUE(loaded.load(filename));
+  EXPECT_EQ(3u, loaded.size());
+  for (PlanningCache::Key key = 1; key <= 3; ++key)
+  {
+    godel_msgs::ProcessPlan plan;
+    ASSERT_TRUE(loaded.lookup(key, start, plan));
+    expectSamePlan(makePlan(key * 10, key), plan);
+  }
+  godel_msgs::ProcessPlan plan;
+  EXPECT_FALSE(loaded.lookup(4, start, plan));
+
+  // Only the newest plans are loaded into a smaller cache
+  PlanningCache small(2);
+  small.setContext(makeContext("urdf"));
+  ASSERT_TRUE(small.load(filename));
+  EXPECT_EQ(2u, small.size());
+  EXPECT_FALSE(small.lookup(1, start, plan));
+  EXPECT_TRUE(small.lookup(3, start, plan));
+
+  std::remove(filename.c_str());
+  EXPECT_FALSE(loaded.load(filename));
+}
+
+TEST(PlanningCache, other_context_ignores_file)
+{
+  const std::string filename = tempFile("other_context.cache");
+
+  PlanningCache cache;
+  cache.setContext(makeContext("urdf"));
+  cache.insert(1, std::vector<double>(6, 0.0), makePlan(2, 0.0));
+  ASSERT_TRUE(cache.save(filename));
+
+  PlanningCache loaded;
+  loaded.setContext(makeContext("other urdf"));
+  EXPECT_TRUE(loaded.load(filename));
+  EXPECT_EQ(0u, loaded.size());
+  EXPECT_TRUE(std::ifstream(filename.c_str()).good());
+
+  std::remove(filename.c_str());
+}
+
+TEST(PlanningCache, corrupt_files)
+{
+  const std::string filename = tempFile("corrupt.cache");
+  const std::vector<double> start(6, 0.0);
+
+  PlanningCache cache;
+  for (PlanningCache::Key key = 1; key <= 2; ++key)
+    cache.insert(key, start, makePlan(20, key));
+  ASSERT_TRUE(cache.save(filename));
+  const std::string contents = readFile(filename);
+
+  // Magic and context, then the entry count
+  const std::size_t COUNT_OFFSET = 16;
+  ASSERT_GT(contents.size(), COUNT_OFFSET + 4);
+
+  PlanningCache loaded;
+  loaded.insert(7, start, makePlan(1, 7.0));
+
+  // Truncated files fail without adding anything
+  writeFile(filename, contents.substr(0, contents.size() - 8));
+  EXPECT_FALSE(loaded.load(filename));
+  EXPECT_EQ(1u, loaded.size());
+
+  // So do counts larger than the file could hold, without allocating for them
+  std::string huge_count = contents;
+  huge_count.replace(COUNT_OFFSET, 4, "\xff\xff\xff\xff", 4);
+  writeFile(filename, huge_count);
+  EXPECT_FALSE(loaded.load(filename));
+
+  std::string huge_joints = contents;
+  huge_joints.replace(COUNT_OFFSET + 4 + sizeof(PlanningCache::Key), 4, "\xff\xff\xff\x7f", 4);
+  writeFile(filename, huge_joints);
+  EXPECT_FALSE(loaded.load(filename));
+
+  writeFile(filename, "not a planning cache");
+  EXPECT_FALSE(loaded.load(filename));
+  EXPECT_EQ(1u, loaded.size());
+
+  writeFile(filename, contents);
+  EXPECT_TRUE(loaded.load(filename));
+  EXPECT_EQ(3u, loaded.size());
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
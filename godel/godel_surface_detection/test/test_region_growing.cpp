@@ -0,0 +1,135 @@
+/*
+* Software License Agreement (Apache License)
+*
+* Copyright (c) 2016, Southwest Research Institute
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <segmentation/region_growing.h>
+#include <pcl/search/kdtree.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace godel_surface_detection::segmentation;
+
+// Fixed clouds with the labels pcl::RegionGrowing gives them, built with their normals and curvatures set directly
+struct LabelledCloud
+{
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+  pcl::PointCloud<pcl::Normal> normals;
+
+  LabelledCloud() : cloud(new pcl::PointCloud<pcl::PointXYZRGB>()) {}
+
+  int add(float x, float y, float z, float nx, float ny, float nz, float curvature = 0.0f)
+  {
+    pcl::PointXYZRGB pt;
+    pt.x = x;
+    pt.y = y;
+    pt.z = z;
+    cloud->push_back(pt);
+
+    pcl::Normal n;
+    n.normal_x = nx;
+    n.normal_y = ny;
+    n.normal_z = nz;
+    n.curvature = curvature;
+    normals.push_back(n);
+    return static_cast<int>(cloud->size()) - 1;
+  }
+
+  std::vector<std::vector<int> > grow(int k, const RegionGrowingParameters& params) const
+  {
+    pcl::search::KdTree<pcl::PointXYZRGB> tree;
+    tree.setInputCloud(cloud);
+    NeighborGraph graph;
+    graph.build(tree, k);
+
+    std::vector<std::vector<int> > regions;
+    for (const auto& cluster : growRegions(*cloud, normals, graph, params))
+      regions.push_back(cluster.indices);
+    return regions;
+  }
+};
+
+static RegionGrowingParameters makeParameters()
+{
+  RegionGrowingParameters params;
+  params.smoothness_threshold = 0.1;
+  params.curvature_threshold = 0.1;
+  params.residual_threshold = 0.002;
+  params.min_cluster_size = 3;
+  params.max_cluster_size = 1000;
+  return params;
+}
+
+TEST(RegionGrowing, two_planes)
+{
+  LabelledCloud c;
+
+  // A 5 x 5 cm floor and a wall at right angles to it, 1 cm apart, on a 1 cm grid
+  std::vector<int> floor, wall;
+  for (int i = 0; i < 5; ++i)
+    for (int j = 0; j < 5; ++j)
+      floor.push_back(c.add(i * 0.01f, j * 0.01f, 0.0f, 0.0f, 0.0f, 1.0f));
+  for (int j = 0; j < 5; ++j)
+    for (int k = 1; k < 5; ++k)
+      wall.push_back(c.add(0.05f, j * 0.01f, k * 0.01f, 1.0f, 0.0f, 0.0f));
+
+  // 5 mm above the floor's tangent planes: fails the residual test towards all its neighbors, yet joins the floor
+  floor.push_back(c.add(0.02f, 0.02f, 0.005f, 0.0f, 0.0f, 1.0f));
+
+  // Fails the curvature test: joins the floor without growing it
+  floor.push_back(c.add(0.015f, 0.035f, 0.0f, 0.0f, 0.0f, 1.0f, 0.5f));
+
+  // Without a normal, in no region
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  c.add(0.025f, 0.005f, 0.0f, nan, nan, nan, nan);
+
+  const auto regions = c.grow(8, makeParameters());
+  ASSERT_EQ(2u, regions.size());
+  EXPECT_EQ(floor, regions[0]);
+  EXPECT_EQ(wall, regions[1]);
+
+  // The size limits drop the floor, leaving the wall
+  RegionGrowingParameters params = makeParameters();
+  params.max_cluster_size = 25;
+  const auto walls = c.grow(8, params);
+  ASSERT_EQ(1u, walls.size());
+  EXPECT_EQ(wall, walls[0]);
+}
+
+TEST(RegionGrowing, curved_points_seed_their_neighbors)
+{
+  LabelledCloud c;
+
+  // A line of points that all fail the curvature test, flattest last
+  for (int i = 0; i < 5; ++i)
+    c.add(i * 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.5f - i * 0.1f);
+
+  // pcl with setNumberOfNeighbours(3) seeds point 4, which takes in 3 and 2, then point 1, which takes in 0
+  RegionGrowingParameters params = makeParameters();
+  params.min_cluster_size = 1;
+  const auto regions = c.grow(2, params);
+  ASSERT_EQ(2u, regions.size());
+  EXPECT_EQ(std::vector<int>({2, 3, 4}), regions[0]);
+  EXPECT_EQ(std::vector<int>({0, 1}), regions[1]);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+/*
+* Software License Agreement (Apache License)
+*
+* Copyright (c) 2016, Southwest Research Institute
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <segmentation/surface_segmentation.h>
+
+static const double SEARCH_RADIUS = 0.0017;
+
+// Points along x at the given offsets (in mm), so that only consecutive points are within SEARCH_RADIUS
+static pcl::PointCloud<pcl::PointXYZRGB>::Ptr makeLine(const std::vector<double>& offsets_mm)
+{
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZRGB>());
+  for (double x : offsets_mm)
+  {
+    pcl::PointXYZRGB pt;
+    pt.x = x * 0.001;
+    pt.y = 0.0;
+    pt.z = 0.0;
+    cloud->push_back(pt);
+  }
+  return cloud;
+}
+
+static std::vector<std::vector<int> > sort(const pcl::PointCloud<pcl::PointXYZRGB>::Ptr& cloud,
+                                           const std::vector<int>& boundary)
+{
+  SurfaceSegmentation segmentation;
+  segmentation.setInputCloud(cloud);
+  segmentation.setSearchRadius(SEARCH_RADIUS);
+
+  pcl::IndicesPtr boundary_indices (new std::vector<int>(boundary));
+  std::vector<pcl::IndicesPtr> sorted;
+  const int n = segmentation.sortBoundary(boundary_indices, sorted);
+  EXPECT_EQ(sorted.size(), static_cast<std::size_t>(n));
+
+  std::vector<std::vector<int> > result;
+  for (const auto& b : sorted)
+    result.push_back(*b);
+  return result;
+}
+
+TEST(SortBoundary, walks_from_first_index)
+{
+  // Gaps of 1, 1.2, 1.4 and 1.6 mm, so the walk never has to break a tie
+  auto cloud = makeLine({0.0, 1.0, 2.2, 3.6, 5.2});
+
+  // The boundary starts at the first listed index, which appears only once in the result
+  const auto sorted = sort(cloud, {0, 3, 1, 4, 2});
+  ASSERT_EQ(1u, sorted.size());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), sorted[0]);
+
+  const auto reversed = sort(cloud, {4, 2, 0, 1, 3});
+  ASSERT_EQ(1u, reversed.size());
+  EXPECT_EQ(std::vector<int>({4, 3, 2, 1, 0}), reversed[0]);
+}
+
+TEST(SortBoundary, duplicate_start_index)
+{
+  auto cloud = makeLine({0.0, 1.0, 2.2, 3.6, 5.2});
+
+  // The start index listed twice is walked once; its second entry is already used
+  const auto sorted = sort(cloud, {0, 3, 0, 1, 4, 2});
+  ASSERT_EQ(1u, sorted.size());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), sorted[0]);
+}
+
+TEST(SortBoundary, isolated_point)
+{
+  // Point 5 has no neighbour within the search radius
+  auto cloud = makeLine({0.0, 1.0, 2.2, 3.6, 5.2, 100.0});
+
+  const auto sorted = sort(cloud, {0, 3, 5, 1, 4, 2});
+  ASSERT_EQ(2u, sorted.size());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), sorted[0]);
+  EXPECT_EQ(std::vector<int>({5}), sorted[1]);
+
+  // A boundary of nothing but the isolated point
+  const auto single = sort(cloud, {5});
+  ASSERT_EQ(1u, single.size());
+  EXPECT_EQ(std::vector<int>({5}), single[0]);
+}
+
+TEST(SortBoundary, gap_starts_new_boundary)
+{
+  // A 3 mm gap between points 2 and 3
+  auto cloud = makeLine({0.0, 1.0, 2.2, 5.2, 6.4});
+
+  const auto sorted = sort(cloud, {0, 1, 2, 3, 4});
+  ASSERT_EQ(2u, sorted.size());
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), sorted[0]);
+  EXPECT_EQ(std::vector<int>({3, 4}), sorted[1]);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
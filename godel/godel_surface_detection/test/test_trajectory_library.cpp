@@ -0,0 +1,181 @@
+/*
+* Software License Agreement (Apache License)
+*
+* Copyright (c) 2016, Southwest Research Institute
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <services/trajectory_library.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+using godel_surface_detection::TrajectoryLibrary;
+
+static std::string tempFile(const std::string& name)
+{
+  return "/tmp/test_trajectory_library_" + std::to_string(::getpid()) + "_" + name;
+}
+
+static trajectory_msgs::JointTrajectory makeTrajectory(std::size_t n_points, double offset)
+{
+  trajectory_msgs::JointTrajectory traj;
+  traj.header.seq = n_points;
+  traj.header.stamp.sec = 1466000000;
+  traj.header.stamp.nsec = 123456789;
+  traj.header.frame_id = "world_frame";
+  for (std::size_t j = 0; j < 6; ++j)
+    traj.joint_names.push_back("joint_" + std::to_string(j + 1));
+
+  traj.points.resize(n_points);
+  for (std::size_t i = 0; i < n_points; ++i)
+  {
+    for (std::size_t j = 0; j < 6; ++j)
+      traj.points[i].positions.push_back(offset + 0.01 * i - 0.1 * j);
+    traj.points[i].time_from_start.sec = i / 10;
+    traj.points[i].time_from_start.nsec = (i % 10) * 100000000 + 7;
+  }
+  return traj;
+}
+
+// Three plans covering empty trajectories and columns that are empty, full or ragged
+static TrajectoryLibrary makeLibrary()
+{
+  TrajectoryLibrary lib;
+
+  godel_msgs::ProcessPlan& blend = lib.get()["blend_0"];
+  blend.type = godel_msgs::ProcessPlan::BLEND_TYPE;
+  blend.trajectory_approach = makeTrajectory(5, 0.5);
+  blend.trajectory_process = makeTrajectory(40, -1.0);
+  blend.trajectory_depart = makeTrajectory(5, 1.5);
+  for (std::size_t i = 0; i < blend.trajectory_process.points.size(); ++i)
+    blend.trajectory_process.points[i].velocities.assign(6, 0.25 * i);
+
+  godel_msgs::ProcessPlan& scan = lib.get()["scan_0"];
+  scan.type = godel_msgs::ProcessPlan::SCAN_TYPE;
+  scan.trajectory_process = makeTrajectory(12, 2.0);
+  scan.trajectory_process.header.frame_id = "";
+  for (std::size_t i = 0; i < scan.trajectory_process.points.size(); i += 3)
+    scan.trajectory_process.points[i].accelerations.assign(i % 2 ? 6 : 1, -0.5 * i);
+  scan.trajectory_process.points[4].effort.push_back(3.0);
+
+  lib.get()["empty"];
+  return lib;
+}
+
+static void expectSameTrajectory(const trajectory_msgs::JointTrajectory& expected,
+                                 const trajectory_msgs::JointTrajectory& actual)
+{
+  EXPECT_EQ(expected.header.seq, actual.header.seq);
+  EXPECT_EQ(expected.header.stamp.sec, actual.header.stamp.sec);
+  EXPECT_EQ(expected.header.stamp.nsec, actual.header.stamp.nsec);
+  EXPECT_EQ(expected.header.frame_id, actual.header.frame_id);
+  EXPECT_EQ(expected.joint_names, actual.joint_names);
+
+  ASSERT_EQ(expected.points.size(), actual.points.size());
+  for (std::size_t i = 0; i < expected.points.size(); ++i)
+  {
+    SCOPED_TRACE(i);
+    EXPECT_EQ(expected.points[i].positions, actual.points[i].positions);
+    EXPECT_EQ(expected.points[i].velocities, actual.points[i].velocities);
+    EXPECT_EQ(expected.points[i].accelerations, actual.points[i].accelerations);
+    EXPECT_EQ(expected.points[i].effort, actual.points[i].effort);
+    EXPECT_EQ(expected.points[i].time_from_start.sec, actual.points[i].time_from_start.sec);
+    EXPECT_EQ(expected.points[i].time_from_start.nsec, actual.points[i].time_from_start.nsec);
+  }
+}
+
+static void expectSameLibrary(const TrajectoryLibrary& expected, TrajectoryLibrary& actual)
+{
+  ASSERT_EQ(expected.names(), actual.names());
+  for (const auto& entry : expected.get())
+  {
+    SCOPED_TRACE(entry.first);
+    const godel_msgs::ProcessPlan* plan = actual.find(entry.first);
+    ASSERT_TRUE(plan != NULL);
+    EXPECT_EQ(entry.second.type, plan->type);
+    expectSameTrajectory(entry.second.trajectory_approach, plan->trajectory_approach);
+    expectSameTrajectory(entry.second.trajectory_process, plan->trajectory_process);
+    expectSameTrajectory(entry.second.trajectory_depart, plan->trajectory_depart);
+  }
+}
+
+TEST(TrajectoryLibrary, binary_round_trip)
+{
+  const std::string filename = tempFile("round_trip.gtl");
+  TrajectoryLibrary lib = makeLibrary();
+  lib.save(filename);
+
+  TrajectoryLibrary loaded;
+  loaded.load(filename);
+  EXPECT_TRUE(loaded.contains("scan_0"));
+  EXPECT_FALSE(loaded.contains("scan_1"));
+  EXPECT_TRUE(loaded.find("scan_1") == NULL);
+  expectSameLibrary(lib, loaded);
+
+  // Loading the same names again is refused
+  EXPECT_THROW(loaded.load(filename), std::runtime_error);
+  std::remove(filename.c_str());
+}
+
+TEST(TrajectoryLibrary, save_over_mapped_file)
+{
+  const std::string filename = tempFile("mapped.gtl");
+  const TrajectoryLibrary lib = makeLibrary();
+  TrajectoryLibrary(lib).save(filename);
+
+  // Only part of the mapped library is decoded when it is written back over its own file
+  TrajectoryLibrary loaded;
+  loaded.load(filename);
+  ASSERT_TRUE(loaded.find("blend_0") != NULL);
+  loaded.save(filename);
+
+  TrajectoryLibrary reloaded;
+  reloaded.load(filename);
+  expectSameLibrary(lib, reloaded);
+  std::remove(filename.c_str());
+}
+
+TEST(TrajectoryLibrary, truncated_file)
+{
+  const std::string filename = tempFile("truncated.gtl");
+  makeLibrary().save(filename);
+
+  std::string contents;
+  {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  ASSERT_GT(contents.size(), 64u);
+  {
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size() / 2);
+  }
+
+  // The index is at the end of the file
+  TrajectoryLibrary loaded;
+  EXPECT_THROW(loaded.load(filename), std::runtime_error);
+  EXPECT_TRUE(loaded.names().empty());
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+/*
+* Software License Agreement (Apache License)
+*
+* Copyright (c) 2016, Southwest Research Institute
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <detection/voxel_map.h>
+#include <pcl/filters/voxel_grid.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+using godel_surface_detection::detection::VoxelMap;
+
+static const double LEAF_SIZE = 0.004;
+
+/**
+ * Three overlapping scans of a 2.4 x 2.4 x 0.8 cm block straddling the origin, plus a NaN point each.
+ * Points sit within 0.3 leaves of a voxel center, away from the voxel faces where float and double
+ * rounding could disagree about the voxel a point falls in.
+ */
+static std::vector<pcl::PointCloud<pcl::PointXYZRGB> > makeScans()
+{
+  std::mt19937 gen (7);
+  std::uniform_int_distribution<int> voxel (-3, 2);
+  std::uniform_int_distribution<int> layer (-1, 0);
+  std::uniform_real_distribution<double> jitter (-0.3, 0.3);
+  std::uniform_int_distribution<int> color (0, 255);
+
+  std::vector<pcl::PointCloud<pcl::PointXYZRGB> > scans(3);
+  for (auto& scan : scans)
+  {
+    for (int i = 0; i < 500; ++i)
+    {
+      pcl::PointXYZRGB pt;
+      pt.x = (voxel(gen) + 0.5 + jitter(gen)) * LEAF_SIZE;
+      pt.y = (voxel(gen) + 0.5 + jitter(gen)) * LEAF_SIZE;
+      pt.z = (layer(gen) + 0.5 + jitter(gen)) * LEAF_SIZE;
+      pt.r = color(gen);
+      pt.g = color(gen);
+      pt.b = color(gen);
+      scan.push_back(pt);
+    }
+
+    pcl::PointXYZRGB nan;
+    nan.x = nan.y = nan.z = std::numeric_limits<float>::quiet_NaN();
+    scan.push_back(nan);
+    scan.is_dense = false;
+  }
+  return scans;
+}
+
+static void expectSameCloud(const pcl::PointCloud<pcl::PointXYZRGB>& expected,
+                            const pcl::PointCloud<pcl::PointXYZRGB>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (std::size_t i = 0; i < expected.size(); ++i)
+  {
+    // pcl::VoxelGrid averages in single precision
+    EXPECT_NEAR(expected.points[i].x, actual.points[i].x, 1e-6) << "voxel " << i;
+    EXPECT_NEAR(expected.points[i].y, actual.points[i].y, 1e-6) << "voxel " << i;
+    EXPECT_NEAR(expected.points[i].z, actual.points[i].z, 1e-6) << "voxel " << i;
+    EXPECT_LE(std::abs(expected.points[i].r - actual.points[i].r), 1) << "voxel " << i;
+    EXPECT_LE(std::abs(expected.points[i].g - actual.points[i].g), 1) << "voxel " << i;
+    EXPECT_LE(std::abs(expected.points[i].b - actual.points[i].b), 1) << "voxel " << i;
+  }
+}
+
+TEST(VoxelMap, matches_voxel_grid)
+{
+  const auto scans = makeScans();
+
+  VoxelMap map (LEAF_SIZE);
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr all (new pcl::PointCloud<pcl::PointXYZRGB>());
+  for (const auto& scan : scans)
+  {
+    map.insert(scan);
+    *all += scan;
+  }
+  EXPECT_EQ(all->size() - scans.size(), map.pointCount());
+
+  for (unsigned min_hits : {1u, 20u})
+  {
+    pcl::PointCloud<pcl::PointXYZRGB> expected;
+    pcl::VoxelGrid<pcl::PointXYZRGB> grid;
+    grid.setInputCloud(all);
+    grid.setLeafSize(LEAF_SIZE, LEAF_SIZE, LEAF_SIZE);
+    grid.setMinimumPointsNumberPerVoxel(min_hits);
+    grid.filter(expected);
+
+    pcl::PointCloud<pcl::PointXYZRGB> fused;
+    map.toCloud(fused, min_hits);
+    SCOPED_TRACE(min_hits);
+    expectSameCloud(expected, fused);
+    if (min_hits == 1)
+    {
+      EXPECT_EQ(expected.size(), map.size());
+    }
+  }
+}
+
+TEST(VoxelMap, height_limits_and_clear)
+{
+  VoxelMap map (LEAF_SIZE);
+  for (const auto& scan : makeScans())
+    map.insert(scan);
+
+  pcl::PointCloud<pcl::PointXYZRGB> all, above;
+  map.toCloud(all);
+  map.toCloud(above, 1, 0.0);
+  ASSERT_LT(above.size(), all.size());
+  for (const auto& pt : above.points)
+    EXPECT_GE(pt.z, 0.0);
+
+  map.clear();
+  EXPECT_EQ(0u, map.size());
+  EXPECT_EQ(0u, map.pointCount());
+  map.toCloud(all);
+  EXPECT_TRUE(all.empty());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
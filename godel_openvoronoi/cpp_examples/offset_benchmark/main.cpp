@@ -0,0 +1,67 @@
+// Times producing every offset of a pocket, once with one Offset::offset() call per distance and
+// once with a single Offset::offsets() call.
+//
+// usage: offset_benchmark [number of pocket vertices] [offset step]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include <openvoronoi/voronoidiagram.hpp>
+#include <openvoronoi/offset.hpp>
+#include <openvoronoi/polygon_interior_filter.hpp>
+#include <openvoronoi/version.hpp>
+
+#include <boost/random.hpp>
+#include <boost/timer.hpp>
+
+int main(int argc,char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000;
+    double step = argc > 2 ? atof(argv[2]) : 0.0004;
+
+    // a star-shaped pocket, offset inwards
+    ovd::VoronoiDiagram* vd = new ovd::VoronoiDiagram(1,(int)(10*sqrt(n)));
+    boost::mt19937 gen(42);
+    boost::uniform_real<double> radius(0.8,1.0);
+    std::vector<int> ids;
+    for (int i=0; i<n; i++) {
+        double a = 2*M_PI*i/n;
+        double r = 0.6*radius(gen);
+        ids.push_back( vd->insert_point_site( ovd::Point(r*cos(a), r*sin(a)) ) );
+    }
+    for (int i=0; i<n; i++)
+        vd->insert_line_site( ids[i], ids[(i+1) % n] );
+    ovd::polygon_interior_filter interior(true);
+    vd->filter(&interior);
+    ovd::HEGraph& g = vd->get_graph_reference();
+
+    std::cout << "OpenVoronoi " << ovd::version() << " " << ovd::build_type() << "\n";
+    std::cout << n << " pocket vertices, offset step " << step << "\n";
+
+    boost::timer timer;
+    ovd::Offset single(g);
+    std::size_t levels = 0, loops = 0;
+    for (double t=step; ; t+=step) {
+        ovd::OffsetLoops offset_list = single.offset(t);
+        if (offset_list.empty())
+            break;
+        levels++;
+        loops += offset_list.size();
+    }
+    double t_single = timer.elapsed();
+
+    timer.restart();
+    ovd::Offset batched(g);
+    std::vector<ovd::OffsetLoops> all = batched.offsets(step, step);
+    double t_batched = timer.elapsed();
+
+    std::cout << levels << " levels, " << loops << " loops\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "offset() per level: " << t_single << " s\n";
+    std::cout << "offsets():          " << t_batched << " s\n";
+
+    delete vd;
+    return all.size() == levels ? 0 : -1;
+}
@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2016 Southwest Research Institute
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FILTERED_DOUBLE_HPP
+#define FILTERED_DOUBLE_HPP
+
+#include <cmath>
+#include <cfloat>
+#include <exception>
+#include <algorithm>
+
+namespace ovd {
+namespace numeric {
+
+/// \brief thrown by FilteredDouble when its error bound is too large to decide a result
+struct Uncertain : public std::exception {
+    virtual const char* what() const throw() { return "ovd::numeric::Uncertain"; }
+};
+
+/// \brief a double carrying a running bound on its forward error
+///
+/// Each operation adds the error propagated from its operands to the rounding error of
+/// its own result, so that |value - exact| <= err, where exact is the result of the same
+/// expression evaluated in exact arithmetic on the (double) inputs.
+/// Rounding is charged at DBL_EPSILON, twice the unit roundoff, which also covers the
+/// rounding of the bound itself.
+///
+/// A comparison, chop() or to_double() that the bound can not decide throws Uncertain,
+/// so that a solver templated on the number type can be re-run in qd_real precision.
+class FilteredDouble {
+public:
+    /// an exact zero
+    FilteredDouble() : v(0), e(0) {}
+    /// an exact input value
+    FilteredDouble(double x) : v(x), e(0) {}
+    /// \param x value
+    /// \param err bound on the absolute error of \a x
+    FilteredDouble(double x, double err) : v(x), e(err) {}
+
+    /// the (rounded) value
+    double value() const { return v; }
+    /// bound on the absolute error of value()
+    double error() const { return e; }
+
+    /// largest error, relative to max(1,|value|), that to_double() accepts.
+    /// well below the 1e-9 and 1e-6 tolerances VertexPositioner applies to solutions.
+    static double tolerance() { return 1e-11; }
+
+    /// negation
+    FilteredDouble operator-() const { return FilteredDouble(-v, e); }
+    /// addition
+    FilteredDouble& operator+=(const FilteredDouble& o) { *this = *this + o; return *this; }
+    /// subtraction
+    FilteredDouble& operator-=(const FilteredDouble& o) { *this = *this - o; return *this; }
+    /// multiplication
+    FilteredDouble& operator*=(const FilteredDouble& o) { *this = *this * o; return *this; }
+    /// division
+    FilteredDouble& operator/=(const FilteredDouble& o) { *this = *this / o; return *this; }
+
+    /// sum of \a a and \a b
+    friend FilteredDouble operator+(const FilteredDouble& a, const FilteredDouble& b) {
+        double s = a.v + b.v;
+        return FilteredDouble(s, a.e + b.e + DBL_EPSILON*std::fabs(s));
+    }
+    /// difference of \a a and \a b
+    friend FilteredDouble operator-(const FilteredDouble& a, const FilteredDouble& b) {
+        double d = a.v - b.v;
+        return FilteredDouble(d, a.e + b.e + DBL_EPSILON*std::fabs(d));
+    }
+    /// product of \a a and \a b
+    friend FilteredDouble operator*(const FilteredDouble& a, const FilteredDouble& b) {
+        double p = a.v * b.v;
+        return FilteredDouble(p, std::fabs(a.v)*b.e + std::fabs(b.v)*a.e + a.e*b.e + DBL_EPSILON*std::fabs(p));
+    }
+    /// quotient of \a a and \a b. throws Uncertain if \a b may be zero.
+    friend FilteredDouble operator/(const FilteredDouble& a, const FilteredDouble& b) {
+        double den = std::fabs(b.v) - b.e;
+        if (!(den > 0))
+            throw Uncertain();
+        double q = a.v / b.v;
+        return FilteredDouble(q, (a.e + std::fabs(q)*b.e) / den + DBL_EPSILON*std::fabs(q));
+    }
+    /// square root. throws Uncertain if \a a may be negative.
+    friend FilteredDouble sqrt(const FilteredDouble& a) {
+        if (a.v < a.e)
+            throw Uncertain();
+        double r = std::sqrt(a.v);
+        // |sqrt(x)-sqrt(y)| <= |x-y| / sqrt(y), and also <= sqrt(|x-y|)
+        double err = std::sqrt(a.e);
+        if (r > 0)
+            err = std::min(err, a.e / r);
+        return FilteredDouble(r, err + DBL_EPSILON*r);
+    }
+
+    /// certain equality
+    friend bool operator==(const FilteredDouble& a, const FilteredDouble& b) {
+        double err = a.e + b.e;
+        if (err == 0)
+            return a.v == b.v;
+        if (std::fabs(a.v - b.v) > err)
+            return false;
+        throw Uncertain();
+    }
+    /// certain inequality
+    friend bool operator!=(const FilteredDouble& a, const FilteredDouble& b) { return !(a == b); }
+    /// certain greater-than
+    friend bool operator>(const FilteredDouble& a, const FilteredDouble& b) {
+        double err = a.e + b.e;
+        if (a.v - b.v > err)
+            return true;
+        if (b.v - a.v >= err)
+            return false;
+        throw Uncertain();
+    }
+    /// certain less-than
+    friend bool operator<(const FilteredDouble& a, const FilteredDouble& b) { return b > a; }
+    /// certain greater-or-equal
+    friend bool operator>=(const FilteredDouble& a, const FilteredDouble& b) { return !(b > a); }
+    /// certain less-or-equal
+    friend bool operator<=(const FilteredDouble& a, const FilteredDouble& b) { return !(a > b); }
+
+    /// absolute value
+    friend FilteredDouble fabs(const FilteredDouble& a) { return FilteredDouble(std::fabs(a.v), a.e); }
+
+    /// chop() with the same 1e-20 threshold as the qd_real version.
+    /// throws Uncertain if the bound straddles the threshold.
+    friend FilteredDouble chop(const FilteredDouble& a) {
+        const double tol = 1e-20;
+        if (std::fabs(a.v) + a.e < tol)
+            return FilteredDouble(0);
+        if (std::fabs(a.v) - a.e >= tol)
+            return a;
+        throw Uncertain();
+    }
+
+    /// the value as a double, if its error is within tolerance(). throws Uncertain otherwise.
+    friend double to_double(const FilteredDouble& a) {
+        if (a.e > tolerance() * std::max(1.0, std::fabs(a.v)))
+            throw Uncertain();
+        return a.v;
+    }
+
+private:
+    double v; ///< value
+    double e; ///< error bound
+};
+
+} // numeric
+} // ovd
+
+#endif
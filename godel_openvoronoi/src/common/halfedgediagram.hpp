@@ -304,6 +304,9 @@ void twin_edges( Edge e1, Edge e2 ) {
     g[e2].twin = e1;
 }
 
+/// reserve storage for \a n faces in total
+void reserve_faces(unsigned int n) { faces.reserve(n); }
+
 /// add a face 
 Face add_face() {
     TFaceProperties f_prop;
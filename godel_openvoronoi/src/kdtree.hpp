@@ -20,6 +20,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 
 namespace kdtree {
 
@@ -88,6 +89,14 @@ public:
     int insert( const point_type pos) {
         return insert(root_, pos);
     }
+    /// \brief insert all the given points, median first along alternating directions
+    ///
+    /// builds a balanced tree when called on an empty tree. inserting spatially sorted
+    /// points one at a time through insert() would give a degenerate tree.
+    /// \param pts points to insert, reordered on return
+    void insert_balanced( std::vector<point_type>& pts ) {
+        insert_balanced( pts.begin(), pts.end(), 0 );
+    }
     /// return a point in the tree that is nearest to the given point
     /// false is returned if the tree is empty. 
     std::pair<point_type,bool> nearest( const point_type& pos) {
@@ -146,6 +155,25 @@ private:
             }
         }
     }
+    /// comparison of points along one direction
+    struct coord_less {
+        /// compare along \a d
+        coord_less(int d) : dir(d) {}
+        /// true if \a a is before \a b along dir
+        bool operator()(const point_type& a, const point_type& b) const { return a[dir] < b[dir]; }
+        int dir; ///< direction
+    };
+    /// insert the median of [first, last) along \a dir, then recurse into both halves
+    void insert_balanced( typename std::vector<point_type>::iterator first,
+                          typename std::vector<point_type>::iterator last, int dir ) {
+        if (first == last)
+            return;
+        typename std::vector<point_type>::iterator mid = first + (last - first)/2;
+        std::nth_element( first, mid, last, coord_less(dir) );
+        insert( *mid );
+        insert_balanced( first, mid, (dir + 1) % dim_ );
+        insert_balanced( mid + 1, last, (dir + 1) % dim_ );
+    }
     /// square
     double sq(double x) {return x*x;}
     
@@ -17,6 +17,8 @@
  *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include "offset.hpp"
 
 namespace ovd
@@ -39,6 +41,106 @@ OffsetLoops Offset::offset(double t) {
     return offset_list;
 }
 
+/// \brief create offsets at each of the increasing offset distances \a t
+///
+/// The result is the same as calling offset() for every distance, but the graph is only traversed
+/// once. A face requires an offset at distance t when t lies strictly between the clearance-values
+/// at the ends of one of its edges, so the distances at which each face requires an offset are
+/// found by binary search on the edge clearances, and the faces are collected per distance.
+/// Each offset loop is then walked starting from the faces collected for its distance.
+std::vector<OffsetLoops> Offset::offsets(const std::vector<double>& t) {
+    std::vector< std::vector<HEFace> > level_faces( t.size() );
+    std::vector< std::pair<std::size_t, std::size_t> > ranges; // [first, last) indices into t
+    for(HEFace f=0; f<g.num_faces() ; f++) {
+        if ( !face_valid(f) )
+            continue;
+        ranges.clear();
+        HEEdge start = g[f].edge;
+        HEEdge current = start;
+        do {
+            double src_r = g[ g.source(current) ].dist();
+            double trg_r = g[ g.target(current) ].dist();
+            std::size_t first = std::upper_bound( t.begin(), t.end(), std::min(src_r,trg_r) ) - t.begin();
+            std::size_t last = std::lower_bound( t.begin(), t.end(), std::max(src_r,trg_r) ) - t.begin();
+            if (first < last)
+                ranges.push_back( std::make_pair(first,last) );
+            current = g[current].next;
+        } while ( current!=start );
+
+        // merge the ranges of the edges so that the face is listed once per distance
+        std::sort( ranges.begin(), ranges.end() );
+        std::size_t next = 0; // first distance not yet listed
+        for (std::size_t i=0; i<ranges.size(); ++i) {
+            for (std::size_t level=std::max(next, ranges[i].first); level<ranges[i].second; ++level)
+                level_faces[level].push_back(f);
+            next = std::max(next, ranges[i].second);
+        }
+    }
+
+    // faces are listed in increasing order, so loops are started on the same faces as offset() does
+    std::vector<OffsetLoops> result( t.size() );
+    for (std::size_t level=0; level<t.size(); ++level) {
+        offset_list.clear();
+        const std::vector<HEFace>& faces = level_faces[level];
+        for (std::size_t i=0; i<faces.size(); ++i)
+            face_done[ faces[i] ] = 0;
+        for (std::size_t i=0; i<faces.size(); ++i) {
+            if ( face_done[ faces[i] ]==0 )
+                offset_loop_walk(faces[i], t[level]); // marks every face it visits as done
+        }
+        result[level].swap(offset_list);
+    }
+    return result;
+}
+
+/// \brief create offsets at distances \a start, \a start + \a step, ... for as long as they produce loops
+///
+/// the distances are accumulated by repeated addition of \a step, as a caller of offset() would.
+std::vector<OffsetLoops> Offset::offsets(double start, double step) {
+    std::vector<double> t;
+    if (step > 0) {
+        const double max_t = max_clearance();
+        for (double ti=start; ti<max_t; ti+=step)
+            t.push_back(ti);
+    }
+    std::vector<OffsetLoops> result = offsets(t);
+    for (std::size_t level=0; level<result.size(); ++level) {
+        if ( result[level].empty() ) {
+            result.resize(level);
+            break;
+        }
+    }
+    return result;
+}
+
+/// the largest clearance-value of any vertex on a face that may be offset
+double Offset::max_clearance() {
+    double max_t = 0;
+    for(HEFace f=0; f<g.num_faces() ; f++) {
+        if ( !face_valid(f) )
+            continue;
+        HEEdge start = g[f].edge;
+        HEEdge current = start;
+        do {
+            max_t = std::max(max_t, g[ g.source(current) ].dist() );
+            current = g[current].next;
+        } while ( current!=start );
+    }
+    return max_t;
+}
+
+/// offsets are not produced on faces with one or more invalid edges, see set_flags()
+bool Offset::face_valid(HEFace f) {
+    HEEdge start = g[f].edge;
+    HEEdge current = start;
+    do {
+        if ( !g[current].valid )
+            return false;
+        current = g[current].next;
+    } while ( current!=start );
+    return true;
+}
+
 /// find a suitable start face
 bool Offset::find_start_face(HEFace& start) {
     for(HEFace f=0; f<g.num_faces() ; f++) {
@@ -20,6 +20,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 
 #include "graph.hpp"
 #include "site.hpp"
@@ -77,9 +78,15 @@ public:
     void print();
     /// create offsets at offset distance \a t
     OffsetLoops offset(double t);
+    /// create offsets at each of the increasing offset distances \a t
+    std::vector<OffsetLoops> offsets(const std::vector<double>& t);
+    /// create offsets at distances \a start, \a start + \a step, ... for as long as they produce loops
+    std::vector<OffsetLoops> offsets(double start, double step);
 protected:
     bool find_start_face(HEFace& start);
     void offset_loop_walk(HEFace start, double t);
+    double max_clearance();
+    bool face_valid(HEFace f);
     OffsetVertex offset_element_from_face(HEFace current_face, HEEdge current_edge, HEEdge next_edge, double t);
     bool edge_mode(HEEdge e, double t);
     bool find_cw(Point start, Point center, Point end);
@@ -132,6 +132,8 @@ public:
     virtual ~VoronoiDiagram();
     int insert_point_site(const Point& p, int step=0);
     bool insert_line_site(int idx1, int idx2, int step=99); // default step should make algorithm run until the end!
+    std::vector<int> insert_point_sites(const std::vector<Point>& pts);
+    bool insert_line_sites(const std::vector< std::pair<int,int> >& segments);
     void insert_arc_site(int idx1, int idx2, const Point& c, bool cw, int step=99);
     
     /// return the far radius
@@ -199,6 +201,8 @@ protected:
     };
 
     void initialize();
+    HEVertex   add_point_site(const Point& p, HEFace nearest);
+    HEFace     find_nearest_face(HEFace f, const Point& p);
     HEVertex   find_seed_vertex(HEFace f, Site* site);
     EdgeVector find_in_out_edges(); 
     EdgeData   find_edge_data(HEFace f, VertexVector startverts, std::pair<HEVertex,HEVertex> segment);
@@ -247,7 +251,7 @@ protected:
     int num_lsites; ///< the number of line-segment sites
     int num_asites; ///< the number of arc-sites
     FaceVector incident_faces; ///< temporary variable for ::INCIDENT faces, will be reset to ::NONINCIDENT after a site has been inserted
-    std::set<HEVertex> modified_vertices; ///< temporary variable for in-vertices, out-vertices that need to be reset after a site has been inserted
+    VertexVector modified_vertices; ///< temporary variable for in-vertices, out-vertices that need to be reset after a site has been inserted
     VertexVector v0; ///< IN-vertices, i.e. to-be-deleted
     bool debug; ///< turn debug output on/off
     bool silent; ///< no warnings emitted when silent==true
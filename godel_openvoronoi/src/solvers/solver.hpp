@@ -56,9 +56,9 @@ public:
     /// used by alt_sep_solver
     virtual void set_type(int t) {type=t;}
     /// set the debug mode to \a b
-    void set_debug(bool b) {debug=b;}
+    virtual void set_debug(bool b) {debug=b;}
     /// no warnings/messages to stdout will be written, if silent is set true.
-    void set_silent(bool b) {silent=b;}
+    virtual void set_silent(bool b) {silent=b;}
 protected:
     /// flag for debug output
     bool debug;
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2016 Southwest Research Institute
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "solver.hpp"
+#include "common/filtered_double.hpp"
+
+namespace ovd {
+namespace solvers {
+
+/// \brief runs a fast Solver, and an exact one only when the fast result can not be certified
+///
+/// The fast solver is normally instantiated on numeric::FilteredDouble, which throws
+/// numeric::Uncertain when its error bound can not decide a branch or certify an output.
+/// The exact solver (normally instantiated on qd_real) is then run instead.
+/// Both solvers are owned, and deleted, by the AdaptiveSolver.
+class AdaptiveSolver : public Solver {
+public:
+    /// \param fast solver to try first
+    /// \param exact solver to fall back to
+    AdaptiveSolver(Solver* fast, Solver* exact) : fast_solver(fast), exact_solver(exact),
+        fast_count(0), fallback_count(0) {}
+    virtual ~AdaptiveSolver() {
+        delete fast_solver;
+        delete exact_solver;
+    }
+
+    int solve( Site* s1, double k1, Site* s2, double k2, Site* s3, double k3, std::vector<Solution>& slns ) {
+        std::vector<Solution> fast_slns;
+        try {
+            int n = fast_solver->solve(s1, k1, s2, k2, s3, k3, fast_slns);
+            slns.insert(slns.end(), fast_slns.begin(), fast_slns.end());
+            ++fast_count;
+            return n;
+        } catch (const numeric::Uncertain&) {
+            ++fallback_count;
+            return exact_solver->solve(s1, k1, s2, k2, s3, k3, slns);
+        }
+    }
+
+    virtual void set_type(int t) {
+        Solver::set_type(t);
+        fast_solver->set_type(t);
+        exact_solver->set_type(t);
+    }
+    virtual void set_debug(bool b) {
+        Solver::set_debug(b);
+        fast_solver->set_debug(b);
+        exact_solver->set_debug(b);
+    }
+    virtual void set_silent(bool b) {
+        Solver::set_silent(b);
+        fast_solver->set_silent(b);
+        exact_solver->set_silent(b);
+    }
+
+    /// number of solve() calls answered by the fast solver
+    unsigned int num_fast() const { return fast_count; }
+    /// number of solve() calls that fell back to the exact solver
+    unsigned int num_fallback() const { return fallback_count; }
+private:
+    Solver* fast_solver; ///< tried first
+    Solver* exact_solver; ///< used when the fast result is uncertain
+    unsigned int fast_count; ///< calls answered by fast_solver
+    unsigned int fallback_count; ///< calls answered by exact_solver
+};
+
+} // solvers
+} // ovd
@@ -35,7 +35,7 @@ using namespace ovd::numeric; // sq() chop()
 namespace ovd {
 namespace solvers {
     
-/// \brief templated point-class, so we can use qd_real as the coordinate type.
+/// \brief templated point-class, so we can use qd_real or FilteredDouble as the coordinate type.
 template<class Scalar>
 struct scalar_pt {
     scalar_pt<Scalar>() : x(0), y(0) {}
@@ -47,10 +47,10 @@ struct scalar_pt {
     Scalar x;
     /// y coordinate
     Scalar y;
-    /// return x coordinate
-    double getx() { return x; }
-    /// return y coordinate
-    double gety() { return y; }
+    /// return x coordinate as double
+    double getx() { return to_double(x); }
+    /// return y coordinate as double
+    double gety() { return to_double(y); }
     /// assignment operator
     scalar_pt<Scalar> &operator=(const Point& p) {
         x = p.x;
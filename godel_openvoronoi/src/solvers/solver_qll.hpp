@@ -35,6 +35,9 @@ namespace solvers {
 
  
 /// \brief quadratic-linear-linear Solver
+///
+/// templated on the number type used for the algebra, normally qd_real.
+template<class Scalar>
 class QLLSolver : public Solver {
 public:
 
@@ -44,11 +47,12 @@ int solve( Site* s1, double k1,
     if (debug && !silent) 
         std::cout << "QLLSolver.\n";
     
-    std::vector< Eq<qd_real> > quads,lins; // equation-parameters, in quad-precision
+    std::vector< Eq<Scalar> > quads,lins; // equation-parameters, in Scalar precision
     boost::array<Site*,3> sites = {{s1,s2,s3}};
     boost::array<double,3> kvals = {{k1,k2,k3}};
     for (unsigned int i=0;i<3;i++) {
-        Eq<qd_real> eqn = sites[i]->eqp_qd( kvals[i] );
+        Eq<Scalar> eqn;
+        eqn = sites[i]->eqp( kvals[i] );
         if (sites[i]->is_linear() ) // store site-equations in lins or quads
             lins.push_back( eqn ); 
         else
@@ -87,31 +91,31 @@ private:
 // xk, yk, kk, rk = params of one ('last') quadratic site (point or arc)
 // solns = output solution triplets (x,y,t) or (u,v,t)
 // returns number of solutions found
-int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti, 
-      const Eq<qd_real>& quad, qd_real k3, std::vector<Solution>& solns) { 
+int qll_solver( const std::vector< Eq<Scalar> >& lins, int xi, int yi, int ti, 
+      const Eq<Scalar>& quad, Scalar k3, std::vector<Solution>& solns) { 
     assert( lins.size() == 2 );
-    qd_real ai = lins[0][xi]; // first linear 
-    qd_real bi = lins[0][yi];
-    qd_real ki = lins[0][ti];
-    qd_real ci = lins[0].c;
+    Scalar ai = lins[0][xi]; // first linear 
+    Scalar bi = lins[0][yi];
+    Scalar ki = lins[0][ti];
+    Scalar ci = lins[0].c;
     
-    qd_real aj = lins[1][xi]; // second linear
-    qd_real bj = lins[1][yi];
-    qd_real kj = lins[1][ti];
-    qd_real cj = lins[1].c;
+    Scalar aj = lins[1][xi]; // second linear
+    Scalar bj = lins[1][yi];
+    Scalar kj = lins[1][ti];
+    Scalar cj = lins[1].c;
     
-    qd_real d = chop( ai*bj - aj*bi ); // chop! (determinant for 2 linear eqns (?))
+    Scalar d = chop( ai*bj - aj*bi ); // chop! (determinant for 2 linear eqns (?))
     if (d == 0) // no solution can be found!
         return -1;
     // these are the w-equations for qll_solve()
     // (2) u = a1 w + b1
     // (3) v = a2 w + b2
-    qd_real a0 =  (bi*kj - bj*ki) / d;
-    qd_real a1 = -(ai*kj - aj*ki) / d;
-    qd_real b0 =  (bi*cj - bj*ci) / d;
-    qd_real b1 = -(ai*cj - aj*ci) / d;
+    Scalar a0 =  (bi*kj - bj*ki) / d;
+    Scalar a1 = -(ai*kj - aj*ki) / d;
+    Scalar b0 =  (bi*cj - bj*ci) / d;
+    Scalar b1 = -(ai*cj - aj*ci) / d;
     // based on the 'last' quadratic of (s1,s2,s3)
-    qd_real aargs[3][2];
+    Scalar aargs[3][2];
     aargs[0][0] = 1.0;
     aargs[0][1] = quad.a;
     aargs[1][0] = 1.0;
@@ -119,7 +123,7 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
     aargs[2][0] = -1.0;
     aargs[2][1] = quad.k;
     
-    qd_real isolns[2][3];
+    Scalar isolns[2][3];
     // this solves for w, and returns either 0, 1, or 2 triplets of (u,v,t) in isolns
     // NOTE: indexes of aargs shuffled depending on (xi,yi,ti) !
     int scount = qll_solve( aargs[xi][0], aargs[xi][1],
@@ -147,23 +151,23 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
 /// (3) v = a2 w + b2
 /// solve (1) for w (can have 0, 1, or 2 roots)
 /// then substitute into (2) and (3) to find (u, v, t)
-int qll_solve( qd_real a0, qd_real b0, qd_real c0, qd_real d0, 
-                      qd_real e0, qd_real f0, qd_real g0, 
-                      qd_real a1, qd_real b1, 
-                      qd_real a2, qd_real b2, 
-                      qd_real soln[][3])
+int qll_solve( Scalar a0, Scalar b0, Scalar c0, Scalar d0, 
+                      Scalar e0, Scalar f0, Scalar g0, 
+                      Scalar a1, Scalar b1, 
+                      Scalar a2, Scalar b2, 
+                      Scalar soln[][3])
 {
     //std::cout << "qll_solver()\n";
     // TODO:  optimize using abs(a0) == abs(c0) == abs(d0) == 1
-    qd_real a = chop( (a0*(a1*a1) + c0*(a2*a2) + e0) ); 
-    qd_real b = chop( (2*a0*a1*b1 + 2*a2*b2*c0 + a1*b0 + a2*d0 + f0) ); 
-    qd_real c = a0*(b1*b1) + c0*(b2*b2) + b0*b1 + b2*d0 + g0;
-    std::vector<qd_real> roots = quadratic_roots(a, b, c); // solves a*w^2 + b*w + c = 0
+    Scalar a = chop( (a0*(a1*a1) + c0*(a2*a2) + e0) ); 
+    Scalar b = chop( (2*a0*a1*b1 + 2*a2*b2*c0 + a1*b0 + a2*d0 + f0) ); 
+    Scalar c = a0*(b1*b1) + c0*(b2*b2) + b0*b1 + b2*d0 + g0;
+    std::vector<Scalar> roots = quadratic_roots(a, b, c); // solves a*w^2 + b*w + c = 0
     if ( roots.empty() ) { // No roots, no solutions
         return 0;
     } else {
         for (unsigned int i=0; i<roots.size(); i++) {
-            qd_real w = roots[i];
+            Scalar w = roots[i];
             soln[i][0] = a1*w + b1; // u
             soln[i][1] = a2*w + b2; // v
             soln[i][2] = w;         // t
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "voronoidiagram.hpp"
+#include "offset.hpp"
+#include "polygon_interior_filter.hpp"
+
+#include <boost/random.hpp>
+
+// checks that Offset::offsets() produces the same loops as calling Offset::offset() once per distance
+
+// a star-shaped pocket of n vertices, with a hexagonal island if requested
+ovd::VoronoiDiagram* pocket(int n, unsigned int seed, bool island) {
+    ovd::VoronoiDiagram* vd = new ovd::VoronoiDiagram(1,100);
+    boost::mt19937 gen(seed);
+    boost::uniform_real<double> radius(0.8,1.0);
+
+    std::vector< std::vector<int> > loops(1);
+    for (int i=0; i<n; i++) {
+        double a = 2*M_PI*i/n;
+        double r = 0.6*radius(gen);
+        loops[0].push_back( vd->insert_point_site( ovd::Point(r*cos(a), r*sin(a)) ) );
+    }
+    if (island) {
+        loops.push_back( std::vector<int>() );
+        for (int i=0; i<6; i++) {
+            double a = -2*M_PI*i/6; // clockwise
+            loops[1].push_back( vd->insert_point_site( ovd::Point(0.15*cos(a)+0.1, 0.15*sin(a)) ) );
+        }
+    }
+    for (unsigned int l=0; l<loops.size(); l++) {
+        for (unsigned int i=0; i<loops[l].size(); i++)
+            vd->insert_line_site( loops[l][i], loops[l][(i+1) % loops[l].size()] );
+    }
+
+    ovd::polygon_interior_filter interior(true);
+    vd->filter(&interior);
+    return vd;
+}
+
+bool same_loops(const ovd::OffsetLoops& a, const ovd::OffsetLoops& b) {
+    if (a.size() != b.size())
+        return false;
+    for (unsigned int i=0; i<a.size(); i++) {
+        if (a[i].offset_distance != b[i].offset_distance || a[i].vertices.size() != b[i].vertices.size())
+            return false;
+        std::list<ovd::OffsetVertex>::const_iterator x = a[i].vertices.begin();
+        std::list<ovd::OffsetVertex>::const_iterator y = b[i].vertices.begin();
+        for (; x != a[i].vertices.end(); ++x, ++y) {
+            if (x->p.x != y->p.x || x->p.y != y->p.y || x->r != y->r || x->f != y->f || x->cw != y->cw)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    const double step = 0.004;
+    for (int island=0; island<2; island++) {
+        for (unsigned int seed=1; seed<4; seed++) {
+            ovd::VoronoiDiagram* vd = pocket(200, seed, island);
+            if (!vd->check()) {
+                std::cout << "invalid diagram for seed " << seed << "\n";
+                return -1;
+            }
+            ovd::HEGraph& g = vd->get_graph_reference();
+
+            // distances accumulated the way offsets(start, step) does
+            std::vector<ovd::OffsetLoops> expected;
+            std::vector<double> t;
+            ovd::Offset single(g);
+            for (double ti=step; ; ti+=step) {
+                ovd::OffsetLoops loops = single.offset(ti);
+                if (loops.empty())
+                    break;
+                expected.push_back(loops);
+                t.push_back(ti);
+            }
+
+            ovd::Offset batched(g);
+            std::vector<ovd::OffsetLoops> by_distance = batched.offsets(t);
+            std::vector<ovd::OffsetLoops> by_step = batched.offsets(step, step);
+            if (expected.empty() || by_distance.size() != expected.size() || by_step.size() != expected.size()) {
+                std::cout << "seed " << seed << ": " << expected.size() << " levels, offsets() gave "
+                          << by_distance.size() << " and " << by_step.size() << "\n";
+                return -1;
+            }
+            for (unsigned int level=0; level<expected.size(); level++) {
+                if (!same_loops(expected[level], by_distance[level]) || !same_loops(expected[level], by_step[level])) {
+                    std::cout << "seed " << seed << ": loops differ at t=" << t[level] << "\n";
+                    return -1;
+                }
+            }
+            std::cout << "island=" << island << " seed=" << seed << ": " << expected.size() << " levels OK\n";
+            delete vd;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "voronoidiagram.hpp"
+
+#include <boost/random.hpp>
+
+// checks that insert_point_sites() and insert_line_sites() build the same diagram as inserting
+// the sites one at a time with insert_point_site() and insert_line_site()
+
+// a random star-shaped polygon of n vertices, in order
+std::vector<ovd::Point> polygon(int n, unsigned int seed) {
+    boost::mt19937 gen(seed);
+    boost::uniform_real<double> radius(0.3,0.6);
+    std::vector<ovd::Point> pts;
+    for (int i=0; i<n; i++) {
+        double a = 2*M_PI*i/n;
+        double r = radius(gen);
+        pts.push_back( ovd::Point(r*cos(a), r*sin(a)) );
+    }
+    return pts;
+}
+
+bool same_counts(ovd::VoronoiDiagram* a, ovd::VoronoiDiagram* b, const char* stage) {
+    ovd::HEGraph& ga = a->get_graph_reference();
+    ovd::HEGraph& gb = b->get_graph_reference();
+    if (ga.num_vertices() != gb.num_vertices() || ga.num_edges() != gb.num_edges() || ga.num_faces() != gb.num_faces()) {
+        std::cout << stage << ": sequential insertion gave " << ga.num_vertices() << " vertices, " << ga.num_edges()
+                  << " edges, " << ga.num_faces() << " faces, bulk insertion " << gb.num_vertices() << ", "
+                  << gb.num_edges() << ", " << gb.num_faces() << "\n";
+        return false;
+    }
+    bool check_a = a->check();
+    bool check_b = b->check();
+    if (!check_a || !check_b || check_a != check_b) {
+        std::cout << stage << ": check() gave " << check_a << " for sequential and " << check_b << " for bulk insertion\n";
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    for (unsigned int seed=1; seed<4; seed++) {
+        std::vector<ovd::Point> pts = polygon(500, seed);
+        ovd::VoronoiDiagram* sequential = new ovd::VoronoiDiagram(1,100);
+        ovd::VoronoiDiagram* bulk = new ovd::VoronoiDiagram(1,100);
+
+        std::vector<int> sequential_ids;
+        for (unsigned int i=0; i<pts.size(); i++)
+            sequential_ids.push_back( sequential->insert_point_site( pts[i] ) );
+        std::vector<int> bulk_ids = bulk->insert_point_sites( pts );
+        if (bulk_ids.size() != pts.size() || !same_counts(sequential, bulk, "points"))
+            return -1;
+
+        std::vector< std::pair<int,int> > segments;
+        for (unsigned int i=0; i<pts.size(); i++) {
+            unsigned int next = (i+1) % pts.size();
+            sequential->insert_line_site( sequential_ids[i], sequential_ids[next] );
+            segments.push_back( std::make_pair( bulk_ids[i], bulk_ids[next] ) );
+        }
+        if (!bulk->insert_line_sites( segments ) || !same_counts(sequential, bulk, "lines"))
+            return -1;
+
+        // the bulk call only inserts point sites by walking the graph while it holds nothing else
+        std::vector<ovd::Point> more(1, ovd::Point(0.01, 0.02));
+        sequential->insert_point_site( more[0] );
+        if (bulk->insert_point_sites( more ).size() != 1 || !same_counts(sequential, bulk, "points after lines"))
+            return -1;
+
+        std::cout << "seed=" << seed << " OK\n";
+        delete sequential;
+        delete bulk;
+    }
+    return 0;
+}
@@ -33,6 +33,7 @@
 #include "solvers/solver_qll.hpp"
 #include "solvers/solver_sep.hpp"
 #include "solvers/solver_alt_sep.hpp"
+#include "solvers/solver_adaptive.hpp"
 
 using namespace ovd::numeric; // sq() chop()
 
@@ -40,10 +41,14 @@ namespace ovd {
 
 /// create positioner, set graph.
 VertexPositioner::VertexPositioner(HEGraph& gi): g(gi) {
-    //ppp_solver = new solvers::PPPSolver<double>(); // faster, but inaccurate
-    ppp_solver =      new solvers::PPPSolver<qd_real>(); // slower, more accurate
+    // PPPSolver<double> alone is fast but inaccurate, PPPSolver<qd_real> is slow but accurate.
+    // The adaptive solvers run in double precision with an error bound, and use qd_real
+    // only when the bound is too large to certify the double result.
+    ppp_solver =      new solvers::AdaptiveSolver( new solvers::PPPSolver<numeric::FilteredDouble>(),
+                                                   new solvers::PPPSolver<qd_real>() );
     lll_solver =      new solvers::LLLSolver();
-    qll_solver =      new solvers::QLLSolver();
+    qll_solver =      new solvers::AdaptiveSolver( new solvers::QLLSolver<numeric::FilteredDouble>(),
+                                                   new solvers::QLLSolver<qd_real>() );
     sep_solver =      new solvers::SEPSolver();
     alt_sep_solver =  new solvers::ALTSEPSolver();
     lll_para_solver = new solvers::LLLPARASolver();
@@ -360,6 +365,16 @@ void VertexPositioner::set_silent(bool b) {
     sep_solver->set_silent(b);
     alt_sep_solver->set_silent(b);
 }
+
+/// number of PPP and QLL solves certified in double precision
+unsigned int VertexPositioner::num_fast_solves() const {
+    return ppp_solver->num_fast() + qll_solver->num_fast();
+}
+
+/// number of PPP and QLL solves that fell back to qd_real precision
+unsigned int VertexPositioner::num_fallback_solves() const {
+    return ppp_solver->num_fallback() + qll_solver->num_fallback();
+}
     
 /// dispatch to the correct solver based on the sites
 int VertexPositioner::solver_dispatch(Site* s1, double k1, Site* s2, double k2, Site* s3, double k3, 
@@ -29,6 +29,7 @@ namespace ovd {
 
 namespace solvers {
 class Solver; // fwd decl
+class AdaptiveSolver;
 }
 
 /// Calculates the (x,y) position of a VoronoiVertex in the VoronoiDiagram
@@ -42,6 +43,8 @@ public:
     double dist_error(HEEdge e, const solvers::Solution& sl, Site* s3);
     void solver_debug(bool b);
     void set_silent(bool b); ///< no warning messages when silent==true
+    unsigned int num_fast_solves() const;
+    unsigned int num_fallback_solves() const;
 private:
 
     /// predicate for rejecting out-of-region solutions
@@ -94,10 +97,10 @@ private:
 
 // solvers, to which we dispatch, depending on the input sites
     
-    solvers::Solver* ppp_solver; ///< point-point-point solver
+    solvers::AdaptiveSolver* ppp_solver; ///< point-point-point solver
     solvers::Solver* lll_solver; ///< line-line-line solver
     solvers::Solver* lll_para_solver; ///< solver
-    solvers::Solver* qll_solver; ///< solver
+    solvers::AdaptiveSolver* qll_solver; ///< solver
     solvers::Solver* sep_solver; ///< separator solver
     solvers::Solver* alt_sep_solver; ///< alternative separator solver
 // DATA
@@ -31,6 +31,70 @@
 
 namespace ovd {
 
+namespace {
+
+/// distance of (\a x, \a y) along a Hilbert curve through a 2^16 x 2^16 grid
+unsigned int hilbert_distance(unsigned int x, unsigned int y) {
+    const unsigned int n = 1u << 16;
+    unsigned int d = 0;
+    for (unsigned int s = n/2; s > 0; s /= 2) {
+        unsigned int rx = (x & s) > 0;
+        unsigned int ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) { // rotate the quadrant
+            if (rx == 1) {
+                x = n-1 - x;
+                y = n-1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+/// \brief orders indices by increasing key
+struct key_less {
+    /// \param k keys, indexed by the values being sorted
+    key_less(const std::vector<unsigned int>& k) : keys(k) {}
+    /// compare by key
+    bool operator()(unsigned int a, unsigned int b) const { return keys[a] < keys[b]; }
+    const std::vector<unsigned int>& keys; ///< keys
+};
+
+/// Hilbert-curve distance of each point, on a grid spanning the bounding box of all points
+std::vector<unsigned int> hilbert_keys(const std::vector<Point>& pts) {
+    Point min_p = pts[0], max_p = pts[0];
+    BOOST_FOREACH( const Point& p, pts ) {
+        min_p.x = std::min(min_p.x, p.x);
+        min_p.y = std::min(min_p.y, p.y);
+        max_p.x = std::max(max_p.x, p.x);
+        max_p.y = std::max(max_p.y, p.y);
+    }
+    double extent = std::max(max_p.x - min_p.x, max_p.y - min_p.y);
+    double scale = extent > 0 ? 65535.0 / extent : 0.0;
+    std::vector<unsigned int> keys;
+    keys.reserve( pts.size() );
+    BOOST_FOREACH( const Point& p, pts ) {
+        keys.push_back( hilbert_distance( static_cast<unsigned int>( (p.x - min_p.x)*scale ),
+                                          static_cast<unsigned int>( (p.y - min_p.y)*scale ) ) );
+    }
+    return keys;
+}
+
+/// \brief return the indices of \a pts in the order they are met along a Hilbert curve
+std::vector<unsigned int> hilbert_order(const std::vector<Point>& pts) {
+    std::vector<unsigned int> order( pts.size() );
+    for (unsigned int i = 0; i < order.size(); ++i)
+        order[i] = i;
+    if ( !pts.empty() ) {
+        std::vector<unsigned int> keys = hilbert_keys( pts );
+        std::sort( order.begin(), order.end(), key_less(keys) );
+    }
+    return order;
+}
+
+} // anonymous namespace
+
 /// \brief create a VoronoiDiagram
 /// \param far is the radius of a circle within which all sites must be located. use far==1.0
 /// \param n_bins is the number of bins for FaceGrid, the bucket-search for nearest-neighbors 
@@ -185,6 +249,99 @@ void VoronoiDiagram::initialize() {
 /// -# remove IN-IN edges and IN-NEW edges, see remove_vertex_set()
 /// -# reset vertex/face status to be ready for next incremental operation, see reset_status()
 int VoronoiDiagram::insert_point_site(const Point& p, int step) {
+    std::pair<kd_point,bool> nearest = kd_tree->nearest( kd_point(p) );
+    assert( nearest.second );
+    HEVertex new_vert = add_point_site( p, nearest.first.face );
+    kd_tree->insert( kd_point( p, g[new_vert].face ) );
+ 
+    assert( vd_checker->is_valid() );
+ 
+    return g[new_vert].index;
+}
+
+/// \brief insert many PointSite:s into the diagram
+///
+/// \param pts positions of the sites
+/// \return integer handles to the inserted points, in the same order as \a pts
+///
+/// \details
+/// The same rules as for insert_point_site() apply, and the resulting diagram is the same,
+/// but the sites are inserted in the order they are met along a Hilbert curve.
+/// Consecutive sites are then close to each other, so the face nearest to the next site is found
+/// by walking from the previous new face instead of searching the kd-tree, and the delete-tree
+/// of each insertion lies in a part of the graph that was recently visited.
+/// The kd-tree is rebuilt, balanced, once all sites are inserted.
+/// If line or arc sites were inserted already the walk is not valid, and each site is inserted with insert_point_site().
+std::vector<int> VoronoiDiagram::insert_point_sites(const std::vector<Point>& pts) {
+    std::vector<int> ids( pts.size() );
+    if ( pts.empty() )
+        return ids;
+    if ( num_lsites != 0 || num_asites != 0 ) {
+        for (unsigned int i=0; i<pts.size(); i++)
+            ids[i] = insert_point_site( pts[i] );
+        return ids;
+    }
+    g.reserve_faces( g.num_faces() + pts.size() );
+    
+    std::vector<unsigned int> order = hilbert_order( pts );
+    std::pair<kd_point,bool> nearest = kd_tree->nearest( kd_point( pts[ order[0] ] ) );
+    assert( nearest.second );
+    HEFace f = nearest.first.face;
+    BOOST_FOREACH( unsigned int i, order ) {
+        f = find_nearest_face( f, pts[i] );
+        HEVertex new_vert = add_point_site( pts[i], f );
+        f = g[new_vert].face;
+        ids[i] = g[new_vert].index;
+    }
+    
+    std::vector<kd_point> kd_points;
+    kd_points.reserve( g.num_faces() );
+    for ( HEFace face = 0; face < g.num_faces(); ++face ) {
+        if ( g[face].site && g[face].site->isPoint() )
+            kd_points.push_back( kd_point( g[face].site->position(), face ) );
+    }
+    delete kd_tree;
+    kd_tree = new kdtree::KDTree<kd_point>(2);
+    kd_tree->insert_balanced( kd_points );
+    
+    assert( vd_checker->is_valid() );
+    return ids;
+}
+
+/// \brief insert many LineSite:s into the diagram
+///
+/// \param segments pairs of integer handles to the start and end points of each line-segment
+/// \return true if all line-segments were inserted
+///
+/// \details
+/// The same rules as for insert_line_site() apply. The segments are inserted sorted along 
+/// a Hilbert curve through their midpoints, so that consecutive insertions work on nearby parts of the graph.
+bool VoronoiDiagram::insert_line_sites(const std::vector< std::pair<int,int> >& segments) {
+    if ( segments.empty() )
+        return true;
+    // each segment adds a face on either side, and may add a null-face at each endpoint
+    g.reserve_faces( g.num_faces() + 4*segments.size() );
+    
+    std::vector<Point> mid_points;
+    mid_points.reserve( segments.size() );
+    typedef std::pair<int,int> Segment;
+    BOOST_FOREACH( const Segment& seg, segments ) {
+        HEVertex start=HEVertex(), end=HEVertex();
+        boost::tie(start,end) = find_endpoints( seg.first, seg.second );
+        mid_points.push_back( 0.5*( g[start].position + g[end].position ) );
+    }
+    
+    bool ok = true;
+    BOOST_FOREACH( unsigned int i, hilbert_order( mid_points ) ) {
+        ok = insert_line_site( segments[i].first, segments[i].second ) && ok;
+    }
+    return ok;
+}
+
+/// \brief insert a new PointSite at \a p, given the face of the existing PointSite \a nearest to it
+///
+/// steps 2-8 of insert_point_site(). returns the new ::POINTSITE vertex, with its face set.
+HEVertex VoronoiDiagram::add_point_site(const Point& p, HEFace nearest) {
     num_psites++;
     //int current_step=1;
     if (p.norm() >= far_radius ) {
@@ -197,9 +354,7 @@ int VoronoiDiagram::insert_point_site(const Point& p, int step) {
     PointSite* new_site =  new PointSite(p);
     new_site->v = new_vert;
     vertex_map.insert( VertexMapPair(g[new_vert].index,new_vert) ); // so that we can find the descriptor later based on its index
-    std::pair<kd_point,bool> nearest = kd_tree->nearest( kd_point(p) );
-    assert( nearest.second );
-    HEVertex v_seed = find_seed_vertex( nearest.first.face , new_site);
+    HEVertex v_seed = find_seed_vertex( nearest , new_site);
     mark_vertex( v_seed, new_site );
 //if (step==current_step) return -1; current_step++;
     augment_vertex_set( new_site ); // grow the tree to maximum size
@@ -219,9 +374,35 @@ int VoronoiDiagram::insert_point_site(const Point& p, int step) {
     reset_status(); // reset all vertices to UNDECIDED
  
     assert( vd_checker->face_ok( newface ) );
-    assert( vd_checker->is_valid() );
- 
-    return g[new_vert].index;
+    return new_vert;
+}
+
+/// \brief find the face of the PointSite nearest to \a p, by walking from face \a f
+///
+/// moves to the adjacent PointSite face whose site is nearest to \a p, until no adjacent site is nearer.
+/// This greedy walk along delaunay-edges always ends at the nearest site.
+/// Only valid while the diagram contains only PointSite:s.
+HEFace VoronoiDiagram::find_nearest_face(HEFace f, const Point& p) {
+    assert( num_lsites == 0 && num_asites == 0 );
+    double min_dist = ( g[f].site->position() - p ).norm_sq();
+    HEFace next = f;
+    do {
+        f = next;
+        HEEdge current = g[f].edge;
+        HEEdge start = current;
+        do {
+            if ( g[current].type != OUTEDGE ) { // the outermost edges have invalid twins
+                HEFace adj = g[ g[current].twin ].face;
+                double d = ( g[adj].site->position() - p ).norm_sq();
+                if ( d < min_dist ) {
+                    min_dist = d;
+                    next = adj;
+                }
+            }
+            current = g[current].next;
+        } while ( current != start );
+    } while ( next != f );
+    return f;
 }
 
 /// \brief insert a LineSite into the diagram
@@ -729,7 +910,7 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
         HEVertex new_v = g.add_vertex( VoronoiVertex(g[src].position,NEW,NORMAL,g[src].position) );
         double mid = numeric::diangle_mid( g[src].alfa, g[trg].alfa  );
         g[new_v].alfa = mid;
-        modified_vertices.insert(new_v);
+        modified_vertices.push_back(new_v);
         g.add_vertex_in_edge( new_v, next_edge);
         g[new_v].k3=new_k3;
 
@@ -826,7 +1007,7 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
             HEVertex sep_target = g.target(sep_edge);
             g[sep_target].status = NEW;
             g[sep_target].k3 = new_k3;
-            modified_vertices.insert(sep_target);
+            modified_vertices.push_back(sep_target);
             
             return std::make_pair( HEVertex(), g[pointsite_edge].face ); // no new separator-point returned
         }
@@ -869,7 +1050,7 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
                 g[adj].status = NEW;
             }
             g[adj].k3 = new_k3;
-            modified_vertices.insert(adj);
+            modified_vertices.push_back(adj);
             return std::make_pair( sep_point, g.HFace() );
         }
     }
@@ -888,7 +1069,7 @@ HEVertex VoronoiDiagram::add_separator_vertex(HEVertex endp, HEEdge edge, Point
         g.print_edge(edge);
     }
     g.add_vertex_in_edge(sep,edge);
-    modified_vertices.insert(sep);
+    modified_vertices.push_back(sep);
     return sep;
 }
 
@@ -1252,7 +1433,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
             g[v].status = OUT; // detH was positive (or zero), so mark OUT
             if (debug) std::cout << g[v].index << " marked OUT (in_circle) ( " << h << " )\n";
         }
-        modified_vertices.insert( v );
+        modified_vertices.push_back(v);
     }
     
     assert( vertexQueue.empty() );
@@ -1267,7 +1448,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
 void VoronoiDiagram::mark_vertex(HEVertex& v,  Site* site) {
     g[v].status = IN;
     v0.push_back( v );
-    modified_vertices.insert(v);
+    modified_vertices.push_back(v);
     
     if (site->isPoint())
         mark_adjacent_faces_p(v);
@@ -1481,7 +1662,8 @@ void VoronoiDiagram::remove_split_vertex(HEFace f) {
         if (debug) std::cout << " removing split-vertex " << g[v].index << "\n";
         
         g.remove_deg2_vertex( v );
-        modified_vertices.erase(v);
+        modified_vertices.erase( std::remove( modified_vertices.begin(), modified_vertices.end(), v ), 
+                                 modified_vertices.end() );
         
         assert( vd_checker->face_ok( f ) );
     }
@@ -1518,7 +1700,7 @@ void VoronoiDiagram::add_vertices( Site* new_site ) {
             //exit(-1);
         }
         HEVertex q = g.add_vertex( VoronoiVertex( sl.p, NEW, NORMAL, new_site->apex_point( sl.p ), sl.k3 ) );
-        modified_vertices.insert(q);
+        modified_vertices.push_back(q);
         g.add_vertex_in_edge( q, q_edges[m] );
         g[q].max_error = vpos->dist_error( q_edges[m], sl, new_site);
         if (debug) {
@@ -1539,9 +1721,7 @@ HEFace VoronoiDiagram::add_face(Site* s) {
     g[newface].site = s;
     s->face = newface;
     g[newface].status = NONINCIDENT;
-    if (s->isPoint() )
-        kd_tree->insert( kd_point( s->position(), newface ) );
-        //fgrid->add_face( newface, s->position() ); 
+    //fgrid->add_face( newface, s->position() ); 
     
     return newface;
 }
@@ -1761,7 +1941,7 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         double min_t = g[e1].minimum_t(f_site,new_site);
         g[apex].position = g[e1].point(min_t);
         g[apex].init_dist(f_site->apex_point(g[apex].position));
-        modified_vertices.insert( apex );
+        modified_vertices.push_back(apex);
     }
 }
 
@@ -2043,10 +2223,17 @@ void VoronoiDiagram::repair_face( HEFace f, std::pair<HEVertex,HEVertex> segment
 ///
 /// removes the IN vertices stored in v0 (and associated IN-NEW edges)
 void VoronoiDiagram::remove_vertex_set() {
+    // the IN vertices are exactly those in v0. drop them from modified_vertices in one pass,
+    // before their descriptors become invalid
+    VertexVector::iterator kept = modified_vertices.begin();
+    BOOST_FOREACH( HEVertex v, modified_vertices ) {
+        if ( g[v].status != IN )
+            *kept++ = v;
+    }
+    modified_vertices.erase( kept, modified_vertices.end() );
     BOOST_FOREACH( HEVertex& v, v0 ) {      // it should now be safe to delete all IN vertices
         assert( g[v].status == IN );
         g.delete_vertex(v); // this also removes edges connecting to v
-        modified_vertices.erase(v);
     }
 }
 
@@ -2204,6 +2391,8 @@ std::string VoronoiDiagram::print() const {
     o << " num_point_sites = "<< num_point_sites() <<"\n";
     o << " num_line_sites  = "<< num_line_sites() <<"\n";
     o << " num_split_vertices  = "<< num_split_vertices() <<"\n";
+    o << " num_fast_solves     = "<< vpos->num_fast_solves() <<"\n";
+    o << " num_fallback_solves = "<< vpos->num_fallback_solves() <<"\n";
     return o.str();
 }
 
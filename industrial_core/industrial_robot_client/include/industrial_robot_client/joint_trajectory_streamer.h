@@ -32,6 +32,7 @@
 #ifndef JOINT_TRAJECTORY_STREAMER_H
 #define JOINT_TRAJECTORY_STREAMER_H
 
+#include <deque>
 #include <boost/thread/thread.hpp>
 #include "industrial_robot_client/joint_trajectory_interface.h"
 
@@ -59,6 +60,15 @@ typedef TransferStates::TransferState TransferState;
 
 //* JointTrajectoryStreamer
 /**
+ *
+ * Points are streamed either stop-and-wait (each point is sent once the reply
+ * to the previous one arrived) or windowed, where up to window_size points are
+ * in flight and replies are matched to points by sequence number.  In windowed
+ * mode a FAILURE reply is taken to mean that the robot's motion buffer is full:
+ * streaming resumes from the rejected point with the window halved, and the
+ * window grows back by one point per accepted point.  This relies on the robot
+ * rejecting points that do not follow the last accepted one, if a point is
+ * accepted after an earlier one was rejected the trajectory is stopped.
  *
  * THIS CLASS IS NOT THREAD-SAFE
  *
@@ -75,8 +85,11 @@ public:
    * \brief Default constructor
    *
    * \param min_buffer_size minimum number of points as required by robot implementation
+   * \param window_size maximum number of points sent ahead of their replies, 1 for
+   *   stop-and-wait streaming (may be overridden by the '~streaming_window' param)
    */
-  JointTrajectoryStreamer(int min_buffer_size = 1) : min_buffer_size_(min_buffer_size) {};
+  JointTrajectoryStreamer(int min_buffer_size = 1, int window_size = 1)
+    : streaming_thread_(NULL), min_buffer_size_(min_buffer_size), window_size_(window_size) {};
 
   /**
    * \brief Class initializer
@@ -107,6 +120,28 @@ protected:
 
   void trajectoryStop();
 
+  /**
+   * \brief Sends points until the window is full and handles one reply.  Must be
+   * called with mutex_ held.
+   *
+   * \return true if streaming can continue right away, false if the robot
+   * rejected a point or the connection failed
+   */
+  bool streamWindow();
+
+  /**
+   * \brief Collects the replies to the points in flight while the connection
+   * is up, then forgets the points.  They are sent again from the first point
+   * that was not acknowledged.
+   */
+  void rewindWindow();
+
+  /**
+   * \brief Accounts for a reply that failed to arrive.  Its point is no longer
+   * in flight if the reply was taken off the connection.
+   */
+  void replyLost();
+
   boost::thread* streaming_thread_;
   boost::mutex mutex_;
   int current_point_;
@@ -114,6 +149,10 @@ protected:
   TransferState state_;
   ros::Time streaming_start_;
   int min_buffer_size_;
+  int window_size_;  // maximum number of points in flight
+  int window_;       // current number of points allowed in flight
+  int next_point_;   // next point to send, current_point_ is the next point to be acknowledged
+  std::deque<int> in_flight_;  // points sent but not acknowledged, oldest first
 };
 
 } //joint_trajectory_streamer
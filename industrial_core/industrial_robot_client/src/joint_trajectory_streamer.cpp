@@ -29,9 +29,12 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include "industrial_robot_client/joint_trajectory_streamer.h"
 
 using industrial::simple_message::SimpleMessage;
+namespace ReplyTypes = industrial::simple_message::ReplyTypes;
+namespace StandardMsgTypes = industrial::simple_message::StandardMsgTypes;
 
 namespace industrial_robot_client
 {
@@ -47,8 +50,18 @@ bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::vec
 
   rtn &= JointTrajectoryInterface::init(connection, joint_names, velocity_limits);
 
+  ros::param::param("~streaming_window", this->window_size_, this->window_size_);
+  if (this->window_size_ < 1)
+  {
+    ROS_WARN("Invalid streaming window: %d, streaming stop-and-wait", this->window_size_);
+    this->window_size_ = 1;
+  }
+  ROS_INFO("Streaming window: %d point(s)", this->window_size_);
+
   this->mutex_.lock();
   this->current_point_ = 0;
+  this->next_point_ = 0;
+  this->window_ = this->window_size_;
   this->state_ = TransferStates::IDLE;
   this->streaming_thread_ =
       new boost::thread(boost::bind(&JointTrajectoryStreamer::streamingThread, this));
@@ -60,6 +73,17 @@ bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::vec
 
 JointTrajectoryStreamer::~JointTrajectoryStreamer()
 {
+  if (this->streaming_thread_)
+  {
+    // the thread may be waiting for a reply, which only a closed connection ends
+    this->streaming_thread_->interrupt();
+    if (!this->streaming_thread_->timed_join(boost::posix_time::seconds(1)))
+    {
+      ROS_WARN("Streaming thread did not stop, closing the robot connection");
+      this->connection_->makeDisconnect();
+      this->streaming_thread_->join();
+    }
+  }
   delete this->streaming_thread_;
 }
 
@@ -107,6 +131,9 @@ bool JointTrajectoryStreamer::send_to_robot(const std::vector<JointTrajPtMessage
     ROS_INFO("Executing trajectory of size: %d", (int)messages.size());
     this->current_traj_ = messages;
     this->current_point_ = 0;
+    this->next_point_ = 0;
+    this->in_flight_.clear();
+    this->window_ = this->window_size_;
     this->state_ = TransferStates::STREAMING;
     this->streaming_start_ = ros::Time::now();
   }
@@ -137,11 +164,17 @@ void JointTrajectoryStreamer::streamingThread()
 {
   JointTrajPtMessage jtpMsg;
   int connectRetryCount = 1;
+  bool streamNow = false;
 
   ROS_INFO("Starting joint trajectory streamer thread");
   while (ros::ok())
   {
-    ros::Duration(0.005).sleep();
+    boost::this_thread::interruption_point();
+
+    // windowed streaming only waits for replies, unless the robot is busy
+    if (!streamNow)
+      ros::Duration(0.005).sleep();
+    streamNow = false;
 
     // automatically re-establish connection, if required
     if (connectRetryCount-- > 0)
@@ -185,6 +218,12 @@ void JointTrajectoryStreamer::streamingThread()
           break;
         }
 
+        if (this->window_size_ > 1)
+        {
+          streamNow = streamWindow();
+          break;
+        }
+
         jtpMsg = this->current_traj_[this->current_point_];
         jtpMsg.toRequest(msg);
             
@@ -211,8 +250,104 @@ void JointTrajectoryStreamer::streamingThread()
   ROS_WARN("Exiting trajectory streamer thread");
 }
 
+bool JointTrajectoryStreamer::streamWindow()
+{
+  SimpleMessage msg, reply;
+
+  while ((int)this->in_flight_.size() < this->window_ && this->next_point_ < (int)this->current_traj_.size())
+  {
+    this->current_traj_[this->next_point_].toRequest(msg);
+    if (!this->connection_->sendMsg(msg))
+    {
+      ROS_WARN("Failed sent joint point, will try again");
+      rewindWindow();
+      return false;
+    }
+    this->in_flight_.push_back(this->next_point_++);
+  }
+
+  if (!this->connection_->receiveMsg(reply))
+  {
+    ROS_WARN("Failed to receive joint point reply, will try again");
+    replyLost();
+    rewindWindow();
+    return false;
+  }
+
+  // replies arrive in the order the points were sent, the echoed point (if any) must match
+  int point = this->in_flight_.front();
+  int seq = this->current_traj_[point].point_.getSequence();
+  this->in_flight_.pop_front();
+  JointTrajPtMessage echo;
+  if (StandardMsgTypes::JOINT_TRAJ_PT != reply.getMessageType() ||
+      (reply.getDataLength() > 0 && echo.init(reply) && echo.point_.getSequence() != seq))
+  {
+    ROS_ERROR("Reply does not match point[%d] (sequence %d), stopping trajectory", point, seq);
+    trajectoryStop();
+    return false;
+  }
+
+  if (ReplyTypes::SUCCESS == reply.getReplyCode())
+  {
+    ROS_DEBUG("Point[%d of %d] sent to controller", point, (int)this->current_traj_.size());
+    this->current_point_++;
+    this->window_ = std::min(this->window_ + 1, this->window_size_);
+    return true;
+  }
+
+  // the robot buffer is full: collect the replies to the points sent after the
+  // rejected one, and send them again after a pause with a smaller window
+  ROS_DEBUG("Point[%d] rejected, %d point(s) in flight", point, (int)this->in_flight_.size());
+  while (!this->in_flight_.empty())
+  {
+    if (!this->connection_->receiveMsg(reply))
+    {
+      ROS_WARN("Failed to receive joint point reply, will try again");
+      replyLost();
+      break;
+    }
+    if (ReplyTypes::SUCCESS == reply.getReplyCode())
+    {
+      ROS_ERROR("Point[%d] accepted after point[%d] was rejected, stopping trajectory", this->in_flight_.front(), point);
+      this->in_flight_.pop_front();
+      trajectoryStop();
+      return false;
+    }
+    this->in_flight_.pop_front();
+  }
+  rewindWindow();
+  this->window_ = std::max(this->window_ / 2, 1);
+  return false;
+}
+
+void JointTrajectoryStreamer::replyLost()
+{
+  // a reply that could not be read was taken off the connection all the same,
+  // unless the connection dropped, which takes the other replies with it
+  if (this->connection_->isConnected() && !this->in_flight_.empty())
+    this->in_flight_.pop_front();
+}
+
+void JointTrajectoryStreamer::rewindWindow()
+{
+  // collect the replies to points in flight, so they are not taken for the replies to the next points sent
+  SimpleMessage reply;
+  while (!this->in_flight_.empty() && this->connection_->isConnected())
+  {
+    if (!this->connection_->receiveMsg(reply))
+      replyLost();
+    else
+      this->in_flight_.pop_front();
+  }
+  this->in_flight_.clear();
+  this->next_point_ = this->current_point_;
+}
+
 void JointTrajectoryStreamer::trajectoryStop()
 {
+  // the replies to points in flight are not taken for the reply to the stop command
+  rewindWindow();
+
   JointTrajectoryInterface::trajectoryStop();
 
   ROS_DEBUG("Stop command sent, entering idle mode");
@@ -0,0 +1,305 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2011, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *       * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *       * Neither the name of the Southwest Research Institute, nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "industrial_robot_client/joint_trajectory_streamer.h"
+#include "simple_message/socket/tcp_server.h"
+#include <algorithm>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <boost/thread/thread.hpp>
+
+using industrial_robot_client::joint_trajectory_streamer::JointTrajectoryStreamer;
+using industrial::joint_traj_pt_message::JointTrajPtMessage;
+using industrial::byte_array::ByteArray;
+using industrial::simple_message::SimpleMessage;
+using industrial::tcp_client::TcpClient;
+using industrial::tcp_server::TcpServer;
+namespace ReplyTypes = industrial::simple_message::ReplyTypes;
+namespace SpecialSeqValues = industrial::joint_traj_pt::SpecialSeqValues;
+namespace TransferStates = industrial_robot_client::joint_trajectory_streamer::TransferStates;
+
+static const int TEST_PORT_BASE = 11500;
+static const int NUM_POINTS = 200;
+
+/**
+ * \brief Server that can also send bytes that are not a message
+ */
+class RawTcpServer : public TcpServer
+{
+public:
+  using TcpServer::sendBytes;
+};
+
+/**
+ * \brief Robot motion server on the loopback interface.  Accepts points in
+ * sequence into a motion buffer of 'buffer_size' points, which executes one
+ * point every 'execute_period'.  Points arriving while the buffer is full, or
+ * out of sequence, are rejected.  The first time point 'garbled_seq' arrives it
+ * is dropped and answered with bytes that are not a message.  Without 'replies'
+ * points are accepted but never answered.
+ */
+class LoopbackRobot
+{
+public:
+  LoopbackRobot(int port, int buffer_size, double execute_period, int garbled_seq = -1, bool replies = true)
+    : buffer_size_(buffer_size), execute_period_(execute_period), garbled_seq_(garbled_seq), replies_(replies),
+      next_seq_(0), rejected_(0), stopped_(false)
+  {
+    server_.init(port);
+    thread_ = new boost::thread(boost::bind(&LoopbackRobot::serve, this));
+  }
+
+  ~LoopbackRobot()
+  {
+    thread_->join();
+    delete thread_;
+  }
+
+  int accepted() { boost::mutex::scoped_lock lock(mutex_); return next_seq_; }
+  int rejected() { boost::mutex::scoped_lock lock(mutex_); return rejected_; }
+  bool stopped() { boost::mutex::scoped_lock lock(mutex_); return stopped_; }
+
+private:
+  void serve()
+  {
+    SimpleMessage request, reply;
+    JointTrajPtMessage point;
+    ros::WallTime started;
+    int executed = 0;
+
+    server_.makeConnect();
+    while (server_.receiveMsg(request))
+    {
+      point.init(request);
+      int seq = point.point_.getSequence();
+      ReplyTypes::ReplyType code = ReplyTypes::SUCCESS;
+
+      if (garbled_seq_ == seq)
+      {
+        garbled_seq_ = -1;
+        ByteArray garbage;
+        garbage.load((int)sizeof(int));
+        garbage.load((int)0);
+        server_.sendBytes(garbage);
+        continue;
+      }
+
+      boost::mutex::scoped_lock lock(mutex_);
+      if (SpecialSeqValues::STOP_TRAJECTORY == seq)
+        stopped_ = true;
+      else
+      {
+        if (0 == next_seq_)
+          started = ros::WallTime::now();
+        if (execute_period_ > 0)
+          executed = std::min(next_seq_, (int)((ros::WallTime::now() - started).toSec() / execute_period_));
+
+        if (seq != next_seq_ || (buffer_size_ > 0 && next_seq_ - executed >= buffer_size_))
+        {
+          code = ReplyTypes::FAILURE;
+          rejected_++;
+        }
+        else
+          next_seq_++;
+      }
+      lock.unlock();
+
+      point.toReply(reply, code);
+      if (replies_)
+        server_.sendMsg(reply);
+    }
+  }
+
+  RawTcpServer server_;
+  boost::thread* thread_;
+  boost::mutex mutex_;
+  int buffer_size_;
+  double execute_period_;
+  int garbled_seq_;
+  bool replies_;
+  int next_seq_;
+  int rejected_;
+  bool stopped_;
+};
+
+/**
+ * \brief Streamer connected straight to the loopback robot, without the ROS
+ * topics and services that init() sets up
+ */
+class LoopbackStreamer : public JointTrajectoryStreamer
+{
+public:
+  LoopbackStreamer(int window_size) : JointTrajectoryStreamer(1, window_size) {}
+
+  void start(TcpClient* client, int port)
+  {
+    char ip[] = "127.0.0.1";
+    client->init(ip, port);
+    this->connection_ = client;
+    this->current_point_ = 0;
+    this->next_point_ = 0;
+    this->window_ = this->window_size_;
+    this->state_ = TransferStates::IDLE;
+    this->streaming_thread_ = new boost::thread(boost::bind(&JointTrajectoryStreamer::streamingThread, this));
+
+    // the streaming thread connects, then waits 250 ms before streaming
+    while (!client->isConnected())
+      ros::WallDuration(0.01).sleep();
+    ros::WallDuration(0.5).sleep();
+  }
+
+  void stop()
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    trajectoryStop();
+  }
+
+  // streams NUM_POINTS points and returns the points per second, or 0 on timeout
+  double stream(double timeout)
+  {
+    std::vector<JointTrajPtMessage> msgs;
+    std::vector<double> pos(6, 0.0);
+    for (int i = 0; i < NUM_POINTS; ++i)
+    {
+      pos[0] = i * 0.001;
+      msgs.push_back(create_message(i, pos, 0.5, 0.01));
+    }
+
+    ros::WallTime start = ros::WallTime::now();
+    send_to_robot(msgs);
+    while (TransferStates::STREAMING == this->state_)
+    {
+      if ((ros::WallTime::now() - start).toSec() > timeout)
+        return 0;
+      ros::WallDuration(0.001).sleep();
+    }
+    return NUM_POINTS / (ros::WallTime::now() - start).toSec();
+  }
+
+  int acknowledged() { return this->current_point_; }
+};
+
+TEST(JointTrajectoryStreamerSuite, stop_and_wait)
+{
+  LoopbackRobot robot(TEST_PORT_BASE, 0, 0);
+  TcpClient client;
+  LoopbackStreamer streamer(1);
+  streamer.start(&client, TEST_PORT_BASE);
+
+  double rate = streamer.stream(30.0);
+  ASSERT_GT(rate, 0);
+  std::cout << "stop-and-wait: " << rate << " points/s" << std::endl;
+  EXPECT_EQ(NUM_POINTS, streamer.acknowledged());
+  EXPECT_EQ(NUM_POINTS, robot.accepted());
+  EXPECT_EQ(0, robot.rejected());
+  streamer.stop();
+  EXPECT_TRUE(robot.stopped());
+}
+
+TEST(JointTrajectoryStreamerSuite, windowed)
+{
+  LoopbackRobot robot(TEST_PORT_BASE + 1, 0, 0);
+  TcpClient client;
+  LoopbackStreamer streamer(16);
+  streamer.start(&client, TEST_PORT_BASE + 1);
+
+  double rate = streamer.stream(30.0);
+  ASSERT_GT(rate, 0);
+  std::cout << "windowed (16 points): " << rate << " points/s" << std::endl;
+  EXPECT_EQ(NUM_POINTS, streamer.acknowledged());
+  EXPECT_EQ(NUM_POINTS, robot.accepted());
+  EXPECT_EQ(0, robot.rejected());
+  streamer.stop();
+  EXPECT_TRUE(robot.stopped());
+
+  // stop-and-wait is paced at one point per 5 ms
+  EXPECT_GT(rate, 400);
+}
+
+TEST(JointTrajectoryStreamerSuite, windowed_full_buffer)
+{
+  // the window is larger than the robot buffer, which takes 2 ms per point
+  LoopbackRobot robot(TEST_PORT_BASE + 2, 8, 0.002);
+  TcpClient client;
+  LoopbackStreamer streamer(32);
+  streamer.start(&client, TEST_PORT_BASE + 2);
+
+  double rate = streamer.stream(30.0);
+  ASSERT_GT(rate, 0);
+  std::cout << "windowed (32 points, 8 point buffer): " << rate << " points/s, "
+            << robot.rejected() << " rejected" << std::endl;
+  EXPECT_EQ(NUM_POINTS, streamer.acknowledged());
+  EXPECT_EQ(NUM_POINTS, robot.accepted());
+  EXPECT_GT(robot.rejected(), 0);
+  streamer.stop();
+  EXPECT_TRUE(robot.stopped());
+}
+
+TEST(JointTrajectoryStreamerSuite, windowed_garbled_reply)
+{
+  // the points sent after the garbled one are rejected out of sequence, and
+  // their replies must not be taken for the replies to the points sent again
+  LoopbackRobot robot(TEST_PORT_BASE + 4, 0, 0, 5);
+  TcpClient client;
+  LoopbackStreamer streamer(16);
+  streamer.start(&client, TEST_PORT_BASE + 4);
+
+  ASSERT_GT(streamer.stream(30.0), 0);
+  EXPECT_EQ(NUM_POINTS, streamer.acknowledged());
+  EXPECT_EQ(NUM_POINTS, robot.accepted());
+  EXPECT_EQ(15, robot.rejected());
+  streamer.stop();
+  EXPECT_TRUE(robot.stopped());
+}
+
+TEST(JointTrajectoryStreamerSuite, destroyed_waiting_for_reply)
+{
+  LoopbackRobot robot(TEST_PORT_BASE + 5, 0, 0, -1, false);
+  TcpClient client;
+  LoopbackStreamer* streamer = new LoopbackStreamer(4);
+  streamer->start(&client, TEST_PORT_BASE + 5);
+
+  // the streaming thread is left waiting for the first reply
+  EXPECT_EQ(0, streamer->stream(0.2));
+  EXPECT_EQ(4, robot.accepted());
+
+  ros::WallTime start = ros::WallTime::now();
+  delete streamer;
+  EXPECT_LT((ros::WallTime::now() - start).toSec(), 5.0);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "utest_streamer");
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -38,7 +38,6 @@
 #include "shared_types.h"
 #endif
 
-#include <deque>
 #include <vector>
 #include "string.h"
 
@@ -73,6 +72,11 @@ namespace byte_array
  * STL class, for safety and performance reasons.  This may limit cross-platform
  * usage of this class (e.g. in the MotoPlus compiler).
  *
+ * The data is kept contiguous in a buffer that slides forward as data is
+ * unloaded from the front, so unloading from either end does not move any
+ * data.  The space freed at the front is reused once the buffer has to grow.
+ * The data can be read or written in place through a ByteSpan.
+ *
  * THIS CLASS IS NOT THREAD-SAFE
  *
  */
@@ -84,6 +88,17 @@ public:
   // Provides SimpleSerialize access to byte array internals
   friend class SimpleSerialize;
 
+  /**
+   * \brief Contiguous range of bytes inside a byte array, used to read or
+   * write the array in place (e.g. by socket calls).  A span is invalidated
+   * by the next call that loads, unloads or initializes the array.
+   */
+  struct ByteSpan
+  {
+    char* data;
+    unsigned int size;
+  };
+
   /**
    * \brief Default constructor
    *
@@ -140,6 +155,27 @@ public:
    */
   void copyTo(std::vector<char> & out);
 
+  /**
+   * \brief returns the data of the byte array, for reading in place.
+   * WARNING: Byte swapping is not performed on data read through the span.
+   *
+   * \return span of all bytes in the array (NULL data if the array is empty)
+   */
+  ByteSpan getReadSpan();
+
+  /**
+   * \brief appends byte_size bytes to the end of the byte array and returns
+   * them, for writing in place.  The content of the new bytes is undefined
+   * until written.
+   * WARNING: Byte swapping is not performed on data written through the span.
+   *
+   * \param byte_size number of bytes to append
+   *
+   * \return span of the appended bytes, NULL data and zero size if byte_size
+   * is negative or the max array size would be exceeded
+   */
+  ByteSpan getWriteSpan(const industrial::shared_types::shared_int byte_size);
+
   /**
    * \brief loads a boolean into the byte array
    *
@@ -301,11 +337,11 @@ public:
    * WARNING: This method is meant for read-only operations
    *
    * \deprecated This is unsafe with dynamic buffer sizing.
-   * Use copyTo(vector<char>) instead.
+   * Use getReadSpan() or copyTo(vector<char>) instead.
    *
    * \return char* pointer to the raw data
    */
-   __attribute__((deprecated("This ptr will be invalid once buffer is changed.  Please use: copyTo(vector<char>) instead.")))
+   __attribute__((deprecated("This ptr will be invalid once buffer is changed.  Please use: getReadSpan() or copyTo(vector<char>) instead.")))
   char* getRawDataPtr();
 
   /**
@@ -316,9 +352,9 @@ public:
   unsigned int getBufferSize();
 
   /**
-   * \brief gets current buffer size
+   * \brief gets the largest size the buffer can grow to
    *
-   * \return buffer size
+   * \return max buffer size, no larger than the largest shared_int
    */
   unsigned int getMaxBufferSize();
 
@@ -334,14 +370,29 @@ public:
 private:
 
   /**
-   * \brief internal data buffer
+   * \brief internal data buffer, the data occupies [begin_, end_)
+   */
+  std::vector<char> buffer_;
+
+  /**
+   * \brief index of the first byte of data in buffer_
+   */
+  unsigned int begin_;
+
+  /**
+   * \brief index one past the last byte of data in buffer_
    */
-  std::deque<char> buffer_;
-  
+  unsigned int end_;
+
   /**
-   * \brief temporary continuous buffer for getRawDataPtr() use
+   * \brief Extends the data by byte_size bytes at the end, moving the data
+   * to the start of buffer_ or growing buffer_ if there is no room.
+   *
+   * \param byteSize (in bytes)
+   *
+   * \return pointer to the first new byte
    */
-   std::vector<char> getRawDataPtr_buffer_;
+  char* extend(industrial::shared_types::shared_int byteSize);
 
 #ifdef BYTE_SWAPPING
   /**
@@ -111,6 +111,14 @@ public:
    */
   virtual bool makeConnect()=0;
 
+  /**
+   * \brief closes the connection, so that a send or receive blocked on another
+   * thread fails.  Connections that cannot be closed this way do nothing.
+   */
+  virtual void makeDisconnect()
+  {
+  }
+
 private:
 
   // Overrides
@@ -64,6 +64,7 @@
 #define RECV(sockfd, buf, len, flags) recv(sockfd, buf, len, flags)
 #define SELECT(n, readfds, writefds, exceptfds, timeval) select(n, readfds, writefds, exceptfds, timeval)
 #define CLOSE(fd) close(fd)
+#define SHUTDOWN(sockfd) shutdown(sockfd, SHUT_RDWR)
 #ifndef HTONS // OSX defines HTONS
 #define HTONS(num) htons(num)
 #endif
@@ -108,6 +109,7 @@ extern "C" STATUS setsockopt (   /* remove "extern C", if you're using C instead
 #define RECV(sockfd, buf, len, flags) mpRecv(sockfd, buf, len, flags)
 #define SELECT(n, readfds, writefds, exceptfds, timeval) mpSelect(n, readfds, writefds, exceptfds, timeval)
 #define CLOSE(fd) mpClose(fd)
+#define SHUTDOWN(sockfd) -1 //MOTOPLUS does not support this function.
 #define HTONS(num) mpHtons(num)
 #define INET_ADDR(str) mpInetAddr(str)
 #define SOCKLEN_T unsigned int
@@ -168,6 +170,13 @@ public:
   {
     setConnected(false);
   }
+
+  // Shuts the socket down, which wakes up a receive polling it on another thread.
+  // The connection is marked disconnected by the send or receive that fails.
+  void makeDisconnect()
+  {
+    SHUTDOWN(this->getSockHandle());
+  }
   
   /**
    * \brief returns true if socket data is ready to receive
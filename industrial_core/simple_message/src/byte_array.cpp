@@ -38,6 +38,9 @@
 #include "log_wrapper.h"
 #endif
 
+#include <algorithm>
+#include <limits>
+
 namespace industrial
 {
 namespace byte_array
@@ -47,7 +50,10 @@ using namespace industrial::simple_serialize;
 using namespace industrial::shared_types;
 using namespace industrial::byte_array;
 
-ByteArray::ByteArray(void)
+// initial size of the buffer, enough for most messages
+static const unsigned int MIN_CAPACITY = 256;
+
+ByteArray::ByteArray(void) : begin_(0), end_(0)
 {
   this->init();
 #ifdef BYTE_SWAPPING
@@ -61,7 +67,9 @@ ByteArray::~ByteArray(void)
 
 void ByteArray::init()
 {
-  this->buffer_.clear();
+  // keep the buffer for reuse
+  this->begin_ = 0;
+  this->end_ = 0;
 }
 
 bool ByteArray::init(const char* buffer, const shared_int byte_size)
@@ -85,9 +93,15 @@ bool ByteArray::init(const char* buffer, const shared_int byte_size)
 
 void ByteArray::copyFrom(ByteArray & buffer)
 {
+  if (&buffer == this)
+  {
+    return;
+  }
+
   if (buffer.getBufferSize() != 0)
   {
-    this->buffer_ = buffer.buffer_;
+    this->init();
+    this->load(buffer);
   }
   else
   {
@@ -97,7 +111,70 @@ void ByteArray::copyFrom(ByteArray & buffer)
 
 void ByteArray::copyTo(std::vector<char> &out)
 {
-  out.assign(buffer_.begin(), buffer_.end());
+  ByteSpan data = this->getReadSpan();
+  out.assign(data.data, data.data + data.size);
+}
+
+ByteArray::ByteSpan ByteArray::getReadSpan()
+{
+  ByteSpan span;
+  span.data = this->buffer_.empty() ? NULL : &this->buffer_[this->begin_];
+  span.size = this->getBufferSize();
+  return span;
+}
+
+ByteArray::ByteSpan ByteArray::getWriteSpan(const shared_int byte_size)
+{
+  ByteSpan span;
+  span.data = NULL;
+  span.size = 0;
+
+  if (byte_size < 0)
+  {
+    LOG_ERROR("Invalid span size: %d", byte_size);
+    return span;
+  }
+  // compared without adding, which could wrap around
+  if ((unsigned int)byte_size > this->getMaxBufferSize() - this->getBufferSize())
+  {
+    LOG_ERROR("Additional data would exceed buffer size");
+    return span;
+  }
+
+  try
+  {
+    span.data = this->extend(byte_size);
+    span.size = byte_size;
+  }
+  catch (std::exception)
+  {
+    LOG_ERROR("Failed to extend byte array by %d bytes", byte_size);
+  }
+  return span;
+}
+
+char* ByteArray::extend(shared_int byteSize)
+{
+  if ((size_t)this->end_ + byteSize > this->buffer_.size())
+  {
+    // reclaim the space in front of the data before growing
+    unsigned int size = this->getBufferSize();
+    if (this->begin_ > 0)
+    {
+      memmove(&this->buffer_[0], &this->buffer_[this->begin_], size);
+      this->begin_ = 0;
+      this->end_ = size;
+    }
+    if ((size_t)this->end_ + byteSize > this->buffer_.size())
+    {
+      size_t capacity = std::max(2 * this->buffer_.size(), (size_t)MIN_CAPACITY);
+      this->buffer_.resize(std::max(capacity, (size_t)(this->end_ + byteSize)));
+    }
+  }
+
+  char* bytePtr = this->buffer_.empty() ? NULL : &this->buffer_[this->end_];
+  this->end_ += byteSize;
+  return bytePtr;
 }
 
 
@@ -129,8 +206,7 @@ void ByteArray::swap(void *value, shared_int byteSize)
 
 char* ByteArray::getRawDataPtr()
 {
-  this->copyTo( this->getRawDataPtr_buffer_ );
-  return &getRawDataPtr_buffer_[0];
+  return this->getReadSpan().data;
 }
 
 /****************************************************************
@@ -175,16 +251,20 @@ bool ByteArray::load(simple_serialize::SimpleSerialize &value)
 bool ByteArray::load(ByteArray &value)
 {
   LOG_COMM("Executing byte array load through byte array");
-  std::deque<char>& src = value.buffer_;
-  std::deque<char>& dest  = this->buffer_;
+  unsigned int byteSize = value.getBufferSize();
 
-  if (this->getBufferSize()+value.getBufferSize() > this->getMaxBufferSize())
+  if (this->getBufferSize()+byteSize > this->getMaxBufferSize())
   {
     LOG_ERROR("Additional data would exceed buffer size");
     return false;
   }
 
-  dest.insert(dest.end(), src.begin(), src.end());
+  if (byteSize > 0)
+  {
+    // value may be this array, look up its data after extending
+    char* dest = this->extend(byteSize);
+    memcpy(dest, &value.buffer_[value.begin_], byteSize);
+  }
   return true;
 }
 
@@ -208,8 +288,10 @@ bool ByteArray::load(void* value, const shared_int byte_size)
 
   try
   {
-    char* bytePtr = (char*)value;
-    this->buffer_.insert(this->buffer_.end(), bytePtr, bytePtr + byte_size);
+    if (byte_size > 0)
+    {
+      memcpy(this->extend(byte_size), value, byte_size);
+    }
 
     rtn = true;
   }
@@ -276,11 +358,12 @@ bool ByteArray::unload(ByteArray &value, const shared_int byte_size)
 
   if (byte_size <= this->getBufferSize())
   {
-    std::deque<char>& src  = this->buffer_;
-    std::deque<char>& dest = value.buffer_;
-
-    dest.insert(dest.end(), src.end()-byte_size, src.end());
-    src.erase(src.end()-byte_size, src.end());
+    if (byte_size > 0)
+    {
+      char* dest = value.extend(byte_size);
+      memcpy(dest, &this->buffer_[this->end_ - byte_size], byte_size);
+      this->end_ -= byte_size;
+    }
     rtn = true;
   }
   else
@@ -306,10 +389,11 @@ bool ByteArray::unload(void* value, shared_int byteSize)
 
   if (byteSize <= this->getBufferSize())
   {
-      std::deque<char>& src  = this->buffer_;
-
-      std::copy(src.end()-byteSize, src.end(), (char*)value);
-      src.erase(src.end()-byteSize, src.end());
+      if (byteSize > 0)
+      {
+        memcpy(value, &this->buffer_[this->end_ - byteSize], byteSize);
+        this->end_ -= byteSize;
+      }
       rtn = true;
   }
   else
@@ -326,9 +410,8 @@ bool ByteArray::unload(void* value, shared_int byteSize)
 /****************************************************************
  // unloadFront(*)
  //
- // Methods for unloading various data types.  Unloading data shortens
- // the internal buffer and requires a memmove.  These functions should
- // be used sparingly, as they are expensive.
+ // Methods for unloading various data types.  Unloading data from the
+ // front only advances the start of the data, no data is moved.
  //
  */
 bool ByteArray::unloadFront(industrial::shared_types::shared_real &value)
@@ -369,10 +452,11 @@ bool ByteArray::unloadFront(void* value, const industrial::shared_types::shared_
 
   if (byteSize <= this->getBufferSize())
   {
-      std::deque<char>& src  = this->buffer_;
-
-      std::copy(src.begin(), src.begin()+byteSize, (char*)value);
-      src.erase(src.begin(), src.begin()+byteSize);
+      if (byteSize > 0)
+      {
+        memcpy(value, &this->buffer_[this->begin_], byteSize);
+        this->begin_ += byteSize;
+      }
       rtn = true;
   }
   else
@@ -386,12 +470,13 @@ bool ByteArray::unloadFront(void* value, const industrial::shared_types::shared_
 
 unsigned int ByteArray::getBufferSize()
 {
-  return this->buffer_.size();
+  return this->end_ - this->begin_;
 }
 
 unsigned int ByteArray::getMaxBufferSize()
 {
-  return this->buffer_.max_size();
+  // sizes are passed as shared_int
+  return std::min(this->buffer_.max_size(), (size_t)std::numeric_limits<shared_int>::max());
 }
 
 
@@ -86,18 +86,16 @@ bool SimpleMessage::init(ByteArray & msg)
 
   if (msg.getBufferSize() >= this->getHeaderSize())
   {
-    // Check to see if the message is larger than the standard header
-    // If so, copy out the data portion.
-    if (msg.getBufferSize() > this->getHeaderSize())
-    {
-      dataSize = msg.getBufferSize() - this->getHeaderSize();
-      LOG_COMM("Unloading data portion of message: %d bytes", dataSize);
-      msg.unload(this->data_, dataSize);
-    }
+    // Parse the header in place, the rest of the message is the data portion
     LOG_COMM("Unloading header data");
-    msg.unload(this->reply_code_);
-    msg.unload(this->comm_type_);
-    msg.unload(this->message_type_);
+    msg.unloadFront(this->message_type_);
+    msg.unloadFront(this->comm_type_);
+    msg.unloadFront(this->reply_code_);
+
+    dataSize = msg.getBufferSize();
+    LOG_COMM("Unloading data portion of message: %d bytes", dataSize);
+    this->data_.init();
+    msg.unload(this->data_, dataSize);
     LOG_COMM("SimpleMessage::init(type: %d, comm: %d, reply: %d, data[%d]...)",
               this->message_type_, this->comm_type_, this->reply_code_, this->data_.getBufferSize());
     rtn = this->validateMessage();
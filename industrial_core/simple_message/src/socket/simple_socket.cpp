@@ -57,11 +57,9 @@ namespace industrial
         if (this->MAX_BUFFER_SIZE > (int)buffer.getBufferSize())
         {
 
-          // copy to local array, since ByteArray no longer supports
-          // direct pointer-access to data values
-          std::vector<char> localBuffer;
-          buffer.copyTo(localBuffer);
-          rc = rawSendBytes(&localBuffer[0], localBuffer.size());
+          // send straight from the byte array
+          ByteArray::ByteSpan data = buffer.getReadSpan();
+          rc = rawSendBytes(data.data, data.size);
           if (this->SOCKET_FAIL != rc)
           {
             rtn = true;
@@ -101,12 +99,7 @@ namespace industrial
       bool rtn = false;
       shared_int remainBytes = num_bytes;
       bool ready, error;
-
-      // Reset the buffer (this is not required since the buffer length should
-      // ensure that we don't read any of the garbage that may be left over from
-      // a previous read), but it is good practice.
-
-      memset(&this->buffer_, 0, sizeof(this->buffer_));
+      ByteArray::ByteSpan dest;
 
       // Doing a sanity check to determine if the byte array buffer is smaller than
       // what can be received by the socket.
@@ -115,9 +108,23 @@ namespace industrial
         LOG_WARN("Socket buffer max size: %u, is larger than byte array buffer: %u",
             this->MAX_BUFFER_SIZE, buffer.getMaxBufferSize());
       }
+      // num_bytes usually comes off the wire, as a message length
+      if (num_bytes < 0 || num_bytes > this->MAX_BUFFER_SIZE)
+      {
+        LOG_ERROR("Bytes to receive: %d, outside of max socket size: %d", num_bytes, this->MAX_BUFFER_SIZE);
+        buffer.init();
+        return false;
+      }
       if (this->isConnected())
       {
+        // receive straight into the byte array
         buffer.init();
+        dest = buffer.getWriteSpan(num_bytes);
+        if (NULL == dest.data && num_bytes > 0)
+        {
+          LOG_ERROR("Failed to allocate %d bytes to receive into", num_bytes);
+          remainBytes = 0;
+        }
         while (remainBytes > 0)
         {
           // Polling the socket results in an "interruptable" socket read.  This
@@ -127,7 +134,7 @@ namespace industrial
           {
             if(ready)
             {
-              rc = rawReceiveBytes(this->buffer_, remainBytes);
+              rc = rawReceiveBytes(dest.data + (num_bytes - remainBytes), remainBytes);
               if (this->SOCKET_FAIL == rc)
               {
                 this->logSocketError("Socket received failed", rc, errno);
@@ -147,7 +154,6 @@ namespace industrial
                 remainBytes = remainBytes - rc;
                 LOG_COMM("Byte array receive, bytes read: %u, bytes reqd: %u, bytes left: %u",
                     rc, num_bytes, remainBytes);
-                buffer.load(&this->buffer_, rc);
                 rtn = true;
               }
             }
@@ -178,6 +184,8 @@ namespace industrial
 
       if (!rtn)
       {
+        // drop the bytes that were not received
+        buffer.init();
         this->setConnected(false);
       }
       return rtn;
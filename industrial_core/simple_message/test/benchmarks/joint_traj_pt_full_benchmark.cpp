@@ -0,0 +1,109 @@
+/*
+ * Times encoding JointTrajPtFull messages into the ByteArray that is sent on the wire
+ * (JointTrajPtFullMessage::toRequest() and SimpleMessage::toByteArray()), and decoding them
+ * from a received ByteArray (SimpleMessage::init() and JointTrajPtFullMessage::init()).
+ *
+ * Usage: joint_traj_pt_full_benchmark [n_messages] [n_repeats]
+ */
+
+#include "simple_message/byte_array.h"
+#include "simple_message/simple_message.h"
+#include "simple_message/messages/joint_traj_pt_full_message.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+using namespace industrial::byte_array;
+using namespace industrial::joint_data;
+using namespace industrial::joint_traj_pt_full;
+using namespace industrial::joint_traj_pt_full_message;
+using namespace industrial::shared_types;
+using namespace industrial::simple_message;
+
+namespace
+{
+
+double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+JointTrajPtFullMessage makeMessage()
+{
+  JointData positions, velocities, accelerations;
+  for (int i = 0; i < positions.getMaxNumJoints(); ++i)
+  {
+    positions.setJoint(i, 0.1 * i);
+    velocities.setJoint(i, 0.01 * i);
+    accelerations.setJoint(i, 0.001 * i);
+  }
+
+  JointTrajPtFull point;
+  point.init(1, 42,
+             ValidFieldTypes::TIME | ValidFieldTypes::POSITION | ValidFieldTypes::VELOCITY |
+                 ValidFieldTypes::ACCELERATION,
+             1.5, positions, velocities, accelerations);
+
+  JointTrajPtFullMessage msg;
+  msg.init(point);
+  return msg;
+}
+
+void report(const char* name, int repeat, unsigned int bytes, int n_messages, double seconds)
+{
+  std::printf("%-8s %8d %8u %14.1f %14.1f\n", name, repeat, bytes, seconds * 1e9 / n_messages,
+              n_messages * bytes / seconds / 1e6);
+}
+
+}  // anon namespace
+
+int main(int argc, char** argv)
+{
+  const int n_messages = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const int n_repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  JointTrajPtFullMessage msg = makeMessage();
+  SimpleMessage simple;
+  ByteArray wire;
+  msg.toRequest(simple);
+  simple.toByteArray(wire);
+  const unsigned int bytes = wire.getBufferSize();
+
+  std::printf("%d messages per repeat\n", n_messages);
+  std::printf("%-8s %8s %8s %14s %14s\n", "step", "repeat", "bytes", "ns / message", "MB / s");
+
+  shared_int checksum = 0;
+  for (int r = 0; r < n_repeats; ++r)
+  {
+    ByteArray encoded;
+    double start = now();
+    for (int i = 0; i < n_messages; ++i)
+    {
+      msg.setSequence(i);
+      msg.toRequest(simple);
+      simple.toByteArray(encoded);
+      checksum += encoded.getBufferSize();
+    }
+    report("encode", r, bytes, n_messages, now() - start);
+
+    ByteArray received;
+    JointTrajPtFullMessage decoded;
+    start = now();
+    for (int i = 0; i < n_messages; ++i)
+    {
+      received.copyFrom(wire);
+      simple.init(received);
+      decoded.init(simple);
+      checksum += decoded.point_.getSequence();
+    }
+    report("decode", r, bytes, n_messages, now() - start);
+  }
+
+  // keep the results alive
+  if (checksum == 42)
+    std::printf(" ");
+  return 0;
+}
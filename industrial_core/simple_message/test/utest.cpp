@@ -234,7 +234,7 @@ TEST(ByteArraySuite, copy)
 
   // Copy too large
   ByteArray tooBig;
-  if (tooBig.getMaxBufferSize()-1 <= std::numeric_limits<shared_int>::max())
+  if (tooBig.getMaxBufferSize() < (unsigned int)std::numeric_limits<shared_int>::max())
   {
       shared_int TOO_BIG = tooBig.getMaxBufferSize()-1;
       char bigBuffer[TOO_BIG];
@@ -249,6 +249,103 @@ TEST(ByteArraySuite, copy)
                 << "ByteArray.MaxSize==INT_MAX.  Skipping TOO_BIG tests" << std::endl;
 }
 
+TEST(ByteArraySuite, spans)
+{
+  const shared_int SIZE = 100;
+  char buffer[SIZE];
+  for (int i = 0; i < SIZE; i++)
+    buffer[i] = (char)i;
+
+  ByteArray bytes;
+  ByteArray::ByteSpan span = bytes.getReadSpan();
+  EXPECT_EQ(span.size, 0u);
+
+  // Writing in place
+  span = bytes.getWriteSpan(SIZE);
+  ASSERT_TRUE(NULL != span.data);
+  ASSERT_EQ((shared_int)span.size, SIZE);
+  memcpy(span.data, buffer, SIZE);
+  EXPECT_EQ((shared_int)bytes.getBufferSize(), SIZE);
+
+  // Reading in place sees the data that remains
+  char front[10];
+  ASSERT_TRUE(bytes.unloadFront(&front[0], sizeof(front)));
+  EXPECT_EQ(0, memcmp(front, buffer, sizeof(front)));
+  span = bytes.getReadSpan();
+  ASSERT_EQ((shared_int)span.size, SIZE - 10);
+  EXPECT_EQ(0, memcmp(span.data, buffer + 10, SIZE - 10));
+
+  // Appending after a front unload keeps the data contiguous
+  span = bytes.getWriteSpan(10);
+  ASSERT_TRUE(NULL != span.data);
+  memcpy(span.data, buffer, 10);
+  span = bytes.getReadSpan();
+  ASSERT_EQ((shared_int)span.size, SIZE);
+  EXPECT_EQ(0, memcmp(span.data, buffer + 10, SIZE - 10));
+  EXPECT_EQ(0, memcmp(span.data + SIZE - 10, buffer, 10));
+
+  // Negative or too large, the array is unchanged
+  span = bytes.getWriteSpan(-1);
+  EXPECT_TRUE(NULL == span.data);
+  EXPECT_EQ(span.size, 0u);
+  span = bytes.getWriteSpan(bytes.getMaxBufferSize());
+  EXPECT_TRUE(NULL == span.data);
+  EXPECT_EQ(span.size, 0u);
+  EXPECT_EQ((shared_int)bytes.getBufferSize(), SIZE);
+}
+
+TEST(ByteArraySuite, sliding)
+{
+  // Loading at the back while unloading from the front, the data stays in order
+  ByteArray bytes;
+  shared_int next_in = 0, next_out = 0, value;
+
+  for (int i = 0; i < 1000; i++)
+  {
+    for (int j = 0; j < 3; j++)
+      ASSERT_TRUE(bytes.load(next_in++));
+    for (int j = 0; j < 2; j++)
+    {
+      ASSERT_TRUE(bytes.unloadFront(value));
+      ASSERT_EQ(next_out++, value);
+    }
+  }
+  EXPECT_EQ((shared_int)bytes.getBufferSize(), (next_in - next_out) * (shared_int)sizeof(shared_int));
+
+  // Loading a byte array into itself
+  ByteArray twice;
+  ASSERT_TRUE(twice.load(next_in));
+  ASSERT_TRUE(twice.load(twice));
+  ASSERT_TRUE(twice.unload(value));
+  EXPECT_EQ(next_in, value);
+  ASSERT_TRUE(twice.unload(value));
+  EXPECT_EQ(next_in, value);
+}
+
+TEST(SimpleMessageSuite, reinit)
+{
+  // A message initialized twice holds the second data portion only
+  ByteArray data, msgBytes;
+  SimpleMessage msg, first, second;
+  shared_int value;
+
+  ASSERT_TRUE(data.load((shared_int)1));
+  ASSERT_TRUE(first.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID, data));
+  data.init();
+  ASSERT_TRUE(data.load((shared_int)2));
+  ASSERT_TRUE(second.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID, data));
+
+  first.toByteArray(msgBytes);
+  ASSERT_TRUE(msg.init(msgBytes));
+  second.toByteArray(msgBytes);
+  ASSERT_TRUE(msg.init(msgBytes));
+
+  EXPECT_EQ(msg.getDataLength(), (int)sizeof(shared_int));
+  ByteArray out = msg.getData();
+  ASSERT_TRUE(out.unload(value));
+  EXPECT_EQ(2, value);
+}
+
 // Need access to protected members for testing
 #ifndef UDP_TEST
 class TestClient : public TcpClient
@@ -262,6 +359,7 @@ class TestClient : public TcpClient
 class TestServer : public TcpServer
 {
   public:
+  using TcpServer::MAX_BUFFER_SIZE;
   bool receiveBytes(ByteArray & buffer, shared_int num_bytes)
   {
     return TcpServer::receiveBytes(buffer, num_bytes);
@@ -279,6 +377,7 @@ class TestClient : public UdpClient
 class TestServer : public UdpServer
 {
   public:
+  using UdpServer::MAX_BUFFER_SIZE;
   bool receiveBytes(ByteArray & buffer, shared_int num_bytes)
   {
     return UdpServer::receiveBytes(buffer, num_bytes);
@@ -334,6 +433,16 @@ TEST(SocketSuite, read)
   ASSERT_EQ(TWO_INTS, recv.getBufferSize());
   ASSERT_TRUE(server.receiveBytes(recv, ONE_INTS));
   ASSERT_EQ(ONE_INTS, recv.getBufferSize());
+
+  // Negative and oversized lengths are rejected without reading
+  ASSERT_TRUE(client.sendBytes(send));
+  EXPECT_FALSE(server.receiveBytes(recv, -1));
+  EXPECT_EQ(0u, recv.getBufferSize());
+  EXPECT_FALSE(server.receiveBytes(recv, TestServer::MAX_BUFFER_SIZE + 1));
+  EXPECT_FALSE(server.receiveBytes(recv, std::numeric_limits<shared_int>::max()));
+  ASSERT_TRUE(server.isConnected());
+  ASSERT_TRUE(server.receiveBytes(recv, ONE_INTS));
+  ASSERT_EQ(ONE_INTS, recv.getBufferSize());
 }
 
 
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstring>
 #include <string>
+#include "ur_modern_driver/bswap.h"
 #include "ur_modern_driver/log.h"
 #include "ur_modern_driver/types.h"
 
@@ -154,6 +155,14 @@ public:
     set = std::bitset<N>(val);
   }
 
+  // Decodes n consecutive 64 bit fields (doubles or integers) into dst in one pass
+  void parseWords(void* dst, size_t n)
+  {
+    assert(buf_pos_ + n * sizeof(uint64_t) <= buf_end_);
+    bswap64(buf_pos_, static_cast<uint8_t*>(dst), n);
+    buf_pos_ += n * sizeof(uint64_t);
+  }
+
   void consume()
   {
     buf_pos_ = buf_end_;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <endian.h>
+#include <inttypes.h>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Converts n 64 bit words between network (big endian) and host order.
+// Uses the widest byte shuffle the target supports, src and dst must not overlap.
+inline void bswap64(const uint8_t* src, uint8_t* dst, size_t n)
+{
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i mask32 = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                         14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 8));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 8), _mm256_shuffle_epi8(v, mask32));
+  }
+#endif
+
+#if defined(__SSSE3__)
+  const __m128i mask16 = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+  for (; i + 2 <= n; i += 2)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 8), _mm_shuffle_epi8(v, mask16));
+  }
+#elif defined(__SSE2__)
+  // swap the bytes of each 16 bit lane, then reverse the lanes of each word
+  for (; i + 2 <= n; i += 2)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 8));
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 8), v);
+  }
+#endif
+
+  for (; i < n; i++)
+  {
+    uint64_t word;
+    std::memcpy(&word, src + i * 8, sizeof(word));
+    word = be64toh(word);
+    std::memcpy(dst + i * 8, &word, sizeof(word));
+  }
+#else
+  std::memcpy(dst, src, n * sizeof(uint64_t));
+#endif
+}
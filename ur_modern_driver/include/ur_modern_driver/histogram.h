@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Counts samples in fixed width bins over [0, bins * width), larger samples
+// go into an overflow bin. add() does not allocate.
+class Histogram
+{
+private:
+  double width_;
+  std::vector<size_t> counts_;
+  size_t n_;
+  double sum_, min_, max_;
+
+public:
+  Histogram(size_t bins, double width) : width_(width), counts_(bins + 1)
+  {
+    clear();
+  }
+
+  void add(double value)
+  {
+    value = std::max(value, 0.0);
+    size_t bin = static_cast<size_t>(value / width_);
+    counts_[std::min(bin, counts_.size() - 1)]++;
+    n_++;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  void clear()
+  {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    n_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = 0;
+  }
+
+  size_t count() const
+  {
+    return n_;
+  }
+  double mean() const
+  {
+    return n_ > 0 ? sum_ / n_ : 0;
+  }
+  double min() const
+  {
+    return n_ > 0 ? min_ : 0;
+  }
+  double max() const
+  {
+    return max_;
+  }
+
+  // upper edge of the bin holding the p-th quantile (0 < p <= 1),
+  // or max() if that is the overflow bin
+  double quantile(double p) const
+  {
+    size_t target = static_cast<size_t>(p * n_ + 0.5);
+    size_t seen = 0;
+    for (size_t i = 0; i + 1 < counts_.size(); i++)
+    {
+      seen += counts_[i];
+      if (seen >= target)
+        return std::min((i + 1) * width_, max_);
+    }
+    return max_;
+  }
+
+  size_t bins() const
+  {
+    return counts_.size();
+  }
+  size_t binCount(size_t bin) const
+  {
+    return counts_[bin];
+  }
+  double binWidth() const
+  {
+    return width_;
+  }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+template <typename T>
+class IPacketRecycler
+{
+public:
+  virtual void recycle(T* packet) = 0;
+};
+
+// Deleter handing a packet back to the pool it was acquired from,
+// or deleting it if it was allocated outside of a pool
+template <typename T>
+struct PacketDeleter
+{
+  IPacketRecycler<T>* pool;
+
+  PacketDeleter(IPacketRecycler<T>* pool = nullptr) : pool(pool)
+  {
+  }
+
+  void operator()(T* packet) const
+  {
+    if (pool)
+      pool->recycle(packet);
+    else
+      delete packet;
+  }
+};
+
+template <typename T>
+using PacketPtr = std::unique_ptr<T, PacketDeleter<T>>;
+
+// Fixed set of preallocated packets of type T, handed out as PacketPtr<Base>
+// and returned to the pool when the handle is destroyed. Handles may be
+// destroyed on any thread but must not outlive the pool. Once the pool is
+// exhausted acquire() falls back to the heap.
+template <typename Base, typename T>
+class PacketPool : public IPacketRecycler<Base>
+{
+private:
+  std::unique_ptr<T[]> packets_;
+  std::vector<T*> free_;
+  std::mutex mutex_;
+  size_t misses_;
+
+public:
+  PacketPool(size_t size) : packets_(new T[size]), misses_(0)
+  {
+    free_.reserve(size);
+    for (size_t i = 0; i < size; i++)
+    {
+      free_.push_back(&packets_[i]);
+    }
+  }
+
+  PacketPtr<Base> acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_.empty())
+      {
+        T* packet = free_.back();
+        free_.pop_back();
+        return PacketPtr<Base>(packet, PacketDeleter<Base>(this));
+      }
+      misses_++;
+    }
+    return PacketPtr<Base>(new T);
+  }
+
+  void recycle(Base* packet)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(static_cast<T*>(packet));
+  }
+
+  // number of acquire() calls that had to allocate
+  size_t misses()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+};
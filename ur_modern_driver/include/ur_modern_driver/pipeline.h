@@ -5,11 +5,19 @@
 #include <thread>
 #include <vector>
 #include "ur_modern_driver/log.h"
+#include "ur_modern_driver/packet_pool.h"
 #include "ur_modern_driver/queue/readerwriterqueue.h"
 
 using namespace moodycamel;
 using namespace std;
 
+// number of products the pipeline buffers between producer and consumer, the
+// producer drops products beyond it even though the queue rounds its capacity up
+static const size_t PIPELINE_QUEUE_SIZE = 32;
+// a packet pool this large is never exhausted by one pipeline: a full queue,
+// one product being consumed and one being produced
+static const size_t PIPELINE_POOL_SIZE = PIPELINE_QUEUE_SIZE + 2;
+
 template <typename T>
 class IConsumer
 {
@@ -27,7 +35,9 @@ public:
   {
   }
 
-  virtual bool consume(shared_ptr<T> product) = 0;
+  // product is only borrowed for the duration of the call, it
+  // is returned to its producer's pool once all consumers are done
+  virtual bool consume(T& product) = 0;
 };
 
 template <typename T>
@@ -70,7 +80,7 @@ public:
     }
   }
 
-  bool consume(shared_ptr<T> product)
+  bool consume(T& product)
   {
     bool res = true;
     for (auto& con : consumers_)
@@ -96,7 +106,7 @@ public:
   {
   }
 
-  virtual bool tryGet(std::vector<unique_ptr<T>>& products) = 0;
+  virtual bool tryGet(std::vector<PacketPtr<T>>& products) = 0;
 };
 
 template <typename T>
@@ -107,14 +117,16 @@ private:
   typedef Clock::time_point Time;
   IProducer<T>& producer_;
   IConsumer<T>& consumer_;
-  BlockingReaderWriterQueue<unique_ptr<T>> queue_;
+  BlockingReaderWriterQueue<PacketPtr<T>> queue_;
   atomic<bool> running_;
   thread pThread_, cThread_;
 
   void run_producer()
   {
     producer_.setupProducer();
-    std::vector<unique_ptr<T>> products;
+    // reused for every read so that it stops allocating once warmed up
+    std::vector<PacketPtr<T>> products;
+    products.reserve(8);
     while (running_)
     {
       if (!producer_.tryGet(products))
@@ -124,7 +136,8 @@ private:
 
       for (auto& p : products)
       {
-        if (!queue_.try_enqueue(std::move(p)))
+        // the consumer only shrinks the queue, so size_approx() never undercounts here
+        if (queue_.size_approx() >= PIPELINE_QUEUE_SIZE || !queue_.try_enqueue(std::move(p)))
         {
           LOG_ERROR("Pipeline producer owerflowed!");
         }
@@ -140,7 +153,7 @@ private:
   void run_consumer()
   {
     consumer_.setupConsumer();
-    unique_ptr<T> product;
+    PacketPtr<T> product;
     Time last_pkg = Clock::now();
     Time last_warn = last_pkg;
     while (running_)
@@ -162,7 +175,9 @@ private:
       }
 
       last_pkg = Clock::now();
-      if (!consumer_.consume(std::move(product)))
+      bool ok = consumer_.consume(*product);
+      product.reset();
+      if (!ok)
         break;
     }
     consumer_.teardownConsumer();
@@ -172,7 +187,7 @@ private:
 
 public:
   Pipeline(IProducer<T>& producer, IConsumer<T>& consumer)
-    : producer_(producer), consumer_(consumer), queue_{ 32 }, running_{ false }
+    : producer_(producer), consumer_(consumer), queue_{ PIPELINE_QUEUE_SIZE }, running_{ false }
   {
   }
 
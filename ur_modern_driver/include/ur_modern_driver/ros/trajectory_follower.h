@@ -3,12 +3,16 @@
 #include <inttypes.h>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstring>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
+#include "ur_modern_driver/histogram.h"
 #include "ur_modern_driver/log.h"
+#include "ur_modern_driver/queue/readerwriterqueue.h"
 #include "ur_modern_driver/ur/commander.h"
 #include "ur_modern_driver/ur/server.h"
 
@@ -28,9 +32,29 @@ struct TrajectoryPoint
   }
 };
 
+struct ServojParams
+{
+  double time = 0.008;
+  double lookahead_time = 0.03;
+  double gain = 300.;
+  // send trajectories one setpoint per RT state packet, see TrajectoryFollower::tick()
+  bool rt_clock = false;
+  // number of setpoints interpolated ahead of the RT clock
+  size_t rt_buffer = 4;
+};
+
 class TrajectoryFollower
 {
 private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Setpoint
+  {
+    std::array<double, 6> positions;
+    double time;  // since the start of the trajectory
+    unsigned generation;
+  };
+
   std::atomic<bool> running_;
   std::array<double, 6> last_positions_;
   URCommander &commander_;
@@ -39,6 +63,25 @@ private:
   double servoj_time_, servoj_lookahead_time_, servoj_gain_;
   std::string program_;
 
+  // RT clocked streaming, setpoints_ is filled by execute() and drained by tick().
+  // generation_ changes at the start and end of every trajectory, tick() drops the
+  // setpoints of earlier ones. streaming_ is set once the buffer is primed.
+  bool rt_clock_;
+  size_t rt_buffer_;
+  moodycamel::ReaderWriterQueue<Setpoint> setpoints_;
+  moodycamel::spsc_sema::LightweightSemaphore tick_sema_;
+  std::atomic<unsigned> generation_;
+  std::atomic<bool> streaming_, stream_failed_;
+  std::atomic<double> rt_period_;
+  // only touched by tick()
+  bool tick_streaming_;
+  double last_tick_time_, last_send_time_, stream_start_;
+  Clock::time_point last_send_;
+  // filled by tick(), in microseconds
+  std::mutex stats_mutex_;
+  Histogram latency_, jitter_;
+  size_t underruns_, skipped_;
+
   template <typename T>
   size_t append(uint8_t *buffer, T &val)
   {
@@ -49,13 +92,28 @@ private:
 
   bool execute(std::array<double, 6> &positions, bool keep_alive);
   double interpolate(double t, double T, double p0_pos, double p1_pos, double p0_vel, double p1_vel);
+  bool stream(std::vector<TrajectoryPoint> &trajectory, std::atomic<bool> &interrupt);
+  bool waitTick();
 
 public:
+  // reads ServojParams from the ~servoj_* parameters
   TrajectoryFollower(URCommander &commander, std::string &reverse_ip, int reverse_port, bool version_3);
+  TrajectoryFollower(URCommander &commander, std::string &reverse_ip, int reverse_port, bool version_3,
+                     const ServojParams &params);
 
   bool start();
   bool execute(std::array<double, 6> &positions);
   bool execute(std::vector<TrajectoryPoint> &trajectory, std::atomic<bool> &interrupt);
   void stop();
   void interrupt();
+
+  // Called for every RT state packet with its controller time. While a
+  // trajectory is executed in rt_clock mode this sends exactly one setpoint.
+  void tick(double controller_time);
+
+  // statistics of the last trajectory streamed in rt_clock mode
+  Histogram latencyHistogram();
+  Histogram jitterHistogram();
+  size_t underruns();
+  size_t skipped();
 };
\ No newline at end of file
@@ -10,9 +10,9 @@
 class URRTPacketConsumer : public IConsumer<RTPacket>
 {
 public:
-  virtual bool consume(shared_ptr<RTPacket> packet)
+  virtual bool consume(RTPacket& packet)
   {
-    return packet->consumeWith(*this);
+    return packet.consumeWith(*this);
   }
 
   virtual bool consume(RTState_V1_6__7& state) = 0;
@@ -24,9 +24,9 @@ public:
 class URStatePacketConsumer : public IConsumer<StatePacket>
 {
 public:
-  virtual bool consume(shared_ptr<StatePacket> packet)
+  virtual bool consume(StatePacket& packet)
   {
-    return packet->consumeWith(*this);
+    return packet.consumeWith(*this);
   }
 
   virtual bool consume(MasterBoardData_V1_X& data) = 0;
@@ -41,9 +41,9 @@ public:
 class URMessagePacketConsumer : public IConsumer<MessagePacket>
 {
 public:
-  virtual bool consume(shared_ptr<MessagePacket> packet)
+  virtual bool consume(MessagePacket& packet)
   {
-    return packet->consumeWith(*this);
+    return packet.consumeWith(*this);
   }
 
   virtual bool consume(VersionMessage& message) = 0;
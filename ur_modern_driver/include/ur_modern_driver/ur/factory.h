@@ -47,7 +47,7 @@ public:
   URFactory(std::string& host) : stream_(host, UR_PRIMARY_PORT)
   {
     URProducer<MessagePacket> prod(stream_, parser_);
-    std::vector<unique_ptr<MessagePacket>> results;
+    std::vector<PacketPtr<MessagePacket>> results;
 
     prod.setupProducer();
 
@@ -9,7 +9,7 @@
 class URMessageParser : public URParser<MessagePacket>
 {
 public:
-  bool parse(BinParser& bp, std::vector<unique_ptr<MessagePacket>>& results)
+  bool parse(BinParser& bp, std::vector<PacketPtr<MessagePacket>>& results)
   {
     int32_t packet_size;
     message_type type;
@@ -30,7 +30,7 @@ public:
     bp.parse(source);
     bp.parse(message_type);
 
-    std::unique_ptr<MessagePacket> result;
+    PacketPtr<MessagePacket> result;
     bool parsed = false;
 
     switch (message_type)
@@ -7,5 +7,8 @@ template <typename T>
 class URParser
 {
 public:
-  virtual bool parse(BinParser& bp, std::vector<std::unique_ptr<T>>& results) = 0;
+  virtual ~URParser()
+  {
+  }
+  virtual bool parse(BinParser& bp, std::vector<PacketPtr<T>>& results) = 0;
 };
@@ -30,7 +30,7 @@ public:
     stream_.disconnect();
   }
 
-  bool tryGet(std::vector<unique_ptr<T>>& products)
+  bool tryGet(std::vector<PacketPtr<T>>& products)
   {
     // 4KB should be enough to hold any packet received from UR
     uint8_t buf[4096];
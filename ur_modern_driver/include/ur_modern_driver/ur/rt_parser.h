@@ -9,8 +9,15 @@
 template <typename T>
 class URRTStateParser : public URParser<RTPacket>
 {
+private:
+  PacketPool<RTPacket, T> pool_;
+
 public:
-  bool parse(BinParser& bp, std::vector<std::unique_ptr<RTPacket>>& results)
+  URRTStateParser() : pool_(PIPELINE_POOL_SIZE)
+  {
+  }
+
+  bool parse(BinParser& bp, std::vector<PacketPtr<RTPacket>>& results)
   {
     int32_t packet_size = bp.peek<int32_t>();
 
@@ -22,7 +29,7 @@ public:
 
     bp.parse(packet_size);  // consumes the peeked data
 
-    std::unique_ptr<RTPacket> packet(new T);
+    PacketPtr<RTPacket> packet(pool_.acquire());
     if (!packet->parseWith(bp))
       return false;
 
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <inttypes.h>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "ur_modern_driver/bin_parser.h"
+#include "ur_modern_driver/bswap.h"
+
+// RT state packets consist solely of 64 bit fields (doubles and bitmasks),
+// so a packet version is fully described by the sequence of its fields and
+// the number of words each one occupies. RTSchema resolves the fields to
+// offsets into T once, merging fields that are adjacent both on the wire
+// and in T into runs. Decoding validates the packet length once and then
+// byte swaps each run in bulk straight into the packet.
+template <typename T>
+class RTSchema
+{
+public:
+  struct Field
+  {
+    size_t words;
+    void* (*member)(T&);  // nullptr for words that are skipped
+  };
+
+private:
+  struct Run
+  {
+    size_t wire;    // byte offset in the packet
+    size_t member;  // byte offset in T
+    size_t words;
+  };
+
+  std::vector<Field> fields_;
+  std::vector<Run> runs_;
+  size_t words_;
+
+public:
+  RTSchema(std::vector<Field> fields) : fields_(fields), words_(0)
+  {
+    T prototype;
+    uint8_t* base = reinterpret_cast<uint8_t*>(&prototype);
+    for (auto const& f : fields_)
+    {
+      if (f.member)
+      {
+        Run run{ words_ * sizeof(uint64_t), static_cast<size_t>(static_cast<uint8_t*>(f.member(prototype)) - base),
+                 f.words };
+        Run* last = runs_.empty() ? nullptr : &runs_.back();
+        if (last && last->wire + last->words * sizeof(uint64_t) == run.wire &&
+            last->member + last->words * sizeof(uint64_t) == run.member)
+          last->words += run.words;
+        else
+          runs_.push_back(run);
+      }
+      words_ += f.words;
+    }
+  }
+
+  // bytes on the wire, including skipped fields
+  size_t size() const
+  {
+    return words_ * sizeof(uint64_t);
+  }
+
+  const std::vector<Field>& fields() const
+  {
+    return fields_;
+  }
+
+  bool decode(BinParser& bp, T& packet) const
+  {
+    if (!bp.checkSize(size()))
+      return false;
+
+    BinParser pp(bp, size());
+    uint8_t* base = reinterpret_cast<uint8_t*>(&packet);
+    size_t wire = 0;
+    for (auto const& r : runs_)
+    {
+      pp.consume(r.wire - wire);
+      pp.parseWords(base + r.member, r.words);
+      wire = r.wire + r.words * sizeof(uint64_t);
+    }
+    pp.consume();
+    return true;
+  }
+
+  // inverse of decode(), writes size() bytes with skipped fields zeroed
+  void encode(const T& packet, uint8_t* buf) const
+  {
+    for (auto const& f : fields_)
+    {
+      size_t len = f.words * sizeof(uint64_t);
+      if (f.member)
+        bswap64(static_cast<const uint8_t*>(f.member(const_cast<T&>(packet))), buf, f.words);
+      else
+        std::memset(buf, 0, len);
+      buf += len;
+    }
+  }
+};
+
+// Field of T covering all of member 'name', which must consist of 64 bit values only
+#define RT_FIELD(T, name)                                                                                              \
+  typename RTSchema<T>::Field                                                                                          \
+  {                                                                                                                    \
+    sizeof(T::name) / sizeof(uint64_t), [](T& p) -> void* { return &p.name; }                                         \
+  }
+
+// n words that are skipped
+#define RT_SKIP(T, n)                                                                                                  \
+  typename RTSchema<T>::Field                                                                                          \
+  {                                                                                                                    \
+    n, nullptr                                                                                                         \
+  }
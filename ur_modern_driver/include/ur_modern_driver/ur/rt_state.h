@@ -5,22 +5,22 @@
 #include "ur_modern_driver/bin_parser.h"
 #include "ur_modern_driver/pipeline.h"
 #include "ur_modern_driver/types.h"
+#include "ur_modern_driver/ur/rt_schema.h"
 
 class URRTPacketConsumer;
 
 class RTPacket
 {
 public:
+  virtual ~RTPacket()
+  {
+  }
   virtual bool parseWith(BinParser& bp) = 0;
   virtual bool consumeWith(URRTPacketConsumer& consumer) = 0;
 };
 
 class RTShared
 {
-protected:
-  void parse_shared1(BinParser& bp);
-  void parse_shared2(BinParser& bp);
-
 public:
   double time;
   std::array<double, 6> q_target;
@@ -57,6 +57,8 @@ class RTState_V1_6__7 : public RTShared, public RTPacket
 public:
   bool parseWith(BinParser& bp);
   virtual bool consumeWith(URRTPacketConsumer& consumer);
+  // wire format, see rt_state.cpp
+  static const RTSchema<RTState_V1_6__7>& schema();
 
   double3_t tool_accelerometer_values;
 
@@ -70,6 +72,8 @@ class RTState_V1_8 : public RTState_V1_6__7
 public:
   bool parseWith(BinParser& bp);
   virtual bool consumeWith(URRTPacketConsumer& consumer);
+  // wire format, see rt_state.cpp
+  static const RTSchema<RTState_V1_8>& schema();
 
   std::array<double, 6> joint_modes;
 
@@ -83,6 +87,8 @@ class RTState_V3_0__1 : public RTShared, public RTPacket
 public:
   bool parseWith(BinParser& bp);
   virtual bool consumeWith(URRTPacketConsumer& consumer);
+  // wire format, see rt_state.cpp
+  static const RTSchema<RTState_V3_0__1>& schema();
 
   std::array<double, 6> i_control;
   cartesian_coord_t tool_vector_target;
@@ -109,6 +115,8 @@ class RTState_V3_2__3 : public RTState_V3_0__1
 public:
   bool parseWith(BinParser& bp);
   virtual bool consumeWith(URRTPacketConsumer& consumer);
+  // wire format, see rt_state.cpp
+  static const RTSchema<RTState_V3_2__3>& schema();
 
   uint64_t digital_outputs;
   double program_state;
@@ -12,21 +12,28 @@ template <typename RMD, typename MBD>
 class URStateParser : public URParser<StatePacket>
 {
 private:
-  StatePacket* from_type(package_type type)
+  PacketPool<StatePacket, RMD> rmd_pool_;
+  PacketPool<StatePacket, MBD> mbd_pool_;
+
+  PacketPtr<StatePacket> from_type(package_type type)
   {
     switch (type)
     {
       case package_type::ROBOT_MODE_DATA:
-        return new RMD;
+        return rmd_pool_.acquire();
       case package_type::MASTERBOARD_DATA:
-        return new MBD;
+        return mbd_pool_.acquire();
       default:
         return nullptr;
     }
   }
 
 public:
-  bool parse(BinParser& bp, std::vector<std::unique_ptr<StatePacket>>& results)
+  URStateParser() : rmd_pool_(PIPELINE_POOL_SIZE), mbd_pool_(PIPELINE_POOL_SIZE)
+  {
+  }
+
+  bool parse(BinParser& bp, std::vector<PacketPtr<StatePacket>>& results)
   {
     int32_t packet_size;
     message_type type;
@@ -65,7 +72,7 @@ public:
       package_type type;
       sbp.parse(type);
 
-      std::unique_ptr<StatePacket> packet(from_type(type));
+      PacketPtr<StatePacket> packet(from_type(type));
 
       if (packet == nullptr)
       {
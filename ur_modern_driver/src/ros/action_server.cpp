@@ -59,6 +59,7 @@ bool ActionServer::updateState(RTShared& data)
 {
   q_actual_ = data.q_actual;
   qd_actual_ = data.qd_actual;
+  follower_.tick(data.time);
   return true;
 }
 
@@ -8,6 +8,11 @@ static const std::string JOINT_STATE_REPLACE("{{JOINT_STATE_REPLACE}}");
 static const std::string SERVO_J_REPLACE("{{SERVO_J_REPLACE}}");
 static const std::string SERVER_IP_REPLACE("{{SERVER_IP_REPLACE}}");
 static const std::string SERVER_PORT_REPLACE("{{SERVER_PORT_REPLACE}}");
+// RT clocked streaming gives up when no RT state packet arrives for this long
+static const int64_t RT_TICK_TIMEOUT_US = 100000;
+// latency and jitter histograms cover 0-2 ms in 50 us bins
+static const size_t RT_HISTOGRAM_BINS = 40;
+static const double RT_HISTOGRAM_WIDTH = 50.0;
 static const std::string POSITION_PROGRAM = R"(
 def driverProg():
 	MULT_jointstate = {{JOINT_STATE_REPLACE}}
@@ -65,19 +70,49 @@ def driverProg():
 end
 )";
 
+static ServojParams loadServojParams()
+{
+  ServojParams params;
+  ros::param::get("~servoj_time", params.time);
+  ros::param::get("~servoj_lookahead_time", params.lookahead_time);
+  ros::param::get("~servoj_gain", params.gain);
+  ros::param::get("~servoj_rt_clock", params.rt_clock);
+  int rt_buffer;
+  if (ros::param::get("~servoj_rt_buffer", rt_buffer) && rt_buffer > 0)
+    params.rt_buffer = static_cast<size_t>(rt_buffer);
+  return params;
+}
+
 TrajectoryFollower::TrajectoryFollower(URCommander &commander, std::string &reverse_ip, int reverse_port,
                                        bool version_3)
+  : TrajectoryFollower(commander, reverse_ip, reverse_port, version_3, loadServojParams())
+{
+}
+
+TrajectoryFollower::TrajectoryFollower(URCommander &commander, std::string &reverse_ip, int reverse_port,
+                                       bool version_3, const ServojParams &params)
   : running_(false)
   , commander_(commander)
   , server_(reverse_port)
-  , servoj_time_(0.008)
-  , servoj_lookahead_time_(0.03)
-  , servoj_gain_(300.)
+  , servoj_time_(params.time)
+  , servoj_lookahead_time_(params.lookahead_time)
+  , servoj_gain_(params.gain)
+  , rt_clock_(params.rt_clock)
+  , rt_buffer_(params.rt_buffer)
+  , setpoints_(params.rt_buffer)
+  , generation_(0)
+  , streaming_(false)
+  , stream_failed_(false)
+  , rt_period_(0)
+  , tick_streaming_(false)
+  , last_tick_time_(0)
+  , last_send_time_(0)
+  , stream_start_(0)
+  , latency_(RT_HISTOGRAM_BINS, RT_HISTOGRAM_WIDTH)
+  , jitter_(RT_HISTOGRAM_BINS, RT_HISTOGRAM_WIDTH)
+  , underruns_(0)
+  , skipped_(0)
 {
-  ros::param::get("~servoj_time", servoj_time_);
-  ros::param::get("~servoj_lookahead_time", servoj_lookahead_time_);
-  ros::param::get("~servoj_gain", servoj_gain_);
-
   std::string res(POSITION_PROGRAM);
   res.replace(res.find(JOINT_STATE_REPLACE), JOINT_STATE_REPLACE.length(), std::to_string(MULT_JOINTSTATE_));
 
@@ -170,6 +205,9 @@ bool TrajectoryFollower::execute(std::vector<TrajectoryPoint> &trajectory, std::
   if (!running_)
     return false;
 
+  if (rt_clock_)
+    return stream(trajectory, interrupt);
+
   using namespace std::chrono;
   typedef duration<double> double_seconds;
   typedef high_resolution_clock Clock;
@@ -230,6 +268,206 @@ bool TrajectoryFollower::execute(std::vector<TrajectoryPoint> &trajectory, std::
   return execute(last.positions, true);
 }
 
+bool TrajectoryFollower::waitTick()
+{
+  return tick_sema_.wait(RT_TICK_TIMEOUT_US);
+}
+
+bool TrajectoryFollower::stream(std::vector<TrajectoryPoint> &trajectory, std::atomic<bool> &interrupt)
+{
+  using namespace std::chrono;
+  typedef duration<double> double_seconds;
+
+  // discard ticks counted while idle
+  while (tick_sema_.tryWait())
+    ;
+
+  // setpoints are interpolated on the RT period, which is learnt from the controller time of the packets.
+  // Leftovers of an interrupted trajectory are dropped by tick() before they are counted against the buffer
+  while (rt_period_ <= 0 || setpoints_.size_approx() > 0)
+  {
+    if (!waitTick())
+    {
+      LOG_ERROR("No RT state packets received, can't stream trajectory");
+      return false;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    latency_.clear();
+    jitter_.clear();
+    underruns_ = 0;
+    skipped_ = 0;
+  }
+  stream_failed_ = false;
+
+  // tick() holds off until streaming_ is set and keeps the setpoints of this generation
+  Setpoint sp;
+  sp.generation = ++generation_;
+  double period = rt_period_;
+  double end = duration_cast<double_seconds>(trajectory.back().time_from_start).count();
+  size_t next = 1;
+  bool ok = true;
+
+  for (size_t k = 1; ok; k++)
+  {
+    sp.time = k * period;
+    while (next + 1 < trajectory.size() &&
+           duration_cast<double_seconds>(trajectory[next].time_from_start).count() <= sp.time)
+      next++;
+
+    if (sp.time >= end || trajectory.size() < 2)
+    {
+      sp.positions = trajectory.back().positions;
+    }
+    else
+    {
+      auto &prev = trajectory[next - 1];
+      auto &point = trajectory[next];
+      double t0 = duration_cast<double_seconds>(prev.time_from_start).count();
+      double d_s = duration_cast<double_seconds>(point.time_from_start - prev.time_from_start).count();
+      for (size_t j = 0; j < sp.positions.size(); j++)
+      {
+        sp.positions[j] = interpolate(sp.time - t0, d_s, prev.positions[j], point.positions[j], prev.velocities[j],
+                                      point.velocities[j]);
+      }
+    }
+
+    // stay at most rt_buffer_ setpoints ahead of the RT clock, streaming starts once the buffer is full
+    while (ok && setpoints_.size_approx() >= rt_buffer_)
+    {
+      streaming_ = true;
+      ok = !interrupt && !stream_failed_ && waitTick();
+    }
+
+    if (!ok || sp.time >= end)
+      break;
+    setpoints_.try_enqueue(sp);
+  }
+
+  // the last setpoint is sent by tick() until the buffer has drained
+  if (ok)
+  {
+    setpoints_.try_enqueue(sp);
+    streaming_ = true;
+    while (ok && setpoints_.size_approx() > 0)
+      ok = !interrupt && !stream_failed_ && waitTick();
+  }
+  streaming_ = false;
+  ++generation_;
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    LOG_INFO("Streamed %zu setpoints, %zu underruns, %zu skipped", latency_.count(), underruns_, skipped_);
+    LOG_INFO("Setpoint latency (us): mean %.0f, p99 %.0f, max %.0f", latency_.mean(), latency_.quantile(0.99),
+             latency_.max());
+    LOG_INFO("RT packet jitter (us): mean %.0f, p99 %.0f, max %.0f", jitter_.mean(), jitter_.quantile(0.99),
+             jitter_.max());
+  }
+
+  // interrupted trajectories are not failures, see execute() above
+  if (interrupt)
+    return true;
+  if (!ok)
+    LOG_ERROR("RT state packets stopped arriving or setpoints could not be sent");
+  return ok && !stream_failed_;
+}
+
+void TrajectoryFollower::tick(double controller_time)
+{
+  Clock::time_point now = Clock::now();
+  double dt = controller_time - last_tick_time_;
+  last_tick_time_ = controller_time;
+  if (dt > 0 && dt < 0.1)
+    rt_period_ = dt;
+
+  // drop what is left of an interrupted trajectory. The setpoint is peeked before generation_
+  // is read, so a setpoint of the trajectory being streamed is never taken for a leftover
+  Setpoint *sp = setpoints_.peek();
+  while (sp != nullptr && sp->generation != generation_)
+  {
+    setpoints_.pop();
+    sp = setpoints_.peek();
+  }
+
+  // hold off until stream() has primed the buffer
+  if (!streaming_)
+  {
+    tick_streaming_ = false;
+    tick_sema_.signal();
+    return;
+  }
+
+  if (!tick_streaming_)
+  {
+    tick_streaming_ = true;
+    stream_start_ = controller_time - rt_period_;
+  }
+
+  // setpoints belonging to ticks that never arrived are skipped to stay on the controller clock,
+  // but the last one is always sent
+  double t = controller_time - stream_start_;
+  size_t skipped = 0;
+  while (setpoints_.size_approx() > 1 && setpoints_.peek()->time < t - rt_period_ / 2)
+  {
+    setpoints_.pop();
+    skipped++;
+  }
+
+  sp = setpoints_.peek();
+  if (sp == nullptr)
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    underruns_++;
+    tick_sema_.signal();
+    return;
+  }
+
+  if (!execute(sp->positions, true))
+    stream_failed_ = true;
+  setpoints_.pop();
+
+  Clock::time_point sent = Clock::now();
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    latency_.add(std::chrono::duration<double, std::micro>(sent - now).count());
+    // arrival of the packet relative to the previous one sent on, compared to the controller clock
+    if (latency_.count() > 1)
+      jitter_.add(std::fabs(std::chrono::duration<double, std::micro>(now - last_send_).count() -
+                            (controller_time - last_send_time_) * 1e6));
+    skipped_ += skipped;
+  }
+  last_send_ = now;
+  last_send_time_ = controller_time;
+
+  tick_sema_.signal();
+}
+
+Histogram TrajectoryFollower::latencyHistogram()
+{
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return latency_;
+}
+
+Histogram TrajectoryFollower::jitterHistogram()
+{
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return jitter_;
+}
+
+size_t TrajectoryFollower::underruns()
+{
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return underruns_;
+}
+
+size_t TrajectoryFollower::skipped()
+{
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return skipped_;
+}
+
 void TrajectoryFollower::stop()
 {
   if (!running_)
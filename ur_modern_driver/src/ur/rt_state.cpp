@@ -1,102 +1,106 @@
 #include "ur_modern_driver/ur/rt_state.h"
 #include "ur_modern_driver/ur/consumer.h"
 
-void RTShared::parse_shared1(BinParser& bp)
-{
-  bp.parse(time);
-  bp.parse(q_target);
-  bp.parse(qd_target);
-  bp.parse(qdd_target);
-  bp.parse(i_target);
-  bp.parse(m_target);
-  bp.parse(q_actual);
-  bp.parse(qd_actual);
-  bp.parse(i_actual);
+template <typename T>
+using Fields = std::vector<typename RTSchema<T>::Field>;
+
+template <typename T>
+static void shared1(Fields<T>& f)
+{
+  f.insert(f.end(), { RT_FIELD(T, time), RT_FIELD(T, q_target), RT_FIELD(T, qd_target), RT_FIELD(T, qdd_target),
+                      RT_FIELD(T, i_target), RT_FIELD(T, m_target), RT_FIELD(T, q_actual), RT_FIELD(T, qd_actual),
+                      RT_FIELD(T, i_actual) });
 }
 
-void RTShared::parse_shared2(BinParser& bp)
+template <typename T>
+static void shared2(Fields<T>& f)
 {
-  bp.parse(digital_inputs);
-  bp.parse(motor_temperatures);
-  bp.parse(controller_time);
-  bp.consume(sizeof(double));  // Unused "Test value" field
-  bp.parse(robot_mode);
+  f.insert(f.end(), { RT_FIELD(T, digital_inputs), RT_FIELD(T, motor_temperatures), RT_FIELD(T, controller_time),
+                      RT_SKIP(T, 1),  // Unused "Test value" field
+                      RT_FIELD(T, robot_mode) });
 }
 
-bool RTState_V1_6__7::parseWith(BinParser& bp)
+template <typename T>
+static Fields<T> fields_V1_6__7()
 {
-  if (!bp.checkSize<RTState_V1_6__7>())
-    return false;
+  Fields<T> f;
+  shared1<T>(f);
+  f.insert(f.end(), { RT_FIELD(T, tool_accelerometer_values), RT_SKIP(T, 15), RT_FIELD(T, tcp_force),
+                      RT_FIELD(T, tool_vector_actual), RT_FIELD(T, tcp_speed_actual) });
+  shared2<T>(f);
+  return f;
+}
 
-  parse_shared1(bp);
+template <typename T>
+static Fields<T> fields_V1_8()
+{
+  Fields<T> f = fields_V1_6__7<T>();
+  f.push_back(RT_FIELD(T, joint_modes));
+  return f;
+}
 
-  bp.parse(tool_accelerometer_values);
-  bp.consume(sizeof(double) * 15);
-  bp.parse(tcp_force);
-  bp.parse(tool_vector_actual);
-  bp.parse(tcp_speed_actual);
+template <typename T>
+static Fields<T> fields_V3_0__1()
+{
+  Fields<T> f;
+  shared1<T>(f);
+  f.insert(f.end(), { RT_FIELD(T, i_control), RT_FIELD(T, tool_vector_actual), RT_FIELD(T, tcp_speed_actual),
+                      RT_FIELD(T, tcp_force), RT_FIELD(T, tool_vector_target), RT_FIELD(T, tcp_speed_target) });
+  shared2<T>(f);
+  f.insert(f.end(), { RT_FIELD(T, joint_modes), RT_FIELD(T, safety_mode),
+                      RT_SKIP(T, 6),  // skip undocumented
+                      RT_FIELD(T, tool_accelerometer_values),
+                      RT_SKIP(T, 6),  // skip undocumented
+                      RT_FIELD(T, speed_scaling), RT_FIELD(T, linear_momentum_norm),
+                      RT_SKIP(T, 2),  // skip undocumented
+                      RT_FIELD(T, v_main), RT_FIELD(T, v_robot), RT_FIELD(T, i_robot), RT_FIELD(T, v_actual) });
+  return f;
+}
 
-  parse_shared2(bp);
+template <typename T>
+static Fields<T> fields_V3_2__3()
+{
+  Fields<T> f = fields_V3_0__1<T>();
+  f.insert(f.end(), { RT_FIELD(T, digital_outputs), RT_FIELD(T, program_state) });
+  return f;
+}
 
-  return true;
+const RTSchema<RTState_V1_6__7>& RTState_V1_6__7::schema()
+{
+  static const RTSchema<RTState_V1_6__7> schema(fields_V1_6__7<RTState_V1_6__7>());
+  return schema;
+}
+const RTSchema<RTState_V1_8>& RTState_V1_8::schema()
+{
+  static const RTSchema<RTState_V1_8> schema(fields_V1_8<RTState_V1_8>());
+  return schema;
+}
+const RTSchema<RTState_V3_0__1>& RTState_V3_0__1::schema()
+{
+  static const RTSchema<RTState_V3_0__1> schema(fields_V3_0__1<RTState_V3_0__1>());
+  return schema;
+}
+const RTSchema<RTState_V3_2__3>& RTState_V3_2__3::schema()
+{
+  static const RTSchema<RTState_V3_2__3> schema(fields_V3_2__3<RTState_V3_2__3>());
+  return schema;
 }
 
+bool RTState_V1_6__7::parseWith(BinParser& bp)
+{
+  return schema().decode(bp, *this);
+}
 bool RTState_V1_8::parseWith(BinParser& bp)
 {
-  if (!bp.checkSize<RTState_V1_8>())
-    return false;
-
-  RTState_V1_6__7::parseWith(bp);
-
-  bp.parse(joint_modes);
-
-  return true;
+  return schema().decode(bp, *this);
 }
-
 bool RTState_V3_0__1::parseWith(BinParser& bp)
 {
-  if (!bp.checkSize<RTState_V3_0__1>())
-    return false;
-
-  parse_shared1(bp);
-
-  bp.parse(i_control);
-  bp.parse(tool_vector_actual);
-  bp.parse(tcp_speed_actual);
-  bp.parse(tcp_force);
-  bp.parse(tool_vector_target);
-  bp.parse(tcp_speed_target);
-
-  parse_shared2(bp);
-
-  bp.parse(joint_modes);
-  bp.parse(safety_mode);
-  bp.consume(sizeof(double[6]));  // skip undocumented
-  bp.parse(tool_accelerometer_values);
-  bp.consume(sizeof(double[6]));  // skip undocumented
-  bp.parse(speed_scaling);
-  bp.parse(linear_momentum_norm);
-  bp.consume(sizeof(double));  // skip undocumented
-  bp.consume(sizeof(double));  // skip undocumented
-  bp.parse(v_main);
-  bp.parse(v_robot);
-  bp.parse(i_robot);
-  bp.parse(v_actual);
-
-  return true;
+  return schema().decode(bp, *this);
 }
-
 bool RTState_V3_2__3::parseWith(BinParser& bp)
 {
-  if (!bp.checkSize<RTState_V3_2__3>())
-    return false;
-
-  RTState_V3_0__1::parseWith(bp);
-
-  bp.parse(digital_outputs);
-  bp.parse(program_state);
-
-  return true;
+  return schema().decode(bp, *this);
 }
 
 bool RTState_V1_6__7::consumeWith(URRTPacketConsumer& consumer)
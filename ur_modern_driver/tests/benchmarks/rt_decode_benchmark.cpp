@@ -0,0 +1,125 @@
+/*
+ * Times decoding of RT state packets from random data, for every RT version through its RTSchema and, for
+ * 3.2, also field by field through BinParser::parse() as parseWith() used to.
+ *
+ * Usage: rt_decode_benchmark [n_packets] [n_repeats]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "ur_modern_driver/bin_parser.h"
+#include "ur_modern_driver/test/random_data.h"
+#include "ur_modern_driver/ur/rt_state.h"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// packets of random data cycled through, small enough to stay in cache
+const size_t N_BUFFERED = 64;
+
+// The hand written decoder of RTState_V3_2__3 that RTSchema replaced
+void parseFieldwise(BinParser& bp, RTState_V3_2__3& s)
+{
+  bp.parse(s.time);
+  bp.parse(s.q_target);
+  bp.parse(s.qd_target);
+  bp.parse(s.qdd_target);
+  bp.parse(s.i_target);
+  bp.parse(s.m_target);
+  bp.parse(s.q_actual);
+  bp.parse(s.qd_actual);
+  bp.parse(s.i_actual);
+  bp.parse(s.i_control);
+  bp.parse(s.tool_vector_actual);
+  bp.parse(s.tcp_speed_actual);
+  bp.parse(s.tcp_force);
+  bp.parse(s.tool_vector_target);
+  bp.parse(s.tcp_speed_target);
+  bp.parse(s.digital_inputs);
+  bp.parse(s.motor_temperatures);
+  bp.parse(s.controller_time);
+  bp.consume(sizeof(double));
+  bp.parse(s.robot_mode);
+  bp.parse(s.joint_modes);
+  bp.parse(s.safety_mode);
+  bp.consume(sizeof(double[6]));
+  bp.parse(s.tool_accelerometer_values);
+  bp.consume(sizeof(double[6]));
+  bp.parse(s.speed_scaling);
+  bp.parse(s.linear_momentum_norm);
+  bp.consume(sizeof(double) * 2);
+  bp.parse(s.v_main);
+  bp.parse(s.v_robot);
+  bp.parse(s.i_robot);
+  bp.parse(s.v_actual);
+  bp.parse(s.digital_outputs);
+  bp.parse(s.program_state);
+}
+
+// Runs decode() over n_packets packets of 'len' bytes, returns ns per packet
+template <typename T, typename Decode>
+double run(RandomDataTest& data, size_t len, size_t n_packets, Decode decode)
+{
+  T state;
+  double checksum = 0;
+
+  const auto start = Clock::now();
+  for (size_t i = 0; i < n_packets;)
+  {
+    BinParser all = data.getParser();
+    for (size_t j = 0; j < N_BUFFERED && i < n_packets; j++, i++)
+    {
+      BinParser bp(all, len);
+      decode(bp, state);
+      checksum += state.time;
+    }
+  }
+  const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  // keep the decoded values alive
+  if (checksum == 42.0)
+    std::printf(" ");
+  return ns / n_packets;
+}
+
+template <typename T>
+void report(const char* name, size_t n_packets, int n_repeats)
+{
+  const size_t len = T::schema().size();
+  RandomDataTest data(len * N_BUFFERED);
+
+  for (int r = 0; r < n_repeats; r++)
+  {
+    double ns = run<T>(data, len, n_packets, [](BinParser& bp, T& s) { s.parseWith(bp); });
+    std::printf("%-16s %8d %8zu %14.1f %14.2f\n", name, r, len, ns, len / ns);
+  }
+}
+
+}  // anon namespace
+
+int main(int argc, char** argv)
+{
+  const size_t n_packets = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 100000;
+  const int n_repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  std::printf("%zu packets per repeat\n", n_packets);
+  std::printf("%-16s %8s %8s %14s %14s\n", "decoder", "repeat", "bytes", "ns / packet", "GB / s");
+
+  report<RTState_V1_6__7>("schema V1.6-7", n_packets, n_repeats);
+  report<RTState_V1_8>("schema V1.8", n_packets, n_repeats);
+  report<RTState_V3_0__1>("schema V3.0-1", n_packets, n_repeats);
+  report<RTState_V3_2__3>("schema V3.2-3", n_packets, n_repeats);
+
+  const size_t len = RTState_V3_2__3::schema().size();
+  RandomDataTest data(len * N_BUFFERED);
+  for (int r = 0; r < n_repeats; r++)
+  {
+    double ns = run<RTState_V3_2__3>(data, len, n_packets, parseFieldwise);
+    std::printf("%-16s %8d %8zu %14.1f %14.2f\n", "fieldwise V3.2-3", r, len, ns, len / ns);
+  }
+
+  return 0;
+}
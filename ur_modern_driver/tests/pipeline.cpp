@@ -0,0 +1,284 @@
+#include "ur_modern_driver/pipeline.h"
+#include <gtest/gtest.h>
+#include <endian.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include "ur_modern_driver/bin_parser.h"
+#include "ur_modern_driver/packet_pool.h"
+#include "ur_modern_driver/ur/consumer.h"
+#include "ur_modern_driver/ur/rt_parser.h"
+#include "ur_modern_driver/ur/rt_state.h"
+
+// every heap allocation made by the test binary, on any thread
+static std::atomic<size_t> allocations(0);
+
+static void* countedAlloc(size_t size)
+{
+  allocations++;
+  void* ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+// every form of new and delete is replaced so that each allocation is freed by its matching form
+void* operator new(size_t size)
+{
+  return countedAlloc(size);
+}
+
+void* operator new[](size_t size)
+{
+  return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+static const size_t WARMUP_PACKETS = 100;
+static const size_t TEST_PACKETS = 1000;
+
+// A zero filled RT packet in the format of a 3.2 controller
+class RTPacketData
+{
+public:
+  // length on the wire, SIZE does not include the fields that are skipped
+  static const size_t LEN = 1060;
+  uint8_t buf[LEN];
+
+  RTPacketData()
+  {
+    std::memset(buf, 0, LEN);
+    int32_t len = htobe32(static_cast<int32_t>(LEN));
+    std::memcpy(buf, &len, sizeof(len));
+  }
+};
+
+class RTDataProducer : public IProducer<RTPacket>
+{
+private:
+  RTPacketData data_;
+  URRTStateParser_V3_2__3 parser_;
+  std::atomic<size_t>& consumed_;
+  std::atomic<bool> stopped_;
+  size_t produced_;
+
+public:
+  RTDataProducer(std::atomic<size_t>& consumed) : consumed_(consumed), stopped_(false), produced_(0)
+  {
+  }
+
+  void stopProducer()
+  {
+    stopped_ = true;
+  }
+
+  bool tryGet(std::vector<PacketPtr<RTPacket>>& products)
+  {
+    // wait for the consumer, an overflowing queue would log
+    while (consumed_ < produced_)
+    {
+      if (stopped_)
+        return false;
+      std::this_thread::yield();
+    }
+
+    BinParser bp(data_.buf, RTPacketData::LEN);
+    produced_++;
+    return parser_.parse(bp, products);
+  }
+};
+
+class CountingConsumer : public URRTPacketConsumer
+{
+public:
+  std::atomic<size_t> count;
+
+  CountingConsumer() : count(0)
+  {
+  }
+
+  bool consume(RTState_V1_6__7& state)
+  {
+    return false;
+  }
+  bool consume(RTState_V1_8& state)
+  {
+    return false;
+  }
+  bool consume(RTState_V3_0__1& state)
+  {
+    return false;
+  }
+  bool consume(RTState_V3_2__3& state)
+  {
+    count++;
+    return true;
+  }
+};
+
+static bool waitFor(std::atomic<size_t>& count, size_t n)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (count < n)
+  {
+    if (std::chrono::steady_clock::now() > deadline)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+TEST(PacketPool, testRecycling)
+{
+  PacketPool<RTPacket, RTState_V1_8> pool(2);
+
+  PacketPtr<RTPacket> a = pool.acquire();
+  PacketPtr<RTPacket> b = pool.acquire();
+  RTPacket* pa = a.get();
+  RTPacket* pb = b.get();
+  EXPECT_EQ(0u, pool.misses());
+
+  // exhausted, falls back to the heap
+  PacketPtr<RTPacket> c = pool.acquire();
+  ASSERT_NE(nullptr, c.get());
+  EXPECT_EQ(1u, pool.misses());
+
+  a.reset();
+  b.reset();
+  c.reset();
+
+  PacketPtr<RTPacket> d = pool.acquire();
+  PacketPtr<RTPacket> e = pool.acquire();
+  EXPECT_TRUE((d.get() == pa && e.get() == pb) || (d.get() == pb && e.get() == pa));
+  EXPECT_EQ(1u, pool.misses());
+}
+
+TEST(PacketPool, testParserAllocations)
+{
+  RTPacketData data;
+  URRTStateParser_V3_2__3 parser;
+  std::vector<PacketPtr<RTPacket>> products;
+  CountingConsumer consumer;
+
+  for (size_t i = 0; i < WARMUP_PACKETS + TEST_PACKETS; i++)
+  {
+    if (i == WARMUP_PACKETS)
+      allocations = 0;
+
+    BinParser bp(data.buf, RTPacketData::LEN);
+    ASSERT_TRUE(parser.parse(bp, products));
+    for (auto& p : products)
+    {
+      ASSERT_TRUE(p->consumeWith(consumer));
+    }
+    products.clear();
+  }
+
+  EXPECT_EQ(0u, allocations.load()) << "allocations in " << TEST_PACKETS << " packets";
+  EXPECT_EQ(WARMUP_PACKETS + TEST_PACKETS, consumer.count.load());
+}
+
+TEST(Pipeline, testSteadyStateAllocations)
+{
+  CountingConsumer consumer;
+  RTDataProducer producer(consumer.count);
+  Pipeline<RTPacket> pipeline(producer, consumer);
+
+  pipeline.run();
+
+  // stop before asserting, a failed assertion would leave the threads running
+  bool warmed_up = waitFor(consumer.count, WARMUP_PACKETS);
+  size_t start_count = consumer.count;
+  size_t start_allocations = allocations;
+  bool finished = warmed_up && waitFor(consumer.count, start_count + TEST_PACKETS);
+  size_t packets = consumer.count - start_count;
+  size_t allocated = allocations - start_allocations;
+
+  pipeline.stop();
+
+  ASSERT_TRUE(finished) << "Pipeline consumed only " << consumer.count.load() << " packets";
+  EXPECT_EQ(0.0, static_cast<double>(allocated) / packets) << allocated << " allocations in " << packets
+                                                            << " packets";
+}
+
+// Hands out pooled packets as fast as the queue takes them, without parsing
+class FloodProducer : public IProducer<RTPacket>
+{
+public:
+  PacketPool<RTPacket, RTState_V3_2__3> pool;
+  std::atomic<size_t> produced;
+
+  FloodProducer() : pool(PIPELINE_POOL_SIZE), produced(0)
+  {
+  }
+
+  bool tryGet(std::vector<PacketPtr<RTPacket>>& products)
+  {
+    if (produced == 4 * PIPELINE_QUEUE_SIZE)
+      return false;
+    products.push_back(pool.acquire());
+    produced++;
+    return true;
+  }
+};
+
+// Holds on to the first product until released
+class StalledConsumer : public IConsumer<RTPacket>
+{
+public:
+  std::atomic<bool> released;
+  std::atomic<size_t> count;
+
+  StalledConsumer() : released(false), count(0)
+  {
+  }
+
+  bool consume(RTPacket& product)
+  {
+    while (!released)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    count++;
+    return true;
+  }
+};
+
+TEST(Pipeline, testStalledConsumer)
+{
+  StalledConsumer consumer;
+  FloodProducer producer;
+  Pipeline<RTPacket> pipeline(producer, consumer);
+
+  pipeline.run();
+  bool flooded = waitFor(producer.produced, 4 * PIPELINE_QUEUE_SIZE);
+  consumer.released = true;
+  // the queue and the product being consumed, the rest were dropped
+  bool drained = waitFor(consumer.count, PIPELINE_QUEUE_SIZE);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pipeline.stop();
+
+  ASSERT_TRUE(flooded && drained) << "Pipeline consumed only " << consumer.count.load() << " packets";
+  EXPECT_LE(consumer.count.load(), PIPELINE_QUEUE_SIZE + 1);
+  EXPECT_EQ(0u, producer.pool.misses());
+}
@@ -0,0 +1,229 @@
+#include "ur_modern_driver/ros/trajectory_follower.h"
+#include <gtest/gtest.h>
+#include <endian.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ur_modern_driver/ur/commander.h"
+#include "ur_modern_driver/ur/server.h"
+#include "ur_modern_driver/ur/stream.h"
+
+static const int PRIMARY_PORT = 50301;
+static const int REVERSE_PORT = 50302;
+static const double RT_PERIOD = 0.008;
+static const double MULT_JOINTSTATE = 1000000.0;
+
+// Stands in for the robot: accepts the program upload on a URServer, connects
+// back to the TrajectoryFollower like the uploaded program would, records the
+// setpoints it receives and sends an RT tick every RT_PERIOD.
+class FakeController
+{
+private:
+  std::string host_;
+  URServer primary_;
+  URStream reverse_;
+  std::thread reader_, ticker_;
+  std::atomic<bool> ticking_;
+  std::mutex mutex_;
+
+  void read()
+  {
+    if (!primary_.accept() || !reverse_.connect())
+      return;
+
+    uint8_t buf[sizeof(int32_t) * 7];
+    size_t have = 0, n = 0;
+    while (reverse_.TCPSocket::read(buf + have, sizeof(buf) - have, n))
+    {
+      have += n;
+      if (have < sizeof(buf))
+        continue;
+      have = 0;
+
+      std::array<double, 6> positions;
+      for (size_t i = 0; i < positions.size(); i++)
+      {
+        int32_t val;
+        std::memcpy(&val, buf + i * sizeof(int32_t), sizeof(val));
+        positions[i] = static_cast<int32_t>(be32toh(val)) / MULT_JOINTSTATE;
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      setpoints.push_back(positions);
+      setpoint_ticks.push_back(ticks);
+    }
+  }
+
+  void tick(TrajectoryFollower& follower)
+  {
+    // the controller clock advances one period per tick even if the host oversleeps
+    while (ticking_)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(RT_PERIOD * 1e6)));
+      size_t k = ++ticks;
+      follower.tick(k * RT_PERIOD);
+    }
+  }
+
+public:
+  std::atomic<size_t> ticks;
+  std::vector<std::array<double, 6>> setpoints;
+  std::vector<size_t> setpoint_ticks;
+
+  FakeController() : host_("127.0.0.1"), primary_(PRIMARY_PORT), reverse_(host_, REVERSE_PORT), ticking_(false), ticks(0)
+  {
+  }
+
+  bool bind()
+  {
+    return primary_.bind();
+  }
+
+  // number of setpoints received so far, while the reader is running
+  size_t received()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return setpoints.size();
+  }
+
+  void run(TrajectoryFollower& follower)
+  {
+    ticking_ = true;
+    reader_ = std::thread(&FakeController::read, this);
+    ticker_ = std::thread(&FakeController::tick, this, std::ref(follower));
+  }
+
+  void stop()
+  {
+    ticking_ = false;
+    ticker_.join();
+    reverse_.disconnect();
+    reader_.join();
+  }
+};
+
+// a straight line at constant velocity from 0 to distance
+static std::vector<TrajectoryPoint> makeLine(double duration, double distance)
+{
+  std::array<double, 6> p0, p1, vel;
+  p0.fill(0.0);
+  p1.fill(distance);
+  vel.fill(distance / duration);
+  std::vector<TrajectoryPoint> trajectory;
+  trajectory.push_back(TrajectoryPoint(p0, vel, std::chrono::microseconds(0)));
+  trajectory.push_back(TrajectoryPoint(p1, vel, std::chrono::microseconds(static_cast<int64_t>(duration * 1e6))));
+  return trajectory;
+}
+
+TEST(TrajectoryFollower, testRTClockedStreaming)
+{
+  FakeController controller;
+  ASSERT_TRUE(controller.bind());
+
+  std::string host("127.0.0.1");
+  URStream stream(host, PRIMARY_PORT);
+  ASSERT_TRUE(stream.connect());
+  URCommander_V3_X commander(stream);
+
+  ServojParams params;
+  params.rt_clock = true;
+  TrajectoryFollower follower(commander, host, REVERSE_PORT, true, params);
+
+  // a straight line at constant velocity, ending between two ticks
+  const double duration = 0.404;
+  const double distance = 0.5;
+  std::vector<TrajectoryPoint> trajectory = makeLine(duration, distance);
+
+  controller.run(follower);
+  bool started = follower.start();
+  std::atomic<bool> interrupt(false);
+  bool executed = started && follower.execute(trajectory, interrupt);
+  follower.stop();
+  controller.stop();
+
+  ASSERT_TRUE(started) << "Fake controller did not connect";
+  ASSERT_TRUE(executed) << "Trajectory was not streamed";
+
+  // one setpoint per tick at the tick's trajectory time, the last one at the end of the trajectory.
+  // Setpoints only go missing if the host stalls for longer than the lookahead buffer.
+  const size_t expected = static_cast<size_t>(duration / RT_PERIOD) + 1;
+  const size_t skipped = follower.skipped();
+  ASSERT_EQ(expected, controller.setpoints.size() + skipped);
+  EXPECT_EQ(controller.setpoints.size(), follower.latencyHistogram().count());
+  EXPECT_GE(follower.underruns(), skipped);
+
+  size_t k = 0;
+  for (auto const& setpoint : controller.setpoints)
+  {
+    // trajectory tick of this setpoint, later than the previous one
+    size_t next = static_cast<size_t>(std::round(setpoint[0] * duration / (distance * RT_PERIOD)));
+    next = std::min(next, expected);
+    ASSERT_GT(next, k);
+    ASSERT_LE(next - k, skipped + 1);
+    k = next;
+
+    double p = std::min(distance, distance * k * RT_PERIOD / duration);
+    for (auto const& q : setpoint)
+    {
+      ASSERT_NEAR(p, q, 2e-6) << "setpoint " << k;
+    }
+  }
+  EXPECT_EQ(expected, k);
+
+  // setpoints were spread over the ticks, not sent in bursts
+  EXPECT_GE(controller.setpoint_ticks.back() - controller.setpoint_ticks.front(), controller.setpoints.size() - 1);
+}
+
+TEST(TrajectoryFollower, testRTClockedInterrupt)
+{
+  FakeController controller;
+  ASSERT_TRUE(controller.bind());
+
+  std::string host("127.0.0.1");
+  URStream stream(host, PRIMARY_PORT);
+  ASSERT_TRUE(stream.connect());
+  URCommander_V3_X commander(stream);
+
+  ServojParams params;
+  params.rt_clock = true;
+  TrajectoryFollower follower(commander, host, REVERSE_PORT, true, params);
+
+  std::vector<TrajectoryPoint> interrupted = makeLine(2.0, 1.0);
+  const double duration = 0.204;
+  const double distance = 0.5;
+  std::vector<TrajectoryPoint> trajectory = makeLine(duration, distance);
+
+  controller.run(follower);
+  bool started = follower.start();
+
+  // interrupted with setpoints left in the buffer, which must not be sent as part of the next trajectory
+  std::atomic<bool> interrupt(false);
+  bool first = false;
+  std::thread executor([&] { first = started && follower.execute(interrupted, interrupt); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  interrupt = true;
+  executor.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  size_t sent_before = controller.received();
+
+  interrupt = false;
+  bool second = started && follower.execute(trajectory, interrupt);
+  follower.stop();
+  controller.stop();
+
+  ASSERT_TRUE(started) << "Fake controller did not connect";
+  ASSERT_TRUE(first && second) << "Trajectories were not streamed";
+  ASSERT_GT(sent_before, 0u);
+
+  // every setpoint of the second trajectory arrives or is counted as skipped, and it starts from the beginning
+  const size_t expected = static_cast<size_t>(duration / RT_PERIOD) + 1;
+  ASSERT_EQ(expected, controller.setpoints.size() - sent_before + follower.skipped());
+  if (follower.skipped() == 0)
+  {
+    EXPECT_NEAR(distance * RT_PERIOD / duration, controller.setpoints[sent_before][0], 2e-6);
+  }
+  EXPECT_NEAR(distance, controller.setpoints.back()[0], 2e-6);
+}
@@ -189,4 +189,75 @@ TEST(RTState_V3_2__3, testTooSmallBuffer)
   BinParser bp = rdt.getParser(true);
   RTState_V3_2__3 state;
   EXPECT_FALSE(state.parseWith(bp)) << "parse() should fail when buffer not big enough";
-}
\ No newline at end of file
+}
+
+// Decodes random data, encodes it again and compares word by word with the
+// original, skipped fields must come back as zero
+template <typename T>
+void testRoundTrip()
+{
+  const RTSchema<T>& schema = T::schema();
+  RandomDataTest rdt(schema.size() + sizeof(int32_t));
+  BinParser bp = rdt.getParser(true);
+  T state;
+  ASSERT_TRUE(state.parseWith(bp)) << "parse() returned false";
+  ASSERT_TRUE(bp.empty()) << "did not consume all data";
+
+  std::vector<uint8_t> encoded(schema.size());
+  schema.encode(state, encoded.data());
+
+  BinParser ebp(encoded.data(), encoded.size());
+  size_t word = 0;
+  for (auto const& field : schema.fields())
+  {
+    for (size_t i = 0; i < field.words; i++, word++)
+    {
+      uint64_t actual;
+      ebp.parse(actual);
+      if (field.member)
+        ASSERT_EQ(rdt.getNext<uint64_t>(), actual) << "word " << word << " differs";
+      else
+      {
+        rdt.skip(sizeof(uint64_t));
+        ASSERT_EQ(0u, actual) << "skipped word " << word << " was not zeroed";
+      }
+    }
+  }
+}
+
+template <typename T>
+void testTruncatedPacket()
+{
+  RandomDataTest rdt(T::schema().size() + sizeof(int32_t) - sizeof(uint64_t));
+  BinParser bp = rdt.getParser(true);
+  T state;
+  EXPECT_FALSE(state.parseWith(bp)) << "parse() should fail when the last field is missing";
+}
+
+TEST(RTState_V1_6__7, testRoundTrip)
+{
+  EXPECT_EQ(760u, RTState_V1_6__7::schema().size());
+  testRoundTrip<RTState_V1_6__7>();
+  testTruncatedPacket<RTState_V1_6__7>();
+}
+
+TEST(RTState_V1_8, testRoundTrip)
+{
+  EXPECT_EQ(808u, RTState_V1_8::schema().size());
+  testRoundTrip<RTState_V1_8>();
+  testTruncatedPacket<RTState_V1_8>();
+}
+
+TEST(RTState_V3_0__1, testRoundTrip)
+{
+  EXPECT_EQ(1040u, RTState_V3_0__1::schema().size());
+  testRoundTrip<RTState_V3_0__1>();
+  testTruncatedPacket<RTState_V3_0__1>();
+}
+
+TEST(RTState_V3_2__3, testRoundTrip)
+{
+  EXPECT_EQ(1056u, RTState_V3_2__3::schema().size());
+  testRoundTrip<RTState_V3_2__3>();
+  testTruncatedPacket<RTState_V3_2__3>();
+}